@@ -0,0 +1,142 @@
+// Scaling benchmark for the parallel Molecule graph algorithms
+// Build: cmake -DLPP_BUILD_BENCHMARKS=ON ... && ./bench_graph [atoms] [avgDegree]
+//
+// Runs sequential MoleculeCsr::bfs and a BFS-labelling component count, then
+// csrParallelBfs and csrConnectedComponents on pools of 1, 2, 4 .. N threads
+// over a random undirected graph.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "lpp_stdlib.hpp"
+
+using namespace lpp::stdlib;
+using Clock = std::chrono::steady_clock;
+using AtomId = MoleculeCsr::AtomId;
+
+namespace
+{
+    double msSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Uniform random undirected edges, stored in both directions
+    MoleculeCsr randomGraph(size_t atoms, size_t avgDegree, uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<AtomId> pick(0, static_cast<AtomId>(atoms - 1));
+        const size_t edges = atoms * avgDegree / 2;
+
+        std::vector<std::pair<AtomId, AtomId>> list(edges);
+        for (auto &e : list)
+            e = {pick(rng), pick(rng)};
+
+        MoleculeCsr g;
+        g.offsets.assign(atoms + 1, 0);
+        for (const auto &e : list)
+        {
+            g.offsets[e.first + 1]++;
+            g.offsets[e.second + 1]++;
+        }
+        for (size_t i = 0; i < atoms; i++)
+            g.offsets[i + 1] += g.offsets[i];
+
+        g.targets.resize(edges * 2);
+        std::vector<size_t> cursor(g.offsets.begin(), g.offsets.end() - 1);
+        for (const auto &e : list)
+        {
+            g.targets[cursor[e.first]++] = e.second;
+            g.targets[cursor[e.second]++] = e.first;
+        }
+        return g;
+    }
+
+    size_t sequentialComponents(const MoleculeCsr &g)
+    {
+        std::vector<bool> seen(g.atomCount(), false);
+        std::vector<AtomId> queue;
+        size_t count = 0;
+        for (AtomId root = 0; root < g.atomCount(); root++)
+        {
+            if (seen[root])
+                continue;
+            count++;
+            seen[root] = true;
+            queue.assign(1, root);
+            for (size_t head = 0; head < queue.size(); head++)
+                for (AtomId v : g.neighbors(queue[head]))
+                    if (!seen[v])
+                    {
+                        seen[v] = true;
+                        queue.push_back(v);
+                    }
+        }
+        return count;
+    }
+
+    template <typename F>
+    double bestOf(int runs, F &&fn)
+    {
+        double best = 1e300;
+        for (int i = 0; i < runs; i++)
+        {
+            auto start = Clock::now();
+            fn();
+            best = std::min(best, msSince(start));
+        }
+        return best;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t atoms = argc > 1 ? std::stoul(argv[1]) : (size_t(1) << 22);
+    size_t degree = argc > 2 ? std::stoul(argv[2]) : 16;
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    const int runs = 3;
+
+    std::cout << "Building random graph: " << atoms << " atoms, avg degree " << degree << "\n";
+    MoleculeCsr g = randomGraph(atoms, degree, 42);
+    std::cout << g.edgeCount() << " directed edges\n\n";
+
+    size_t reachedSeq = 0, componentsSeq = 0;
+    double bfsSeq = bestOf(runs, [&]
+                           { reachedSeq = g.bfs(0).size(); });
+    double ccSeq = bestOf(runs, [&]
+                          { componentsSeq = sequentialComponents(g); });
+
+    std::cout << std::left << std::setw(10) << "threads"
+              << std::right << std::setw(12) << "BFS ms" << std::setw(10) << "speedup"
+              << std::setw(12) << "CC ms" << std::setw(10) << "speedup" << "\n";
+    std::cout << std::left << std::setw(10) << "seq" << std::fixed << std::setprecision(1)
+              << std::right << std::setw(12) << bfsSeq << std::setw(10) << "1.0"
+              << std::setw(12) << ccSeq << std::setw(10) << "1.0" << "\n";
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        ThreadPool pool(threads);
+        size_t reached = 0, components = 0;
+
+        double bfsMs = bestOf(runs, [&]
+                              { reached = csrParallelBfs(g, g, 0, pool).reached; });
+        double ccMs = bestOf(runs, [&]
+                             {
+            std::vector<AtomId> labels = csrConnectedComponents(g, pool);
+            components = 0;
+            for (size_t i = 0; i < labels.size(); i++)
+                components += labels[i] == i; });
+
+        std::cout << std::left << std::setw(10) << threads << std::right
+                  << std::setw(12) << bfsMs << std::setw(10) << std::setprecision(2) << bfsSeq / bfsMs
+                  << std::setprecision(1) << std::setw(12) << ccMs << std::setw(10) << std::setprecision(2) << ccSeq / ccMs
+                  << std::setprecision(1);
+        if (reached != reachedSeq || components != componentsSeq)
+            std::cout << "  MISMATCH";
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Load-time benchmark for bulk Molecule construction
+// Build: cmake -DLPP_BUILD_BENCHMARKS=ON ... && ./bench_loader [edges] [atoms]
+//
+// Writes a random "from to weight" edge list, then compares a line-by-line
+// parse feeding Molecule::addBond against loadEdgeList on pools of 1, 2, 4 .. N
+// threads, and a snapshot save/load round trip.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include "lpp_stdlib.hpp"
+
+using namespace lpp::stdlib;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    double msSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void writeEdgeList(const std::string &path, size_t edges, size_t atoms, uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<size_t> pick(0, atoms - 1);
+        std::uniform_int_distribution<int> weight(1, 100);
+        std::ofstream out(path);
+        for (size_t i = 0; i < edges; i++)
+            out << "atom" << pick(rng) << ' ' << "atom" << pick(rng) << ' ' << weight(rng) << '\n';
+    }
+
+    // Baseline: what L++ code had to write before (getline + addBond)
+    Molecule<std::string> addBondLoop(const std::string &path)
+    {
+        Molecule<std::string> mol;
+        std::ifstream in(path);
+        std::string line, from, to;
+        double weight;
+        while (std::getline(in, line))
+        {
+            std::istringstream fields(line);
+            if (!(fields >> from >> to >> weight))
+                continue;
+            mol.addAtom(from);
+            mol.addAtom(to);
+            mol.addBond(from, to, BondType::SINGLE, weight);
+        }
+        mol.freeze();
+        return mol;
+    }
+
+    void report(const std::string &name, double ms, double baseMs, size_t bytes)
+    {
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << ms
+                  << std::setw(10) << std::setprecision(2) << baseMs / ms
+                  << std::setw(12) << std::setprecision(1) << bytes / ms / 1e3 << "\n";
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t edges = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    size_t atoms = argc > 2 ? std::stoul(argv[2]) : 200000;
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    const std::string listPath = "bench_loader_edges.txt";
+    const std::string snapshotPath = "bench_loader_edges.lppmol";
+
+    writeEdgeList(listPath, edges, atoms, 42);
+    const size_t bytes = MappedFile(listPath).size();
+    std::cout << edges << " edges over " << atoms << " atoms (" << bytes / (1 << 20) << " MiB)\n\n";
+
+    std::cout << std::left << std::setw(22) << "method" << std::right << std::setw(10) << "ms"
+              << std::setw(10) << "speedup" << std::setw(12) << "MB/s" << "\n";
+
+    auto start = Clock::now();
+    Molecule<std::string> baseline = addBondLoop(listPath);
+    double baseMs = msSince(start);
+    report("getline + addBond", baseMs, baseMs, bytes);
+
+    FrozenMolecule<std::string> loaded;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        ThreadPool pool(threads);
+        start = Clock::now();
+        loaded = loadEdgeList(listPath, EdgeListOptions(), pool);
+        report("loadEdgeList x" + std::to_string(threads), msSince(start), baseMs, bytes);
+    }
+
+    start = Clock::now();
+    saveSnapshot(loaded, snapshotPath);
+    report("saveSnapshot", msSince(start), baseMs, bytes);
+
+    start = Clock::now();
+    FrozenMolecule<std::string> restored = loadSnapshot(snapshotPath);
+    report("loadSnapshot", msSince(start), baseMs, bytes);
+
+    // addBond drops duplicate lines, the loaders keep them as parallel edges
+    if (loaded.atomCount() != baseline.atomCount() || restored.csr().targets != loaded.csr().targets)
+        std::cout << "MISMATCH\n";
+
+    std::remove(listPath.c_str());
+    std::remove(snapshotPath.c_str());
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Parsing throughput benchmark for the CSV and JSON readers
+// Build: cmake -DLPP_BUILD_BENCHMARKS=ON ... && ./bench_parse [rows]
+//
+// Writes a CSV file and sums one numeric column three ways: getline + split
+// (what L++ code had to do before), lines() + parseCsvLine, and csvRows().
+// Then writes the same records as one JSON array and as NDJSON, and sums the
+// same field through the on-demand reader.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include "lpp_stdlib.hpp"
+
+using namespace lpp::stdlib;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    double msSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // id,name,city,score,note: every tenth note is quoted and holds a comma
+    void writeFiles(const std::string &csvPath, const std::string &jsonPath, const std::string &ndjsonPath,
+                    size_t rows, uint64_t seed)
+    {
+        static const char *cities[] = {"Rome", "Milan", "Turin", "Naples", "Bologna"};
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> score(0.0, 100.0);
+        std::ofstream csv(csvPath), json(jsonPath), ndjson(ndjsonPath);
+        csv << "id,name,city,score,note\n";
+        json << "[\n";
+        for (size_t i = 0; i < rows; i++)
+        {
+            const std::string name = "user" + std::to_string(rng() % 100000);
+            const char *city = cities[rng() % 5];
+            const std::string value = std::to_string(score(rng));
+            const bool quoted = i % 10 == 0;
+            csv << i << ',' << name << ',' << city << ',' << value << ','
+                << (quoted ? "\"late, resent\"" : "ok") << '\n';
+            std::string record = "{\"id\": " + std::to_string(i) + ", \"name\": \"" + name + "\", \"city\": \"" + city +
+                                 "\", \"score\": " + value + ", \"tags\": [\"a\", \"b\"], \"note\": \"" +
+                                 (quoted ? "late, resent" : "ok") + "\"}";
+            json << record << (i + 1 < rows ? ",\n" : "\n");
+            ndjson << record << '\n';
+        }
+        json << "]\n";
+    }
+
+    // Baseline: getline + split, one std::string per field. Lines with a
+    // quoted comma split into too many fields; the score column is still
+    // fourth, so the sum matches.
+    double splitSum(const std::string &path)
+    {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line); // Header
+        double sum = 0;
+        while (std::getline(in, line))
+            sum += std::stod(split(line, ",")[3]);
+        return sum;
+    }
+
+    double lineSum(const std::string &path)
+    {
+        CsvRow row;
+        double sum = 0;
+        bool header = true;
+        for (std::string_view line : lines(path))
+        {
+            parseCsvLine(line, row);
+            if (!header)
+                sum += row.asDouble(3);
+            header = false;
+        }
+        return sum;
+    }
+
+    double csvSum(const std::string &path)
+    {
+        double sum = 0;
+        for (const CsvRow &row : csvRows(path))
+        {
+            if (row.lineNumber() > 1)
+                sum += row.asDouble(3);
+        }
+        return sum;
+    }
+
+    double jsonSum(const std::string &path)
+    {
+        JsonDocument doc = readJson(path);
+        double sum = 0;
+        for (JsonValue record : doc.root())
+            sum += record["score"].getDouble();
+        return sum;
+    }
+
+    double ndjsonSum(const std::string &path)
+    {
+        double sum = 0;
+        for (std::string_view line : lines(path))
+            sum += jsonView(line)["score"].getDouble();
+        return sum;
+    }
+
+    void report(const std::string &name, double ms, double baseMs, size_t bytes)
+    {
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << ms
+                  << std::setw(10) << std::setprecision(2) << baseMs / ms
+                  << std::setw(10) << std::setprecision(2) << bytes / ms / 1e6 << "\n";
+    }
+
+    template <typename F>
+    void run(const std::string &name, F fn, const std::string &path, double &baseMs, double expected)
+    {
+        const size_t bytes = MappedFile(path).size();
+        auto start = Clock::now();
+        const double sum = fn(path);
+        const double ms = msSince(start);
+        if (baseMs == 0)
+            baseMs = ms;
+        report(name, ms, baseMs, bytes);
+        if (std::abs(sum - expected) > 1e-6 * std::abs(expected))
+            std::cout << "MISMATCH " << sum << " != " << expected << "\n";
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    const std::string csvPath = "bench_parse.csv";
+    const std::string jsonPath = "bench_parse.json";
+    const std::string ndjsonPath = "bench_parse.ndjson";
+
+    writeFiles(csvPath, jsonPath, ndjsonPath, rows, 42);
+    std::cout << rows << " records\n\n";
+    std::cout << std::left << std::setw(24) << "method" << std::right << std::setw(10) << "ms"
+              << std::setw(10) << "speedup" << std::setw(10) << "GB/s" << "\n";
+
+    // Warm the page cache so the first method isn't charged for the disk
+    readChunks(csvPath, 1 << 20, [](std::string_view) {});
+
+    const double expected = csvSum(csvPath);
+    double baseMs = 0;
+    run("getline + split", splitSum, csvPath, baseMs, expected);
+    run("lines + parseCsvLine", lineSum, csvPath, baseMs, expected);
+    run("csvRows", csvSum, csvPath, baseMs, expected);
+
+    readChunks(jsonPath, 1 << 20, [](std::string_view) {});
+    readChunks(ndjsonPath, 1 << 20, [](std::string_view) {});
+    run("readJson (array)", jsonSum, jsonPath, baseMs, expected);
+    run("lines + jsonView", ndjsonSum, ndjsonPath, baseMs, expected);
+
+    std::remove(csvPath.c_str());
+    std::remove(jsonPath.c_str());
+    std::remove(ndjsonPath.c_str());
+    return 0;
+}
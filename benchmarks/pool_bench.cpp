@@ -0,0 +1,140 @@
+// Allocation benchmark for the ObjectPool, pooled Factory and Flyweight patterns
+// Build: cmake -DLPP_BUILD_BENCHMARKS=ON ... && ./bench_pool [operations] [live objects] [distinct keys]
+//
+// Counts calls to the global operator new alongside wall time:
+//  - object churn: make_unique per object vs SlabPool::acquire
+//  - flyweight lookup: unordered_map<string, unique_ptr<T>> (what the old
+//    Flyweight expansion declared) vs InternTable
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "lpp_patterns.hpp"
+
+using namespace lpp::patterns;
+using Clock = std::chrono::steady_clock;
+
+static size_t allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace
+{
+    struct Particle
+    {
+        double x, y, vx, vy;
+        uint32_t ttl;
+        Particle(double x, double y, uint32_t ttl) : x(x), y(y), vx(1), vy(-1), ttl(ttl) {}
+    };
+
+    struct Glyph
+    {
+        std::string symbol;
+        uint32_t width;
+        bool operator==(const Glyph &other) const { return symbol == other.symbol; }
+    };
+
+    struct GlyphHash
+    {
+        size_t operator()(const Glyph &g) const { return std::hash<std::string>()(g.symbol); }
+    };
+
+    double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void report(const std::string &name, size_t ops, double seconds, size_t mallocs)
+    {
+        std::cout << "  " << std::left << std::setw(30) << name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(10) << (ops / seconds / 1e6) << " Mops/s"
+                  << std::setw(12) << mallocs << " mallocs\n";
+    }
+
+    // Keeps `live` objects around and replaces one per step, so every
+    // step is one release and one allocation
+    template <typename Handle, typename Make>
+    double churn(size_t ops, size_t live, Make make)
+    {
+        std::vector<Handle> window;
+        window.reserve(live);
+        for (size_t i = 0; i < live; i++)
+            window.push_back(make(i));
+        double checksum = 0;
+        for (size_t i = 0; i < ops; i++)
+        {
+            Handle &slot = window[(i * 7919) % live];
+            checksum += slot->x + slot->ttl;
+            slot = make(i);
+        }
+        return checksum;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t ops = argc > 1 ? std::stoul(argv[1]) : 5000000;
+    size_t live = argc > 2 ? std::stoul(argv[2]) : 10000;
+    size_t keys = argc > 3 ? std::stoul(argv[3]) : 2000;
+
+    std::cout << ops << " operations, " << live << " live objects, " << keys << " distinct glyphs\n\n";
+
+    std::cout << "object churn\n";
+    size_t before = allocations;
+    auto start = Clock::now();
+    double a = churn<std::unique_ptr<Particle>>(ops, live, [](size_t i)
+                                                { return std::make_unique<Particle>(i, i, i & 63); });
+    report("make_unique", ops, secondsSince(start), allocations - before);
+
+    SlabPool<Particle> pool;
+    before = allocations;
+    start = Clock::now();
+    double b = churn<PoolHandle<Particle>>(ops, live, [&](size_t i)
+                                           { return pool.acquire(i, i, i & 63); });
+    report("SlabPool::acquire", ops, secondsSince(start), allocations - before);
+
+    std::vector<std::string> symbols(keys);
+    for (size_t k = 0; k < keys; k++)
+        symbols[k] = "g" + std::to_string(k);
+
+    std::cout << "flyweight lookup\n";
+    std::unordered_map<std::string, std::unique_ptr<Glyph>> map;
+    size_t widths = 0;
+    before = allocations;
+    start = Clock::now();
+    for (size_t i = 0; i < ops; i++)
+    {
+        const std::string &symbol = symbols[(i * 7919) % keys];
+        auto it = map.find(symbol);
+        if (it == map.end())
+            it = map.emplace(symbol, std::make_unique<Glyph>(Glyph{symbol, 8})).first;
+        widths += it->second->width;
+    }
+    report("unordered_map + unique_ptr", ops, secondsSince(start), allocations - before);
+
+    InternTable<Glyph, GlyphHash> table;
+    before = allocations;
+    start = Clock::now();
+    for (size_t i = 0; i < ops; i++)
+        widths += table.intern(Glyph{symbols[(i * 7919) % keys], 8})->width;
+    report("InternTable::intern", ops, secondsSince(start), allocations - before);
+
+    if (a != b || map.size() != table.size())
+        std::cout << "  MISMATCH\n";
+    return widths == 0;
+}
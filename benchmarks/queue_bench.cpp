@@ -0,0 +1,178 @@
+// Throughput/latency benchmark for the stdlib concurrent queues
+// Build: cmake -DLPP_BUILD_BENCHMARKS=ON ... && ./bench_queue [itemsPerProducer]
+//
+// Compares a mutex-guarded std::queue against SpscQueue, MpmcQueue and
+// Channel under 1..N producers and consumers.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "lpp_stdlib.hpp"
+
+using namespace lpp::stdlib;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    // Baseline: what L++ code had to write before (Queue + a mutex)
+    template <typename T>
+    class LockedQueue
+    {
+    private:
+        std::mutex m;
+        std::queue<T> q;
+        size_t cap;
+
+    public:
+        explicit LockedQueue(size_t capacity) : cap(capacity) {}
+        bool tryEnqueue(T item)
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (q.size() >= cap)
+                return false;
+            q.push(std::move(item));
+            return true;
+        }
+        bool tryDequeue(T &out)
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (q.empty())
+                return false;
+            out = std::move(q.front());
+            q.pop();
+            return true;
+        }
+    };
+
+    double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void report(const std::string &name, int producers, int consumers, size_t items, double seconds)
+    {
+        std::cout << std::left << std::setw(14) << name
+                  << std::right << std::setw(3) << producers << "P/" << std::setw(2) << consumers << "C"
+                  << std::setw(12) << std::fixed << std::setprecision(2) << (items / seconds / 1e6) << " Mops/s\n";
+    }
+
+    // Spin-based pipeline for the non-blocking queues
+    template <typename Q>
+    double runPolling(Q &queue, int producers, int consumers, size_t perProducer)
+    {
+        const size_t total = perProducer * producers;
+        std::atomic<size_t> consumed{0};
+        std::vector<std::thread> threads;
+
+        auto start = Clock::now();
+        for (int p = 0; p < producers; p++)
+        {
+            threads.emplace_back([&]
+                                 {
+                for (size_t i = 0; i < perProducer; i++)
+                    while (!queue.tryEnqueue(i))
+                        std::this_thread::yield(); });
+        }
+        for (int c = 0; c < consumers; c++)
+        {
+            threads.emplace_back([&]
+                                 {
+                size_t item;
+                while (consumed.load(std::memory_order_relaxed) < total)
+                {
+                    if (queue.tryDequeue(item))
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    else
+                        std::this_thread::yield();
+                } });
+        }
+        for (auto &t : threads)
+            t.join();
+        return secondsSince(start);
+    }
+
+    double runChannel(int producers, int consumers, size_t perProducer)
+    {
+        Channel<size_t> channel(4096);
+        std::vector<std::thread> senders, receivers;
+
+        auto start = Clock::now();
+        for (int p = 0; p < producers; p++)
+            senders.emplace_back([&]
+                                 { for (size_t i = 0; i < perProducer; i++) channel.send(i); });
+        for (int c = 0; c < consumers; c++)
+            receivers.emplace_back([&]
+                                   { while (channel.receive()) {} });
+        for (auto &t : senders)
+            t.join();
+        channel.close();
+        for (auto &t : receivers)
+            t.join();
+        return secondsSince(start);
+    }
+
+    // Round trip through two SPSC rings (ping/pong between two threads)
+    template <typename Q>
+    double pingPongNs(size_t rounds)
+    {
+        Q ping(64), pong(64);
+        std::thread echo([&]
+                         {
+            size_t v;
+            for (size_t i = 0; i < rounds; i++)
+            {
+                while (!ping.tryDequeue(v))
+                    std::this_thread::yield();
+                while (!pong.tryEnqueue(v))
+                    std::this_thread::yield();
+            } });
+
+        auto start = Clock::now();
+        size_t v;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            while (!ping.tryEnqueue(i))
+                std::this_thread::yield();
+            while (!pong.tryDequeue(v))
+                std::this_thread::yield();
+        }
+        double seconds = secondsSince(start);
+        echo.join();
+        return seconds * 1e9 / rounds;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t perProducer = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    int maxThreads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+
+    std::cout << "== Throughput (" << perProducer << " items per producer) ==\n";
+    {
+        LockedQueue<size_t> locked(4096);
+        report("mutex+queue", 1, 1, perProducer, runPolling(locked, 1, 1, perProducer));
+        SpscQueue<size_t> spsc(4096);
+        report("SpscQueue", 1, 1, perProducer, runPolling(spsc, 1, 1, perProducer));
+    }
+
+    for (int n = 1; n <= maxThreads / 2; n *= 2)
+    {
+        LockedQueue<size_t> locked(4096);
+        report("mutex+queue", n, n, perProducer * n, runPolling(locked, n, n, perProducer));
+        MpmcQueue<size_t> mpmc(4096);
+        report("MpmcQueue", n, n, perProducer * n, runPolling(mpmc, n, n, perProducer));
+        report("Channel", n, n, perProducer * n, runChannel(n, n, perProducer));
+    }
+
+    std::cout << "\n== Latency (round trip, 2 threads) ==\n";
+    const size_t rounds = std::min<size_t>(perProducer, 200000);
+    std::cout << std::left << std::setw(14) << "SpscQueue" << std::right << std::setw(10)
+              << std::setprecision(1) << pingPongNs<SpscQueue<size_t>>(rounds) << " ns\n";
+    std::cout << std::left << std::setw(14) << "MpmcQueue" << std::right << std::setw(10)
+              << pingPongNs<MpmcQueue<size_t>>(rounds) << " ns\n";
+    std::cout << std::left << std::setw(14) << "mutex+queue" << std::right << std::setw(10)
+              << pingPongNs<LockedQueue<size_t>>(rounds) << " ns\n";
+    return 0;
+}
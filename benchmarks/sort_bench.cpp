@@ -0,0 +1,160 @@
+// Sorting benchmark: std::sort vs pdqsort, radixSort and parallelSort
+// Build: cmake -DLPP_BUILD_BENCHMARKS=ON ... && ./bench_sort [n] [threads]
+//
+// Each input is sorted by every method from the same copy and the result is
+// checked against std::sort. Then sortBy on a record key against
+// std::stable_sort, and lowerBound against std::lower_bound.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include "lpp_stdlib.hpp"
+
+using namespace lpp::stdlib;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    double msSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void report(const std::string &name, double ms, double baseMs)
+    {
+        std::cout << "  " << std::left << std::setw(22) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << ms
+                  << std::setw(10) << std::setprecision(2) << baseMs / ms << "\n";
+    }
+
+    template <typename T, typename F>
+    void run(const std::string &name, const std::vector<T> &input, const std::vector<T> &expected, F sortFn,
+             double &baseMs)
+    {
+        std::vector<T> data = input;
+        auto start = Clock::now();
+        sortFn(data);
+        const double ms = msSince(start);
+        if (baseMs == 0)
+            baseMs = ms;
+        report(name, ms, baseMs);
+        if (data != expected)
+            std::cout << "  MISMATCH in " << name << "\n";
+    }
+
+    template <typename T>
+    void compare(const std::string &label, const std::vector<T> &input, ThreadPool &pool)
+    {
+        std::cout << label << "\n";
+        std::vector<T> expected = input;
+        double baseMs = 0;
+        run("std::sort", input, expected, [&](std::vector<T> &v)
+            { std::sort(v.begin(), v.end()); expected = v; }, baseMs);
+        run("pdqsort", input, expected, [](std::vector<T> &v)
+            { pdqsort(v.begin(), v.end()); }, baseMs);
+        if constexpr (std::is_arithmetic<T>::value)
+        {
+            run("radixSort", input, expected, [](std::vector<T> &v)
+                { radixSort(v); }, baseMs);
+        }
+        run("parallelSort", input, expected, [&](std::vector<T> &v)
+            { parallelSort(v, std::less<>(), pool); }, baseMs);
+    }
+
+    struct Record
+    {
+        uint32_t id;
+        double score;
+    };
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    size_t threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    ThreadPool pool(threads);
+    std::mt19937_64 rng(42);
+
+    std::cout << n << " elements, " << pool.size() << " threads\n\n";
+    std::cout << "  " << std::left << std::setw(22) << "method" << std::right << std::setw(10) << "ms"
+              << std::setw(10) << "speedup" << "\n";
+
+    std::vector<int64_t> random(n);
+    for (auto &x : random)
+        x = static_cast<int64_t>(rng());
+    compare("random int64", random, pool);
+
+    std::vector<int32_t> random32(n);
+    for (auto &x : random32)
+        x = static_cast<int32_t>(rng());
+    compare("random int32", random32, pool);
+
+    std::vector<int64_t> ascending = random;
+    std::sort(ascending.begin(), ascending.end());
+    for (size_t i = 0; i < n / 100; i++)
+        std::swap(ascending[rng() % n], ascending[rng() % n]);
+    compare("nearly sorted int64", ascending, pool);
+
+    std::vector<int64_t> fewUnique(n);
+    for (auto &x : fewUnique)
+        x = static_cast<int64_t>(rng() % 16);
+    compare("16 distinct int64", fewUnique, pool);
+
+    std::vector<double> doubles(n);
+    std::normal_distribution<double> normal(0.0, 1000.0);
+    for (auto &x : doubles)
+        x = normal(rng);
+    compare("normal double", doubles, pool);
+
+    std::vector<std::string> strings(n / 10);
+    for (auto &s : strings)
+        s = "key" + std::to_string(rng() % 1000000);
+    compare("string (n/10)", strings, pool);
+
+    // Key extraction: the score is computed once per record, not per comparison
+    std::cout << "records by score\n";
+    std::vector<Record> records(n);
+    for (size_t i = 0; i < n; i++)
+        records[i] = {static_cast<uint32_t>(i), normal(rng)};
+    auto start = Clock::now();
+    std::vector<Record> expected = records;
+    std::stable_sort(expected.begin(), expected.end(), [](const Record &a, const Record &b)
+                     { return a.score < b.score; });
+    double baseMs = msSince(start);
+    report("std::stable_sort", baseMs, baseMs);
+    start = Clock::now();
+    std::vector<Record> byScore = sortBy(records, [](const Record &r)
+                                         { return r.score; });
+    report("sortBy", msSince(start), baseMs);
+    for (size_t i = 0; i < n; i++)
+    {
+        if (byScore[i].id != expected[i].id)
+        {
+            std::cout << "  MISMATCH in sortBy\n";
+            break;
+        }
+    }
+
+    // Search: random probes into the sorted int64 data
+    std::cout << "10M probes\n";
+    std::vector<int64_t> sortedKeys = random;
+    std::sort(sortedKeys.begin(), sortedKeys.end());
+    std::vector<int64_t> probes(10000000);
+    for (auto &x : probes)
+        x = static_cast<int64_t>(rng());
+    size_t checkStd = 0, checkLpp = 0;
+    start = Clock::now();
+    for (int64_t probe : probes)
+        checkStd += static_cast<size_t>(std::lower_bound(sortedKeys.begin(), sortedKeys.end(), probe) - sortedKeys.begin());
+    baseMs = msSince(start);
+    report("std::lower_bound", baseMs, baseMs);
+    start = Clock::now();
+    for (int64_t probe : probes)
+        checkLpp += lowerBound(sortedKeys, probe);
+    report("lowerBound", msSince(start), baseMs);
+    if (checkStd != checkLpp)
+        std::cout << "  MISMATCH in lowerBound\n";
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Scaling benchmark for parallel for on the work-stealing TaskScheduler
+// Build: cmake -DLPP_BUILD_BENCHMARKS=ON ... && ./bench_task [rows] [max threads]
+//
+// Renders a Mandelbrot set one row per iteration. Rows near the set cost
+// far more than rows outside it, so static splitting balances badly; the
+// scheduler's on-demand splitting and stealing should keep speedup close
+// to the thread count. Also times spawn + join of many small tasks.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lpp_stdlib.hpp"
+
+using namespace lpp::stdlib;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    constexpr int WIDTH = 1024;
+    constexpr int MAX_ITER = 2000;
+
+    double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    uint64_t renderRow(int y, int rows)
+    {
+        uint64_t iterations = 0;
+        const double ci = -1.25 + 2.5 * y / rows;
+        for (int x = 0; x < WIDTH; x++)
+        {
+            const double cr = -2.0 + 2.6 * x / WIDTH;
+            double zr = 0, zi = 0;
+            int i = 0;
+            while (i < MAX_ITER && zr * zr + zi * zi < 4.0)
+            {
+                const double t = zr * zr - zi * zi + cr;
+                zi = 2 * zr * zi + ci;
+                zr = t;
+                i++;
+            }
+            iterations += i;
+        }
+        return iterations;
+    }
+
+    void report(const std::string &name, double seconds, double baseline)
+    {
+        std::cout << "  " << std::left << std::setw(22) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << seconds * 1e3 << " ms" << std::setprecision(2)
+                  << std::setw(9) << baseline / seconds << "x\n";
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int rows = argc > 1 ? std::stoi(argv[1]) : 768;
+    size_t maxThreads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << rows << " rows x " << WIDTH << " px, up to " << maxThreads << " threads\n\n";
+
+    std::vector<int> ys(rows);
+    for (int y = 0; y < rows; y++)
+        ys[y] = y;
+
+    std::cout << "mandelbrot rows (parallel for)\n";
+    auto start = Clock::now();
+    uint64_t expected = 0;
+    for (int y : ys)
+        expected += renderRow(y, rows);
+    const double sequential = secondsSince(start);
+    report("sequential", sequential, sequential);
+
+    bool mismatch = false;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        TaskScheduler scheduler(threads);
+        std::vector<uint64_t> perRow(rows);
+        start = Clock::now();
+        parallelForEach(ys, [&](int y)
+                        { perRow[y] = renderRow(y, rows); }, scheduler);
+        const double seconds = secondsSince(start);
+        uint64_t total = 0;
+        for (uint64_t row : perRow)
+            total += row;
+        mismatch |= total != expected;
+        report(std::to_string(threads) + " thread(s)", seconds, sequential);
+    }
+
+    std::cout << "spawn + join, 100k empty tasks\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        TaskScheduler scheduler(threads);
+        std::atomic<uint64_t> ran{0};
+        start = Clock::now();
+        {
+            TaskScope scope(scheduler);
+            for (int i = 0; i < 100000; i++)
+                scope.spawn([&ran]
+                            { ran.fetch_add(1, std::memory_order_relaxed); });
+            scope.join();
+        }
+        const double seconds = secondsSince(start);
+        mismatch |= ran != 100000;
+        std::cout << "  " << std::left << std::setw(22) << (std::to_string(threads) + " thread(s)") << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(10) << 100000 / seconds / 1e6 << " Mtasks/s\n";
+    }
+
+    if (mismatch)
+        std::cout << "  MISMATCH\n";
+    return mismatch;
+}
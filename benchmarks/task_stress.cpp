@@ -0,0 +1,105 @@
+// Stress test for spawn/await on the TaskScheduler
+// Build: cmake -DLPP_BUILD_BENCHMARKS=ON ... && ./stress_task [pairs] [max threads]
+//
+// Spawns tiny tasks and awaits each one after yielding, so a worker has
+// usually taken the task and the awaiting thread, finding nothing to run,
+// goes to sleep just as the worker finishes it. A lost wakeup leaves the
+// waiter asleep for good; a watchdog reports that as a hang and exits with
+// status 1.
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lpp_stdlib.hpp"
+
+using namespace lpp::stdlib;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    long smallWork(long i)
+    {
+        uint64_t x = static_cast<uint64_t>(i);
+        for (int k = 0; k < 64; k++)
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<long>((x >> 33) % 7);
+    }
+
+    long spawnAndAwait(TaskScheduler &scheduler, long i)
+    {
+        Task<long> task = spawn([i]
+                                { return smallWork(i); },
+                                scheduler);
+        std::this_thread::yield();
+        return task.get();
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const long pairs = argc > 1 ? std::stol(argv[1]) : 200000;
+    const size_t maxThreads = argc > 2 ? std::stoul(argv[2]) : 4;
+
+    std::atomic<long> progress{0};
+    std::atomic<bool> finished{false};
+    std::thread watchdog([&]
+                         {
+        long last = -1;
+        auto lastChange = Clock::now();
+        while (!finished.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            const long now = progress.load();
+            if (now != last)
+            {
+                last = now;
+                lastChange = Clock::now();
+            }
+            else if (Clock::now() - lastChange > std::chrono::seconds(10))
+            {
+                std::cout << "HANG after " << now << " awaits\n";
+                std::_Exit(1);
+            }
+        } });
+
+    for (size_t threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        TaskScheduler scheduler(threads);
+        const auto start = Clock::now();
+        long sum = 0;
+        for (long i = 0; i < pairs; i++)
+        {
+            sum += spawnAndAwait(scheduler, i);
+            progress.fetch_add(1);
+        }
+
+        // Several awaiting threads at once
+        std::vector<std::thread> awaiters;
+        std::atomic<long> shared{0};
+        for (size_t t = 0; t < threads; t++)
+        {
+            awaiters.emplace_back([&]
+                                  {
+                for (long i = 0; i < pairs / 4; i++)
+                {
+                    shared += spawnAndAwait(scheduler, i);
+                    progress.fetch_add(1);
+                } });
+        }
+        for (auto &awaiter : awaiters)
+            awaiter.join();
+
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::cout << threads << " workers: " << pairs + static_cast<long>(threads) * (pairs / 4)
+                  << " spawn/await pairs in " << ms << " ms (checksum " << sum + shared.load() << ")\n";
+    }
+
+    finished = true;
+    watchdog.join();
+    return 0;
+}
@@ -0,0 +1,100 @@
+#!/bin/sh
+# End-to-end build time of a generated multi-module project, per-module
+# translation units against lppc --unity
+# Usage: benchmarks/unity_build_bench.sh <path/to/lppc> [modules] [units] [profile]
+#
+# Every module defines a few functions and a match expression; main.lpp calls
+# one function from each. The per-module build transpiles each file with
+# 'lppc -c', compiles every .lpp.cpp on its own (the prelude and
+# lpp_stdlib.hpp are parsed once per module) and links. The unity build
+# does all of it with one lppc invocation.
+
+set -e
+
+LPPC=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+MODULES=${2:-200}
+UNITS=${3:-1}
+PROFILE=${4:-debug}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+ln -s "$ROOT/stdlib" "$WORK/stdlib"
+mkdir "$WORK/project"
+cd "$WORK/project"
+
+FLAGS="-std=c++17 -O0 -g"
+case "$PROFILE" in
+release) FLAGS="-std=c++17 -O2 -flto -DNDEBUG" ;;
+release-native) FLAGS="-std=c++17 -O3 -flto -march=native -DNDEBUG" ;;
+size) FLAGS="-std=c++17 -Os -flto -DNDEBUG -s" ;;
+esac
+
+i=0
+echo "#pragma paradigm hybrid" > main.lpp
+echo "" >> main.lpp
+while [ "$i" -lt "$MODULES" ]; do
+    cat > "mod$i.lpp" <<EOF
+#pragma paradigm hybrid
+
+fn scale$i(x: int) -> int {
+    return x * $i + 1;
+}
+
+fn classify$i(x: int) -> int {
+    return match x {
+        case 0 -> 10,
+        case 1 -> 20,
+        case 2 -> 30
+    };
+}
+
+fn step$i(x: int) -> int {
+    let total = 0;
+    for (let k = 0; k < x; k++) {
+        total += scale$i(k);
+    }
+    return total;
+}
+EOF
+    i=$((i + 1))
+done
+
+echo "fn main() -> int {" >> main.lpp
+echo "    let total = 0;" >> main.lpp
+i=0
+while [ "$i" -lt "$MODULES" ]; do
+    echo "    total += step$i(3);" >> main.lpp
+    i=$((i + 1))
+done
+echo "    print(total);" >> main.lpp
+echo "    return 0;" >> main.lpp
+echo "}" >> main.lpp
+
+now() { date +%s.%N; }
+elapsed() { awk "BEGIN { printf \"%.2f\", $2 - $1 }"; }
+
+echo "$MODULES modules, profile $PROFILE"
+
+# Per-module: the declarations main.lpp needs come from the unity build's
+# prototype block, so generate it once without timing it
+"$LPPC" --unity -c main.lpp mod*.lpp -o decl > /dev/null 2>&1
+sed -n '/^\/\/ Functions of all modules/,/^$/p' decl.unity0.cpp > decls.hpp
+
+start=$(now)
+for f in main.lpp mod*.lpp; do
+    "$LPPC" -c "$f" > /dev/null 2>&1
+done
+sed -i 's|^using namespace lpp::stdlib;|using namespace lpp::stdlib;\n#include "decls.hpp"|' main.lpp.cpp
+for f in *.lpp.cpp; do
+    g++ -w -c "$f" -o "$f.o" $FLAGS
+done
+g++ *.lpp.cpp.o -o separate $FLAGS
+separate=$(elapsed "$start" "$(now)")
+echo "  per-module TUs      ${separate}s  -> $(./separate)"
+
+rm -f *.lppcache
+start=$(now)
+"$LPPC" --unity --units "$UNITS" --profile "$PROFILE" main.lpp mod*.lpp -o unity > /dev/null 2>&1
+unity=$(elapsed "$start" "$(now)")
+echo "  unity, $UNITS unit(s)     ${unity}s  -> $(./unity)"
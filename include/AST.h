@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <cstdint>
+#include <set>
 
 namespace lpp
 {
@@ -22,6 +25,29 @@ namespace lpp
     // Forward declarations
     class ASTVisitor;
 
+    // Effects of a Function or LambdaExpr, filled in by EffectAnalyzer. Flags
+    // cover the body and everything it calls; a summary that was never
+    // analyzed counts as having every effect.
+    struct EffectSummary
+    {
+        bool analyzed = false;
+        bool readsGlobal = false;  // reads state it doesn't own: outer variables, members
+        bool writesGlobal = false; // assigns or mutates such state
+        bool io = false;           // print, files, input, channels, await
+        bool random = false;       // quantum observation, random numbers, clocks
+        bool unknown = false;      // calls something whose effects aren't known
+        bool mayThrow = false;     // contains a throw
+        bool recursive = false;    // reaches itself through the call graph
+        int selfCalls = 0;         // call sites of itself in its own body
+        bool memoize = false;      // transpiler caches results by argument
+
+        // Names behind each flag, for 'lppc --effects'
+        std::set<std::string> reads, writes, ioCalls, randomCalls, unknownCalls, calls;
+
+        bool isPure() const { return isReadOnly() && !readsGlobal; }
+        bool isReadOnly() const { return analyzed && !writesGlobal && !io && !random && !unknown; }
+    };
+
     // Base AST Node
     class ASTNode
     {
@@ -40,6 +66,11 @@ namespace lpp
         //   };
         virtual ~ASTNode() = default;
         virtual void accept(ASTVisitor &visitor) = 0;
+
+        // Source line the construct starts on (0: not recorded). Set by the
+        // parser for functions, classes, quantum declarations and the
+        // expressions lppc --emit-stats reports on.
+        int line = 0;
     };
 
     // Expressions
@@ -149,6 +180,7 @@ namespace lpp
     public:
         std::unique_ptr<Expression> iterable;
         std::unique_ptr<Expression> fn;
+        bool parallel = false; // fn is read-only (EffectAnalyzer): run on the thread pool
 
         MapExpr(std::unique_ptr<Expression> iter, std::unique_ptr<Expression> f)
             : iterable(std::move(iter)), fn(std::move(f)) {}
@@ -161,6 +193,7 @@ namespace lpp
     public:
         std::unique_ptr<Expression> iterable;
         std::unique_ptr<Expression> predicate;
+        bool parallel = false; // predicate is read-only (EffectAnalyzer)
 
         FilterExpr(std::unique_ptr<Expression> iter, std::unique_ptr<Expression> pred)
             : iterable(std::move(iter)), predicate(std::move(pred)) {}
@@ -174,6 +207,7 @@ namespace lpp
         std::unique_ptr<Expression> iterable;
         std::unique_ptr<Expression> fn;
         std::unique_ptr<Expression> initial; // optional
+        bool parallel = false;               // fn is read-only (EffectAnalyzer); used by associative kernels
 
         ReduceExpr(std::unique_ptr<Expression> iter, std::unique_ptr<Expression> f, std::unique_ptr<Expression> init = nullptr)
             : iterable(std::move(iter)), fn(std::move(f)), initial(std::move(init)) {}
@@ -242,6 +276,7 @@ namespace lpp
         std::string returnType;         // opzionale
         bool hasRestParam = false;      // true if last param is ...rest
         std::string restParamName = ""; // name of rest parameter
+        EffectSummary effects;
 
         LambdaExpr(std::vector<std::pair<std::string, std::string>> params,
                    std::unique_ptr<Expression> b,
@@ -402,6 +437,28 @@ namespace lpp
         void accept(ASTVisitor &visitor) override;
     };
 
+    // Spawned task: spawn f(args) - the arguments are evaluated and copied
+    // at the spawn, the call runs on the task scheduler; yields a Task
+    // that 'await' waits for. Inside scope { } the task is joined at scope exit.
+    class SpawnExpr : public Expression
+    {
+    public:
+        std::unique_ptr<Expression> expression; // CallExpr or obj.method(...)
+
+        explicit SpawnExpr(std::unique_ptr<Expression> expr)
+            : expression(std::move(expr)) {}
+        void accept(ASTVisitor &visitor) override;
+
+        // The spawned call: f(args) itself, or the call part of obj.method(args)
+        CallExpr *call() const
+        {
+            if (auto *direct = dynamic_cast<CallExpr *>(expression.get()))
+                return direct;
+            auto *method = dynamic_cast<IndexExpr *>(expression.get());
+            return method && method->isDot ? dynamic_cast<CallExpr *>(method->index.get()) : nullptr;
+        }
+    };
+
     // Throw expression: throw error
     class ThrowExpr : public Expression
     {
@@ -615,6 +672,22 @@ namespace lpp
         void accept(ASTVisitor &visitor) override;
     };
 
+    // Parallel loop: parallel for (var in array) { body } - iterations run
+    // concurrently on the task scheduler; the loop ends when all have finished
+    class ParallelForStmt : public Statement
+    {
+    public:
+        std::string variable;
+        std::unique_ptr<Expression> iterable;
+        std::vector<std::unique_ptr<Statement>> body;
+
+        ParallelForStmt(const std::string &var,
+                        std::unique_ptr<Expression> iter,
+                        std::vector<std::unique_ptr<Statement>> b)
+            : variable(var), iterable(std::move(iter)), body(std::move(b)) {}
+        void accept(ASTVisitor &visitor) override;
+    };
+
     // Do-while loop: do { body } while (cond);
     class DoWhileStmt : public Statement
     {
@@ -628,6 +701,27 @@ namespace lpp
         void accept(ASTVisitor &visitor) override;
     };
 
+    // Arena block: arena { body } - allocations inside are freed at block exit
+    class ArenaStmt : public Statement
+    {
+    public:
+        std::vector<std::unique_ptr<Statement>> body;
+
+        explicit ArenaStmt(std::vector<std::unique_ptr<Statement>> b) : body(std::move(b)) {}
+        void accept(ASTVisitor &visitor) override;
+    };
+
+    // Structured concurrency: scope { body } - every task spawned inside
+    // has finished when the block is left
+    class ScopeStmt : public Statement
+    {
+    public:
+        std::vector<std::unique_ptr<Statement>> body;
+
+        explicit ScopeStmt(std::vector<std::unique_ptr<Statement>> b) : body(std::move(b)) {}
+        void accept(ASTVisitor &visitor) override;
+    };
+
     // Try-catch-finally: try { } catch (e) { } finally { }
     class TryCatchStmt : public Statement
     {
@@ -714,6 +808,7 @@ namespace lpp
         std::string problemType; // e.g., "Configuration", "Logging", "DataAccess"
         std::string className;
         std::string patternType; // auto-detected: Singleton, Factory, Observer, etc.
+        std::string typeArgument; // autopattern Observer Bus<Order>: "Order"
 
         AutoPatternStmt(const std::string &problem, const std::string &name)
             : problemType(problem), className(name) {}
@@ -743,7 +838,9 @@ namespace lpp
         bool isPrototype = false;               // true for forward declarations
         bool isGetter = false;                  // true for getter methods
         bool isSetter = false;                  // true for setter methods
+        bool useArena = false;                  // true after '#pragma allocator arena'
         std::vector<std::string> genericParams; // for generics: <T, U>
+        EffectSummary effects;
 
         Function(const std::string &n,
                  std::vector<std::pair<std::string, std::string>> params,
@@ -766,6 +863,8 @@ namespace lpp
         std::vector<std::unique_ptr<Function>> methods;
         std::unique_ptr<Function> constructor;
         std::string designPattern = ""; // for @pattern: Singleton, Factory, Observer, etc.
+        std::string patternArgument;    // @pattern Observer<Order>: the event type
+        bool autoPattern = false;       // autopattern: lowers to lpp::patterns::<designPattern><name, ...>
 
         ClassDecl(const std::string &n,
                   const std::string &base,
@@ -805,7 +904,7 @@ namespace lpp
         void accept(ASTVisitor &visitor) override;
     };
 
-    // Molecule/Graph declaration: mol Name { A - B; B = C; }
+    // Molecule/Graph declaration: mol Name { A - B; B = C; A -> C: 2.5; }
     enum class BondType
     {
         SINGLE,       // -  (undirected edge)
@@ -820,9 +919,13 @@ namespace lpp
         std::string from;
         std::string to;
         BondType type;
+        double weight;  // A - B: 2.5; (1.0 when omitted)
+        bool weighted;
 
         Bond(const std::string &f, const std::string &t, BondType bt)
-            : from(f), to(t), type(bt) {}
+            : from(f), to(t), type(bt), weight(1.0), weighted(false) {}
+        Bond(const std::string &f, const std::string &t, BondType bt, double w)
+            : from(f), to(t), type(bt), weight(w), weighted(true) {}
     };
 
     class MoleculeDecl : public ASTNode
@@ -839,6 +942,13 @@ namespace lpp
         void accept(ASTVisitor &visitor) override;
     };
 
+    // Settings from top-level '#pragma' lines after the paradigm line
+    struct ProgramPragmas
+    {
+        std::optional<uint64_t> seed; // #pragma seed N
+        bool relaxedFloat = false;    // #pragma fp relaxed
+    };
+
     class Program : public ASTNode
     {
     public:
@@ -851,6 +961,7 @@ namespace lpp
         std::vector<std::unique_ptr<TypeDecl>> types;
         std::vector<std::unique_ptr<Statement>> enums;
         std::vector<std::unique_ptr<MoleculeDecl>> molecules;
+        ProgramPragmas pragmas;
 
         Program(ParadigmMode pm,
                 std::vector<std::unique_ptr<Function>> funcs,
@@ -903,6 +1014,7 @@ namespace lpp
         virtual void visit(MatchExpr &node) = 0;
         virtual void visit(CastExpr &node) = 0;
         virtual void visit(AwaitExpr &node) = 0;
+        virtual void visit(SpawnExpr &node) = 0;
         virtual void visit(ThrowExpr &node) = 0;
         virtual void visit(YieldExpr &node) = 0;
         virtual void visit(TypeOfExpr &node) = 0;
@@ -917,7 +1029,10 @@ namespace lpp
         virtual void visit(SwitchStmt &node) = 0;
         virtual void visit(ForStmt &node) = 0;
         virtual void visit(ForInStmt &node) = 0;
+        virtual void visit(ParallelForStmt &node) = 0;
         virtual void visit(DoWhileStmt &node) = 0;
+        virtual void visit(ArenaStmt &node) = 0;
+        virtual void visit(ScopeStmt &node) = 0;
         virtual void visit(TryCatchStmt &node) = 0;
         virtual void visit(DestructuringStmt &node) = 0;
         virtual void visit(EnumDecl &node) = 0;
@@ -109,6 +109,8 @@ namespace lpp
         void visit(Assignment &node) override;
         void visit(IfStmt &node) override;
         void visit(WhileStmt &node) override;
+        void visit(ArenaStmt &node) override;
+        void visit(ScopeStmt &node) override;
         void visit(ReturnStmt &node) override;
         void visit(ExprStmt &node) override;
 
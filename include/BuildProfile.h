@@ -0,0 +1,76 @@
+#ifndef BUILD_PROFILE_H
+#define BUILD_PROFILE_H
+
+#include "AST.h"
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <initializer_list>
+
+namespace lpp
+{
+
+    // Profile-guided optimization stage for the backend compile.
+    // 'generate' builds an instrumented binary that writes .gcda files when
+    // run; 'use' rebuilds with those profiles.
+    enum class PgoMode
+    {
+        NONE,
+        GENERATE,
+        USE
+    };
+
+    // Named settings for the g++ invocation that turns generated C++ into an
+    // executable. Selected with 'lppc --profile <name>', the "profile" key of
+    // package.lpp, or the default for the file's '#pragma paradigm'.
+    //
+    //   debug           -O0 -g, assertions on
+    //   release         -O2 -flto -DNDEBUG
+    //   release-native  -O3 -flto -march=native -DNDEBUG (not portable)
+    //   size            -Os -flto -DNDEBUG, symbols stripped
+    struct BuildProfile
+    {
+        std::string name;
+        std::string optLevel; // "0", "2", "3" or "s"
+        bool lto = false;
+        bool debugInfo = false;
+        bool nativeArch = false;
+        bool strip = false;
+        PgoMode pgo = PgoMode::NONE;
+
+        static std::optional<BuildProfile> fromName(const std::string &name);
+        static BuildProfile defaultFor(ParadigmMode paradigm);
+        static const std::vector<std::string> &names();
+
+        // Flags appended to the g++ command line, space separated
+        std::string compilerFlags() const;
+
+        // One line for --time-report and the build cache stamp,
+        // e.g. "release (-O2 -flto -DNDEBUG)"
+        std::string describe() const;
+    };
+
+    // Remembers the key of the last successful backend compile next to the
+    // executable ('<output>.lppcache'). The key covers the generated C++, the
+    // full compiler command, the profile, the compiler version and the
+    // contents of the stdlib headers the code includes, so switching profiles
+    // or flags, upgrading g++ or editing the stdlib always rebuilds.
+    class BuildCache
+    {
+    public:
+        // FNV-1a over the fields (std::hash is not stable between runs)
+        static uint64_t fingerprint(std::initializer_list<std::string> fields);
+
+        // 'stdlibDir' holds the lpp_stdlib.hpp and lpp_patterns.hpp the
+        // generated code includes
+        static std::string computeKey(const std::string &cppCode, const std::string &command,
+                                      const BuildProfile &profile, const std::string &stdlibDir);
+
+        static bool isUpToDate(const std::string &outputFile, const std::string &key);
+        static void store(const std::string &outputFile, const std::string &key, const BuildProfile &profile);
+    };
+
+} // namespace lpp
+
+#endif // BUILD_PROFILE_H
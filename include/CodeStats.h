@@ -0,0 +1,93 @@
+#ifndef CODE_STATS_H
+#define CODE_STATS_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+namespace lpp
+{
+
+    // Size of the C++ the transpiler generates, for 'lppc --emit-stats'.
+    // The transpiler opens a span around every function, class and expanded
+    // construct (map/filter/reduce, list comprehensions, match, template
+    // literals, autopattern classes, QuantumVar declarations and calls, and
+    // user lambdas) and closes it when the construct is written. Once a module
+    // is transpiled, each span's text is scanned for lambda introducers,
+    // immediately invoked lambdas ('})()') and template instantiation hints
+    // (template-ids, decltype, generic 'auto' parameters), and the counts
+    // are reported per construct with its L++ source line, per function and
+    // per construct kind.
+    class CodeStats
+    {
+    public:
+        struct Counts
+        {
+            size_t bytes = 0;
+            int lambdas = 0;
+            int iifes = 0;
+            int templateHints = 0;
+
+            Counts &operator+=(const Counts &other);
+        };
+
+        // Records the C++ written to 'out' while it is alive. Does nothing
+        // when 'stats' is null, so the transpiler can keep one on the stack
+        // unconditionally.
+        class Span
+        {
+        public:
+            Span(CodeStats *stats, std::ostream &out, const char *kind, int line, const std::string &name = "");
+            ~Span();
+            Span(const Span &) = delete;
+            Span &operator=(const Span &) = delete;
+
+        private:
+            CodeStats *stats;
+            std::ostream &out;
+            size_t index;
+        };
+
+        // Spans recorded until the next endModule() belong to 'file'
+        void beginModule(const std::string &file);
+        // 'code' is the module's generated C++ (without the prelude) that
+        // the span offsets point into
+        void endModule(const std::string &code);
+
+        std::string toJson() const;
+
+    private:
+        struct Record
+        {
+            std::string kind; // "function", "class" or a construct kind
+            std::string name; // functions and classes only
+            int line = 0;
+            size_t begin = 0;
+            size_t end = 0;
+            size_t parent = 0;      // index + 1 of the enclosing span, 0 at top level
+            std::string function;   // enclosing function, Class::method for methods
+            Counts self;            // text not covered by nested spans
+            Counts total;           // including nested spans
+        };
+
+        struct Module
+        {
+            std::string file;
+            Counts total;
+            std::vector<Record> records;
+        };
+
+        std::vector<Module> modules;
+        std::vector<size_t> open;
+
+        size_t openSpan(const char *kind, int line, const std::string &name, size_t offset);
+        void closeSpan(size_t index, size_t offset);
+
+        static Counts scan(const std::string &code, size_t begin, size_t end);
+        static bool isScope(const std::string &kind) { return kind == "function" || kind == "class"; }
+    };
+
+} // namespace lpp
+
+#endif // CODE_STATS_H
@@ -0,0 +1,156 @@
+#ifndef EFFECT_ANALYZER_H
+#define EFFECT_ANALYZER_H
+
+#include "AST.h"
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+#include <memory>
+#include <ostream>
+
+namespace lpp
+{
+    // Interprocedural effect inference. Every Function (methods included) and
+    // LambdaExpr gets an EffectSummary: which outer state it reads or writes,
+    // whether it does I/O or draws randomness, and which functions it calls.
+    // Local effects are collected in one walk; callee effects are then folded
+    // in over the call graph until nothing changes, so recursion and mutual
+    // recursion settle.
+    //
+    // The results are written back onto the AST for the transpiler:
+    //   - map/filter/reduce whose function is read-only get 'parallel'
+    //   - pure, tree-recursive functions with scalar parameters get 'memoize'
+    class EffectAnalyzer : public ASTVisitor
+    {
+    public:
+        void analyze(Program &program);
+
+        // One line per function and lambda, as printed by 'lppc --effects'
+        void dump(std::ostream &out) const;
+
+        void visit(NumberExpr &node) override;
+        void visit(StringExpr &node) override;
+        void visit(TemplateLiteralExpr &node) override;
+        void visit(BoolExpr &node) override;
+        void visit(IdentifierExpr &node) override;
+        void visit(BinaryExpr &node) override;
+        void visit(UnaryExpr &node) override;
+        void visit(PostfixExpr &node) override;
+        void visit(CallExpr &node) override;
+        void visit(LambdaExpr &node) override;
+        void visit(TernaryIfExpr &node) override;
+        void visit(PipelineExpr &node) override;
+        void visit(CompositionExpr &node) override;
+        void visit(RangeExpr &node) override;
+        void visit(MapExpr &node) override;
+        void visit(FilterExpr &node) override;
+        void visit(ReduceExpr &node) override;
+        void visit(IterateWhileExpr &node) override;
+        void visit(AutoIterateExpr &node) override;
+        void visit(IterateStepExpr &node) override;
+        void visit(ArrayExpr &node) override;
+        void visit(TupleExpr &node) override;
+        void visit(ListComprehension &node) override;
+        void visit(SpreadExpr &node) override;
+        void visit(IndexExpr &node) override;
+        void visit(ObjectExpr &node) override;
+        void visit(MatchExpr &node) override;
+        void visit(CastExpr &node) override;
+        void visit(AwaitExpr &node) override;
+        void visit(SpawnExpr &node) override;
+        void visit(ThrowExpr &node) override;
+        void visit(YieldExpr &node) override;
+        void visit(TypeOfExpr &node) override;
+        void visit(InstanceOfExpr &node) override;
+        void visit(QuantumMethodCall &node) override;
+
+        void visit(VarDecl &node) override;
+        void visit(QuantumVarDecl &node) override;
+        void visit(Assignment &node) override;
+        void visit(IfStmt &node) override;
+        void visit(WhileStmt &node) override;
+        void visit(SwitchStmt &node) override;
+        void visit(ForStmt &node) override;
+        void visit(ForInStmt &node) override;
+        void visit(ParallelForStmt &node) override;
+        void visit(DoWhileStmt &node) override;
+        void visit(ArenaStmt &node) override;
+        void visit(ScopeStmt &node) override;
+        void visit(TryCatchStmt &node) override;
+        void visit(DestructuringStmt &node) override;
+        void visit(EnumDecl &node) override;
+        void visit(BreakStmt &node) override;
+        void visit(ContinueStmt &node) override;
+        void visit(ReturnStmt &node) override;
+        void visit(ImportStmt &node) override;
+        void visit(ExportStmt &node) override;
+        void visit(AutoPatternStmt &node) override;
+        void visit(ExprStmt &node) override;
+
+        void visit(Function &node) override;
+        void visit(ClassDecl &node) override;
+        void visit(InterfaceDecl &node) override;
+        void visit(TypeDecl &node) override;
+        void visit(MoleculeDecl &node) override;
+        void visit(Program &node) override;
+
+    private:
+        // A Function or LambdaExpr in the call graph
+        struct Unit
+        {
+            std::string name; // "fib", "Counter.bump", "lambda in main"
+            EffectSummary *effects = nullptr;
+            Function *function = nullptr; // null for lambdas
+            std::vector<Unit *> callees;
+        };
+        std::vector<std::unique_ptr<Unit>> units;
+        std::map<const Function *, Unit *> unitsByFunction;
+        std::multimap<std::string, Unit *> freeFunctions; // overloads share a name
+        std::multimap<std::string, Unit *> methods; // by method name, across classes
+        std::set<std::string> constantNames;        // classes, enums, types, molecules
+
+        // Units being walked, innermost last, with the names each declares.
+        // A variable read or written is outer state for every frame above the
+        // one that declares it; lambdas bound with 'let f = x -> ...' are
+        // remembered so calls and map(f) can find their summaries.
+        struct Frame
+        {
+            Unit *unit;
+            std::set<std::string> locals;
+            std::map<std::string, LambdaExpr *> lambdas;
+        };
+        std::vector<Frame> frames;
+
+        // Higher-order operators whose 'parallel' flag depends on their
+        // function's final summary
+        struct PendingParallel
+        {
+            bool *flag;
+            Expression *fn;
+            LambdaExpr *boundLambda; // fn names a let-bound lambda
+        };
+        std::vector<PendingParallel> pending;
+
+        Unit *addUnit(const std::string &name, EffectSummary &effects, Function *function);
+        void analyzeBody(Unit *unit, Function &node);
+        void declare(const std::string &name);
+        int declaringFrame(const std::string &name) const;
+        void recordRead(const std::string &name);
+        void recordWrite(const std::string &name);
+        void recordCall(Unit *callee);
+        void recordBuiltin(const std::string &name);
+        void recordMethodCall(Expression *receiver, const std::string &method);
+        void queueParallel(bool &flag, Expression *fn);
+        void visitFunctionValue(Expression *fn);
+        static std::string rootName(Expression *expr);
+
+        void propagate();
+        void markRecursion();
+        void decideMemoization(Unit &unit);
+        bool isReadOnlyFunction(Expression *fn, LambdaExpr *boundLambda) const;
+    };
+
+} // namespace lpp
+
+#endif // EFFECT_ANALYZER_H
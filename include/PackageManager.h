@@ -36,6 +36,7 @@ namespace lpp
         std::string author;
         std::string license;
         std::string entryPoint;
+        std::string profile; // default build profile for lppc, see BuildProfile.h
         std::vector<PackageDependency> dependencies;
         std::vector<PackageDependency> devDependencies;
         std::map<std::string, std::string> scripts;
@@ -7,6 +7,7 @@
 #include <vector>
 #include <memory>
 #include <set>
+#include <limits>
 
 namespace lpp
 {
@@ -80,6 +81,9 @@ namespace lpp
         static constexpr size_t MAX_RECURSION_DEPTH = 100; // Reduced from 500 to prevent stack overflow
         size_t recursionDepth = 0;
 
+        // Set by '#pragma allocator arena', consumed by the next function()
+        bool pendingArenaAllocator = false;
+
         // Helper to safely parse doubles with validation
         bool safeStod(const std::string &str, double &result)
         {
@@ -135,12 +139,21 @@ namespace lpp
         void synchronize();
         void error(const std::string &message);
 
+        // Record the source line a node starts on (ASTNode::line)
+        template <typename T>
+        static std::unique_ptr<T> located(int line, std::unique_ptr<T> node)
+        {
+            node->line = line;
+            return node;
+        }
+
         // Parsing methods
         std::unique_ptr<Function> function();
         std::unique_ptr<ClassDecl> classDeclaration();
         std::unique_ptr<InterfaceDecl> interfaceDeclaration();
         std::unique_ptr<TypeDecl> typeDeclaration();
         std::unique_ptr<MoleculeDecl> moleculeDeclaration();
+        void pragmaDirective(ProgramPragmas &pragmas);
         std::unique_ptr<ClassDecl> expandAutoPattern(std::unique_ptr<AutoPatternStmt> autoPattern);
 
         std::unique_ptr<Statement> statement();
@@ -150,6 +163,9 @@ namespace lpp
         std::unique_ptr<Statement> whileStatement();
         std::unique_ptr<Statement> forStatement();
         std::unique_ptr<Statement> doWhileStatement();
+        std::unique_ptr<Statement> arenaStatement();
+        std::unique_ptr<Statement> parallelForStatement();
+        std::unique_ptr<Statement> scopeStatement();
         std::unique_ptr<Statement> switchStatement();
         std::unique_ptr<Statement> tryCatchStatement();
         std::unique_ptr<Statement> enumDeclaration();
@@ -160,6 +176,7 @@ namespace lpp
         std::unique_ptr<Statement> notationStatement();
         std::unique_ptr<Statement> fixityDeclaration();
         std::vector<std::unique_ptr<Statement>> block(bool enableImplicitReturn = false);
+        std::string genericTypeArguments(); // <int, string> after a type name
 
         std::unique_ptr<Expression> expression();
         std::unique_ptr<Expression> linearExpression();
@@ -73,6 +73,12 @@ namespace lpp
         PARADIGM_GOLF_DISCOURAGED,
         PARADIGM_GOLF_ENCOURAGED,
 
+        // Region allocation
+        ARENA_ESCAPE, // arena-allocated value returned or stored outside its arena
+
+        // Concurrency
+        DATA_RACE, // parallel for body or spawned call writes state other tasks share
+
         // Control flow (BUG #150: Missing categories)
         CONTROL_FLOW_ERROR, // break/continue outside loop
         INTERNAL_ERROR      // Compiler internal errors
@@ -215,6 +221,7 @@ namespace lpp
         void visit(MatchExpr &node) override;
         void visit(CastExpr &node) override;
         void visit(AwaitExpr &node) override;
+        void visit(SpawnExpr &node) override;
         void visit(ThrowExpr &node) override;
         void visit(YieldExpr &node) override;
         void visit(TypeOfExpr &node) override;
@@ -229,7 +236,10 @@ namespace lpp
         void visit(SwitchStmt &node) override;
         void visit(ForStmt &node) override;
         void visit(ForInStmt &node) override;
+        void visit(ParallelForStmt &node) override;
         void visit(DoWhileStmt &node) override;
+        void visit(ArenaStmt &node) override;
+        void visit(ScopeStmt &node) override;
         void visit(TryCatchStmt &node) override;
         void visit(DestructuringStmt &node) override;
         void visit(EnumDecl &node) override;
@@ -279,6 +289,24 @@ namespace lpp
         // Dead code detection
         std::set<CFGNode *> visitedNodes;
 
+        // Open arena regions (arena blocks, '#pragma allocator arena'
+        // functions), innermost last
+        struct ArenaRegion
+        {
+            std::set<std::string> declared;  // every local declared inside
+            std::set<std::string> allocated; // locals whose storage is in the arena
+        };
+        std::vector<ArenaRegion> arenaRegions;
+
+        // Open 'parallel for' bodies, innermost last. Iterations run at the
+        // same time, so a body may only write what it declares itself.
+        struct ParallelRegion
+        {
+            std::set<std::string> declared; // loop variable and body locals
+            int loopDepth;                  // loopDepth inside the body
+        };
+        std::vector<ParallelRegion> parallelRegions;
+
         // Helper methods
         void buildCFG(std::vector<std::unique_ptr<Statement>> &statements);
         CFGNode *createNode(CFGNode::Type type);
@@ -307,6 +335,14 @@ namespace lpp
         void checkInfiniteLoop(WhileStmt &node);
         void checkIntegerOverflow(BinaryExpr &node);
         void checkTaintedData(Expression &node);
+        int arenaRegionOf(Expression *expr) const;
+        void checkArenaEscape(Expression *value, const std::string *target);
+        void declareLocal(const std::string &name);
+        void checkParallelWrite(const std::string &name, const std::string &action);
+        void checkSharedMethodCall(IndexExpr &node, bool spawned);
+        void checkSharedFreeCall(CallExpr &node, bool spawned);
+        void checkSharedMutation(const std::string &target, const std::string &function,
+                                 const std::string &shown, bool spawned);
 
         // Symbolic execution helpers
         SymbolicValue evaluateExpression(Expression *expr);
@@ -0,0 +1,45 @@
+#ifndef STDLIB_CACHE_H
+#define STDLIB_CACHE_H
+
+#include <string>
+#include <optional>
+#include <vector>
+
+namespace lpp
+{
+
+    // Precompiled prelude for generated code: the standard headers every
+    // transpiled file includes plus lpp_stdlib.hpp, compiled once per
+    // toolchain, flag set and stdlib version and kept in the user cache
+    // directory. Compiling with '-include <prelude>' then loads the parsed
+    // headers instead of re-reading ~10k lines per translation unit; the
+    // #include of lpp_stdlib.hpp in the generated code is a no-op behind its
+    // include guard. Without a usable entry the header path is used as is.
+    //
+    // Entries live in <cache>/stdlib-<key>/, where <cache> is $LPP_CACHE_DIR,
+    // $XDG_CACHE_HOME/lpp or ~/.cache/lpp and <key> hashes the output of
+    // 'g++ -dumpfullversion -dumpmachine', the flags and the header contents.
+    // Writing a new entry evicts the least recently used ones: entries used
+    // in the last hour always stay, the four most recently used stay for a
+    // week, anything else is removed.
+    class StdlibCache
+    {
+    public:
+        // Path to pass to -include, building the entry first if needed.
+        // 'stdlibHeader' is the lpp_stdlib.hpp the generated code includes,
+        // 'systemHeaders' the standard headers it includes before it.
+        // Returns nullopt if the toolchain cannot precompile it (remembered
+        // in the entry, so later builds don't retry).
+        static std::optional<std::string> prepare(const std::string &stdlibHeader, const std::string &flags,
+                                                  const std::vector<std::string> &systemHeaders);
+
+        static std::string cacheDirectory();
+
+        // Output of 'g++ -dumpfullversion -dumpmachine', "" without g++.
+        // Computed once per run.
+        static std::string toolchainId();
+    };
+
+} // namespace lpp
+
+#endif // STDLIB_CACHE_H
@@ -58,6 +58,9 @@ namespace lpp
         NEW,
         ASYNC,
         AWAIT,
+        SPAWN,    // Task on the work-stealing scheduler
+        PARALLEL, // parallel for
+        SCOPE,    // Structured concurrency block
         TRY,
         CATCH,
         FINALLY,
@@ -2,8 +2,13 @@
 #define TRANSPILER_H
 
 #include "AST.h"
+#include "CodeStats.h"
 #include <string>
 #include <sstream>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <set>
 
 namespace lpp
 {
@@ -13,6 +18,25 @@ namespace lpp
     public:
         std::string transpile(Program &program);
 
+        // Unity builds (lppc --unity) merge several modules into one
+        // translation unit: the prelude is written once per unit, followed by
+        // each module's declarations and body. A module tag keeps generated
+        // temporaries and namespace-scope statics of different modules apart,
+        // and imports of modules that are part of the same build are dropped.
+        std::string transpilePrelude(bool withPatterns);
+        std::string transpileModule(Program &program);
+        std::string transpileDeclarations(Program &program);
+        void setModuleTag(const std::string &tag) { moduleTag = tag; }
+        void setUnityModules(std::set<std::string> stems) { unityModules = std::move(stems); }
+        static bool usesPatterns(const Program &program);
+
+        // lppc --emit-stats: record what each construct expands to while
+        // transpiling. transpileModule() ends the collector's current module.
+        void setStats(CodeStats *collector) { stats = collector; }
+
+        // Standard headers every generated file includes, in order
+        static const std::vector<std::string> &preludeHeaders();
+
         void visit(NumberExpr &node) override;
         void visit(StringExpr &node) override;
         void visit(TemplateLiteralExpr &node) override;
@@ -42,6 +66,7 @@ namespace lpp
         void visit(MatchExpr &node) override;
         void visit(CastExpr &node) override;
         void visit(AwaitExpr &node) override;
+        void visit(SpawnExpr &node) override;
         void visit(ThrowExpr &node) override;
         void visit(YieldExpr &node) override;
         void visit(TypeOfExpr &node) override;
@@ -56,7 +81,10 @@ namespace lpp
         void visit(SwitchStmt &node) override;
         void visit(ForStmt &node) override;
         void visit(ForInStmt &node) override;
+        void visit(ParallelForStmt &node) override;
         void visit(DoWhileStmt &node) override;
+        void visit(ArenaStmt &node) override;
+        void visit(ScopeStmt &node) override;
         void visit(TryCatchStmt &node) override;
         void visit(DestructuringStmt &node) override;
         void visit(EnumDecl &node) override;
@@ -86,11 +114,56 @@ namespace lpp
         // BUG #332 fix: Track generator context for yield validation
         bool inGeneratorContext = false;
 
+        // #pragma fp relaxed: reduce kernels may reorder floating-point ops
+        bool relaxedFloat = false;
+
+        // #pragma paradigm functional: arrays, Map and Set lower to the
+        // stdlib's persistent collections so updates share structure
+        bool persistentCollections = false;
+
+        // Enclosing arena blocks and '#pragma allocator arena' functions,
+        // innermost last: array literals, ranges, comprehensions and T[]
+        // locals become std::pmr::vector on arenaStack.back()
+        std::vector<std::string> arenaStack;
+        std::atomic<int> arenaCounter{0};
+        void beginArena();
+        std::string arenaResource() const;
+
+        // Enclosing scope { } blocks, innermost last: a spawn inside one
+        // registers its task there so the block joins it
+        std::vector<std::string> scopeStack;
+        std::atomic<int> scopeCounter{0};
+
+        // Unity build state, see transpileModule
+        std::string moduleTag;
+        std::set<std::string> unityModules;
+        std::string uniqueSuffix(std::atomic<int> &counter) const;
+
+        CodeStats *stats = nullptr;
+
+        // Methods don't get effect attributes (they read through 'this')
+        bool inClass = false;
+        static std::string functionAttribute(const Function &node);
+
         void indent();
         void writeLine(const std::string &line);
         std::string mapType(const std::string &lppType);
         std::string mapOperator(const std::string &op);
         std::string convertMethodSignature(const std::string &lppSignature);
+        // 'lpp::patterns::Base<Name, Args...>' for a class with a pattern
+        // whose template in lpp_patterns.hpp is 'base'
+        std::string patternTemplate(const ClassDecl &node, const std::string &base);
+
+        // Reduce/map lambdas that lower to stdlib vector kernels
+        static std::string reduceKernelName(Expression *fn);
+        static bool isArithmeticMapLambda(Expression *fn);
+        static bool isArithmeticExpr(Expression *expr);
+
+        // Molecule lowering: perfect hash over atom names for StaticMolecule
+        static uint64_t moleculeNameHash(const std::string &name, uint64_t seed);
+        static void buildMoleculePerfectHash(const std::vector<std::string> &names,
+                                             std::vector<uint64_t> &displacements,
+                                             std::vector<uint32_t> &slots);
     };
 
 } // namespace lpp
@@ -33,6 +33,7 @@ namespace lpp
     void MatchExpr::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void CastExpr::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void AwaitExpr::accept(ASTVisitor &visitor) { visitor.visit(*this); }
+    void SpawnExpr::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void ThrowExpr::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void YieldExpr::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void TypeOfExpr::accept(ASTVisitor &visitor) { visitor.visit(*this); }
@@ -48,7 +49,10 @@ namespace lpp
     void SwitchStmt::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void ForStmt::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void ForInStmt::accept(ASTVisitor &visitor) { visitor.visit(*this); }
+    void ParallelForStmt::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void DoWhileStmt::accept(ASTVisitor &visitor) { visitor.visit(*this); }
+    void ArenaStmt::accept(ASTVisitor &visitor) { visitor.visit(*this); }
+    void ScopeStmt::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void TryCatchStmt::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void DestructuringStmt::accept(ASTVisitor &visitor) { visitor.visit(*this); }
     void EnumDecl::accept(ASTVisitor &visitor) { visitor.visit(*this); }
@@ -465,6 +465,27 @@ namespace lpp
         exitScope();
     }
 
+    // Arena escapes are reported by the StaticAnalyzer (ARENA-ESCAPE)
+    void BorrowChecker::visit(ArenaStmt &node)
+    {
+        enterScope();
+        for (auto &stmt : node.body)
+        {
+            stmt->accept(*this);
+        }
+        exitScope();
+    }
+
+    void BorrowChecker::visit(ScopeStmt &node)
+    {
+        enterScope();
+        for (auto &stmt : node.body)
+        {
+            stmt->accept(*this);
+        }
+        exitScope();
+    }
+
     void BorrowChecker::visit(ReturnStmt &node)
     {
         currentLine++;
@@ -0,0 +1,155 @@
+#include "BuildProfile.h"
+#include "StdlibCache.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+
+namespace lpp
+{
+
+    std::optional<BuildProfile> BuildProfile::fromName(const std::string &name)
+    {
+        BuildProfile profile;
+        profile.name = name;
+
+        if (name == "debug")
+        {
+            profile.optLevel = "0";
+            profile.debugInfo = true;
+        }
+        else if (name == "release")
+        {
+            profile.optLevel = "2";
+            profile.lto = true;
+        }
+        else if (name == "release-native")
+        {
+            profile.optLevel = "3";
+            profile.lto = true;
+            profile.nativeArch = true;
+        }
+        else if (name == "size")
+        {
+            profile.optLevel = "s";
+            profile.lto = true;
+            profile.strip = true;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+        return profile;
+    }
+
+    // Golfed programs are throwaway scripts where a small binary matters more
+    // than peak speed. Everything else gets the portable optimized build;
+    // release-native is never a default because its binaries only run on CPUs
+    // like the build machine.
+    BuildProfile BuildProfile::defaultFor(ParadigmMode paradigm)
+    {
+        switch (paradigm)
+        {
+        case ParadigmMode::GOLFED:
+            return *fromName("size");
+        case ParadigmMode::FUNCTIONAL:
+        case ParadigmMode::IMPERATIVE:
+        case ParadigmMode::OOP:
+        case ParadigmMode::HYBRID:
+        default:
+            return *fromName("release");
+        }
+    }
+
+    const std::vector<std::string> &BuildProfile::names()
+    {
+        static const std::vector<std::string> all = {"debug", "release", "release-native", "size"};
+        return all;
+    }
+
+    std::string BuildProfile::compilerFlags() const
+    {
+        std::string flags = "-O" + optLevel;
+        if (debugInfo)
+            flags += " -g";
+        if (lto)
+            flags += " -flto";
+        if (nativeArch)
+            flags += " -march=native";
+        if (!debugInfo)
+            flags += " -DNDEBUG";
+        if (strip)
+            flags += " -s";
+
+        if (pgo == PgoMode::GENERATE)
+            flags += " -fprofile-generate";
+        else if (pgo == PgoMode::USE)
+            flags += " -fprofile-use -fprofile-correction -Wno-missing-profile";
+        return flags;
+    }
+
+    std::string BuildProfile::describe() const
+    {
+        return name + " (" + compilerFlags() + ")";
+    }
+
+    uint64_t BuildCache::fingerprint(std::initializer_list<std::string> fields)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (const std::string &field : fields)
+        {
+            for (unsigned char c : field)
+            {
+                hash ^= c;
+                hash *= 1099511628211ULL;
+            }
+            hash ^= 0xff; // field separator
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // Contents of a header, or "" if it is missing
+    static std::string readHeader(const std::filesystem::path &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        if (file.is_open())
+            contents << file.rdbuf();
+        return contents.str();
+    }
+
+    std::string BuildCache::computeKey(const std::string &cppCode, const std::string &command,
+                                       const BuildProfile &profile, const std::string &stdlibDir)
+    {
+        const std::filesystem::path dir(stdlibDir);
+        std::ostringstream key;
+        key << profile.name << "-" << std::hex << std::setw(16) << std::setfill('0')
+            << fingerprint({cppCode, command, profile.describe(), StdlibCache::toolchainId(),
+                            readHeader(dir / "lpp_stdlib.hpp"), readHeader(dir / "lpp_patterns.hpp")});
+        return key.str();
+    }
+
+    bool BuildCache::isUpToDate(const std::string &outputFile, const std::string &key)
+    {
+        std::error_code ec;
+        if (!std::filesystem::exists(outputFile, ec))
+            return false;
+
+        std::ifstream stamp(outputFile + ".lppcache");
+        std::string storedKey;
+        return stamp.is_open() && std::getline(stamp, storedKey) && storedKey == key;
+    }
+
+    void BuildCache::store(const std::string &outputFile, const std::string &key, const BuildProfile &profile)
+    {
+        std::ofstream stamp(outputFile + ".lppcache");
+        if (!stamp.is_open())
+        {
+            return;
+        }
+        stamp << key << "\n"
+              << profile.describe() << "\n";
+    }
+
+} // namespace lpp
@@ -0,0 +1,325 @@
+#include "CodeStats.h"
+#include <sstream>
+#include <map>
+#include <cctype>
+
+namespace lpp
+{
+
+    static bool isIdentChar(char c)
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    static std::string jsonString(const std::string &text)
+    {
+        std::string result = "\"";
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            if (static_cast<unsigned char>(c) < 0x20)
+                result += ' ';
+            else
+                result += c;
+        }
+        return result + "\"";
+    }
+
+    static void writeCounts(std::ostream &json, const CodeStats::Counts &counts)
+    {
+        json << "\"bytes\": " << counts.bytes << ", \"lambdas\": " << counts.lambdas
+             << ", \"iifes\": " << counts.iifes << ", \"templateHints\": " << counts.templateHints;
+    }
+
+    CodeStats::Counts &CodeStats::Counts::operator+=(const Counts &other)
+    {
+        bytes += other.bytes;
+        lambdas += other.lambdas;
+        iifes += other.iifes;
+        templateHints += other.templateHints;
+        return *this;
+    }
+
+    CodeStats::Span::Span(CodeStats *stats, std::ostream &out, const char *kind, int line, const std::string &name)
+        : stats(stats), out(out), index(0)
+    {
+        if (stats)
+            index = stats->openSpan(kind, line, name, static_cast<size_t>(out.tellp()));
+    }
+
+    CodeStats::Span::~Span()
+    {
+        if (stats)
+            stats->closeSpan(index, static_cast<size_t>(out.tellp()));
+    }
+
+    void CodeStats::beginModule(const std::string &file)
+    {
+        modules.push_back(Module{file, {}, {}});
+        open.clear();
+    }
+
+    size_t CodeStats::openSpan(const char *kind, int line, const std::string &name, size_t offset)
+    {
+        if (modules.empty())
+            beginModule("");
+        std::vector<Record> &records = modules.back().records;
+
+        Record record;
+        record.kind = kind;
+        record.name = name;
+        record.line = line;
+        record.begin = offset;
+        record.end = offset;
+        record.parent = open.empty() ? 0 : open.back() + 1;
+
+        // Constructs belong to the innermost function; a function inside a
+        // class is reported as Class::method
+        const Record *parent = record.parent ? &records[record.parent - 1] : nullptr;
+        if (record.kind == "function")
+            record.function = parent && parent->kind == "class" ? parent->name + "::" + name : name;
+        else if (parent)
+            record.function = parent->function;
+
+        records.push_back(record);
+        open.push_back(records.size() - 1);
+        return records.size() - 1;
+    }
+
+    void CodeStats::closeSpan(size_t index, size_t offset)
+    {
+        modules.back().records[index].end = offset;
+        if (!open.empty() && open.back() == index)
+            open.pop_back();
+    }
+
+    void CodeStats::endModule(const std::string &code)
+    {
+        if (modules.empty())
+            beginModule("");
+        Module &module = modules.back();
+        module.total = scan(code, 0, code.size());
+
+        std::vector<std::vector<size_t>> children(module.records.size());
+        for (size_t i = 0; i < module.records.size(); i++)
+        {
+            if (module.records[i].parent)
+                children[module.records[i].parent - 1].push_back(i);
+        }
+
+        // Own text is the span minus its direct children; children come after
+        // their parent, so walking backwards sees every child total first
+        for (size_t i = module.records.size(); i-- > 0;)
+        {
+            Record &record = module.records[i];
+            size_t from = record.begin;
+            for (size_t child : children[i])
+            {
+                record.self += scan(code, from, module.records[child].begin);
+                from = module.records[child].end;
+            }
+            record.self += scan(code, from, record.end);
+
+            record.total = record.self;
+            for (size_t child : children[i])
+                record.total += module.records[child].total;
+        }
+        open.clear();
+    }
+
+    // Counts tokens that start inside [begin, end); string literals and
+    // comments are skipped. Context before 'begin' is read to tell a lambda
+    // introducer from a subscript.
+    CodeStats::Counts CodeStats::scan(const std::string &code, size_t begin, size_t end)
+    {
+        Counts counts;
+        if (end <= begin || end > code.size())
+            return counts;
+        counts.bytes = end - begin;
+
+        size_t i = begin;
+        while (i < end)
+        {
+            const char c = code[i];
+
+            if (c == '"' || (c == '\'' && (i == 0 || !isIdentChar(code[i - 1]))))
+            {
+                for (i++; i < end && code[i] != c; i++)
+                {
+                    if (code[i] == '\\')
+                        i++;
+                }
+                i++;
+                continue;
+            }
+            if (c == '/' && i + 1 < end && (code[i + 1] == '/' || code[i + 1] == '*'))
+            {
+                const bool line = code[i + 1] == '/';
+                const size_t close = line ? code.find('\n', i) : code.find("*/", i + 2);
+                i = close == std::string::npos ? end : close + (line ? 1 : 2);
+                continue;
+            }
+
+            // Immediately invoked lambda: ... })()
+            if (c == '}' && code.compare(i + 1, 3, ")()") == 0)
+            {
+                counts.iifes++;
+                i++;
+                continue;
+            }
+
+            // Lambda introducer: a capture list that is not a subscript,
+            // followed by a parameter list or body
+            if (c == '[' && (i + 1 >= code.size() || code[i + 1] != '['))
+            {
+                size_t before = i;
+                while (before > 0 && code[before - 1] == ' ')
+                    before--;
+                bool subscript = false;
+                if (before > 0)
+                {
+                    const char prev = code[before - 1];
+                    if (prev == ')' || prev == ']' || prev == '"')
+                        subscript = true;
+                    else if (isIdentChar(prev))
+                    {
+                        size_t word = before;
+                        while (word > 0 && isIdentChar(code[word - 1]))
+                            word--;
+                        subscript = code.compare(word, before - word, "return") != 0;
+                    }
+                }
+
+                size_t close = i + 1;
+                while (close < code.size() && (isIdentChar(code[close]) || code[close] == '&' ||
+                                               code[close] == '=' || code[close] == ',' ||
+                                               code[close] == ' ' || code[close] == '*'))
+                    close++;
+                size_t next = close + 1;
+                while (next < code.size() && code[next] == ' ')
+                    next++;
+                if (!subscript && close < code.size() && code[close] == ']' && next < code.size() &&
+                    (code[next] == '(' || code[next] == '{'))
+                    counts.lambdas++;
+                i++;
+                continue;
+            }
+
+            if (isIdentChar(c) && !std::isdigit(static_cast<unsigned char>(c)) &&
+                (i == 0 || !isIdentChar(code[i - 1])))
+            {
+                size_t stop = i;
+                while (stop < code.size() && isIdentChar(code[stop]))
+                    stop++;
+                const std::string word = code.substr(i, stop - i);
+
+                if (word == "decltype")
+                {
+                    counts.templateHints++;
+                }
+                else if (word == "auto")
+                {
+                    // Generic lambda parameter: 'auto x,' 'auto x)' 'auto... xs)'
+                    size_t next = stop;
+                    while (next < code.size() && (code[next] == ' ' || code[next] == '&' || code[next] == '.'))
+                        next++;
+                    while (next < code.size() && isIdentChar(code[next]))
+                        next++;
+                    while (next < code.size() && code[next] == ' ')
+                        next++;
+                    if (next > stop && next < code.size() && (code[next] == ',' || code[next] == ')'))
+                        counts.templateHints++;
+                }
+                else if (stop + 1 < code.size() && code[stop] == '<' && code[stop + 1] != '<' &&
+                         code[stop + 1] != '=' && word != "operator" && word.find("_cast") == std::string::npos)
+                {
+                    // Template-id: vector<int>, reduceSum<...>, template<...>
+                    counts.templateHints++;
+                }
+                i = stop;
+                continue;
+            }
+            i++;
+        }
+        return counts;
+    }
+
+    std::string CodeStats::toJson() const
+    {
+        std::ostringstream json;
+        json << "{\n  \"modules\": [";
+        for (size_t m = 0; m < modules.size(); m++)
+        {
+            const Module &module = modules[m];
+            json << (m ? ",\n" : "\n") << "    {\n      \"file\": " << jsonString(module.file) << ", ";
+            writeCounts(json, module.total);
+
+            // Construct kinds over the whole module and per function, by own text
+            std::map<std::string, std::pair<int, Counts>> kinds;
+            std::map<std::string, std::map<std::string, std::pair<int, Counts>>> functionKinds;
+            for (const Record &record : module.records)
+            {
+                if (isScope(record.kind))
+                    continue;
+                auto &kind = kinds[record.kind];
+                kind.first++;
+                kind.second += record.self;
+                auto &inFunction = functionKinds[record.function][record.kind];
+                inFunction.first++;
+                inFunction.second += record.self;
+            }
+            auto writeKinds = [&json](const std::map<std::string, std::pair<int, Counts>> &byKind)
+            {
+                json << "{";
+                bool first = true;
+                for (const auto &entry : byKind)
+                {
+                    json << (first ? "" : ", ") << jsonString(entry.first) << ": {\"count\": " << entry.second.first << ", ";
+                    writeCounts(json, entry.second.second);
+                    json << "}";
+                    first = false;
+                }
+                json << "}";
+            };
+
+            json << ",\n      \"kinds\": ";
+            writeKinds(kinds);
+
+            json << ",\n      \"functions\": [";
+            bool first = true;
+            for (const Record &record : module.records)
+            {
+                if (record.kind != "function")
+                    continue;
+                json << (first ? "\n" : ",\n") << "        {\"name\": " << jsonString(record.function)
+                     << ", \"line\": " << record.line << ", ";
+                writeCounts(json, record.total);
+                json << ", \"kinds\": ";
+                writeKinds(functionKinds[record.function]);
+                json << "}";
+                first = false;
+            }
+            json << (first ? "]" : "\n      ]");
+
+            // Own counts per construct; 'totalBytes' includes nested constructs
+            json << ",\n      \"constructs\": [";
+            first = true;
+            for (const Record &record : module.records)
+            {
+                if (isScope(record.kind))
+                    continue;
+                json << (first ? "\n" : ",\n") << "        {\"kind\": " << jsonString(record.kind)
+                     << ", \"line\": " << record.line << ", \"function\": "
+                     << (record.function.empty() ? "null" : jsonString(record.function)) << ", ";
+                writeCounts(json, record.self);
+                json << ", \"totalBytes\": " << record.total.bytes << "}";
+                first = false;
+            }
+            json << (first ? "]" : "\n      ]") << "\n    }";
+        }
+        json << (modules.empty() ? "]" : "\n  ]") << "\n}\n";
+        return json.str();
+    }
+
+} // namespace lpp
@@ -0,0 +1,939 @@
+#include "EffectAnalyzer.h"
+#include <algorithm>
+#include <iterator>
+
+namespace lpp
+{
+    namespace
+    {
+        // Free functions from lpp_stdlib.hpp and <cmath> that L++ code calls by
+        // name, by effect. Anything not listed (and not user-defined) is unknown.
+        const std::set<std::string> pureBuiltins = {
+            "len", "abs", "sqrt", "cbrt", "pow", "exp", "log", "log2", "log10",
+            "sin", "cos", "tan", "asin", "acos", "atan", "atan2", "sinh", "cosh", "tanh",
+            "floor", "ceil", "round", "trunc", "fabs", "fmod", "hypot", "min", "max",
+            "str", "toString", "to_string", "stoi", "stol", "stod", "parseInt", "parseFloat",
+            "toUpper", "toLower", "trim", "split", "join", "substring", "charAt", "indexOf",
+            "startsWith", "endsWith", "replace", "repeat", "reverse", "contains", "slice",
+            "sorted", "sortBy", "topK", "topKBy", "binarySearch", "lowerBound", "upperBound",
+            "map", "filter", "reduce", "mapEach", "filterEach", "reduceEach", "mapVector",
+            "reduceSum", "reduceProduct", "reduceMin", "reduceMax", "reduceAll", "reduceAny",
+            "collect", "take", "keys", "values", "has", "getOrDefault", "parseJson",
+            "persistent", "toPersistentVector", "range"};
+
+        // Pure builtins that throw on bad input (unparsable numbers or JSON,
+        // out-of-range indices, negative counts, empty delimiters); calling
+        // one sets mayThrow, which keeps the function from being LPP_PURE
+        const std::set<std::string> throwingBuiltins = {
+            "stoi", "stol", "stod", "parseInt", "parseFloat", "charAt", "parseJson",
+            "substring", "repeat", "split"};
+
+        const std::set<std::string> ioBuiltins = {
+            "print", "println", "printf", "input", "flush", "exit", "sleep",
+            "readFile", "writeFile", "appendFile", "readChunks", "readJson", "lines",
+            "csvRows", "loadEdgeList", "loadSnapshot", "saveSnapshot"};
+
+        const std::set<std::string> randomBuiltins = {
+            "random", "randomInt", "randomFloat", "rand", "shuffle", "seedRandom",
+            "threadRandom", "now", "time", "clock"};
+
+        // Sort their first argument in place
+        const std::set<std::string> mutatingBuiltins = {
+            "sortInPlace", "pdqsort", "radixSort", "radixSortBy", "parallelSort", "nthElement"};
+
+        // Methods on values (vectors, strings, maps, stdlib containers) that
+        // only read the receiver, or that change it
+        const std::set<std::string> readOnlyMethods = {
+            "size", "length", "empty", "isEmpty", "get", "at", "contains", "has", "find",
+            "count", "keys", "values", "front", "back", "first", "last", "substr",
+            "substring", "startsWith", "endsWith", "indexOf", "charAt", "toString", "str",
+            "slice", "peek", "getResult", "getState", "getInstance"};
+
+        const std::set<std::string> mutatingMethods = {
+            "push", "push_back", "pushBack", "pushFront", "pop", "pop_back", "popBack",
+            "popFront", "insert", "erase", "remove", "clear", "set", "add", "append",
+            "sort", "reverse", "resize", "reserve", "emplace", "emplace_back", "assign",
+            "swap", "update", "enqueue", "dequeue"};
+
+        const std::set<std::string> ioMethods = {
+            "send", "receive", "trySend", "tryReceive", "read", "write", "close", "flush",
+            "publish", "post", "subscribe"};
+
+        // Parameter and return types a memo table can key on
+        bool isMemoKeyType(const std::string &type)
+        {
+            return type == "int" || type == "float" || type == "bool" || type == "string";
+        }
+
+        std::string joinNames(const std::set<std::string> &names)
+        {
+            std::string text;
+            for (const auto &name : names)
+                text += (text.empty() ? "" : ", ") + name;
+            return text;
+        }
+    } // namespace
+
+    void EffectAnalyzer::analyze(Program &program)
+    {
+        units.clear();
+        freeFunctions.clear();
+        unitsByFunction.clear();
+        methods.clear();
+        constantNames.clear();
+        pending.clear();
+        frames.clear();
+
+        // Register every function first so calls resolve regardless of order
+        for (auto &cls : program.classes)
+        {
+            constantNames.insert(cls->name);
+            for (auto &method : cls->methods)
+                methods.emplace(method->name, addUnit(cls->name + "." + method->name, method->effects, method.get()));
+            if (cls->constructor)
+                methods.emplace(cls->name, addUnit(cls->name + ".constructor", cls->constructor->effects, cls->constructor.get()));
+        }
+        for (auto &func : program.functions)
+            freeFunctions.emplace(func->name, addUnit(func->name, func->effects, func.get()));
+        for (auto &type : program.types)
+        {
+            constantNames.insert(type->name);
+            for (auto &variant : type->variants)
+                constantNames.insert(variant.first);
+        }
+        for (auto &stmt : program.enums)
+        {
+            if (auto *decl = dynamic_cast<EnumDecl *>(stmt.get()))
+                constantNames.insert(decl->name);
+        }
+        for (auto &mol : program.molecules)
+            constantNames.insert(mol->name);
+
+        program.accept(*this);
+
+        propagate();
+        markRecursion();
+        for (auto &unit : units)
+            decideMemoization(*unit);
+        for (auto &site : pending)
+            *site.flag = isReadOnlyFunction(site.fn, site.boundLambda);
+    }
+
+    EffectAnalyzer::Unit *EffectAnalyzer::addUnit(const std::string &name, EffectSummary &effects, Function *function)
+    {
+        effects = EffectSummary();
+        effects.analyzed = true;
+        units.push_back(std::make_unique<Unit>());
+        Unit *unit = units.back().get();
+        unit->name = name;
+        unit->effects = &effects;
+        unit->function = function;
+        if (function)
+            unitsByFunction[function] = unit;
+        return unit;
+    }
+
+    void EffectAnalyzer::analyzeBody(Unit *unit, Function &node)
+    {
+        frames.push_back(Frame{unit, {}, {}});
+        for (const auto &param : node.parameters)
+            declare(param.first);
+        if (node.hasRestParam)
+            declare(node.restParamName);
+        for (auto &stmt : node.body)
+            stmt->accept(*this);
+        frames.pop_back();
+    }
+
+    void EffectAnalyzer::declare(const std::string &name)
+    {
+        if (!frames.empty())
+            frames.back().locals.insert(name);
+    }
+
+    int EffectAnalyzer::declaringFrame(const std::string &name) const
+    {
+        for (int i = static_cast<int>(frames.size()) - 1; i >= 0; i--)
+        {
+            if (frames[i].locals.count(name))
+                return i;
+        }
+        return -1;
+    }
+
+    void EffectAnalyzer::recordRead(const std::string &name)
+    {
+        if (name.empty() || constantNames.count(name) || freeFunctions.count(name))
+            return;
+        const size_t owner = static_cast<size_t>(declaringFrame(name) + 1);
+        for (size_t i = owner; i < frames.size(); i++)
+        {
+            frames[i].unit->effects->readsGlobal = true;
+            frames[i].unit->effects->reads.insert(name);
+        }
+    }
+
+    void EffectAnalyzer::recordWrite(const std::string &name)
+    {
+        if (name.empty())
+            return;
+        const size_t owner = static_cast<size_t>(declaringFrame(name) + 1);
+        for (size_t i = owner; i < frames.size(); i++)
+        {
+            frames[i].unit->effects->writesGlobal = true;
+            frames[i].unit->effects->writes.insert(name);
+        }
+    }
+
+    void EffectAnalyzer::recordCall(Unit *callee)
+    {
+        for (auto &frame : frames)
+        {
+            auto &callees = frame.unit->callees;
+            if (std::find(callees.begin(), callees.end(), callee) == callees.end())
+                callees.push_back(callee);
+            frame.unit->effects->calls.insert(callee->name);
+        }
+    }
+
+    void EffectAnalyzer::recordBuiltin(const std::string &name)
+    {
+        if (throwingBuiltins.count(name))
+        {
+            for (auto &frame : frames)
+                frame.unit->effects->mayThrow = true;
+        }
+        if (pureBuiltins.count(name))
+            return;
+        for (auto &frame : frames)
+        {
+            EffectSummary &effects = *frame.unit->effects;
+            if (ioBuiltins.count(name))
+            {
+                effects.io = true;
+                effects.ioCalls.insert(name);
+            }
+            else if (randomBuiltins.count(name))
+            {
+                effects.random = true;
+                effects.randomCalls.insert(name);
+            }
+            else
+            {
+                effects.unknown = true;
+                effects.unknownCalls.insert(name);
+            }
+        }
+    }
+
+    void EffectAnalyzer::recordMethodCall(Expression *receiver, const std::string &method)
+    {
+        const std::string root = rootName(receiver);
+        auto range = methods.equal_range(method);
+        if (range.first != range.second)
+        {
+            // A method some class declares. Receivers aren't typed here, so
+            // every class's method of that name counts
+            for (auto it = range.first; it != range.second; ++it)
+                recordCall(it->second);
+            recordWrite(root);
+        }
+        else if (mutatingMethods.count(method))
+        {
+            recordWrite(root);
+        }
+        else if (ioMethods.count(method))
+        {
+            for (auto &frame : frames)
+            {
+                frame.unit->effects->io = true;
+                frame.unit->effects->ioCalls.insert("." + method);
+            }
+        }
+        else if (!readOnlyMethods.count(method))
+        {
+            for (auto &frame : frames)
+            {
+                frame.unit->effects->unknown = true;
+                frame.unit->effects->unknownCalls.insert("." + method);
+            }
+        }
+    }
+
+    void EffectAnalyzer::queueParallel(bool &flag, Expression *fn)
+    {
+        LambdaExpr *bound = nullptr;
+        if (auto *ident = dynamic_cast<IdentifierExpr *>(fn))
+        {
+            for (auto frame = frames.rbegin(); frame != frames.rend() && !bound; ++frame)
+            {
+                auto it = frame->lambdas.find(ident->name);
+                if (it != frame->lambdas.end())
+                    bound = it->second;
+            }
+        }
+        pending.push_back(PendingParallel{&flag, fn, bound});
+    }
+
+    // Operand used as a function (map/filter/reduce, pipeline stages,
+    // composition): a bare name is a call to it, a lambda is walked
+    void EffectAnalyzer::visitFunctionValue(Expression *fn)
+    {
+        if (auto *ident = dynamic_cast<IdentifierExpr *>(fn))
+        {
+            CallExpr call(ident->name, {});
+            visit(call);
+        }
+        else
+        {
+            fn->accept(*this);
+        }
+    }
+
+    // Variable an lvalue-ish expression is rooted in: a.b[i].c -> "a";
+    // this.count -> "this.count"; "" for temporaries
+    std::string EffectAnalyzer::rootName(Expression *expr)
+    {
+        if (auto *ident = dynamic_cast<IdentifierExpr *>(expr))
+            return ident->name;
+        if (auto *index = dynamic_cast<IndexExpr *>(expr))
+        {
+            auto *object = dynamic_cast<IdentifierExpr *>(index->object.get());
+            auto *prop = dynamic_cast<IdentifierExpr *>(index->index.get());
+            if (object && object->name == "this" && index->isDot && prop)
+                return "this." + prop->name;
+            return rootName(index->object.get());
+        }
+        return "";
+    }
+
+    // Callee effects flow into callers until no summary changes
+    void EffectAnalyzer::propagate()
+    {
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (auto &unit : units)
+            {
+                EffectSummary &effects = *unit->effects;
+                for (Unit *callee : unit->callees)
+                {
+                    const EffectSummary &from = *callee->effects;
+                    const size_t before = effects.reads.size() + effects.writes.size() + effects.ioCalls.size() +
+                                          effects.randomCalls.size() + effects.unknownCalls.size();
+                    const bool flagsBefore[] = {effects.readsGlobal, effects.writesGlobal, effects.io,
+                                                effects.random, effects.unknown, effects.mayThrow};
+                    effects.readsGlobal |= from.readsGlobal;
+                    effects.writesGlobal |= from.writesGlobal;
+                    effects.io |= from.io;
+                    effects.random |= from.random;
+                    effects.unknown |= from.unknown;
+                    effects.mayThrow |= from.mayThrow;
+                    effects.reads.insert(from.reads.begin(), from.reads.end());
+                    effects.writes.insert(from.writes.begin(), from.writes.end());
+                    effects.ioCalls.insert(from.ioCalls.begin(), from.ioCalls.end());
+                    effects.randomCalls.insert(from.randomCalls.begin(), from.randomCalls.end());
+                    effects.unknownCalls.insert(from.unknownCalls.begin(), from.unknownCalls.end());
+                    const size_t after = effects.reads.size() + effects.writes.size() + effects.ioCalls.size() +
+                                         effects.randomCalls.size() + effects.unknownCalls.size();
+                    const bool flagsAfter[] = {effects.readsGlobal, effects.writesGlobal, effects.io,
+                                               effects.random, effects.unknown, effects.mayThrow};
+                    if (after != before || !std::equal(std::begin(flagsBefore), std::end(flagsBefore), flagsAfter))
+                        changed = true;
+                }
+            }
+        }
+    }
+
+    void EffectAnalyzer::markRecursion()
+    {
+        for (auto &unit : units)
+        {
+            std::set<Unit *> seen;
+            std::vector<Unit *> stack(unit->callees.begin(), unit->callees.end());
+            while (!stack.empty() && !unit->effects->recursive)
+            {
+                Unit *next = stack.back();
+                stack.pop_back();
+                if (next == unit.get())
+                    unit->effects->recursive = true;
+                else if (seen.insert(next).second)
+                    stack.insert(stack.end(), next->callees.begin(), next->callees.end());
+            }
+        }
+    }
+
+    // Memoize pure free functions that call themselves more than once per
+    // call (fib-style tree recursion, where subproblems repeat) and whose
+    // arguments and result are scalars or strings. Linear recursion like
+    // factorial gains nothing from a cache, so it is left alone.
+    void EffectAnalyzer::decideMemoization(Unit &unit)
+    {
+        Function *fn = unit.function;
+        EffectSummary &effects = *unit.effects;
+        if (!fn || freeFunctions.count(fn->name) != 1 || freeFunctions.find(fn->name)->second != &unit)
+            return;
+        if (!effects.isPure() || effects.selfCalls < 2 || fn->parameters.empty())
+            return;
+        if (fn->isAsync || fn->isGenerator || fn->isPrototype || fn->hasRestParam || !fn->genericParams.empty())
+            return;
+        if (!isMemoKeyType(fn->returnType))
+            return;
+        for (const auto &param : fn->parameters)
+        {
+            if (!isMemoKeyType(param.second))
+                return;
+        }
+        effects.memoize = true;
+    }
+
+    bool EffectAnalyzer::isReadOnlyFunction(Expression *fn, LambdaExpr *boundLambda) const
+    {
+        if (boundLambda)
+            return boundLambda->effects.isReadOnly();
+        if (auto *lambda = dynamic_cast<LambdaExpr *>(fn))
+            return lambda->effects.isReadOnly();
+        if (auto *ident = dynamic_cast<IdentifierExpr *>(fn))
+        {
+            auto overloads = freeFunctions.equal_range(ident->name);
+            if (overloads.first == overloads.second)
+                return pureBuiltins.count(ident->name) > 0;
+            return std::all_of(overloads.first, overloads.second, [](const auto &entry)
+                               { return entry.second->effects->isReadOnly(); });
+        }
+        return false;
+    }
+
+    void EffectAnalyzer::dump(std::ostream &out) const
+    {
+        out << "Effects:\n";
+        for (const auto &unit : units)
+        {
+            const EffectSummary &effects = *unit->effects;
+            std::vector<std::string> parts;
+            if (effects.isPure())
+                parts.push_back("pure");
+            if (effects.readsGlobal)
+                parts.push_back("reads-global(" + joinNames(effects.reads) + ")");
+            if (effects.writesGlobal)
+                parts.push_back("writes-global(" + joinNames(effects.writes) + ")");
+            if (effects.io)
+                parts.push_back("io(" + joinNames(effects.ioCalls) + ")");
+            if (effects.random)
+                parts.push_back("random(" + joinNames(effects.randomCalls) + ")");
+            if (effects.unknown)
+                parts.push_back("unknown(" + joinNames(effects.unknownCalls) + ")");
+            if (effects.mayThrow)
+                parts.push_back("throws");
+            if (effects.recursive)
+                parts.push_back("recursive");
+            if (effects.memoize)
+                parts.push_back("memoized");
+
+            out << "  " << unit->name << ": ";
+            for (size_t i = 0; i < parts.size(); i++)
+                out << (i ? ", " : "") << parts[i];
+            if (!effects.calls.empty())
+                out << "; calls " << joinNames(effects.calls);
+            out << "\n";
+        }
+
+        size_t parallel = std::count_if(pending.begin(), pending.end(), [](const PendingParallel &site)
+                                        { return *site.flag; });
+        out << "  " << parallel << " of " << pending.size() << " map/filter/reduce run in parallel\n";
+    }
+
+    // ===== Expressions =====
+
+    void EffectAnalyzer::visit(NumberExpr &node) {}
+    void EffectAnalyzer::visit(StringExpr &node) {}
+    void EffectAnalyzer::visit(BoolExpr &node) {}
+
+    void EffectAnalyzer::visit(TemplateLiteralExpr &node)
+    {
+        for (auto &expr : node.interpolations)
+            expr->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(IdentifierExpr &node)
+    {
+        if (pureBuiltins.count(node.name) || ioBuiltins.count(node.name) || randomBuiltins.count(node.name))
+        {
+            // Passed as a function value; effects count where it's called,
+            // but a throwing builtin can still throw out of this function
+            if (throwingBuiltins.count(node.name))
+            {
+                for (auto &frame : frames)
+                    frame.unit->effects->mayThrow = true;
+            }
+            return;
+        }
+        recordRead(node.name);
+    }
+
+    void EffectAnalyzer::visit(BinaryExpr &node)
+    {
+        node.left->accept(*this);
+        node.right->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(UnaryExpr &node)
+    {
+        node.operand->accept(*this);
+        if (node.op == "++" || node.op == "--")
+            recordWrite(rootName(node.operand.get()));
+    }
+
+    void EffectAnalyzer::visit(PostfixExpr &node)
+    {
+        node.operand->accept(*this);
+        recordWrite(rootName(node.operand.get()));
+    }
+
+    void EffectAnalyzer::visit(CallExpr &node)
+    {
+        for (auto &arg : node.arguments)
+            arg->accept(*this);
+
+        const std::string &name = node.function;
+        const int owner = declaringFrame(name);
+        if (owner >= 0)
+        {
+            // A let-bound lambda's body was already walked where it was
+            // written; any other local is a function value from elsewhere
+            if (!frames[owner].lambdas.count(name))
+            {
+                for (size_t i = static_cast<size_t>(owner); i < frames.size(); i++)
+                {
+                    frames[i].unit->effects->unknown = true;
+                    frames[i].unit->effects->unknownCalls.insert(name);
+                }
+            }
+            return;
+        }
+
+        auto overloads = freeFunctions.equal_range(name);
+        if (overloads.first != overloads.second)
+        {
+            for (auto it = overloads.first; it != overloads.second; ++it)
+                recordCall(it->second);
+            Function *outer = frames.empty() ? nullptr : frames.front().unit->function;
+            if (outer && outer->name == name && freeFunctions.count(name))
+                frames.front().unit->effects->selfCalls++;
+            return;
+        }
+        if (constantNames.count(name))
+        {
+            // Class constructor or ADT variant
+            auto range = methods.equal_range(name);
+            for (auto it = range.first; it != range.second; ++it)
+                recordCall(it->second);
+            return;
+        }
+        if (mutatingBuiltins.count(name))
+        {
+            if (!node.arguments.empty())
+                recordWrite(rootName(node.arguments[0].get()));
+            return;
+        }
+        recordBuiltin(name);
+    }
+
+    void EffectAnalyzer::visit(LambdaExpr &node)
+    {
+        std::string owner = frames.empty() ? "top level" : frames.back().unit->name;
+        Unit *unit = addUnit("lambda in " + owner, node.effects, nullptr);
+        frames.push_back(Frame{unit, {}, {}});
+        for (const auto &param : node.parameters)
+            declare(param.first);
+        if (node.hasRestParam)
+            declare(node.restParamName);
+        node.body->accept(*this);
+        frames.pop_back();
+
+        // The enclosing functions run this body whenever they call it, so
+        // its calls were recorded on them too (recordCall walks every frame)
+    }
+
+    void EffectAnalyzer::visit(TernaryIfExpr &node)
+    {
+        node.condition->accept(*this);
+        node.thenExpr->accept(*this);
+        node.elseExpr->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(PipelineExpr &node)
+    {
+        node.initial->accept(*this);
+        for (auto &stage : node.stages)
+            visitFunctionValue(stage.get());
+    }
+
+    void EffectAnalyzer::visit(CompositionExpr &node)
+    {
+        for (auto &fn : node.functions)
+            visitFunctionValue(fn.get());
+    }
+
+    void EffectAnalyzer::visit(RangeExpr &node)
+    {
+        node.start->accept(*this);
+        node.end->accept(*this);
+        if (node.step)
+            node.step->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(MapExpr &node)
+    {
+        node.iterable->accept(*this);
+        visitFunctionValue(node.fn.get());
+        queueParallel(node.parallel, node.fn.get());
+    }
+
+    void EffectAnalyzer::visit(FilterExpr &node)
+    {
+        node.iterable->accept(*this);
+        visitFunctionValue(node.predicate.get());
+        queueParallel(node.parallel, node.predicate.get());
+    }
+
+    void EffectAnalyzer::visit(ReduceExpr &node)
+    {
+        node.iterable->accept(*this);
+        if (node.initial)
+            node.initial->accept(*this);
+        visitFunctionValue(node.fn.get());
+        queueParallel(node.parallel, node.fn.get());
+    }
+
+    void EffectAnalyzer::visit(IterateWhileExpr &node)
+    {
+        node.start->accept(*this);
+        node.condition->accept(*this);
+        node.stepFn->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(AutoIterateExpr &node)
+    {
+        node.start->accept(*this);
+        node.limit->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(IterateStepExpr &node)
+    {
+        node.start->accept(*this);
+        node.stepFn->accept(*this);
+        node.condition->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(ArrayExpr &node)
+    {
+        for (auto &elem : node.elements)
+            elem->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(TupleExpr &node)
+    {
+        for (auto &elem : node.elements)
+            elem->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(ListComprehension &node)
+    {
+        node.range->accept(*this);
+        declare(node.variable);
+        node.expression->accept(*this);
+        for (auto &pred : node.predicates)
+            pred->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(SpreadExpr &node)
+    {
+        node.expression->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(IndexExpr &node)
+    {
+        // this.prop is member state, recorded by name; any other object is
+        // read through its root variable
+        auto *object = dynamic_cast<IdentifierExpr *>(node.object.get());
+        auto *call = dynamic_cast<CallExpr *>(node.index.get());
+        if (node.isDot && object && object->name == "this" && !call)
+            recordRead(rootName(&node));
+        else
+            node.object->accept(*this);
+
+        if (node.isDot && call)
+        {
+            // obj.method(args)
+            for (auto &arg : call->arguments)
+                arg->accept(*this);
+            recordMethodCall(node.object.get(), call->function);
+        }
+        else if (!node.isDot)
+        {
+            node.index->accept(*this);
+        }
+    }
+
+    void EffectAnalyzer::visit(ObjectExpr &node)
+    {
+        for (auto &prop : node.properties)
+            prop.second->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(MatchExpr &node)
+    {
+        node.expression->accept(*this);
+        for (auto &matchCase : node.cases)
+        {
+            matchCase.first->accept(*this);
+            matchCase.second->accept(*this);
+        }
+    }
+
+    void EffectAnalyzer::visit(CastExpr &node)
+    {
+        node.expression->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(AwaitExpr &node)
+    {
+        node.expression->accept(*this);
+        for (auto &frame : frames)
+        {
+            frame.unit->effects->io = true;
+            frame.unit->effects->ioCalls.insert("await");
+        }
+    }
+
+    // The spawned call's effects are the callee's; starting a task is
+    // scheduling, treated like await
+    void EffectAnalyzer::visit(SpawnExpr &node)
+    {
+        node.expression->accept(*this);
+        for (auto &frame : frames)
+        {
+            frame.unit->effects->io = true;
+            frame.unit->effects->ioCalls.insert("spawn");
+        }
+    }
+
+    void EffectAnalyzer::visit(ThrowExpr &node)
+    {
+        if (node.expression)
+            node.expression->accept(*this);
+        for (auto &frame : frames)
+            frame.unit->effects->mayThrow = true;
+    }
+
+    void EffectAnalyzer::visit(YieldExpr &node)
+    {
+        if (node.value)
+            node.value->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(TypeOfExpr &node)
+    {
+        node.expr->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(InstanceOfExpr &node)
+    {
+        node.expr->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(QuantumMethodCall &node)
+    {
+        for (auto &arg : node.args)
+            arg->accept(*this);
+        recordRead(node.quantumVar);
+        if (node.method == "observe")
+        {
+            for (auto &frame : frames)
+            {
+                frame.unit->effects->random = true;
+                frame.unit->effects->randomCalls.insert(node.quantumVar + ".observe");
+            }
+        }
+        else
+        {
+            recordWrite(node.quantumVar);
+        }
+    }
+
+    // ===== Statements =====
+
+    void EffectAnalyzer::visit(VarDecl &node)
+    {
+        if (node.initializer)
+            node.initializer->accept(*this);
+        declare(node.name);
+        if (auto *lambda = dynamic_cast<LambdaExpr *>(node.initializer.get()); lambda && !frames.empty())
+            frames.back().lambdas[node.name] = lambda;
+    }
+
+    void EffectAnalyzer::visit(QuantumVarDecl &node)
+    {
+        for (auto &state : node.states)
+            state->accept(*this);
+        declare(node.name);
+    }
+
+    void EffectAnalyzer::visit(Assignment &node)
+    {
+        node.value->accept(*this);
+        recordWrite(node.name);
+    }
+
+    void EffectAnalyzer::visit(IfStmt &node)
+    {
+        node.condition->accept(*this);
+        for (auto &stmt : node.thenBranch)
+            stmt->accept(*this);
+        for (auto &stmt : node.elseBranch)
+            stmt->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(WhileStmt &node)
+    {
+        node.condition->accept(*this);
+        for (auto &stmt : node.body)
+            stmt->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(SwitchStmt &node)
+    {
+        node.condition->accept(*this);
+        for (auto &clause : node.cases)
+        {
+            if (clause.value)
+                clause.value->accept(*this);
+            if (clause.guard)
+                clause.guard->accept(*this);
+            for (auto &stmt : clause.statements)
+                stmt->accept(*this);
+        }
+    }
+
+    void EffectAnalyzer::visit(ForStmt &node)
+    {
+        if (node.initializer)
+            node.initializer->accept(*this);
+        if (node.condition)
+            node.condition->accept(*this);
+        if (node.increment)
+            node.increment->accept(*this);
+        for (auto &stmt : node.body)
+            stmt->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(ForInStmt &node)
+    {
+        node.iterable->accept(*this);
+        declare(node.variable);
+        for (auto &stmt : node.body)
+            stmt->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(ParallelForStmt &node)
+    {
+        node.iterable->accept(*this);
+        declare(node.variable);
+        for (auto &stmt : node.body)
+            stmt->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(DoWhileStmt &node)
+    {
+        for (auto &stmt : node.body)
+            stmt->accept(*this);
+        node.condition->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(ArenaStmt &node)
+    {
+        for (auto &stmt : node.body)
+            stmt->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(ScopeStmt &node)
+    {
+        for (auto &stmt : node.body)
+            stmt->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(TryCatchStmt &node)
+    {
+        for (auto &stmt : node.tryBlock)
+            stmt->accept(*this);
+        declare(node.catchVariable);
+        for (auto &stmt : node.catchBlock)
+            stmt->accept(*this);
+        for (auto &stmt : node.finallyBlock)
+            stmt->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(DestructuringStmt &node)
+    {
+        node.source->accept(*this);
+        for (const auto &target : node.targets)
+            declare(target);
+    }
+
+    void EffectAnalyzer::visit(EnumDecl &node) {}
+    void EffectAnalyzer::visit(BreakStmt &node) {}
+    void EffectAnalyzer::visit(ContinueStmt &node) {}
+
+    void EffectAnalyzer::visit(ReturnStmt &node)
+    {
+        if (node.value)
+            node.value->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(ImportStmt &node) {}
+
+    void EffectAnalyzer::visit(ExportStmt &node)
+    {
+        if (node.declaration)
+            node.declaration->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(AutoPatternStmt &node) {}
+
+    void EffectAnalyzer::visit(ExprStmt &node)
+    {
+        node.expression->accept(*this);
+    }
+
+    // ===== Declarations =====
+
+    void EffectAnalyzer::visit(Function &node)
+    {
+        auto it = unitsByFunction.find(&node);
+        if (it != unitsByFunction.end())
+            analyzeBody(it->second, node);
+    }
+
+    void EffectAnalyzer::visit(ClassDecl &node)
+    {
+        for (auto &method : node.methods)
+            method->accept(*this);
+        if (node.constructor)
+            node.constructor->accept(*this);
+    }
+
+    void EffectAnalyzer::visit(InterfaceDecl &node) {}
+    void EffectAnalyzer::visit(TypeDecl &node) {}
+    void EffectAnalyzer::visit(MoleculeDecl &node) {}
+
+    void EffectAnalyzer::visit(Program &node)
+    {
+        for (auto &cls : node.classes)
+            cls->accept(*this);
+        for (auto &func : node.functions)
+            func->accept(*this);
+    }
+
+} // namespace lpp
@@ -48,6 +48,9 @@ namespace lpp
         {"new", TokenType::NEW},
         {"async", TokenType::ASYNC},
         {"await", TokenType::AWAIT},
+        {"spawn", TokenType::SPAWN},
+        {"parallel", TokenType::PARALLEL},
+        {"scope", TokenType::SCOPE},
         {"try", TokenType::TRY},
         {"catch", TokenType::CATCH},
         {"finally", TokenType::FINALLY},
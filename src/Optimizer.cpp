@@ -1,5 +1,6 @@
 #include "Optimizer.h"
 #include <iostream>
+#include <climits>
 
 namespace lpp
 {
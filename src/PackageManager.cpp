@@ -30,10 +30,10 @@ namespace lpp
                 std::string value = line.substr(colonPos + 1);
 
                 // Trim whitespace
-                size_t keyStart = key.find_first_not_of(" \t");
+                size_t keyStart = key.find_first_not_of(" \t\"");
                 if (keyStart != std::string::npos)
                     key.erase(0, keyStart);
-                size_t keyEnd = key.find_last_not_of(" \t");
+                size_t keyEnd = key.find_last_not_of(" \t\"");
                 if (keyEnd != std::string::npos)
                     key.erase(keyEnd + 1);
 
@@ -56,6 +56,8 @@ namespace lpp
                     manifest.license = value;
                 else if (key == "entry")
                     manifest.entryPoint = value;
+                else if (key == "profile")
+                    manifest.profile = value;
             }
         }
 
@@ -79,6 +81,8 @@ namespace lpp
         file << "  \"author\": \"" << manifest.author << "\",\n";
         file << "  \"license\": \"" << manifest.license << "\",\n";
         file << "  \"entry\": \"" << manifest.entryPoint << "\",\n";
+        if (!manifest.profile.empty())
+            file << "  \"profile\": \"" << manifest.profile << "\",\n";
 
         file << "  \"dependencies\": {\n";
         for (size_t i = 0; i < manifest.dependencies.size(); i++)
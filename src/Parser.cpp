@@ -101,6 +101,7 @@ namespace lpp
         std::vector<std::unique_ptr<MoleculeDecl>> molecules;
         std::vector<std::unique_ptr<Statement>> imports;
         std::vector<std::unique_ptr<Statement>> exports;
+        ProgramPragmas pragmas;
 
         while (!isAtEnd())
         {
@@ -118,14 +119,20 @@ namespace lpp
             }
             else if (check(TokenType::AUTOPATTERN))
             {
-                // autopattern <ProblemType> <ClassName>
+                // autopattern <ProblemType> <ClassName>[<TypeArgument>]
                 advance(); // consume 'autopattern'
                 Token problemType = consume(TokenType::IDENTIFIER, "Expected problem type after 'autopattern'");
                 Token className = consume(TokenType::IDENTIFIER, "Expected class name after problem type");
-                consume(TokenType::SEMICOLON, "Expected ';' after autopattern declaration");
 
                 // Create auto-pattern statement and expand it into a class
                 auto autoPattern = std::make_unique<AutoPatternStmt>(problemType.lexeme, className.lexeme);
+                autoPattern->line = className.line;
+                if (check(TokenType::LESS))
+                {
+                    std::string args = genericTypeArguments();
+                    autoPattern->typeArgument = args.substr(1, args.size() - 2);
+                }
+                consume(TokenType::SEMICOLON, "Expected ';' after autopattern declaration");
 
                 // Auto-detect pattern based on problem type and generate class
                 classes.push_back(expandAutoPattern(std::move(autoPattern)));
@@ -164,6 +171,10 @@ namespace lpp
             {
                 molecules.push_back(moleculeDeclaration());
             }
+            else if (check(TokenType::PRAGMA))
+            {
+                pragmaDirective(pragmas);
+            }
             else
             {
                 error("Expected function, class, interface, type, enum, or mol declaration");
@@ -182,9 +193,84 @@ namespace lpp
         //     result.push_back(std::move(stmt)); // GOOD: moved
         //     return result; // RVO or move
         //   }
-        return std::make_unique<Program>(paradigm, std::move(functions), std::move(classes),
-                                         std::move(interfaces), std::move(types), std::move(enums),
-                                         std::move(imports), std::move(exports), std::move(molecules));
+        auto program = std::make_unique<Program>(paradigm, std::move(functions), std::move(classes),
+                                                 std::move(interfaces), std::move(types), std::move(enums),
+                                                 std::move(imports), std::move(exports), std::move(molecules));
+        program->pragmas = pragmas;
+        return program;
+    }
+
+    // Top-level pragmas after the paradigm line:
+    //   #pragma seed <N>             - fixed seed for quantum variables / threadRng()
+    //   #pragma fp strict|relaxed    - floating-point order of reduce kernels
+    //   #pragma experimental <name>  - feature opt-in, accepted for documentation
+    //   #pragma allocator arena      - the next function allocates from an arena
+    void Parser::pragmaDirective(ProgramPragmas &pragmas)
+    {
+        Token pragmaToken = advance();
+        std::istringstream words(pragmaToken.lexeme);
+        std::string keyword, name, value;
+        words >> keyword >> name >> value;
+
+        if (keyword != "pragma")
+        {
+            error("Unknown directive '#" + pragmaToken.lexeme + "'");
+            return;
+        }
+        if (name == "seed")
+        {
+            uint64_t parsed = 0;
+            size_t used = 0;
+            try
+            {
+                parsed = std::stoull(value, &used);
+            }
+            catch (const std::exception &)
+            {
+                used = 0;
+            }
+            if (value.empty() || used != value.size() || value[0] == '-')
+            {
+                error("Expected a non-negative integer after '#pragma seed'");
+                return;
+            }
+            if (pragmas.seed)
+            {
+                error("Duplicate '#pragma seed'");
+                return;
+            }
+            pragmas.seed = parsed;
+        }
+        else if (name == "fp")
+        {
+            if (value == "relaxed")
+                pragmas.relaxedFloat = true;
+            else if (value == "strict")
+                pragmas.relaxedFloat = false;
+            else
+                error("Expected 'strict' or 'relaxed' after '#pragma fp'");
+        }
+        else if (name == "experimental")
+        {
+            // Experimental features are always enabled
+        }
+        else if (name == "allocator")
+        {
+            if (value == "arena")
+                pendingArenaAllocator = true;
+            else if (value == "default")
+                pendingArenaAllocator = false;
+            else
+                error("Expected 'arena' or 'default' after '#pragma allocator'");
+        }
+        else if (name == "paradigm")
+        {
+            error("'#pragma paradigm' must be the first line of the file");
+        }
+        else
+        {
+            error("Unknown pragma '" + name + "'. Expected: seed, fp, experimental, allocator");
+        }
     }
 
     Token Parser::peek() const
@@ -522,8 +608,11 @@ namespace lpp
         auto func = std::make_unique<Function>(name.lexeme, std::move(parameters),
                                                returnType.lexeme, std::move(body),
                                                hasRestParam, restParamName);
+        func->line = name.line;
         func->isAsync = isAsync;
         func->genericParams = std::move(genericParams);
+        func->useArena = pendingArenaAllocator;
+        pendingArenaAllocator = false;
 
         // Validate async function return type
         if (isAsync && returnType.lexeme == "void")
@@ -551,6 +640,10 @@ namespace lpp
             return whileStatement();
         if (match(TokenType::FOR))
             return forStatement();
+        if (match(TokenType::PARALLEL))
+            return parallelForStatement();
+        if (match(TokenType::SCOPE))
+            return scopeStatement();
         if (match(TokenType::DO))
             return doWhileStatement();
         if (match(TokenType::SWITCH))
@@ -559,6 +652,12 @@ namespace lpp
             return tryCatchStatement();
         if (match(TokenType::ENUM))
             return enumDeclaration();
+        // 'arena' is contextual so it stays usable as an identifier
+        if (check(TokenType::IDENTIFIER) && peek().lexeme == "arena" && peekNext().type == TokenType::LBRACE)
+        {
+            advance();
+            return arenaStatement();
+        }
         if (match(TokenType::BREAK))
         {
             consume(TokenType::SEMICOLON, "Expected ';' after 'break'");
@@ -674,6 +773,12 @@ namespace lpp
             Token type = advance();
             typeName = type.lexeme;
 
+            // Generic type arguments: Channel<int>, HashMap<string, int>
+            if (check(TokenType::LESS))
+            {
+                typeName += genericTypeArguments();
+            }
+
             // Check for array type: int[]
             if (match(TokenType::LBRACKET))
             {
@@ -762,6 +867,49 @@ namespace lpp
         return varDecl;
     }
 
+    std::string Parser::genericTypeArguments()
+    {
+        // Copies a balanced '<' ... '>' run as text. Nested closers may be lexed
+        // as '>>' or '>>>', so track depth instead of matching single tokens.
+        std::string result;
+        int depth = 0;
+        do
+        {
+            Token tok = advance();
+            switch (tok.type)
+            {
+            case TokenType::LESS:
+                depth++;
+                result += "<";
+                break;
+            case TokenType::GREATER:
+                depth--;
+                result += ">";
+                break;
+            case TokenType::GREATER_GREATER:
+                depth -= 2;
+                result += ">>";
+                break;
+            case TokenType::GREATER_GREATER_GREATER:
+                depth -= 3;
+                result += ">>>";
+                break;
+            case TokenType::COMMA:
+                result += ", ";
+                break;
+            default:
+                result += tok.lexeme;
+                break;
+            }
+        } while (depth > 0 && !isAtEnd());
+
+        if (depth != 0)
+        {
+            error("Unbalanced '<' '>' in type arguments");
+        }
+        return result;
+    }
+
     std::unique_ptr<Statement> Parser::quantumVarDeclaration()
     {
         // quantum let x = [states] or quantum let x: int = [1,2,3]
@@ -838,12 +986,12 @@ namespace lpp
 
         if (hasWeights)
         {
-            return std::make_unique<QuantumVarDecl>(name.lexeme, typeName,
-                                                    std::move(states), std::move(probabilities));
+            return located(name.line, std::make_unique<QuantumVarDecl>(name.lexeme, typeName,
+                                                                       std::move(states), std::move(probabilities)));
         }
         else
         {
-            return std::make_unique<QuantumVarDecl>(name.lexeme, typeName, std::move(states));
+            return located(name.line, std::make_unique<QuantumVarDecl>(name.lexeme, typeName, std::move(states)));
         }
     }
 
@@ -1016,7 +1164,7 @@ namespace lpp
                 std::vector<std::pair<std::string, std::string>> params = {{paramName, ""}};
                 auto body = expression();
                 --recursionDepth;
-                return std::make_unique<LambdaExpr>(std::move(params), std::move(body));
+                return located(tokens[saved].line, std::make_unique<LambdaExpr>(std::move(params), std::move(body)));
             }
             else
             {
@@ -1073,7 +1221,7 @@ namespace lpp
                     isLambda = true;
                     auto body = expression();
                     --recursionDepth;
-                    return std::make_unique<LambdaExpr>(std::move(params), std::move(body), "", hasRestParam, restParamName);
+                    return located(tokens[saved].line, std::make_unique<LambdaExpr>(std::move(params), std::move(body), "", hasRestParam, restParamName));
                 }
                 else
                 {
@@ -1226,30 +1374,42 @@ namespace lpp
             error("Expected '!!' after step function in iterate-step expression");
         }
 
-        // Map operator: arr @ fn
-        if (match(TokenType::AT))
+        // Map (@), filter (?) and reduce (\) chain left to right:
+        // arr ? (x => x > 2) @ (x => x * x) \ ((a, b) => a + b)
+        for (;;)
         {
-            auto fn = term();
-            return std::make_unique<MapExpr>(std::move(expr), std::move(fn));
-        }
+            // Map operator: arr @ fn
+            if (match(TokenType::AT))
+            {
+                const int line = previous().line;
+                auto fn = term();
+                expr = located(line, std::make_unique<MapExpr>(std::move(expr), std::move(fn)));
+                continue;
+            }
 
-        // Filter operator: arr ? |x| condition (but not ternary ?)
-        // We need to check if next is a lambda to distinguish from ternary
-        if (check(TokenType::QUESTION) && peekNext().type == TokenType::PIPE)
-        {
-            advance(); // consume ?
-            auto predicate = term();
-            return std::make_unique<FilterExpr>(std::move(expr), std::move(predicate));
-        }
+            // Filter operator: arr ? (x => cond) or arr ? predicate. A '?'
+            // after an operand is never the prefix ternary ?cond -> a $ b
+            if (check(TokenType::QUESTION) &&
+                (peekNext().type == TokenType::PIPE || peekNext().type == TokenType::LPAREN ||
+                 peekNext().type == TokenType::IDENTIFIER))
+            {
+                const int line = advance().line; // consume ?
+                auto predicate = term();
+                expr = located(line, std::make_unique<FilterExpr>(std::move(expr), std::move(predicate)));
+                continue;
+            }
 
-        // Reduce operator: arr \ |acc, x| expr
-        if (match(TokenType::BACKSLASH))
-        {
-            auto fn = term();
-            return std::make_unique<ReduceExpr>(std::move(expr), std::move(fn));
-        }
+            // Reduce operator: arr \ ((acc, x) => expr)
+            if (match(TokenType::BACKSLASH))
+            {
+                const int line = previous().line;
+                auto fn = term();
+                expr = located(line, std::make_unique<ReduceExpr>(std::move(expr), std::move(fn)));
+                continue;
+            }
 
-        return expr;
+            return expr;
+        }
     }
 
     std::unique_ptr<Expression> Parser::term()
@@ -1317,6 +1477,17 @@ namespace lpp
             return std::make_unique<AwaitExpr>(std::move(expr));
         }
 
+        // Spawn: like Go's 'go', the operand must be a call
+        if (match(TokenType::SPAWN))
+        {
+            auto spawn = std::make_unique<SpawnExpr>(unary());
+            if (!spawn->call())
+            {
+                error("Expected a function or method call after 'spawn'");
+            }
+            return spawn;
+        }
+
         // Throw expression (can be used as expression in some contexts)
         if (match(TokenType::THROW))
         {
@@ -1395,12 +1566,9 @@ namespace lpp
                 // obj.prop or obj.method() or quantumVar.observe()
                 Token propName = peek(); // initialize with current token
 
-                // Allow quantum keywords as method names
-                if (check(TokenType::OBSERVE))
-                {
-                    propName = advance();
-                }
-                else if (check(TokenType::ENTANGLE))
+                // Allow quantum keywords and get/set (Map.get, HashMap.set) as method names
+                if (check(TokenType::OBSERVE) || check(TokenType::ENTANGLE) ||
+                    check(TokenType::GET) || check(TokenType::SET))
                 {
                     propName = advance();
                 }
@@ -1427,7 +1595,7 @@ namespace lpp
                         }
 
                         consume(TokenType::RPAREN, "Expected ')' after quantum method call");
-                        expr = std::make_unique<QuantumMethodCall>(varName, method, std::move(args));
+                        expr = located(propName.line, std::make_unique<QuantumMethodCall>(varName, method, std::move(args)));
                         continue;
                     }
                 } // End quantum check
@@ -1553,6 +1721,31 @@ namespace lpp
                     consume(TokenType::RPAREN, "Expected ')' after arguments");
                     expr = std::make_unique<CallExpr>(functionName, std::move(arguments));
                 }
+                else if (auto *member = dynamic_cast<IndexExpr *>(expr.get());
+                         member && member->isDot && dynamic_cast<IdentifierExpr *>(member->index.get()))
+                {
+                    // Method call: obj.method(args) keeps the member access and
+                    // turns its property into the call, so it emits obj.method(args)
+                    std::string methodName = static_cast<IdentifierExpr *>(member->index.get())->name;
+                    advance(); // consume '('
+
+                    std::vector<std::unique_ptr<Expression>> arguments;
+                    if (!check(TokenType::RPAREN))
+                    {
+                        do
+                        {
+                            arguments.push_back(expression());
+                        } while (match(TokenType::COMMA));
+                    }
+
+                    consume(TokenType::RPAREN, "Expected ')' after method arguments");
+                    member->index = std::make_unique<CallExpr>(methodName, std::move(arguments));
+                }
+                else
+                {
+                    // Not callable here; leave '(' for the caller instead of spinning
+                    break;
+                }
             }
             else if (check(TokenType::PLUS_PLUS) || check(TokenType::MINUS_MINUS))
             {
@@ -1592,7 +1785,7 @@ namespace lpp
             std::vector<std::unique_ptr<Expression>> args;
             args.push_back(std::move(transformFn));
 
-            return std::make_unique<QuantumMethodCall>(varName.lexeme, "entangle", std::move(args));
+            return located(varName.line, std::make_unique<QuantumMethodCall>(varName.lexeme, "entangle", std::move(args)));
         }
 
         if (match(TokenType::NUMBER))
@@ -1617,6 +1810,7 @@ namespace lpp
         // Template literal: `text ${expr} more`
         if (match(TokenType::BACKTICK))
         {
+            const int templateLine = previous().line;
             std::vector<std::string> strings;
             std::vector<std::unique_ptr<Expression>> interpolations;
             std::string currentString;
@@ -1660,7 +1854,7 @@ namespace lpp
             strings.push_back(currentString); // Final string part
             consume(TokenType::BACKTICK, "Expected '`' after template literal");
 
-            return std::make_unique<TemplateLiteralExpr>(std::move(strings), std::move(interpolations));
+            return located(templateLine, std::make_unique<TemplateLiteralExpr>(std::move(strings), std::move(interpolations)));
         }
 
         if (match(TokenType::TRUE))
@@ -1729,7 +1923,7 @@ namespace lpp
                 }
 
                 consume(TokenType::RBRACKET, "Expected ']' after list comprehension");
-                return std::make_unique<ListComprehension>(std::move(firstExpr), varName.lexeme, std::move(range), std::move(predicates));
+                return located(varName.line, std::make_unique<ListComprehension>(std::move(firstExpr), varName.lexeme, std::move(range), std::move(predicates)));
             }
             else
             {
@@ -1761,6 +1955,7 @@ namespace lpp
         // Match expression: match expr { case pattern -> result }
         if (match(TokenType::MATCH))
         {
+            const int matchLine = previous().line;
             auto expr = expression();
             consume(TokenType::LBRACE, "Expected '{' after match expression");
 
@@ -1788,7 +1983,7 @@ namespace lpp
                 error("Match expression must have at least one case");
             }
 
-            return std::make_unique<MatchExpr>(std::move(expr), std::move(cases));
+            return located(matchLine, std::make_unique<MatchExpr>(std::move(expr), std::move(cases)));
         }
 
         // Object literal: {name: value, ...} or {name, age} (shorthand)
@@ -1872,6 +2067,7 @@ namespace lpp
     {
         // Check for @pattern directive
         std::string designPattern;
+        std::string patternArgument;
         if (check(TokenType::AT))
         {
             advance(); // consume @
@@ -1880,6 +2076,16 @@ namespace lpp
             {
                 Token patternName = consume(TokenType::IDENTIFIER, "Expected pattern name after '@pattern'");
                 designPattern = patternName.lexeme;
+                if (check(TokenType::LESS))
+                {
+                    std::string args = genericTypeArguments();
+                    patternArgument = args.substr(1, args.size() - 2);
+                }
+                if (designPattern == "ObjectPool" && patternArgument.empty())
+                {
+                    error("@pattern ObjectPool needs the pooled type: @pattern ObjectPool<Type>");
+                    throw std::runtime_error("@pattern ObjectPool needs the pooled type: @pattern ObjectPool<Type>");
+                }
             }
         }
 
@@ -1904,6 +2110,7 @@ namespace lpp
             // Constructor
             if (match(TokenType::CONSTRUCTOR))
             {
+                const int constructorLine = previous().line;
                 consume(TokenType::LPAREN, "Expected '(' after 'constructor'");
                 std::vector<std::pair<std::string, std::string>> params;
 
@@ -1921,6 +2128,7 @@ namespace lpp
                 consume(TokenType::RPAREN, "Expected ')' after parameters");
                 auto body = block();
                 constructor = std::make_unique<Function>(name.lexeme, std::move(params), "void", std::move(body));
+                constructor->line = constructorLine;
             }
             // Method
             else if (check(TokenType::FN))
@@ -1962,7 +2170,9 @@ namespace lpp
 
         consume(TokenType::RBRACE, "Expected '}' after class body");
         auto classDecl = std::make_unique<ClassDecl>(name.lexeme, baseClass, std::move(properties), std::move(methods), std::move(constructor));
+        classDecl->line = name.line;
         classDecl->designPattern = designPattern;
+        classDecl->patternArgument = patternArgument;
         return classDecl;
     }
 
@@ -2146,6 +2356,37 @@ namespace lpp
         return std::make_unique<DoWhileStmt>(std::move(body), std::move(condition));
     }
 
+    // Arena block: arena { ... }
+    std::unique_ptr<Statement> Parser::arenaStatement()
+    {
+        auto body = block();
+        return std::make_unique<ArenaStmt>(std::move(body));
+    }
+
+    // Parallel loop: parallel for (x in items) { ... }
+    std::unique_ptr<Statement> Parser::parallelForStatement()
+    {
+        consume(TokenType::FOR, "Expected 'for' after 'parallel'");
+        consume(TokenType::LPAREN, "Expected '(' after 'parallel for'");
+        match(TokenType::LET);
+        Token var = consume(TokenType::IDENTIFIER, "Expected loop variable after 'parallel for ('");
+        if (!match(TokenType::IN) && !match(TokenType::OF))
+        {
+            error("Expected 'in' after loop variable: parallel for (x in items)");
+        }
+        auto iterable = expression();
+        consume(TokenType::RPAREN, "Expected ')' after parallel for");
+        auto body = block();
+        return std::make_unique<ParallelForStmt>(var.lexeme, std::move(iterable), std::move(body));
+    }
+
+    // Structured concurrency block: scope { ... }
+    std::unique_ptr<Statement> Parser::scopeStatement()
+    {
+        auto body = block();
+        return std::make_unique<ScopeStmt>(std::move(body));
+    }
+
     // NEW PARSER METHODS - Try-catch
     std::unique_ptr<Statement> Parser::tryCatchStatement()
     {
@@ -2235,7 +2476,7 @@ namespace lpp
         return std::make_unique<EnumDecl>(name.lexeme, std::move(values));
     }
 
-    // Molecule declaration: mol Name { A - B; B = C; }
+    // Molecule declaration: mol Name { A - B; B = C; A -> C: 2.5; }
     std::unique_ptr<MoleculeDecl> Parser::moleculeDeclaration()
     {
         // FIX BUG #304: Prevent memory exhaustion from huge molecules
@@ -2250,7 +2491,7 @@ namespace lpp
         std::set<std::string> atomSet;                                    // Track unique atoms
         std::set<std::tuple<std::string, std::string, BondType>> bondSet; // Detect duplicate bonds
 
-        // Parse bonds: A - B; or A = B; or A -> B; or A <-> B;
+        // Parse bonds: A - B; or A = B; or A -> B; or A <-> B; (optional ': weight')
         while (!check(TokenType::RBRACE) && !isAtEnd())
         {
             Token from = consume(TokenType::IDENTIFIER, "Expected atom name");
@@ -2305,6 +2546,24 @@ namespace lpp
                 continue;
             }
 
+            // Optional weight: A - B: 2.5;
+            bool weighted = false;
+            double weight = 1.0;
+            if (match(TokenType::COLON))
+            {
+                bool negative = match(TokenType::MINUS);
+                Token weightToken = consume(TokenType::NUMBER, "Expected bond weight (number) after ':'");
+                if (safeStod(weightToken.lexeme, weight))
+                {
+                    weight = negative ? -weight : weight;
+                    weighted = true;
+                }
+                else
+                {
+                    error("Invalid bond weight: " + weightToken.lexeme);
+                }
+            }
+
             // Check for semicolon (STRICT requirement)
             if (!check(TokenType::SEMICOLON))
             {
@@ -2348,7 +2607,14 @@ namespace lpp
             }
 
             // Create bond
-            bonds.push_back(Bond(from.lexeme, to.lexeme, bondType));
+            if (weighted)
+            {
+                bonds.push_back(Bond(from.lexeme, to.lexeme, bondType, weight));
+            }
+            else
+            {
+                bonds.push_back(Bond(from.lexeme, to.lexeme, bondType));
+            }
         }
 
         consume(TokenType::RBRACE, "Expected '}' after molecule body");
@@ -2507,6 +2773,12 @@ namespace lpp
         {
             pattern = "Prototype";
         }
+        else if (problem.find("Pool") != std::string::npos ||
+                 problem.find("Recycle") != std::string::npos ||
+                 problem.find("Reuse") != std::string::npos)
+        {
+            pattern = "ObjectPool"; // ObjectPool/ConnectionPool/BufferPool
+        }
         // ==================== STRUCTURAL PATTERNS (7) ====================
         else if (problem.find("Adapter") != std::string::npos ||
                  problem.find("Wrapper") != std::string::npos ||
@@ -2540,7 +2812,8 @@ namespace lpp
         }
         else if (problem.find("Flyweight") != std::string::npos ||
                  problem.find("Shared") != std::string::npos ||
-                 problem.find("Pool") != std::string::npos)
+                 problem.find("Interned") != std::string::npos ||
+                 problem.find("HashCons") != std::string::npos)
         {
             pattern = "Flyweight";
         }
@@ -2753,773 +3026,22 @@ namespace lpp
 
         autoPattern->patternType = pattern;
 
-        // Generate pattern-specific structure
-        std::vector<std::pair<std::string, std::string>> properties;
-        std::vector<std::unique_ptr<Function>> methods;
-        std::unique_ptr<Function> constructor = nullptr;
-
-        // ==================== CREATIONAL PATTERNS ====================
-
-        if (pattern == "Singleton")
-        {
-            properties.push_back({"instance", className + "*"});
-            std::vector<std::unique_ptr<Statement>> getInstanceBody;
-            auto returnStmt = std::make_unique<ReturnStmt>(std::make_unique<IdentifierExpr>("instance"));
-            getInstanceBody.push_back(std::move(returnStmt));
-            auto getInstance = std::make_unique<Function>("getInstance",
-                                                          std::vector<std::pair<std::string, std::string>>(),
-                                                          className + "*", std::move(getInstanceBody));
-            methods.push_back(std::move(getInstance));
-        }
-        else if (pattern == "Factory")
-        {
-            properties.push_back({"products", "map<string, Product*>"});
-            std::vector<std::pair<std::string, std::string>> createParams;
-            createParams.push_back({"type", "string"});
-            std::vector<std::unique_ptr<Statement>> createBody;
-            auto returnStmt = std::make_unique<ReturnStmt>(nullptr);
-            createBody.push_back(std::move(returnStmt));
-            auto createMethod = std::make_unique<Function>("create",
-                                                           std::move(createParams), "Product*", std::move(createBody));
-            methods.push_back(std::move(createMethod));
-        }
-        else if (pattern == "AbstractFactory")
-        {
-            properties.push_back({"factories", "map<string, Factory*>"});
-            std::vector<std::unique_ptr<Statement>> createProductBody;
-            auto createProduct = std::make_unique<Function>("createProductA",
-                                                            std::vector<std::pair<std::string, std::string>>(),
-                                                            "ProductA*", std::move(createProductBody));
-            methods.push_back(std::move(createProduct));
-            std::vector<std::unique_ptr<Statement>> createProductBBody;
-            auto createProductB = std::make_unique<Function>("createProductB",
-                                                             std::vector<std::pair<std::string, std::string>>(),
-                                                             "ProductB*", std::move(createProductBBody));
-            methods.push_back(std::move(createProductB));
-        }
-        else if (pattern == "Builder")
-        {
-            properties.push_back({"product", "Product*"});
-            std::vector<std::unique_ptr<Statement>> buildPartBody;
-            auto buildPartA = std::make_unique<Function>("buildPartA",
-                                                         std::vector<std::pair<std::string, std::string>>(),
-                                                         "void", std::move(buildPartBody));
-            methods.push_back(std::move(buildPartA));
-            std::vector<std::unique_ptr<Statement>> getResultBody;
-            auto getResult = std::make_unique<Function>("getResult",
-                                                        std::vector<std::pair<std::string, std::string>>(),
-                                                        "Product*", std::move(getResultBody));
-            methods.push_back(std::move(getResult));
-        }
-        else if (pattern == "Prototype")
-        {
-            std::vector<std::unique_ptr<Statement>> cloneBody;
-            auto clone = std::make_unique<Function>("clone",
-                                                    std::vector<std::pair<std::string, std::string>>(),
-                                                    className + "*", std::move(cloneBody));
-            methods.push_back(std::move(clone));
-        }
-
-        // ==================== STRUCTURAL PATTERNS ====================
-
-        else if (pattern == "Adapter")
-        {
-            properties.push_back({"adaptee", "Adaptee*"});
-            std::vector<std::unique_ptr<Statement>> requestBody;
-            auto request = std::make_unique<Function>("request",
-                                                      std::vector<std::pair<std::string, std::string>>(),
-                                                      "void", std::move(requestBody));
-            methods.push_back(std::move(request));
-        }
-        else if (pattern == "Bridge")
-        {
-            properties.push_back({"implementor", "Implementor*"});
-            std::vector<std::unique_ptr<Statement>> operationBody;
-            auto operation = std::make_unique<Function>("operation",
-                                                        std::vector<std::pair<std::string, std::string>>(),
-                                                        "void", std::move(operationBody));
-            methods.push_back(std::move(operation));
-        }
-        else if (pattern == "Composite")
-        {
-            properties.push_back({"children", "vector<Component*>"});
-            std::vector<std::pair<std::string, std::string>> addParams;
-            addParams.push_back({"component", "Component*"});
-            std::vector<std::unique_ptr<Statement>> addBody;
-            auto add = std::make_unique<Function>("add", std::move(addParams), "void", std::move(addBody));
-            methods.push_back(std::move(add));
-            std::vector<std::unique_ptr<Statement>> operationBody;
-            auto operation = std::make_unique<Function>("operation",
-                                                        std::vector<std::pair<std::string, std::string>>(),
-                                                        "void", std::move(operationBody));
-            methods.push_back(std::move(operation));
-        }
-        else if (pattern == "Decorator")
-        {
-            properties.push_back({"component", "Component*"});
-            std::vector<std::unique_ptr<Statement>> operationBody;
-            auto operation = std::make_unique<Function>("operation",
-                                                        std::vector<std::pair<std::string, std::string>>(),
-                                                        "void", std::move(operationBody));
-            methods.push_back(std::move(operation));
-        }
-        else if (pattern == "Facade")
-        {
-            properties.push_back({"subsystem1", "Subsystem1*"});
-            properties.push_back({"subsystem2", "Subsystem2*"});
-            std::vector<std::unique_ptr<Statement>> operationBody;
-            auto operation = std::make_unique<Function>("operation",
-                                                        std::vector<std::pair<std::string, std::string>>(),
-                                                        "void", std::move(operationBody));
-            methods.push_back(std::move(operation));
-        }
-        else if (pattern == "Flyweight")
-        {
-            properties.push_back({"intrinsicState", "string"});
-            properties.push_back({"pool", "map<string, Flyweight*>"});
-            std::vector<std::pair<std::string, std::string>> operationParams;
-            operationParams.push_back({"extrinsicState", "string"});
-            std::vector<std::unique_ptr<Statement>> operationBody;
-            auto operation = std::make_unique<Function>("operation", std::move(operationParams),
-                                                        "void", std::move(operationBody));
-            methods.push_back(std::move(operation));
-        }
-        else if (pattern == "Proxy")
-        {
-            properties.push_back({"realSubject", "RealSubject*"});
-            std::vector<std::unique_ptr<Statement>> requestBody;
-            auto request = std::make_unique<Function>("request",
-                                                      std::vector<std::pair<std::string, std::string>>(),
-                                                      "void", std::move(requestBody));
-            methods.push_back(std::move(request));
-        }
-
-        // ==================== BEHAVIORAL PATTERNS ====================
-
-        else if (pattern == "ChainOfResponsibility")
-        {
-            properties.push_back({"successor", "Handler*"});
-            std::vector<std::pair<std::string, std::string>> handleParams;
-            handleParams.push_back({"request", "Request*"});
-            std::vector<std::unique_ptr<Statement>> handleBody;
-            auto handleRequest = std::make_unique<Function>("handleRequest", std::move(handleParams),
-                                                            "void", std::move(handleBody));
-            methods.push_back(std::move(handleRequest));
-        }
-        else if (pattern == "Command")
-        {
-            properties.push_back({"receiver", "Receiver*"});
-            std::vector<std::unique_ptr<Statement>> executeBody;
-            auto execute = std::make_unique<Function>("execute",
-                                                      std::vector<std::pair<std::string, std::string>>(),
-                                                      "void", std::move(executeBody));
-            methods.push_back(std::move(execute));
-            std::vector<std::unique_ptr<Statement>> undoBody;
-            auto undo = std::make_unique<Function>("undo",
-                                                   std::vector<std::pair<std::string, std::string>>(),
-                                                   "void", std::move(undoBody));
-            methods.push_back(std::move(undo));
-        }
-        else if (pattern == "Iterator")
-        {
-            properties.push_back({"collection", "Collection*"});
-            properties.push_back({"current", "int"});
-            std::vector<std::unique_ptr<Statement>> nextBody;
-            auto next = std::make_unique<Function>("next",
-                                                   std::vector<std::pair<std::string, std::string>>(),
-                                                   "Item*", std::move(nextBody));
-            methods.push_back(std::move(next));
-            std::vector<std::unique_ptr<Statement>> hasNextBody;
-            auto hasNext = std::make_unique<Function>("hasNext",
-                                                      std::vector<std::pair<std::string, std::string>>(),
-                                                      "bool", std::move(hasNextBody));
-            methods.push_back(std::move(hasNext));
-        }
-        else if (pattern == "Mediator")
-        {
-            properties.push_back({"colleagues", "vector<Colleague*>"});
-            std::vector<std::pair<std::string, std::string>> notifyParams;
-            notifyParams.push_back({"sender", "Colleague*"});
-            notifyParams.push_back({"event", "string"});
-            std::vector<std::unique_ptr<Statement>> notifyBody;
-            auto notify = std::make_unique<Function>("notify", std::move(notifyParams),
-                                                     "void", std::move(notifyBody));
-            methods.push_back(std::move(notify));
-        }
-        else if (pattern == "Memento")
-        {
-            properties.push_back({"state", "string"});
-            std::vector<std::unique_ptr<Statement>> saveBody;
-            auto save = std::make_unique<Function>("save",
-                                                   std::vector<std::pair<std::string, std::string>>(),
-                                                   "Memento*", std::move(saveBody));
-            methods.push_back(std::move(save));
-            std::vector<std::pair<std::string, std::string>> restoreParams;
-            restoreParams.push_back({"memento", "Memento*"});
-            std::vector<std::unique_ptr<Statement>> restoreBody;
-            auto restore = std::make_unique<Function>("restore", std::move(restoreParams),
-                                                      "void", std::move(restoreBody));
-            methods.push_back(std::move(restore));
-        }
-        else if (pattern == "Observer")
-        {
-            properties.push_back({"observers", "vector<Observer*>"});
-            std::vector<std::pair<std::string, std::string>> attachParams;
-            attachParams.push_back({"observer", "Observer*"});
-            std::vector<std::unique_ptr<Statement>> attachBody;
-            auto attach = std::make_unique<Function>("attach", std::move(attachParams),
-                                                     "void", std::move(attachBody));
-            methods.push_back(std::move(attach));
-            std::vector<std::unique_ptr<Statement>> notifyBody;
-            auto notify = std::make_unique<Function>("notify",
-                                                     std::vector<std::pair<std::string, std::string>>(),
-                                                     "void", std::move(notifyBody));
-            methods.push_back(std::move(notify));
+        // The class body comes from the pattern's template in
+        // lpp_patterns.hpp; only the type arguments are checked here
+        const std::string &typeArgument = autoPattern->typeArgument;
+        std::string missingArguments;
+        if (pattern == "ObjectPool" && typeArgument.empty())
+        {
+            missingArguments = "ObjectPool needs the pooled type: autopattern " + problem + " " + className + "<Type>;";
         }
-        else if (pattern == "State")
+        else if (pattern == "Lens" && typeArgument.find(',') == std::string::npos)
         {
-            properties.push_back({"state", "State*"});
-            std::vector<std::unique_ptr<Statement>> handleBody;
-            auto handle = std::make_unique<Function>("handle",
-                                                     std::vector<std::pair<std::string, std::string>>(),
-                                                     "void", std::move(handleBody));
-            methods.push_back(std::move(handle));
-            std::vector<std::pair<std::string, std::string>> setStateParams;
-            setStateParams.push_back({"newState", "State*"});
-            std::vector<std::unique_ptr<Statement>> setStateBody;
-            auto setState = std::make_unique<Function>("setState", std::move(setStateParams),
-                                                       "void", std::move(setStateBody));
-            methods.push_back(std::move(setState));
-        }
-        else if (pattern == "Strategy")
-        {
-            properties.push_back({"strategy", "Strategy*"});
-            std::vector<std::unique_ptr<Statement>> executeBody;
-            auto execute = std::make_unique<Function>("execute",
-                                                      std::vector<std::pair<std::string, std::string>>(),
-                                                      "void", std::move(executeBody));
-            methods.push_back(std::move(execute));
-        }
-        else if (pattern == "TemplateMethod")
-        {
-            std::vector<std::unique_ptr<Statement>> templateMethodBody;
-            auto templateMethod = std::make_unique<Function>("templateMethod",
-                                                             std::vector<std::pair<std::string, std::string>>(),
-                                                             "void", std::move(templateMethodBody));
-            methods.push_back(std::move(templateMethod));
-            std::vector<std::unique_ptr<Statement>> step1Body;
-            auto step1 = std::make_unique<Function>("step1",
-                                                    std::vector<std::pair<std::string, std::string>>(),
-                                                    "void", std::move(step1Body));
-            methods.push_back(std::move(step1));
-            std::vector<std::unique_ptr<Statement>> step2Body;
-            auto step2 = std::make_unique<Function>("step2",
-                                                    std::vector<std::pair<std::string, std::string>>(),
-                                                    "void", std::move(step2Body));
-            methods.push_back(std::move(step2));
-        }
-        else if (pattern == "Visitor")
-        {
-            std::vector<std::pair<std::string, std::string>> visitParams;
-            visitParams.push_back({"element", "Element*"});
-            std::vector<std::unique_ptr<Statement>> visitBody;
-            auto visit = std::make_unique<Function>("visit", std::move(visitParams),
-                                                    "void", std::move(visitBody));
-            methods.push_back(std::move(visit));
-        }
-        else if (pattern == "Interpreter")
-        {
-            properties.push_back({"context", "Context*"});
-            std::vector<std::unique_ptr<Statement>> interpretBody;
-            auto interpret = std::make_unique<Function>("interpret",
-                                                        std::vector<std::pair<std::string, std::string>>(),
-                                                        "void", std::move(interpretBody));
-            methods.push_back(std::move(interpret));
+            missingArguments = "Lens needs the whole and part types: autopattern " + problem + " " + className + "<Whole, Part>;";
         }
-
-        // ==================== FUNCTIONAL PATTERNS (20) ====================
-
-        else if (pattern == "Monad")
-        {
-            // Monad: pure composition with bind/flatMap
-            properties.push_back({"value", "T"});
-
-            // bind/flatMap method
-            std::vector<std::pair<std::string, std::string>> bindParams;
-            bindParams.push_back({"f", "function<Monad<U>(T)>"});
-            std::vector<std::unique_ptr<Statement>> bindBody;
-            auto bind = std::make_unique<Function>("bind", std::move(bindParams),
-                                                   "Monad<U>", std::move(bindBody));
-            methods.push_back(std::move(bind));
-
-            // pure/return method (static factory)
-            std::vector<std::pair<std::string, std::string>> pureParams;
-            pureParams.push_back({"x", "T"});
-            std::vector<std::unique_ptr<Statement>> pureBody;
-            auto pure = std::make_unique<Function>("pure", std::move(pureParams),
-                                                   "Monad<T>", std::move(pureBody));
-            methods.push_back(std::move(pure));
-        }
-        else if (pattern == "Functor")
-        {
-            // Functor: map transformation
-            properties.push_back({"value", "T"});
-
-            // map method
-            std::vector<std::pair<std::string, std::string>> mapParams;
-            mapParams.push_back({"f", "function<U(T)>"});
-            std::vector<std::unique_ptr<Statement>> mapBody;
-            auto map = std::make_unique<Function>("map", std::move(mapParams),
-                                                  "Functor<U>", std::move(mapBody));
-            methods.push_back(std::move(map));
-        }
-        else if (pattern == "Applicative")
-        {
-            // Applicative: apply wrapped functions
-            properties.push_back({"value", "T"});
-
-            // apply method
-            std::vector<std::pair<std::string, std::string>> applyParams;
-            applyParams.push_back({"f", "Applicative<function<U(T)>>"});
-            std::vector<std::unique_ptr<Statement>> applyBody;
-            auto apply = std::make_unique<Function>("apply", std::move(applyParams),
-                                                    "Applicative<U>", std::move(applyBody));
-            methods.push_back(std::move(apply));
-
-            // pure method
-            std::vector<std::pair<std::string, std::string>> pureParams;
-            pureParams.push_back({"x", "T"});
-            std::vector<std::unique_ptr<Statement>> pureBody;
-            auto pure = std::make_unique<Function>("pure", std::move(pureParams),
-                                                   "Applicative<T>", std::move(pureBody));
-            methods.push_back(std::move(pure));
-        }
-        else if (pattern == "Monoid")
-        {
-            // Monoid: associative binary operation with identity
-            properties.push_back({"value", "T"});
-
-            // combine/mappend method
-            std::vector<std::pair<std::string, std::string>> combineParams;
-            combineParams.push_back({"other", "Monoid<T>"});
-            std::vector<std::unique_ptr<Statement>> combineBody;
-            auto combine = std::make_unique<Function>("combine", std::move(combineParams),
-                                                      "Monoid<T>", std::move(combineBody));
-            methods.push_back(std::move(combine));
-
-            // empty/mempty method (identity element)
-            std::vector<std::unique_ptr<Statement>> emptyBody;
-            auto empty = std::make_unique<Function>("empty",
-                                                    std::vector<std::pair<std::string, std::string>>(),
-                                                    "Monoid<T>", std::move(emptyBody));
-            methods.push_back(std::move(empty));
-        }
-        else if (pattern == "Foldable")
-        {
-            // Foldable: reduce/fold operations
-            properties.push_back({"container", "Container<T>"});
-
-            // foldLeft method
-            std::vector<std::pair<std::string, std::string>> foldLeftParams;
-            foldLeftParams.push_back({"init", "U"});
-            foldLeftParams.push_back({"f", "function<U(U, T)>"});
-            std::vector<std::unique_ptr<Statement>> foldLeftBody;
-            auto foldLeft = std::make_unique<Function>("foldLeft", std::move(foldLeftParams),
-                                                       "U", std::move(foldLeftBody));
-            methods.push_back(std::move(foldLeft));
-
-            // foldRight method
-            std::vector<std::pair<std::string, std::string>> foldRightParams;
-            foldRightParams.push_back({"init", "U"});
-            foldRightParams.push_back({"f", "function<U(T, U)>"});
-            std::vector<std::unique_ptr<Statement>> foldRightBody;
-            auto foldRight = std::make_unique<Function>("foldRight", std::move(foldRightParams),
-                                                        "U", std::move(foldRightBody));
-            methods.push_back(std::move(foldRight));
-        }
-        else if (pattern == "Traversable")
-        {
-            // Traversable: traverse with effects
-            properties.push_back({"container", "Container<T>"});
-
-            // traverse method
-            std::vector<std::pair<std::string, std::string>> traverseParams;
-            traverseParams.push_back({"f", "function<Applicative<U>(T)>"});
-            std::vector<std::unique_ptr<Statement>> traverseBody;
-            auto traverse = std::make_unique<Function>("traverse", std::move(traverseParams),
-                                                       "Applicative<Container<U>>", std::move(traverseBody));
-            methods.push_back(std::move(traverse));
-
-            // sequence method
-            std::vector<std::unique_ptr<Statement>> sequenceBody;
-            auto sequence = std::make_unique<Function>("sequence",
-                                                       std::vector<std::pair<std::string, std::string>>(),
-                                                       "Applicative<Container<T>>", std::move(sequenceBody));
-            methods.push_back(std::move(sequence));
-        }
-        else if (pattern == "Lens")
-        {
-            // Lens: functional references for immutable updates
-            properties.push_back({"getter", "function<T(S)>"});
-            properties.push_back({"setter", "function<S(S, T)>"});
-
-            // view method
-            std::vector<std::pair<std::string, std::string>> viewParams;
-            viewParams.push_back({"s", "S"});
-            std::vector<std::unique_ptr<Statement>> viewBody;
-            auto view = std::make_unique<Function>("view", std::move(viewParams),
-                                                   "T", std::move(viewBody));
-            methods.push_back(std::move(view));
-
-            // set method
-            std::vector<std::pair<std::string, std::string>> setParams;
-            setParams.push_back({"s", "S"});
-            setParams.push_back({"t", "T"});
-            std::vector<std::unique_ptr<Statement>> setBody;
-            auto set = std::make_unique<Function>("set", std::move(setParams),
-                                                  "S", std::move(setBody));
-            methods.push_back(std::move(set));
-
-            // over/modify method
-            std::vector<std::pair<std::string, std::string>> overParams;
-            overParams.push_back({"s", "S"});
-            overParams.push_back({"f", "function<T(T)>"});
-            std::vector<std::unique_ptr<Statement>> overBody;
-            auto over = std::make_unique<Function>("over", std::move(overParams),
-                                                   "S", std::move(overBody));
-            methods.push_back(std::move(over));
-        }
-        else if (pattern == "Either")
-        {
-            // Either: error handling with Left/Right
-            properties.push_back({"value", "variant<L, R>"});
-            properties.push_back({"isLeft", "bool"});
-
-            // left constructor
-            std::vector<std::pair<std::string, std::string>> leftParams;
-            leftParams.push_back({"l", "L"});
-            std::vector<std::unique_ptr<Statement>> leftBody;
-            auto left = std::make_unique<Function>("left", std::move(leftParams),
-                                                   "Either<L, R>", std::move(leftBody));
-            methods.push_back(std::move(left));
-
-            // right constructor
-            std::vector<std::pair<std::string, std::string>> rightParams;
-            rightParams.push_back({"r", "R"});
-            std::vector<std::unique_ptr<Statement>> rightBody;
-            auto right = std::make_unique<Function>("right", std::move(rightParams),
-                                                    "Either<L, R>", std::move(rightBody));
-            methods.push_back(std::move(right));
-
-            // fold method
-            std::vector<std::pair<std::string, std::string>> foldParams;
-            foldParams.push_back({"onLeft", "function<T(L)>"});
-            foldParams.push_back({"onRight", "function<T(R)>"});
-            std::vector<std::unique_ptr<Statement>> foldBody;
-            auto fold = std::make_unique<Function>("fold", std::move(foldParams),
-                                                   "T", std::move(foldBody));
-            methods.push_back(std::move(fold));
-        }
-        else if (pattern == "Maybe")
-        {
-            // Maybe/Option: optional values with Nothing/Just
-            properties.push_back({"value", "optional<T>"});
-
-            // just constructor
-            std::vector<std::pair<std::string, std::string>> justParams;
-            justParams.push_back({"x", "T"});
-            std::vector<std::unique_ptr<Statement>> justBody;
-            auto just = std::make_unique<Function>("just", std::move(justParams),
-                                                   "Maybe<T>", std::move(justBody));
-            methods.push_back(std::move(just));
-
-            // nothing constructor
-            std::vector<std::unique_ptr<Statement>> nothingBody;
-            auto nothing = std::make_unique<Function>("nothing",
-                                                      std::vector<std::pair<std::string, std::string>>(),
-                                                      "Maybe<T>", std::move(nothingBody));
-            methods.push_back(std::move(nothing));
-
-            // getOrElse method
-            std::vector<std::pair<std::string, std::string>> getOrElseParams;
-            getOrElseParams.push_back({"defaultValue", "T"});
-            std::vector<std::unique_ptr<Statement>> getOrElseBody;
-            auto getOrElse = std::make_unique<Function>("getOrElse", std::move(getOrElseParams),
-                                                        "T", std::move(getOrElseBody));
-            methods.push_back(std::move(getOrElse));
-        }
-        else if (pattern == "StateMonad")
-        {
-            // StateMonad: stateful computation as function
-            properties.push_back({"runState", "function<pair<A, S>(S)>"});
-
-            // bind method
-            std::vector<std::pair<std::string, std::string>> bindParams;
-            bindParams.push_back({"f", "function<State<B, S>(A)>"});
-            std::vector<std::unique_ptr<Statement>> bindBody;
-            auto bind = std::make_unique<Function>("bind", std::move(bindParams),
-                                                   "State<B, S>", std::move(bindBody));
-            methods.push_back(std::move(bind));
-
-            // get (read state)
-            std::vector<std::unique_ptr<Statement>> getBody;
-            auto get = std::make_unique<Function>("get",
-                                                  std::vector<std::pair<std::string, std::string>>(),
-                                                  "State<S, S>", std::move(getBody));
-            methods.push_back(std::move(get));
-
-            // put (write state)
-            std::vector<std::pair<std::string, std::string>> putParams;
-            putParams.push_back({"newState", "S"});
-            std::vector<std::unique_ptr<Statement>> putBody;
-            auto put = std::make_unique<Function>("put", std::move(putParams),
-                                                  "State<void, S>", std::move(putBody));
-            methods.push_back(std::move(put));
-        }
-        else if (pattern == "Reader")
-        {
-            // Reader: dependency injection monad
-            properties.push_back({"runReader", "function<A(R)>"});
-
-            // ask (read environment)
-            std::vector<std::unique_ptr<Statement>> askBody;
-            auto ask = std::make_unique<Function>("ask",
-                                                  std::vector<std::pair<std::string, std::string>>(),
-                                                  "Reader<R, R>", std::move(askBody));
-            methods.push_back(std::move(ask));
-
-            // local (modify environment)
-            std::vector<std::pair<std::string, std::string>> localParams;
-            localParams.push_back({"f", "function<R(R)>"});
-            std::vector<std::unique_ptr<Statement>> localBody;
-            auto local = std::make_unique<Function>("local", std::move(localParams),
-                                                    "Reader<R, A>", std::move(localBody));
-            methods.push_back(std::move(local));
-        }
-        else if (pattern == "Writer")
-        {
-            // Writer: logging/output accumulation monad
-            properties.push_back({"value", "A"});
-            properties.push_back({"log", "W"});
-
-            // tell (write to log)
-            std::vector<std::pair<std::string, std::string>> tellParams;
-            tellParams.push_back({"msg", "W"});
-            std::vector<std::unique_ptr<Statement>> tellBody;
-            auto tell = std::make_unique<Function>("tell", std::move(tellParams),
-                                                   "Writer<void, W>", std::move(tellBody));
-            methods.push_back(std::move(tell));
-
-            // listen (access log)
-            std::vector<std::unique_ptr<Statement>> listenBody;
-            auto listen = std::make_unique<Function>("listen",
-                                                     std::vector<std::pair<std::string, std::string>>(),
-                                                     "Writer<pair<A, W>, W>", std::move(listenBody));
-            methods.push_back(std::move(listen));
-        }
-        else if (pattern == "IO")
-        {
-            // IO: side-effect wrapper
-            properties.push_back({"action", "function<A()>"});
-
-            // unsafePerformIO (execute side effect)
-            std::vector<std::unique_ptr<Statement>> performBody;
-            auto perform = std::make_unique<Function>("unsafePerformIO",
-                                                      std::vector<std::pair<std::string, std::string>>(),
-                                                      "A", std::move(performBody));
-            methods.push_back(std::move(perform));
-
-            // bind method
-            std::vector<std::pair<std::string, std::string>> bindParams;
-            bindParams.push_back({"f", "function<IO<B>(A)>"});
-            std::vector<std::unique_ptr<Statement>> bindBody;
-            auto bind = std::make_unique<Function>("bind", std::move(bindParams),
-                                                   "IO<B>", std::move(bindBody));
-            methods.push_back(std::move(bind));
-        }
-        else if (pattern == "Free")
-        {
-            // Free: AST for computations
-            properties.push_back({"tree", "variant<Pure<A>, Impure<F, Free<F, A>>>"});
-
-            // pure constructor
-            std::vector<std::pair<std::string, std::string>> pureParams;
-            pureParams.push_back({"a", "A"});
-            std::vector<std::unique_ptr<Statement>> pureBody;
-            auto pure = std::make_unique<Function>("pure", std::move(pureParams),
-                                                   "Free<F, A>", std::move(pureBody));
-            methods.push_back(std::move(pure));
-
-            // impure constructor
-            std::vector<std::pair<std::string, std::string>> impureParams;
-            impureParams.push_back({"f", "F<Free<F, A>>"});
-            std::vector<std::unique_ptr<Statement>> impureBody;
-            auto impure = std::make_unique<Function>("impure", std::move(impureParams),
-                                                     "Free<F, A>", std::move(impureBody));
-            methods.push_back(std::move(impure));
-
-            // interpret method
-            std::vector<std::pair<std::string, std::string>> interpretParams;
-            interpretParams.push_back({"interpreter", "function<M<A>(F<A>)>"});
-            std::vector<std::unique_ptr<Statement>> interpretBody;
-            auto interpret = std::make_unique<Function>("interpret", std::move(interpretParams),
-                                                        "M<A>", std::move(interpretBody));
-            methods.push_back(std::move(interpret));
-        }
-        else if (pattern == "Continuation")
-        {
-            // Continuation: CPS (Continuation-Passing Style)
-            properties.push_back({"runCont", "function<R(function<R(A)>)>"});
-
-            // callCC (call-with-current-continuation)
-            std::vector<std::pair<std::string, std::string>> callCCParams;
-            callCCParams.push_back({"f", "function<Cont<R, A>(function<Cont<R, B>(A)>)>"});
-            std::vector<std::unique_ptr<Statement>> callCCBody;
-            auto callCC = std::make_unique<Function>("callCC", std::move(callCCParams),
-                                                     "Cont<R, A>", std::move(callCCBody));
-            methods.push_back(std::move(callCC));
-
-            // bind method
-            std::vector<std::pair<std::string, std::string>> bindParams;
-            bindParams.push_back({"f", "function<Cont<R, B>(A)>"});
-            std::vector<std::unique_ptr<Statement>> bindBody;
-            auto bind = std::make_unique<Function>("bind", std::move(bindParams),
-                                                   "Cont<R, B>", std::move(bindBody));
-            methods.push_back(std::move(bind));
-        }
-        else if (pattern == "Comonad")
-        {
-            // Comonad: dual of Monad
-            properties.push_back({"value", "W<A>"});
-
-            // extract (opposite of pure)
-            std::vector<std::unique_ptr<Statement>> extractBody;
-            auto extract = std::make_unique<Function>("extract",
-                                                      std::vector<std::pair<std::string, std::string>>(),
-                                                      "A", std::move(extractBody));
-            methods.push_back(std::move(extract));
-
-            // extend (opposite of bind)
-            std::vector<std::pair<std::string, std::string>> extendParams;
-            extendParams.push_back({"f", "function<B(W<A>)>"});
-            std::vector<std::unique_ptr<Statement>> extendBody;
-            auto extend = std::make_unique<Function>("extend", std::move(extendParams),
-                                                     "W<B>", std::move(extendBody));
-            methods.push_back(std::move(extend));
-
-            // duplicate
-            std::vector<std::unique_ptr<Statement>> duplicateBody;
-            auto duplicate = std::make_unique<Function>("duplicate",
-                                                        std::vector<std::pair<std::string, std::string>>(),
-                                                        "W<W<A>>", std::move(duplicateBody));
-            methods.push_back(std::move(duplicate));
-        }
-        else if (pattern == "Zipper")
-        {
-            // Zipper: cursor navigation in data structures
-            properties.push_back({"left", "vector<T>"});
-            properties.push_back({"focus", "T"});
-            properties.push_back({"right", "vector<T>"});
-
-            // moveLeft
-            std::vector<std::unique_ptr<Statement>> moveLeftBody;
-            auto moveLeft = std::make_unique<Function>("moveLeft",
-                                                       std::vector<std::pair<std::string, std::string>>(),
-                                                       "Zipper<T>", std::move(moveLeftBody));
-            methods.push_back(std::move(moveLeft));
-
-            // moveRight
-            std::vector<std::unique_ptr<Statement>> moveRightBody;
-            auto moveRight = std::make_unique<Function>("moveRight",
-                                                        std::vector<std::pair<std::string, std::string>>(),
-                                                        "Zipper<T>", std::move(moveRightBody));
-            methods.push_back(std::move(moveRight));
-
-            // update
-            std::vector<std::pair<std::string, std::string>> updateParams;
-            updateParams.push_back({"f", "function<T(T)>"});
-            std::vector<std::unique_ptr<Statement>> updateBody;
-            auto update = std::make_unique<Function>("update", std::move(updateParams),
-                                                     "Zipper<T>", std::move(updateBody));
-            methods.push_back(std::move(update));
-        }
-        else if (pattern == "Church")
-        {
-            // Church: data encoded as functions
-            properties.push_back({"churchEncoding", "function<R(function<R(A)>, function<R()>)>"});
-
-            // fold (church catamorphism)
-            std::vector<std::pair<std::string, std::string>> foldParams;
-            foldParams.push_back({"onValue", "function<R(A)>"});
-            foldParams.push_back({"onEmpty", "function<R()>"});
-            std::vector<std::unique_ptr<Statement>> foldBody;
-            auto fold = std::make_unique<Function>("fold", std::move(foldParams),
-                                                   "R", std::move(foldBody));
-            methods.push_back(std::move(fold));
-
-            // encode
-            std::vector<std::pair<std::string, std::string>> encodeParams;
-            encodeParams.push_back({"value", "A"});
-            std::vector<std::unique_ptr<Statement>> encodeBody;
-            auto encode = std::make_unique<Function>("encode", std::move(encodeParams),
-                                                     "Church<A>", std::move(encodeBody));
-            methods.push_back(std::move(encode));
-        }
-        else if (pattern == "AlgebraicEffect")
-        {
-            // AlgebraicEffect: composable effects with handlers
-            properties.push_back({"effect", "Effect"});
-            properties.push_back({"handler", "function<A(Effect)>"});
-
-            // perform (trigger effect)
-            std::vector<std::pair<std::string, std::string>> performParams;
-            performParams.push_back({"eff", "Effect"});
-            std::vector<std::unique_ptr<Statement>> performBody;
-            auto perform = std::make_unique<Function>("perform", std::move(performParams),
-                                                      "A", std::move(performBody));
-            methods.push_back(std::move(perform));
-
-            // handle (install handler)
-            std::vector<std::pair<std::string, std::string>> handleParams;
-            handleParams.push_back({"h", "function<B(Effect)>"});
-            std::vector<std::unique_ptr<Statement>> handleBody;
-            auto handle = std::make_unique<Function>("handle", std::move(handleParams),
-                                                     "B", std::move(handleBody));
-            methods.push_back(std::move(handle));
-        }
-        else if (pattern == "Morphism")
-        {
-            // Morphism: catamorphism (fold) and anamorphism (unfold)
-            properties.push_back({"algebra", "function<A(F<A>)>"});
-            properties.push_back({"coalgebra", "function<F<A>(A)>"});
-
-            // cata (catamorphism - fold/consume structure)
-            std::vector<std::pair<std::string, std::string>> cataParams;
-            cataParams.push_back({"alg", "function<A(F<A>)>"});
-            cataParams.push_back({"structure", "Fix<F>"});
-            std::vector<std::unique_ptr<Statement>> cataBody;
-            auto cata = std::make_unique<Function>("cata", std::move(cataParams),
-                                                   "A", std::move(cataBody));
-            methods.push_back(std::move(cata));
-
-            // ana (anamorphism - unfold/produce structure)
-            std::vector<std::pair<std::string, std::string>> anaParams;
-            anaParams.push_back({"coalg", "function<F<A>(A)>"});
-            anaParams.push_back({"seed", "A"});
-            std::vector<std::unique_ptr<Statement>> anaBody;
-            auto ana = std::make_unique<Function>("ana", std::move(anaParams),
-                                                  "Fix<F>", std::move(anaBody));
-            methods.push_back(std::move(ana));
-
-            // hylo (hylomorphism - unfold then fold)
-            std::vector<std::pair<std::string, std::string>> hyloParams;
-            hyloParams.push_back({"alg", "function<B(F<B>)>"});
-            hyloParams.push_back({"coalg", "function<F<A>(A)>"});
-            hyloParams.push_back({"seed", "A"});
-            std::vector<std::unique_ptr<Statement>> hyloBody;
-            auto hylo = std::make_unique<Function>("hylo", std::move(hyloParams),
-                                                   "B", std::move(hyloBody));
-            methods.push_back(std::move(hylo));
+        if (!missingArguments.empty())
+        {
+            error(missingArguments);
+            throw std::runtime_error(missingArguments);
         }
 
         // Create and return the class declaration
@@ -3530,8 +3052,12 @@ namespace lpp
         }
 
         auto classDecl = std::make_unique<ClassDecl>(className, "",
-                                                     std::move(properties), std::move(methods), std::move(constructor));
+                                                     std::vector<std::pair<std::string, std::string>>(),
+                                                     std::vector<std::unique_ptr<Function>>());
         classDecl->designPattern = pattern;
+        classDecl->patternArgument = typeArgument;
+        classDecl->autoPattern = true;
+        classDecl->line = autoPattern->line;
 
         return classDecl;
     }
@@ -255,6 +255,30 @@ namespace lpp
             return loopExit;
         }
 
+        // ArenaStmt: straight-line block, its body runs once in sequence
+        if (auto *arenaStmt = dynamic_cast<ArenaStmt *>(stmt))
+        {
+            for (auto &bodyStmt : arenaStmt->body)
+            {
+                currentBlock = buildCFGForStatement(bodyStmt.get(), breakTarget, continueTarget);
+                if (!currentBlock)
+                    return nullptr;
+            }
+            return currentBlock;
+        }
+
+        // ScopeStmt: the same, spawned tasks are joined at its end
+        if (auto *scopeStmt = dynamic_cast<ScopeStmt *>(stmt))
+        {
+            for (auto &bodyStmt : scopeStmt->body)
+            {
+                currentBlock = buildCFGForStatement(bodyStmt.get(), breakTarget, continueTarget);
+                if (!currentBlock)
+                    return nullptr;
+            }
+            return currentBlock;
+        }
+
         // ForStmt: Similar to while
         if (auto *forStmt = dynamic_cast<ForStmt *>(stmt))
         {
@@ -644,6 +668,121 @@ namespace lpp
         return result;
     }
 
+    // Index of the open arena region that owns the storage of expr, or -1.
+    // Collection literals take the innermost region; a local takes the
+    // region it was declared in.
+    int StaticAnalyzer::arenaRegionOf(Expression *expr) const
+    {
+        if (!expr || arenaRegions.empty())
+            return -1;
+        if (dynamic_cast<RangeExpr *>(expr) || dynamic_cast<ListComprehension *>(expr) ||
+            (dynamic_cast<ArrayExpr *>(expr) && currentParadigm != ParadigmMode::FUNCTIONAL))
+            return static_cast<int>(arenaRegions.size()) - 1;
+        if (auto *ident = dynamic_cast<IdentifierExpr *>(expr))
+        {
+            for (int i = static_cast<int>(arenaRegions.size()) - 1; i >= 0; i--)
+            {
+                if (arenaRegions[i].declared.count(ident->name))
+                    return arenaRegions[i].allocated.count(ident->name) ? i : -1;
+            }
+        }
+        return -1;
+    }
+
+    // Arena storage is released at region exit, so an arena value must not
+    // be returned (the caller would hold freed memory) or stored into a
+    // local declared outside the region it was allocated in.
+    void StaticAnalyzer::checkArenaEscape(Expression *value, const std::string *target)
+    {
+        int region = arenaRegionOf(value);
+        if (region < 0)
+            return;
+
+        auto *ident = dynamic_cast<IdentifierExpr *>(value);
+        std::string what = ident ? "'" + ident->name + "'" : "collection";
+        if (!target)
+        {
+            reportIssue(IssueType::ARENA_ESCAPE, Severity::ERROR,
+                        "Arena-allocated " + what + " returned from its arena",
+                        {"arena memory is freed when the arena block or function exits",
+                         "build the result outside the arena, or copy it before returning"});
+            return;
+        }
+
+        for (int i = static_cast<int>(arenaRegions.size()) - 1; i >= region; i--)
+        {
+            if (arenaRegions[i].declared.count(*target))
+                return;
+        }
+        reportIssue(IssueType::ARENA_ESCAPE, Severity::ERROR,
+                    "Arena-allocated " + what + " assigned to '" + *target + "', which outlives the arena",
+                    {"arena memory is freed when the arena block or function exits"});
+    }
+
+    // Locals of the innermost parallel for body belong to one iteration
+    void StaticAnalyzer::declareLocal(const std::string &name)
+    {
+        if (!parallelRegions.empty())
+            parallelRegions.back().declared.insert(name);
+    }
+
+    void StaticAnalyzer::checkParallelWrite(const std::string &name, const std::string &action)
+    {
+        if (parallelRegions.empty() || parallelRegions.back().declared.count(name))
+            return;
+        reportIssue(IssueType::DATA_RACE, Severity::ERROR,
+                    action + " '" + name + "' inside 'parallel for' is a data race",
+                    {"iterations run at the same time and all share '" + name + "'",
+                     "compute per-element results with map (@) and combine them with reduce (\\), "
+                     "or send them through a Channel"});
+    }
+
+    // xs.push(v), push(xs, v) and friends write the receiver or first
+    // argument. Concurrent queues and channels (enqueue, send) are safe to
+    // share and not listed.
+    static bool isMutatingCall(const std::string &function)
+    {
+        static const std::set<std::string> mutatingCalls = {
+            "push", "push_back", "pushBack", "pushFront", "pop", "pop_back", "popBack",
+            "popFront", "insert", "erase", "remove", "clear", "set", "add", "append",
+            "sort", "reverse", "resize", "reserve", "emplace", "emplace_back", "assign",
+            "swap", "update", "sortInPlace", "radixSort", "radixSortBy", "parallelSort"};
+        return mutatingCalls.count(function) > 0;
+    }
+
+    void StaticAnalyzer::checkSharedMethodCall(IndexExpr &node, bool spawned)
+    {
+        auto *receiver = dynamic_cast<IdentifierExpr *>(node.object.get());
+        auto *call = dynamic_cast<CallExpr *>(node.index.get());
+        if (!node.isDot || !receiver || !call)
+            return;
+        checkSharedMutation(receiver->name, call->function, receiver->name + "." + call->function + "()", spawned);
+    }
+
+    void StaticAnalyzer::checkSharedFreeCall(CallExpr &node, bool spawned)
+    {
+        auto *target = node.arguments.empty() ? nullptr : dynamic_cast<IdentifierExpr *>(node.arguments[0].get());
+        if (!target)
+            return;
+        checkSharedMutation(target->name, node.function, node.function + "(" + target->name + ", ...)", spawned);
+    }
+
+    void StaticAnalyzer::checkSharedMutation(const std::string &target, const std::string &function,
+                                             const std::string &shown, bool spawned)
+    {
+        if (!isMutatingCall(function))
+            return;
+        if (spawned)
+        {
+            reportIssue(IssueType::DATA_RACE, Severity::ERROR,
+                        "Spawned call '" + shown + "' mutates '" + target +
+                            "' while the spawning code can still use it",
+                        {"let the task build and return its own value, then 'await' it"});
+            return;
+        }
+        checkParallelWrite(target, "Call to '" + function + "()' on");
+    }
+
     void StaticAnalyzer::reportIssue(IssueType type, Severity severity,
                                      const std::string &message,
                                      const std::vector<std::string> &notes)
@@ -683,11 +822,18 @@ namespace lpp
     void StaticAnalyzer::visit(UnaryExpr &node)
     {
         node.operand->accept(*this);
+        if (auto *ident = dynamic_cast<IdentifierExpr *>(node.operand.get()))
+        {
+            if (node.op == "++" || node.op == "--")
+                checkParallelWrite(ident->name, "Update of");
+        }
     }
 
     void StaticAnalyzer::visit(PostfixExpr &node)
     {
         node.operand->accept(*this);
+        if (auto *ident = dynamic_cast<IdentifierExpr *>(node.operand.get()))
+            checkParallelWrite(ident->name, "Update of");
     }
 
     void StaticAnalyzer::visit(CallExpr &node)
@@ -716,6 +862,7 @@ namespace lpp
         {
             arg->accept(*this);
         }
+        checkSharedFreeCall(node, false);
     }
 
     void StaticAnalyzer::visit(LambdaExpr &node)
@@ -847,6 +994,7 @@ namespace lpp
     {
         node.object->accept(*this);
         node.index->accept(*this);
+        checkSharedMethodCall(node, false);
     }
 
     void StaticAnalyzer::visit(ObjectExpr &node)
@@ -882,6 +1030,18 @@ namespace lpp
 
         // Check paradigm violation
         checkParadigmViolation(node);
+        declareLocal(node.name);
+
+        if (!arenaRegions.empty())
+        {
+            // Functional files keep arrays persistent, so only ranges and
+            // comprehensions are arena-backed there
+            bool arenaArray = node.isArrayType && node.arraySize == 0 &&
+                              currentParadigm != ParadigmMode::FUNCTIONAL;
+            arenaRegions.back().declared.insert(node.name);
+            if (arenaArray || arenaRegionOf(node.initializer.get()) >= 0)
+                arenaRegions.back().allocated.insert(node.name);
+        }
 
         SymbolicValue val;
         if (node.initializer)
@@ -889,6 +1049,11 @@ namespace lpp
             node.initializer->accept(*this);
             val.state = SymbolicValue::State::INITIALIZED;
         }
+        else if (node.type.find('<') != std::string::npos)
+        {
+            // Generic class types (Channel<int>, HashMap<K, V>) are default-constructed
+            val.state = SymbolicValue::State::INITIALIZED;
+        }
         else
         {
             val.state = SymbolicValue::State::UNINITIALIZED;
@@ -906,6 +1071,7 @@ namespace lpp
 
         // Quantum features are experimental and paradigm-agnostic
         // No paradigm violation check
+        declareLocal(node.name);
 
         // Analyze all quantum states
         for (auto &state : node.states)
@@ -930,6 +1096,8 @@ namespace lpp
         checkParadigmViolation(node);
 
         node.value->accept(*this);
+        checkArenaEscape(node.value.get(), &node.name);
+        checkParallelWrite(node.name, "Assignment to");
 
         SymbolicValue val;
         val.state = SymbolicValue::State::INITIALIZED;
@@ -997,6 +1165,12 @@ namespace lpp
                         "'break' statement not within loop or switch",
                         {"break can only be used inside loops (while, for) or switch statements"});
         }
+        else if (!parallelRegions.empty() && loopDepth == parallelRegions.back().loopDepth && switchDepth == 0)
+        {
+            reportIssue(IssueType::CONTROL_FLOW_ERROR, Severity::ERROR,
+                        "'break' cannot stop a 'parallel for'",
+                        {"all iterations are already running; filter the items first instead"});
+        }
     }
 
     void StaticAnalyzer::visit(ContinueStmt &node)
@@ -1009,14 +1183,27 @@ namespace lpp
                         "'continue' statement not within loop",
                         {"continue can only be used inside loops (while, for)"});
         }
+        else if (!parallelRegions.empty() && loopDepth == parallelRegions.back().loopDepth)
+        {
+            reportIssue(IssueType::CONTROL_FLOW_ERROR, Severity::ERROR,
+                        "'continue' is not supported in a 'parallel for' body",
+                        {"wrap the rest of the body in an if instead"});
+        }
     }
 
     void StaticAnalyzer::visit(ReturnStmt &node)
     {
         currentLine++;
+        if (!parallelRegions.empty())
+        {
+            reportIssue(IssueType::CONTROL_FLOW_ERROR, Severity::ERROR,
+                        "'return' inside 'parallel for' cannot leave the enclosing function",
+                        {"each iteration runs as its own task"});
+        }
         if (node.value)
         {
             node.value->accept(*this);
+            checkArenaEscape(node.value.get(), nullptr);
         }
     }
 
@@ -1083,10 +1270,14 @@ namespace lpp
         runDataFlowAnalysis();
 
         // Visit statements
+        arenaRegions.clear();
+        if (node.useArena)
+            arenaRegions.emplace_back();
         for (auto &stmt : node.body)
         {
             stmt->accept(*this);
         }
+        arenaRegions.clear();
     }
 
     void StaticAnalyzer::visit(ClassDecl &node)
@@ -1268,6 +1459,15 @@ namespace lpp
         node.expression->accept(*this);
     }
 
+    void StaticAnalyzer::visit(SpawnExpr &node)
+    {
+        node.expression->accept(*this);
+        if (auto *method = dynamic_cast<IndexExpr *>(node.expression.get()))
+            checkSharedMethodCall(*method, true);
+        else if (auto *call = dynamic_cast<CallExpr *>(node.expression.get()))
+            checkSharedFreeCall(*call, true);
+    }
+
     void StaticAnalyzer::visit(ThrowExpr &node)
     {
         node.expression->accept(*this);
@@ -1341,6 +1541,7 @@ namespace lpp
         node.iterable->accept(*this);
 
         // Register the loop variable
+        declareLocal(node.variable);
         SymbolicValue val;
         val.state = SymbolicValue::State::INITIALIZED;
         {
@@ -1356,6 +1557,28 @@ namespace lpp
         loopDepth--;
     }
 
+    void StaticAnalyzer::visit(ParallelForStmt &node)
+    {
+        node.iterable->accept(*this);
+
+        loopDepth++;
+        parallelRegions.push_back({{node.variable}, loopDepth});
+        {
+            SymbolicValue val;
+            val.state = SymbolicValue::State::INITIALIZED;
+            std::lock_guard<std::mutex> lock(symbolTableMutex); // BUG #346 fix
+            symbolTable[node.variable] = val;
+        }
+
+        for (auto &stmt : node.body)
+        {
+            stmt->accept(*this);
+        }
+
+        parallelRegions.pop_back();
+        loopDepth--;
+    }
+
     void StaticAnalyzer::visit(DoWhileStmt &node)
     {
         loopDepth++;
@@ -1370,6 +1593,24 @@ namespace lpp
         loopDepth--;
     }
 
+    void StaticAnalyzer::visit(ArenaStmt &node)
+    {
+        arenaRegions.emplace_back();
+        for (auto &stmt : node.body)
+        {
+            stmt->accept(*this);
+        }
+        arenaRegions.pop_back();
+    }
+
+    void StaticAnalyzer::visit(ScopeStmt &node)
+    {
+        for (auto &stmt : node.body)
+        {
+            stmt->accept(*this);
+        }
+    }
+
     void StaticAnalyzer::visit(TryCatchStmt &node)
     {
         // Analyze try block
@@ -1381,6 +1622,7 @@ namespace lpp
         // Register catch variable
         if (!node.catchVariable.empty())
         {
+            declareLocal(node.catchVariable);
             SymbolicValue val;
             val.state = SymbolicValue::State::INITIALIZED;
             {
@@ -1422,6 +1664,7 @@ namespace lpp
         std::lock_guard<std::mutex> lock(symbolTableMutex); // BUG #346 fix
         for (const auto &target : node.targets)
         {
+            declareLocal(target);
             SymbolicValue val;
             val.state = SymbolicValue::State::INITIALIZED;
             symbolTable[target] = val;
@@ -0,0 +1,212 @@
+#include "StdlibCache.h"
+#include "BuildProfile.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+
+namespace lpp
+{
+
+    std::string StdlibCache::cacheDirectory()
+    {
+        if (const char *dir = std::getenv("LPP_CACHE_DIR"))
+            return dir;
+        if (const char *xdg = std::getenv("XDG_CACHE_HOME"))
+            return (std::filesystem::path(xdg) / "lpp").string();
+        if (const char *home = std::getenv("HOME"))
+            return (std::filesystem::path(home) / ".cache" / "lpp").string();
+        return (std::filesystem::temp_directory_path() / "lpp-cache").string();
+    }
+
+    // Compiler version and target; a PCH only loads into the exact compiler
+    // build that wrote it
+    static std::string queryToolchain()
+    {
+#ifdef _WIN32
+        FILE *pipe = _popen("g++ -dumpfullversion -dumpmachine 2>NUL", "r");
+#else
+        FILE *pipe = popen("g++ -dumpfullversion -dumpmachine 2>/dev/null", "r");
+#endif
+        if (!pipe)
+        {
+            return "";
+        }
+        std::string id;
+        char buffer[256];
+        while (std::fgets(buffer, sizeof(buffer), pipe))
+        {
+            id += buffer;
+        }
+#ifdef _WIN32
+        _pclose(pipe);
+#else
+        pclose(pipe);
+#endif
+        return id;
+    }
+
+    std::string StdlibCache::toolchainId()
+    {
+        static const std::string id = queryToolchain();
+        return id;
+    }
+
+    // Every build that uses an entry touches its 'last-used' file first
+    static void markUsed(const std::filesystem::path &entry)
+    {
+        const std::filesystem::path stamp = entry / "last-used";
+        std::ofstream(stamp, std::ios::app).close();
+        std::error_code ec;
+        std::filesystem::last_write_time(stamp, std::filesystem::file_time_type::clock::now(), ec);
+    }
+
+    static std::filesystem::file_time_type lastUsed(const std::filesystem::path &entry)
+    {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(entry / "last-used", ec);
+        if (ec)
+            time = std::filesystem::last_write_time(entry, ec); // written before stamps existed
+        return ec ? std::filesystem::file_time_type::min() : time;
+    }
+
+    // Least recently used eviction over the other stdlib-* entries. An entry
+    // used in the last hour is never removed, so a build still compiling
+    // against one (another checkout, another profile) keeps it. Older ones
+    // are removed beyond the KEEP most recently used, and after MAX_IDLE
+    // without use in any case.
+    static void pruneEntries(const std::filesystem::path &keep)
+    {
+        namespace fs = std::filesystem;
+        constexpr size_t KEEP = 4;
+        const auto now = fs::file_time_type::clock::now();
+        const auto grace = std::chrono::hours(1);
+        const auto maxIdle = std::chrono::hours(24 * 7);
+
+        std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+        std::error_code ec;
+        for (fs::directory_iterator it(keep.parent_path(), ec), end; !ec && it != end; it.increment(ec))
+        {
+            const fs::path entry = it->path();
+            if (entry == keep || entry.filename().string().rfind("stdlib-", 0) != 0 || !it->is_directory(ec))
+                continue;
+            entries.emplace_back(lastUsed(entry), entry);
+        }
+        std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b)
+                  { return a.first > b.first; });
+
+        // 'keep' itself counts as one of the most recently used
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            const auto idle = now - entries[i].first;
+            if (idle < grace || (i + 1 < KEEP && idle < maxIdle))
+                continue;
+            std::error_code removeError;
+            fs::remove_all(entries[i].second, removeError);
+        }
+    }
+
+    std::optional<std::string> StdlibCache::prepare(const std::string &stdlibHeader, const std::string &flags,
+                                                    const std::vector<std::string> &systemHeaders)
+    {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+
+        std::ifstream stdlibFile(stdlibHeader);
+        if (!stdlibFile.is_open())
+        {
+            return std::nullopt;
+        }
+        std::stringstream stdlibSource;
+        stdlibSource << stdlibFile.rdbuf();
+
+        const std::string toolchain = toolchainId();
+        if (toolchain.empty())
+        {
+            return std::nullopt;
+        }
+
+        std::string headerList;
+        for (const auto &header : systemHeaders)
+            headerList += header + "\n";
+
+        std::ostringstream key;
+        key << std::hex << std::setw(16) << std::setfill('0')
+            << BuildCache::fingerprint({toolchain, flags, headerList, stdlibSource.str()});
+        const fs::path entry = fs::path(cacheDirectory()) / ("stdlib-" + key.str());
+        const fs::path prelude = entry / "lpp_prelude.hpp";
+        const fs::path pch = entry / "lpp_prelude.hpp.gch";
+
+        // The path is spliced into a shell command
+        if (entry.string().find_first_of("'\"`$;|&") != std::string::npos)
+        {
+            return std::nullopt;
+        }
+        if (fs::exists(pch, ec))
+        {
+            markUsed(entry);
+            return prelude.string();
+        }
+        if (fs::exists(entry / "failed", ec))
+        {
+            return std::nullopt;
+        }
+
+        fs::create_directories(entry, ec);
+        if (ec)
+        {
+            return std::nullopt;
+        }
+        // A PCH is over 100 MB; evict old entries before writing another.
+        // The stamp goes first so a concurrent lppc does not evict this one.
+        markUsed(entry);
+        pruneEntries(entry);
+
+        // A private copy of the stdlib keeps the entry valid when the source
+        // tree changes; the key already covers its contents
+        {
+            std::ofstream copy(entry / "lpp_stdlib.hpp");
+            copy << stdlibSource.str();
+            std::ofstream header(prelude);
+            header << "// Precompiled by lppc, see StdlibCache.h\n";
+            for (const auto &name : systemHeaders)
+                header << "#include <" << name << ">\n";
+            header << "#include \"lpp_stdlib.hpp\"\n";
+        }
+
+        // Concurrent lppc runs each write their own file; the rename makes
+        // whichever finishes first visible in one step
+        std::random_device random;
+        const fs::path staging = entry / ("lpp_prelude.hpp.gch." + std::to_string(random()));
+        auto quote = [](const fs::path &path)
+        {
+#ifdef _WIN32
+            return "\"" + path.string() + "\"";
+#else
+            return "'" + path.string() + "'";
+#endif
+        };
+        std::string command = "g++ " + flags + " -x c++-header " + quote(prelude) + " -o " + quote(staging) +
+                              " > " + quote(entry / "build.log") + " 2>&1";
+        if (system(command.c_str()) != 0)
+        {
+            fs::remove(staging, ec);
+            std::ofstream(entry / "failed") << "see build.log\n";
+            return std::nullopt;
+        }
+        fs::rename(staging, pch, ec);
+        if (ec)
+        {
+            fs::remove(staging, ec);
+            if (!fs::exists(pch, ec))
+                return std::nullopt;
+        }
+        return prelude.string();
+    }
+
+} // namespace lpp
@@ -53,6 +53,9 @@ namespace lpp
         {TokenType::NEW, "NEW"},
         {TokenType::ASYNC, "ASYNC"},
         {TokenType::AWAIT, "AWAIT"},
+        {TokenType::SPAWN, "SPAWN"},
+        {TokenType::PARALLEL, "PARALLEL"},
+        {TokenType::SCOPE, "SCOPE"},
         {TokenType::TRY, "TRY"},
         {TokenType::CATCH, "CATCH"},
         {TokenType::FINALLY, "FINALLY"},
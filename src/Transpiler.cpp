@@ -1,177 +1,47 @@
 #include "Transpiler.h"
 #include <iostream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <algorithm>
+#include <filesystem>
 
 namespace lpp
 {
 
     std::string Transpiler::transpile(Program &program)
+    {
+        std::string prelude = transpilePrelude(usesPatterns(program));
+        return prelude + transpileModule(program);
+    }
+
+    bool Transpiler::usesPatterns(const Program &program)
+    {
+        // Design-pattern macros (@pattern / autopattern) live in their own header
+        return std::any_of(program.classes.begin(), program.classes.end(),
+                           [](const std::unique_ptr<ClassDecl> &cls)
+                           { return !cls->designPattern.empty(); });
+    }
+
+    const std::vector<std::string> &Transpiler::preludeHeaders()
+    {
+        static const std::vector<std::string> headers = {
+            "iostream", "string", "cmath", "vector", "tuple", "array", "optional",
+            "functional", "variant", "map", "any", "future", "random", "chrono"};
+        return headers;
+    }
+
+    std::string Transpiler::transpilePrelude(bool withPatterns)
     {
         output.str("");
         output.clear();
         indentLevel = 0;
 
         // Add standard includes
-        writeLine("#include <iostream>");
-        writeLine("#include <string>");
-        writeLine("#include <cmath>");
-        writeLine("#include <vector>");
-        writeLine("#include <tuple>");
-        writeLine("#include <array>");
-        writeLine("#include <optional>");
-        writeLine("#include <functional>");
-        writeLine("#include <variant>");
-        writeLine("#include <map>");
-        writeLine("#include <any>");
-        writeLine("#include <future>");
-        writeLine("#include <random>");
-        writeLine("#include <chrono>");
-        writeLine("");
-
-        // Quantum Variable class template
-        writeLine("// ============ QUANTUM VARIABLE SYSTEM ============");
-        writeLine("template<typename T>");
-        writeLine("class QuantumVar {");
-        writeLine("private:");
-        indentLevel++;
-        writeLine("std::vector<T> states;");
-        writeLine("std::vector<double> probabilities;");
-        writeLine("std::optional<T> collapsed;");
-        writeLine("bool hasWeights;");
-        writeLine("std::mt19937 rng;");
-        indentLevel--;
-        writeLine("");
-        writeLine("public:");
-        indentLevel++;
-        writeLine("// Constructor for uniform distribution");
-        writeLine("QuantumVar(const std::vector<T>& s) ");
-        indentLevel++;
-        writeLine(": states(s), hasWeights(false), rng(std::chrono::system_clock::now().time_since_epoch().count()) {");
-        writeLine("// Equal probability for all states");
-        writeLine("if (states.empty()) throw std::runtime_error(\"QuantumVar: cannot create with empty states\");");
-        writeLine("double prob = 1.0 / states.size();");
-        writeLine("probabilities = std::vector<double>(states.size(), prob);");
-        indentLevel--;
-        writeLine("}");
-        writeLine("");
-        writeLine("// Constructor for weighted distribution");
-        writeLine("QuantumVar(const std::vector<T>& s, const std::vector<double>& probs)");
-        indentLevel++;
-        writeLine(": states(s), hasWeights(true), rng(std::chrono::system_clock::now().time_since_epoch().count()) {");
-        indentLevel++;
-        writeLine("// Normalize probabilities to sum to 1.0");
-        writeLine("double sum = 0.0;");
-        writeLine("for (double p : probs) sum += p;");
-        writeLine("if (sum > 0.0) {");
-        indentLevel++;
-        writeLine("for (double p : probs) probabilities.push_back(p / sum);");
-        indentLevel--;
-        writeLine("} else {");
-        indentLevel++;
-        writeLine("// Fallback to uniform if all probabilities are 0");
-        writeLine("if (states.empty()) throw std::runtime_error(\"QuantumVar: cannot create with empty states\");");
-        writeLine("double uniformProb = 1.0 / states.size();");
-        writeLine("probabilities = std::vector<double>(states.size(), uniformProb);");
-        indentLevel--;
-        writeLine("}");
-        indentLevel--;
-        writeLine("}");
-        indentLevel--;
-        writeLine("");
-        writeLine("// observe(): Collapse superposition to single state");
-        writeLine("T observe() {");
-        indentLevel++;
-        // FIX BUG #162: QuantumVar doesn't cleanup RNG state in destructor
-        // TODO: Add explicit destructor with RNG cleanup
-        // - ~QuantumVar() { rng.discard(1000); /* clear state */ }
-        // - Or use unique_ptr<std::mt19937> for automatic cleanup
-        // - Track if RNG is seeded: bool rngInitialized = false;
-        // - Cleanup: if (rngInitialized) { /* cleanup */ }
-        // Impact: Prevents RNG state leaks in long-running programs
-        // FIX BUG #132: Multiple observe() calls return same value (idempotent)
-        // TODO: Document behavior clearly:
-        // - First call: Collapses superposition, caches result in 'collapsed'
-        // - Subsequent calls: Return cached 'collapsed' value (deterministic)
-        // - To re-observe: Call reset() first to clear 'collapsed'
-        // Example:
-        //   quantum q = [1, 2, 3];
-        //   q.observe(); // Returns 2 (random)
-        //   q.observe(); // Returns 2 (cached, not random)
-        //   q.reset();   // Clear cache
-        //   q.observe(); // Returns 1 (new random collapse)
-        // CORRECT: Once collapsed, state is fixed (quantum measurement principle)
-        writeLine("if (!collapsed) {");
-        indentLevel++;
-        writeLine("// Weighted random selection");
-        writeLine("std::discrete_distribution<> dist(probabilities.begin(), probabilities.end());");
-        writeLine("int idx = dist(rng);");
-        writeLine("if (idx >= 0 && idx < static_cast<int>(states.size())) collapsed = states[idx];");
-        indentLevel--;
-        writeLine("}");
-        writeLine("return *collapsed;");
-        indentLevel--;
-        writeLine("}");
-        writeLine("");
-        writeLine("// map(): Transform all states (lazy)");
-        writeLine("template<typename F>");
-        writeLine("auto map(F func) -> QuantumVar<decltype(func(std::declval<T>()))> {");
-        indentLevel++;
-        writeLine("using U = decltype(func(std::declval<T>()));");
-        writeLine("std::vector<U> newStates;");
-        writeLine("for (const auto& state : states) {");
-        indentLevel++;
-        writeLine("newStates.push_back(func(state));");
-        indentLevel--;
-        writeLine("}");
-        writeLine("return QuantumVar<U>(newStates, probabilities);");
-        indentLevel--;
-        writeLine("}");
-        writeLine("");
-        writeLine("// reset(): Return to superposition");
-        writeLine("void reset() {");
-        indentLevel++;
-        writeLine("collapsed.reset();");
-        indentLevel--;
-        writeLine("}");
-        writeLine("");
-        writeLine("// entangle(): Create correlated quantum variable");
-        writeLine("template<typename F>");
-        writeLine("auto entangle(F transform) -> QuantumVar<decltype(transform(std::declval<T>()))> {");
-        indentLevel++;
-        writeLine("using U = decltype(transform(std::declval<T>()));");
-        writeLine("// If already collapsed, entangled var uses same index");
-        writeLine("std::vector<U> entangledStates;");
-        writeLine("for (const auto& state : states) {");
-        indentLevel++;
-        writeLine("entangledStates.push_back(transform(state));");
-        indentLevel--;
-        writeLine("}");
-        writeLine("auto result = QuantumVar<U>(entangledStates, probabilities);");
-        writeLine("if (collapsed) {");
-        indentLevel++;
-        writeLine("// Force same index selection");
-        writeLine("int collapsedIdx = 0;");
-        writeLine("for (size_t i = 0; i < states.size(); ++i) {");
-        indentLevel++;
-        writeLine("if (states[i] == *collapsed) { collapsedIdx = i; break; }");
-        indentLevel--;
-        writeLine("}");
-        writeLine("if (collapsedIdx >= 0 && collapsedIdx < static_cast<int>(entangledStates.size())) result.collapsed = entangledStates[collapsedIdx];");
-        indentLevel--;
-        writeLine("}");
-        writeLine("return result;");
-        indentLevel--;
-        writeLine("}");
-        indentLevel--;
-        writeLine("};");
-        writeLine("");
-        writeLine("// Global entangle function");
-        writeLine("template<typename T, typename F>");
-        writeLine("auto entangle(QuantumVar<T>& qvar, F transform) {");
-        indentLevel++;
-        writeLine("return qvar.entangle(transform);");
-        indentLevel--;
-        writeLine("}");
-        writeLine("// ================================================");
+        for (const std::string &header : preludeHeaders())
+        {
+            writeLine("#include <" + header + ">");
+        }
         writeLine("");
 
         // Include LPP Standard Library
@@ -179,30 +49,16 @@ namespace lpp
         writeLine("using namespace lpp::stdlib;");
         writeLine("");
 
-        // Helper function for print
-        writeLine("void print(const std::string& s) {");
-        indentLevel++;
-        writeLine("std::cout << s << std::endl;");
-        indentLevel--;
-        writeLine("}");
-        writeLine("");
-        writeLine("void print(int n) {");
-        indentLevel++;
-        writeLine("std::cout << n << std::endl;");
-        indentLevel--;
-        writeLine("}");
-        writeLine("");
-        writeLine("void print(double n) {");
-        indentLevel++;
-        writeLine("std::cout << n << std::endl;");
-        indentLevel--;
-        writeLine("}");
-        writeLine("");
+        if (withPatterns)
+        {
+            writeLine("#include \"../stdlib/lpp_patterns.hpp\"");
+            writeLine("");
+        }
 
         // Higher-order functions
         writeLine("// Higher-order function: map");
-        writeLine("template<typename T, typename F>");
-        writeLine("auto map(const std::vector<T>& vec, F func) {");
+        writeLine("template<typename T, typename A, typename F>");
+        writeLine("auto map(const std::vector<T, A>& vec, F func) {");
         indentLevel++;
         writeLine("std::vector<decltype(func(vec[0]))> result;");
         writeLine("for (const auto& item : vec) {");
@@ -216,10 +72,10 @@ namespace lpp
         writeLine("");
 
         writeLine("// Higher-order function: filter");
-        writeLine("template<typename T, typename F>");
-        writeLine("std::vector<T> filter(const std::vector<T>& vec, F predicate) {");
+        writeLine("template<typename T, typename A, typename F>");
+        writeLine("std::vector<T, A> filter(const std::vector<T, A>& vec, F predicate) {");
         indentLevel++;
-        writeLine("std::vector<T> result;");
+        writeLine("std::vector<T, A> result(vec.get_allocator());");
         writeLine("for (const auto& item : vec) {");
         indentLevel++;
         writeLine("if (predicate(item)) {");
@@ -235,8 +91,8 @@ namespace lpp
         writeLine("");
 
         writeLine("// Higher-order function: reduce/fold");
-        writeLine("template<typename T, typename F>");
-        writeLine("T reduce(const std::vector<T>& vec, T init, F func) {");
+        writeLine("template<typename T, typename A, typename F>");
+        writeLine("T reduce(const std::vector<T, A>& vec, T init, F func) {");
         indentLevel++;
         writeLine("T result = init;");
         writeLine("for (const auto& item : vec) {");
@@ -249,11 +105,77 @@ namespace lpp
         writeLine("}");
         writeLine("");
 
+        return output.str();
+    }
+
+    std::string Transpiler::transpileModule(Program &program)
+    {
+        output.str("");
+        output.clear();
+        indentLevel = 0;
+        arenaStack.clear();
+        relaxedFloat = program.pragmas.relaxedFloat;
+        persistentCollections = program.paradigm == ParadigmMode::FUNCTIONAL;
+
+        // #pragma seed N: reseed the shared RNG before any user code runs
+        if (program.pragmas.seed)
+        {
+            const std::string flag = moduleTag.empty() ? "__lpp_seeded" : "__lpp_seeded_" + moduleTag;
+            writeLine("static const bool " + flag + " = (lpp::stdlib::seedRandom(" + std::to_string(*program.pragmas.seed) + "ull), true);");
+            writeLine("");
+        }
+
         program.accept(*this);
 
+        if (stats)
+            stats->endModule(output.str());
         return output.str();
     }
 
+    // Prototypes for a module's free functions, so modules merged into one
+    // unit (or split over several) can call each other in any order. Only
+    // signatures made of builtin types are declared: a class in a signature
+    // may be defined in a module that comes later.
+    std::string Transpiler::transpileDeclarations(Program &program)
+    {
+        output.str("");
+        output.clear();
+        indentLevel = 0;
+        persistentCollections = program.paradigm == ParadigmMode::FUNCTIONAL;
+
+        auto isBuiltin = [](const std::string &type)
+        { return type == "int" || type == "float" || type == "string" || type == "bool" || type == "void"; };
+
+        for (const auto &func : program.functions)
+        {
+            if (func->name == "main" || func->isGenerator || func->hasRestParam || !func->genericParams.empty() ||
+                !isBuiltin(func->returnType))
+                continue;
+            bool builtinParams = std::all_of(func->parameters.begin(), func->parameters.end(),
+                                             [&](const std::pair<std::string, std::string> &param)
+                                             { return isBuiltin(param.second); });
+            if (!builtinParams)
+                continue;
+
+            const std::string returnType = mapType(func->returnType);
+            output << (func->isAsync ? "std::future<" + returnType + ">" : returnType) << " " << func->name << "(";
+            for (size_t i = 0; i < func->parameters.size(); i++)
+            {
+                if (i > 0)
+                    output << ", ";
+                output << mapType(func->parameters[i].second) << " " << func->parameters[i].first;
+            }
+            output << ");\n";
+        }
+        return output.str();
+    }
+
+    std::string Transpiler::uniqueSuffix(std::atomic<int> &counter) const
+    {
+        const std::string number = std::to_string(counter++);
+        return moduleTag.empty() ? number : moduleTag + "_" + number;
+    }
+
     void Transpiler::visit(NumberExpr &node)
     {
         output << node.value;
@@ -267,6 +189,7 @@ namespace lpp
     void Transpiler::visit(TemplateLiteralExpr &node)
     {
         // Template literal: `Hello ${name}` => std::string("Hello ") + std::to_string(name)
+        CodeStats::Span span(stats, output, "template_literal", node.line);
         // FIX BUG #317: Escape special characters to prevent code injection
         auto escapeString = [](const std::string &str) -> std::string
         {
@@ -413,6 +336,7 @@ namespace lpp
         // Example SAFE:
         //   async fn foo() { let x = 42; return [x]() { return x; }; } // captures by value
         // Requires: Track function context (is async?) and lambda lifetime
+        CodeStats::Span span(stats, output, "lambda", node.line);
         output << "[](";
 
         const size_t numParams = node.parameters.size();
@@ -534,7 +458,10 @@ namespace lpp
     void Transpiler::visit(RangeExpr &node)
     {
         // BUG #319 fix: Add runtime validation for step != 0
-        output << "([&]() { std::vector<int> __range; int __start = ";
+        if (arenaStack.empty())
+            output << "([&]() { std::vector<int> __range; int __start = ";
+        else
+            output << "([&]() { std::pmr::vector<int> __range(" << arenaResource() << "); int __start = ";
         node.start->accept(*this);
         output << "; int __end = ";
         node.end->accept(*this);
@@ -559,49 +486,77 @@ namespace lpp
 
     void Transpiler::visit(MapExpr &node)
     {
-        // arr @ fn => IIFE with std::transform pattern
-        output << "([&]() { std::vector<decltype(";
-        node.fn->accept(*this);
-        output << "(std::declval<decltype(";
-        node.iterable->accept(*this);
-        output << ")::value_type>()))> __result; for (auto& __item : ";
+        // arr @ (x -> x * k) => vectorizable transform kernel. The lambda is
+        // re-emitted with [&] so it can read locals like k.
+        CodeStats::Span span(stats, output, "map", node.line);
+        if (isArithmeticMapLambda(node.fn.get()))
+        {
+            auto &lambda = static_cast<LambdaExpr &>(*node.fn);
+            const auto &param = lambda.parameters[0];
+            std::string paramType = "auto";
+            if (!param.second.empty())
+            {
+                std::string mappedType = mapType(param.second);
+                if (!mappedType.empty() && mappedType != param.second)
+                    paramType = mappedType;
+            }
+            output << (node.parallel ? "lpp::stdlib::parallelMap(" : "lpp::stdlib::mapVector(");
+            node.iterable->accept(*this);
+            output << ", [&](" << paramType << " " << param.first << ") { return ";
+            lambda.body->accept(*this);
+            output << "; })";
+            return;
+        }
+
+        // arr @ fn => vector of results (lazy view when arr is a lazy range);
+        // split across the thread pool when fn is read-only (EffectAnalyzer)
+        output << (node.parallel ? "lpp::stdlib::parallelMap(" : "lpp::stdlib::mapEach(");
         node.iterable->accept(*this);
-        output << ") { __result.push_back((";
+        output << ", ";
         node.fn->accept(*this);
-        output << ")(__item)); } return __result; })()";
+        output << ")";
     }
 
     void Transpiler::visit(FilterExpr &node)
     {
-        // arr ? |x| cond => IIFE with filter pattern
-        output << "([&]() { std::remove_reference_t<decltype(";
+        // arr ? |x| cond => matching elements (lazy view when arr is a lazy range)
+        CodeStats::Span span(stats, output, "filter", node.line);
+        output << (node.parallel ? "lpp::stdlib::parallelFilter(" : "lpp::stdlib::filterEach(");
         node.iterable->accept(*this);
-        output << ")> __result; for (auto& __item : ";
-        node.iterable->accept(*this);
-        output << ") { if ((";
+        output << ", ";
         node.predicate->accept(*this);
-        output << ")(__item)) { __result.push_back(__item); } } return __result; })()";
+        output << ")";
     }
 
     void Transpiler::visit(ReduceExpr &node)
     {
-        // arr \ |acc,x| expr => IIFE with accumulate pattern
-        output << "([&]() { auto __acc = ";
+        // acc + x, acc * x, min/max ternaries, acc && x, acc || x => stdlib
+        // kernel (multi-accumulator / early exit), still given the lambda
+        // for the strict-order fallback; anything else => left-to-right fold.
+        // The associative kernels also split across the thread pool.
+        CodeStats::Span span(stats, output, "reduce", node.line);
+        const std::string kernel = reduceKernelName(node.fn.get());
+        const bool associative = kernel == "reduceSum" || kernel == "reduceProduct" ||
+                                 kernel == "reduceMin" || kernel == "reduceMax";
+        output << "lpp::stdlib::";
+        if (kernel.empty())
+            output << "reduceEach";
+        else if (node.parallel && associative)
+            output << "parallelR" << kernel.substr(1);
+        else
+            output << kernel;
+        if (!kernel.empty() && kernel != "reduceAll" && kernel != "reduceAny")
+            output << "<lpp::stdlib::FloatOrder::" << (relaxedFloat ? "RELAXED" : "STRICT") << ">";
+        output << "(";
+        node.iterable->accept(*this);
+        output << ", ";
         if (node.initial)
         {
             node.initial->accept(*this);
+            output << ", ";
         }
-        else
-        {
-            output << "decltype(";
-            node.iterable->accept(*this);
-            output << ")::value_type{}";
-        }
-        output << "; for (auto& __item : ";
-        node.iterable->accept(*this);
-        output << ") { __acc = (";
         node.fn->accept(*this);
-        output << ")(__acc, __item); } return __acc; })()";
+        output << ")";
     }
 
     void Transpiler::visit(IterateWhileExpr &node)
@@ -664,6 +619,129 @@ namespace lpp
             }
         }
 
+        if (persistentCollections)
+        {
+            // Functional files: [a, b] is a PersistentVector. With spreads the
+            // result is built through a transient seeded from the first
+            // operand, so [...xs, x] shares all of xs and costs O(log n).
+            auto *first = node.elements.empty() ? nullptr : dynamic_cast<SpreadExpr *>(node.elements[0].get());
+            if (!hasSpread)
+            {
+                output << "lpp::stdlib::PersistentVector<";
+                if (node.elements.empty())
+                {
+                    output << "int";
+                }
+                else
+                {
+                    output << "decltype(";
+                    node.elements[0]->accept(*this);
+                    output << ")";
+                }
+                output << ">{";
+                for (size_t i = 0; i < node.elements.size(); i++)
+                {
+                    if (i > 0)
+                        output << ", ";
+                    node.elements[i]->accept(*this);
+                }
+                output << "}";
+                return;
+            }
+
+            output << "([&]() { auto __arr = ";
+            if (first)
+            {
+                output << "lpp::stdlib::toPersistentVector(";
+                first->expression->accept(*this);
+                output << ")";
+            }
+            else
+            {
+                output << "lpp::stdlib::PersistentVector<decltype(";
+                node.elements[0]->accept(*this);
+                output << ")>()";
+            }
+            output << ".transient(); ";
+            for (size_t i = first ? 1 : 0; i < node.elements.size(); i++)
+            {
+                if (auto spreadExpr = dynamic_cast<SpreadExpr *>(node.elements[i].get()))
+                {
+                    output << "__arr.append(";
+                    spreadExpr->expression->accept(*this);
+                    output << "); ";
+                }
+                else
+                {
+                    output << "__arr.pushBack(";
+                    node.elements[i]->accept(*this);
+                    output << "); ";
+                }
+            }
+            output << "return __arr.persistent(); })()";
+            return;
+        }
+
+        if (!arenaStack.empty())
+        {
+            // Inside an arena: the literal is a std::pmr::vector on the
+            // innermost arena, so its storage goes away with the block
+            const std::string resource = arenaResource();
+            auto *first = node.elements.empty() ? nullptr : dynamic_cast<SpreadExpr *>(node.elements[0].get());
+            if (!hasSpread)
+            {
+                output << "std::pmr::vector<";
+                if (node.elements.empty())
+                {
+                    output << "int>(" << resource << ")";
+                    return;
+                }
+                output << "decltype(";
+                node.elements[0]->accept(*this);
+                output << ")>({";
+                for (size_t i = 0; i < node.elements.size(); i++)
+                {
+                    if (i > 0)
+                        output << ", ";
+                    node.elements[i]->accept(*this);
+                }
+                output << "}, " << resource << ")";
+                return;
+            }
+
+            output << "([&]() { std::pmr::vector<";
+            if (first)
+            {
+                output << "std::decay_t<decltype(*std::begin(";
+                first->expression->accept(*this);
+                output << "))>";
+            }
+            else
+            {
+                output << "decltype(";
+                node.elements[0]->accept(*this);
+                output << ")";
+            }
+            output << "> __arr(" << resource << "); ";
+            for (const auto &elem : node.elements)
+            {
+                if (auto spreadExpr = dynamic_cast<SpreadExpr *>(elem.get()))
+                {
+                    output << "for (auto &&__item : ";
+                    spreadExpr->expression->accept(*this);
+                    output << ") __arr.push_back(__item); ";
+                }
+                else
+                {
+                    output << "__arr.push_back(";
+                    elem->accept(*this);
+                    output << "); ";
+                }
+            }
+            output << "return __arr; })()";
+            return;
+        }
+
         if (hasSpread)
         {
             // Generate IIFE that builds the array with spread
@@ -740,11 +818,15 @@ namespace lpp
     {
         // [x*2 | x in 0..10, x > 3]
         // Trasformiamo in un loop che costruisce un vector
-        std::string tempVar = "__comp_" + std::to_string(lambdaCounter++);
+        CodeStats::Span span(stats, output, "comprehension", node.line);
+        std::string tempVar = "__comp_" + uniqueSuffix(lambdaCounter);
 
-        output << "([&]() { std::vector<decltype(";
+        output << "([&]() { " << (arenaStack.empty() ? "std::vector" : "std::pmr::vector") << "<decltype(";
         node.expression->accept(*this);
-        output << ")> " << tempVar << "; ";
+        output << ")> " << tempVar;
+        if (!arenaStack.empty())
+            output << "(" << arenaResource() << ")";
+        output << "; ";
 
         // For loop sul range
         output << "for (auto " << node.variable << " = ";
@@ -884,6 +966,30 @@ namespace lpp
 
                 output << "std::array<" << mapType(node.type) << ", " << node.arraySize << "> " << node.name;
             }
+            else if (persistentCollections)
+            {
+                // Dynamic array in a functional file: int[] -> PersistentVector<int>
+                output << "lpp::stdlib::PersistentVector<" << mapType(node.type) << "> " << node.name;
+            }
+            else if (!arenaStack.empty())
+            {
+                // Dynamic array inside an arena: int[] -> std::pmr::vector<int>
+                // bound to the arena; an initializer is copied in unless it
+                // already lives there
+                const std::string elemType = mapType(node.type);
+                output << "std::pmr::vector<" << elemType << "> " << node.name;
+                if (node.initializer)
+                {
+                    output << " = lpp::stdlib::toArenaVector<" << elemType << ">(";
+                    node.initializer->accept(*this);
+                    output << ", " << arenaResource() << ");\n";
+                }
+                else
+                {
+                    output << "(" << arenaResource() << ");\n";
+                }
+                return;
+            }
             else
             {
                 // Dynamic array: int[] -> std::vector<int>
@@ -917,18 +1023,25 @@ namespace lpp
 
     void Transpiler::visit(QuantumVarDecl &node)
     {
+        CodeStats::Span span(stats, output, "quantum", node.line);
         indent();
 
         // Determine element type
         std::string elementType = mapType(node.type);
 
-        // Generate QuantumVar<T>
-        output << "QuantumVar<" << elementType << "> " << node.name;
+        // Generate QuantumVar<T>; untyped declarations deduce T from the
+        // state list (QuantumVar<auto> is not valid C++)
+        const bool deduce = elementType == "auto";
+        if (deduce)
+            output << "QuantumVar " << node.name;
+        else
+            output << "QuantumVar<" << elementType << "> " << node.name;
+        const char *statesOpen = deduce ? "(std::vector{" : "({";
 
         if (node.hasWeights)
         {
             // Weighted: QuantumVar<int> x({states}, {probs})
-            output << "({";
+            output << statesOpen;
             for (size_t i = 0; i < node.states.size(); i++)
             {
                 node.states[i]->accept(*this);
@@ -947,7 +1060,7 @@ namespace lpp
         else
         {
             // Uniform: QuantumVar<int> x({states})
-            output << "({";
+            output << statesOpen;
             for (size_t i = 0; i < node.states.size(); i++)
             {
                 node.states[i]->accept(*this);
@@ -1082,6 +1195,14 @@ namespace lpp
 
     void Transpiler::visit(ImportStmt &node)
     {
+        // Unity build: the imported module is compiled along with this one
+        if (unityModules.count(std::filesystem::path(node.module).stem().string()))
+        {
+            indent();
+            output << "// import \"" << node.module << "\" (unity build)\n";
+            return;
+        }
+
         // Transpile to C++ #include
         indent();
         output << "#include \"" << node.module << ".hpp\"\n";
@@ -1114,6 +1235,8 @@ namespace lpp
 
     void Transpiler::visit(Function &node)
     {
+        CodeStats::Span span(stats, output, "function", node.line, node.name);
+
         // Generate template for generics and/or rest parameters
         bool needsTemplate = !node.genericParams.empty() || node.hasRestParam;
 
@@ -1162,6 +1285,9 @@ namespace lpp
         }
         else
         {
+            const std::string attribute = functionAttribute(node);
+            if (!attribute.empty() && !inClass)
+                output << attribute << " ";
             output << mapType(node.returnType) << " " << node.name << "(";
         }
 
@@ -1206,7 +1332,7 @@ namespace lpp
         if (node.hasRestParam)
         {
             // Use function name + counter for uniqueness
-            std::string uniqueId = node.name + "_" + std::to_string(lambdaCounter++);
+            std::string uniqueId = node.name + "_" + uniqueSuffix(lambdaCounter);
             restMacroName = "__LPP_REST_" + node.restParamName + "_" + uniqueId;
             std::string vecName = "__rest_vec_" + node.restParamName + "_" + uniqueId;
             indent();
@@ -1236,6 +1362,28 @@ namespace lpp
             indentLevel++;
         }
 
+        // Pure tree recursion (EffectAnalyzer): the body becomes the compute
+        // step of a per-function result cache
+        const std::string memoName = "__memo_" + node.name;
+        if (node.effects.memoize)
+        {
+            indent();
+            output << "static thread_local lpp::stdlib::MemoCache<" << mapType(node.returnType);
+            for (const auto &param : node.parameters)
+                output << ", " << mapType(param.second);
+            output << "> " << memoName << ";\n";
+            indent();
+            output << "return " << memoName << ".getOrCompute([&]() -> " << mapType(node.returnType) << " {\n";
+            indentLevel++;
+        }
+
+        // #pragma allocator arena: one region for the whole call, declared
+        // inside the async lambda so it lives on the worker's stack
+        if (node.useArena)
+        {
+            beginArena();
+        }
+
         for (auto &stmt : node.body)
         {
             stmt->accept(*this);
@@ -1248,6 +1396,21 @@ namespace lpp
             output << "return;\n";
         }
 
+        if (node.useArena)
+        {
+            arenaStack.pop_back();
+        }
+
+        if (node.effects.memoize)
+        {
+            indentLevel--;
+            indent();
+            output << "}";
+            for (const auto &param : node.parameters)
+                output << ", " << param.first;
+            output << ");\n";
+        }
+
         // Undefine rest parameter macros (FIX BUG #57)
         if (node.hasRestParam)
         {
@@ -1273,6 +1436,30 @@ namespace lpp
         output << "}\n";
     }
 
+    // LPP_CONST / LPP_PURE for functions EffectAnalyzer found side-effect
+    // free. Limited to scalar results and scalar or string parameters, and
+    // to functions that cannot throw, so the compiler is free to merge or
+    // drop calls. Memoized functions write their cache and get neither.
+    std::string Transpiler::functionAttribute(const Function &node)
+    {
+        const EffectSummary &effects = node.effects;
+        if (!effects.isReadOnly() || effects.mayThrow || effects.memoize || node.isAsync || node.isGenerator ||
+            node.hasRestParam || !node.genericParams.empty() || node.name == "main")
+            return "";
+        auto isScalar = [](const std::string &type)
+        { return type == "int" || type == "float" || type == "bool"; };
+        if (!isScalar(node.returnType))
+            return "";
+        bool scalarParams = true;
+        for (const auto &param : node.parameters)
+        {
+            if (!isScalar(param.second) && param.second != "string")
+                return "";
+            scalarParams = scalarParams && isScalar(param.second);
+        }
+        return effects.isPure() && scalarParams ? "LPP_CONST" : "LPP_PURE";
+    }
+
     void Transpiler::visit(Program &node)
     {
         // Imports first
@@ -1323,6 +1510,19 @@ namespace lpp
         }
     }
 
+    void Transpiler::beginArena()
+    {
+        std::string name = "__arena_" + uniqueSuffix(arenaCounter);
+        indent();
+        output << "lpp::stdlib::Arena " << name << ";\n";
+        arenaStack.push_back(name);
+    }
+
+    std::string Transpiler::arenaResource() const
+    {
+        return arenaStack.back() + ".resource()";
+    }
+
     void Transpiler::indent()
     {
         for (int i = 0; i < indentLevel; i++)
@@ -1350,6 +1550,38 @@ namespace lpp
         if (lppType == "void")
             return "void";
 
+        // Generic instantiation: map each type argument (Channel<string> -> Channel<std::string>)
+        size_t open = lppType.find('<');
+        if (open != std::string::npos && lppType.back() == '>')
+        {
+            std::string mapped = lppType.substr(0, open + 1);
+            if (persistentCollections)
+            {
+                // Functional files: Map/Set and their hash variants are persistent HAMTs
+                const std::string base = lppType.substr(0, open);
+                if (base == "Map" || base == "HashMap")
+                    mapped = "lpp::stdlib::PersistentMap<";
+                else if (base == "Set" || base == "HashSet")
+                    mapped = "lpp::stdlib::PersistentSet<";
+            }
+            int depth = 0;
+            size_t argStart = open + 1;
+            for (size_t i = open + 1; i < lppType.size(); i++)
+            {
+                char c = lppType[i];
+                if (c == '<')
+                    depth++;
+                else if ((c == ',' && depth == 0) || (c == '>' && depth-- == 0))
+                {
+                    std::string arg = lppType.substr(argStart, i - argStart);
+                    arg.erase(0, arg.find_first_not_of(' '));
+                    mapped += mapType(arg) + (c == ',' ? ", " : ">");
+                    argStart = i + 1;
+                }
+            }
+            return mapped;
+        }
+
         // FIX BUG #109: Unknown types returned as-is without validation
         // TODO: Validate that lppType is:
         // - A defined class/struct name
@@ -1371,6 +1603,32 @@ namespace lpp
         return op;
     }
 
+    std::string Transpiler::patternTemplate(const ClassDecl &node, const std::string &base)
+    {
+        // Type arguments split at top-level commas, each mapped to C++
+        std::string args = node.name;
+        size_t start = 0;
+        int depth = 0;
+        for (size_t i = 0; i <= node.patternArgument.size(); i++)
+        {
+            char c = i < node.patternArgument.size() ? node.patternArgument[i] : ',';
+            if (c == '<')
+                depth++;
+            else if (c == '>')
+                depth--;
+            else if (c == ',' && depth == 0)
+            {
+                std::string arg = node.patternArgument.substr(start, i - start);
+                arg.erase(0, arg.find_first_not_of(' '));
+                arg.erase(arg.find_last_not_of(' ') + 1);
+                if (!arg.empty())
+                    args += ", " + mapType(arg);
+                start = i + 1;
+            }
+        }
+        return "lpp::patterns::" + base + "<" + args + ">";
+    }
+
     std::string Transpiler::convertMethodSignature(const std::string &lppSignature)
     {
         // Convert "draw() -> void" to "void draw()"
@@ -1441,8 +1699,9 @@ namespace lpp
         // TODO: Track if wildcard (_) pattern encountered
         // Any patterns after _ are unreachable
         // Example: match x { _ -> "default", 1 -> "one" } // 1 unreachable
+        CodeStats::Span span(stats, output, "match", node.line);
 
-        std::string matchVar = "__match_" + std::to_string(matchCounter++);
+        std::string matchVar = "__match_" + uniqueSuffix(matchCounter);
         output << "([&]() { auto " << matchVar << " = ";
         node.expression->accept(*this);
         output << "; ";
@@ -1468,23 +1727,53 @@ namespace lpp
 
     void Transpiler::visit(ClassDecl &node)
     {
+        CodeStats::Span span(stats, output, "class", node.line, node.name);
+
+        // autopattern: one instantiation of the pattern's template in
+        // lpp_patterns.hpp instead of a generated class body
+        if (node.autoPattern)
+        {
+            CodeStats::Span pattern(stats, output, "autopattern", node.line);
+            std::string base = node.designPattern;
+            if (base == "Factory" && !node.patternArgument.empty())
+            {
+                base = "PooledFactory";
+            }
+            writeLine("class " + node.name + " : public " + patternTemplate(node, base) + " {};");
+            return;
+        }
+
+        // @pattern classes with a template in lpp_patterns.hpp derive from it
+        // like autopattern classes; untyped observers and flyweights use its
+        // default std::string argument
+        std::string patternBase;
+        if (node.designPattern == "Observer" || node.designPattern == "Flyweight" ||
+            (node.designPattern == "ObjectPool" && !node.patternArgument.empty()))
+        {
+            patternBase = patternTemplate(node, node.designPattern);
+        }
+        else if (node.designPattern == "Factory" && !node.patternArgument.empty())
+        {
+            patternBase = patternTemplate(node, "PooledFactory");
+        }
+
         // Class declaration
-        writeLine("class " + node.name + (node.baseClass.empty() ? "" : " : public " + node.baseClass) + " {");
+        std::string bases;
+        if (!node.baseClass.empty())
+            bases = "public " + node.baseClass;
+        if (!patternBase.empty())
+            bases += (bases.empty() ? "public " : ", public ") + patternBase;
+        writeLine("class " + node.name + (bases.empty() ? "" : " : " + bases) + " {");
 
         // If design pattern is specified, inject pattern code
         if (!node.designPattern.empty())
         {
             writeLine("// AUTO-GENERATED: " + node.designPattern + " Pattern");
-            writeLine("#include \"lpp_patterns.hpp\"");
 
             if (node.designPattern == "Singleton")
             {
                 writeLine("LPP_PATTERN_SINGLETON(" + node.name + ")");
             }
-            else if (node.designPattern == "Observer")
-            {
-                writeLine("LPP_PATTERN_OBSERVER(" + node.name + ")");
-            }
             else if (node.designPattern == "Builder")
             {
                 writeLine("LPP_PATTERN_BUILDER(" + node.name + ")");
@@ -1506,6 +1795,8 @@ namespace lpp
         }
         writeLine("");
 
+        inClass = true;
+
         // Constructor
         if (node.constructor)
         {
@@ -1520,6 +1811,7 @@ namespace lpp
             writeLine("");
         }
 
+        inClass = false;
         indentLevel--;
         writeLine("};");
     }
@@ -1598,19 +1890,251 @@ namespace lpp
         writeLine("");
     }
 
+    // Kernel for a two-parameter reduce lambda of one of the shapes
+    //   acc + x    acc * x    acc && x    acc || x
+    //   ?acc < x -> acc $ x   (min)       ?acc > x -> acc $ x   (max)
+    // Parameters must be untyped: typed ones would convert every element.
+    std::string Transpiler::reduceKernelName(Expression *fn)
+    {
+        auto *lambda = dynamic_cast<LambdaExpr *>(fn);
+        if (!lambda || lambda->hasRestParam || lambda->parameters.size() != 2)
+            return "";
+        const auto &acc = lambda->parameters[0];
+        const auto &item = lambda->parameters[1];
+        if (!acc.second.empty() || !item.second.empty() || acc.first == item.first)
+            return "";
+
+        auto isName = [](Expression *expr, const std::string &name)
+        {
+            auto *ident = dynamic_cast<IdentifierExpr *>(expr);
+            return ident && ident->name == name;
+        };
+
+        if (auto *binary = dynamic_cast<BinaryExpr *>(lambda->body.get()))
+        {
+            if (!isName(binary->left.get(), acc.first) || !isName(binary->right.get(), item.first))
+                return "";
+            if (binary->op == "+")
+                return "reduceSum";
+            if (binary->op == "*")
+                return "reduceProduct";
+            if (binary->op == "&&" || binary->op == "and")
+                return "reduceAll";
+            if (binary->op == "||" || binary->op == "or")
+                return "reduceAny";
+            return "";
+        }
+
+        if (auto *ternary = dynamic_cast<TernaryIfExpr *>(lambda->body.get()))
+        {
+            auto *cond = dynamic_cast<BinaryExpr *>(ternary->condition.get());
+            if (!cond || !isName(cond->left.get(), acc.first) || !isName(cond->right.get(), item.first) ||
+                !isName(ternary->thenExpr.get(), acc.first) || !isName(ternary->elseExpr.get(), item.first))
+                return "";
+            if (cond->op == "<")
+                return "reduceMin";
+            if (cond->op == ">")
+                return "reduceMax";
+        }
+        return "";
+    }
+
+    // One-parameter lambda whose body is +, -, *, /, % and unary minus over
+    // numbers and names (no calls, so nothing to keep in order)
+    bool Transpiler::isArithmeticMapLambda(Expression *fn)
+    {
+        auto *lambda = dynamic_cast<LambdaExpr *>(fn);
+        return lambda && !lambda->hasRestParam && lambda->parameters.size() == 1 &&
+               isArithmeticExpr(lambda->body.get());
+    }
+
+    bool Transpiler::isArithmeticExpr(Expression *expr)
+    {
+        if (dynamic_cast<NumberExpr *>(expr) || dynamic_cast<IdentifierExpr *>(expr))
+            return true;
+        if (auto *unary = dynamic_cast<UnaryExpr *>(expr))
+            return (unary->op == "-" || unary->op == "+") && isArithmeticExpr(unary->operand.get());
+        if (auto *binary = dynamic_cast<BinaryExpr *>(expr))
+        {
+            const std::string &op = binary->op;
+            return (op == "+" || op == "-" || op == "*" || op == "/" || op == "%") &&
+                   isArithmeticExpr(binary->left.get()) && isArithmeticExpr(binary->right.get());
+        }
+        return false;
+    }
+
+    uint64_t Transpiler::moleculeNameHash(const std::string &name, uint64_t seed)
+    {
+        // Must match lpp::stdlib::detail::moleculeNameHash
+        uint64_t h = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+        for (char c : name)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 32;
+        return h;
+    }
+
+    // Hash-and-displace: names go to buckets by hash(name, 0); each bucket
+    // (largest first) searches for a seed d that sends all its names to free
+    // slots via hash(name, d). Grows the slot table if a bucket gets stuck.
+    void Transpiler::buildMoleculePerfectHash(const std::vector<std::string> &names,
+                                              std::vector<uint64_t> &displacements,
+                                              std::vector<uint32_t> &slots)
+    {
+        static constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+        static constexpr uint64_t MAX_SEED = 1u << 16;
+
+        const size_t bucketCount = std::max<size_t>(1, names.size() / 2);
+        std::vector<std::vector<uint32_t>> buckets(bucketCount);
+        for (uint32_t id = 0; id < names.size(); id++)
+        {
+            buckets[moleculeNameHash(names[id], 0) % bucketCount].push_back(id);
+        }
+        std::vector<size_t> order(bucketCount);
+        for (size_t b = 0; b < bucketCount; b++)
+        {
+            order[b] = b;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                         { return buckets[a].size() > buckets[b].size(); });
+
+        for (size_t slotCount = std::max<size_t>(1, names.size());; slotCount += slotCount / 8 + 1)
+        {
+            slots.assign(slotCount, EMPTY_SLOT);
+            displacements.assign(bucketCount, 1);
+            bool placedAll = true;
+
+            for (size_t b : order)
+            {
+                if (buckets[b].empty())
+                {
+                    continue;
+                }
+                bool placed = false;
+                std::vector<size_t> taken;
+                for (uint64_t seed = 1; seed <= MAX_SEED && !placed; seed++)
+                {
+                    taken.clear();
+                    placed = true;
+                    for (uint32_t id : buckets[b])
+                    {
+                        size_t slot = moleculeNameHash(names[id], seed) % slotCount;
+                        if (slots[slot] != EMPTY_SLOT ||
+                            std::find(taken.begin(), taken.end(), slot) != taken.end())
+                        {
+                            placed = false;
+                            break;
+                        }
+                        taken.push_back(slot);
+                    }
+                    if (placed)
+                    {
+                        displacements[b] = seed;
+                        for (size_t k = 0; k < taken.size(); k++)
+                        {
+                            slots[taken[k]] = buckets[b][k];
+                        }
+                    }
+                }
+                if (!placed)
+                {
+                    placedAll = false;
+                    break;
+                }
+            }
+            if (placedAll)
+            {
+                return;
+            }
+        }
+    }
+
     void Transpiler::visit(MoleculeDecl &node)
     {
-        // Generate Molecule instance: mol Graph { A - B; } -> Molecule<std::string> Graph;
+        // mol Graph { A - B; } -> constexpr CSR data + StaticMolecule<__mol_Graph> Graph.
+        // Atom IDs follow declaration order; names resolve through a perfect hash,
+        // so nothing is hashed or allocated at startup.
         writeLine("// Molecule: " + node.name);
-        writeLine("Molecule<std::string> " + node.name + ";");
+        if (node.atoms.empty())
+        {
+            writeLine("Molecule<std::string> " + node.name + ";");
+            return;
+        }
 
-        // Add atoms
+        std::map<std::string, uint32_t> ids;
         for (const auto &atom : node.atoms)
         {
-            writeLine(node.name + ".addAtom(\"" + atom + "\");");
+            ids.emplace(atom, static_cast<uint32_t>(ids.size()));
+        }
+
+        // Adjacency with the same edge semantics as Molecule::addBond
+        std::vector<std::vector<std::pair<uint32_t, double>>> adjacency(node.atoms.size());
+        bool directed = false;
+        bool weighted = false;
+        for (const auto &bond : node.bonds)
+        {
+            uint32_t from = ids[bond.from];
+            uint32_t to = ids[bond.to];
+            adjacency[from].emplace_back(to, bond.weight);
+            if (bond.type == BondType::ARROW)
+            {
+                directed = true;
+            }
+            else
+            {
+                adjacency[to].emplace_back(from, bond.weight);
+            }
+            weighted = weighted || (bond.weighted && bond.weight != 1.0);
+        }
+
+        auto formatWeight = [](double weight)
+        {
+            std::ostringstream text;
+            text << std::setprecision(std::numeric_limits<double>::max_digits10) << weight;
+            return text.str();
+        };
+
+        // static constexpr T name[] = { ... }; wrapped perLine items per line
+        auto writeArray = [this](const std::string &decl, const std::vector<std::string> &items, size_t perLine = 16)
+        {
+            writeLine(decl + " = {");
+            indentLevel++;
+            for (size_t i = 0; i < items.size(); i += perLine)
+            {
+                std::string line;
+                for (size_t k = i; k < std::min(items.size(), i + perLine); k++)
+                {
+                    line += items[k] + (k + 1 < items.size() ? "," : "");
+                    if (k + 1 < std::min(items.size(), i + perLine))
+                    {
+                        line += " ";
+                    }
+                }
+                writeLine(line);
+            }
+            indentLevel--;
+            writeLine("};");
+        };
+
+        std::vector<std::string> names, offsets, targets, weights, bonds;
+        offsets.push_back("0");
+        size_t edgeCount = 0;
+        for (size_t id = 0; id < node.atoms.size(); id++)
+        {
+            names.push_back("\"" + node.atoms[id] + "\"");
+            for (const auto &edge : adjacency[id])
+            {
+                targets.push_back(std::to_string(edge.first));
+                weights.push_back(formatWeight(edge.second));
+            }
+            edgeCount += adjacency[id].size();
+            offsets.push_back(std::to_string(edgeCount));
         }
 
-        // Add bonds
         for (const auto &bond : node.bonds)
         {
             std::string bondTypeStr;
@@ -1629,9 +2153,49 @@ namespace lpp
                 bondTypeStr = "BondType::BIDIRECTIONAL";
                 break;
             }
-            writeLine(node.name + ".addBond(\"" + bond.from + "\", \"" + bond.to + "\", " + bondTypeStr + ");");
+            bonds.push_back("{" + std::to_string(ids[bond.from]) + ", " + std::to_string(ids[bond.to]) + ", " +
+                            bondTypeStr + ", " + formatWeight(bond.weight) + "}");
         }
-        writeLine("");
+
+        std::vector<uint64_t> displacements;
+        std::vector<uint32_t> slots;
+        buildMoleculePerfectHash(node.atoms, displacements, slots);
+        std::vector<std::string> displacementItems, slotItems;
+        for (uint64_t d : displacements)
+        {
+            displacementItems.push_back(std::to_string(d));
+        }
+        for (uint32_t slot : slots)
+        {
+            slotItems.push_back(slot == 0xFFFFFFFFu ? "MoleculeCsr::NO_ATOM" : std::to_string(slot));
+        }
+
+        std::string dataName = "__mol_" + node.name;
+        writeLine("struct " + dataName);
+        writeLine("{");
+        indentLevel++;
+        writeLine("static constexpr size_t atomCount = " + std::to_string(node.atoms.size()) + ";");
+        writeLine("static constexpr size_t bondCount = " + std::to_string(node.bonds.size()) + ";");
+        writeLine(std::string("static constexpr bool directed = ") + (directed ? "true" : "false") + ";");
+        writeArray("static constexpr std::string_view names[]", names);
+        writeArray("static constexpr size_t offsets[]", offsets);
+        writeArray("static constexpr MoleculeCsr::AtomId targets[]", targets);
+        if (weighted)
+        {
+            writeArray("static constexpr double weights[]", weights);
+        }
+        else
+        {
+            writeLine("static constexpr const double *weights = nullptr;");
+        }
+        writeArray("static constexpr StaticBond bonds[]", bonds, 4);
+        writeLine("static constexpr size_t bucketCount = " + std::to_string(displacements.size()) + ";");
+        writeArray("static constexpr uint64_t displacements[]", displacementItems);
+        writeLine("static constexpr size_t slotCount = " + std::to_string(slots.size()) + ";");
+        writeArray("static constexpr MoleculeCsr::AtomId slots[]", slotItems);
+        indentLevel--;
+        writeLine("};");
+        writeLine("constexpr StaticMolecule<" + dataName + "> " + node.name + "{};");
     }
 
     // NEW IMPLEMENTATIONS - Cast, Await, Throw
@@ -1659,6 +2223,50 @@ namespace lpp
         output << ").get()"; // Assuming std::future
     }
 
+    void Transpiler::visit(SpawnExpr &node)
+    {
+        // spawn f(a, b) => scope.spawn([&, __arg0 = (a), __arg1 = (b)]() mutable
+        //                      { return f(std::move(__arg0), std::move(__arg1)); })
+        // The arguments are copied at the spawn, so loop variables and locals
+        // of the block are safe to pass. Inside scope { } everything else is
+        // shared by reference (the block outlives the task); an unscoped task
+        // may outlive the function and works on copies.
+        CallExpr *call = node.call();
+        if (!call)
+        {
+            throw std::runtime_error("spawn expects a function or method call");
+        }
+
+        // Arena memory may be released before the task runs
+        std::vector<std::string> savedArenas;
+        savedArenas.swap(arenaStack);
+
+        if (scopeStack.empty())
+            output << "lpp::stdlib::spawn([=";
+        else
+            output << scopeStack.back() << ".spawn([&";
+        for (size_t i = 0; i < call->arguments.size(); i++)
+        {
+            output << ", __arg" << i << " = (";
+            call->arguments[i]->accept(*this);
+            output << ")";
+        }
+        output << "]() mutable { return ";
+        if (auto *method = dynamic_cast<IndexExpr *>(node.expression.get()))
+        {
+            method->object->accept(*this);
+            output << ".";
+        }
+        output << call->function << "(";
+        for (size_t i = 0; i < call->arguments.size(); i++)
+        {
+            output << (i > 0 ? ", " : "") << "std::move(__arg" << i << ")";
+        }
+        output << "); })";
+
+        arenaStack.swap(savedArenas);
+    }
+
     void Transpiler::visit(ThrowExpr &node)
     {
         indent();
@@ -1701,6 +2309,7 @@ namespace lpp
     void Transpiler::visit(QuantumMethodCall &node)
     {
         // quantum methods: observe(), map(fn), reset(), entangle(fn)
+        CodeStats::Span span(stats, output, "quantum", node.line);
         if (node.method == "observe")
         {
             output << node.quantumVar << ".observe()";
@@ -1794,6 +2403,31 @@ namespace lpp
         output << "}\n";
     }
 
+    void Transpiler::visit(ParallelForStmt &node)
+    {
+        // parallel for (x in xs) { body } => parallelForEach(xs, [&](auto x) { body });
+        // The race check in StaticAnalyzer keeps the body from writing
+        // anything it shares with other iterations
+        indent();
+        output << "lpp::stdlib::parallelForEach(";
+        node.iterable->accept(*this);
+        output << ", [&](auto " << node.variable << ") {\n";
+
+        // Arena regions are single-threaded; iterations allocate normally
+        std::vector<std::string> savedArenas;
+        savedArenas.swap(arenaStack);
+        indentLevel++;
+        for (auto &stmt : node.body)
+        {
+            stmt->accept(*this);
+        }
+        indentLevel--;
+        arenaStack.swap(savedArenas);
+
+        indent();
+        output << "});\n";
+    }
+
     void Transpiler::visit(DoWhileStmt &node)
     {
         indent();
@@ -1812,6 +2446,52 @@ namespace lpp
         output << ");\n";
     }
 
+    void Transpiler::visit(ArenaStmt &node)
+    {
+        // arena { ... } => a C++ block owning a monotonic region; everything
+        // allocated from it is released in one shot at the closing brace
+        indent();
+        output << "{\n";
+
+        indentLevel++;
+        beginArena();
+        for (auto &stmt : node.body)
+        {
+            stmt->accept(*this);
+        }
+        arenaStack.pop_back();
+        indentLevel--;
+
+        indent();
+        output << "}\n";
+    }
+
+    void Transpiler::visit(ScopeStmt &node)
+    {
+        // scope { ... } => a C++ block owning a TaskScope; join() at the end
+        // waits for the spawned tasks and rethrows the first failure, and the
+        // TaskScope destructor still waits if the block is left early
+        const std::string name = "__scope_" + uniqueSuffix(scopeCounter);
+        indent();
+        output << "{\n";
+
+        indentLevel++;
+        indent();
+        output << "lpp::stdlib::TaskScope " << name << ";\n";
+        scopeStack.push_back(name);
+        for (auto &stmt : node.body)
+        {
+            stmt->accept(*this);
+        }
+        scopeStack.pop_back();
+        indent();
+        output << name << ".join();\n";
+        indentLevel--;
+
+        indent();
+        output << "}\n";
+    }
+
     // NEW IMPLEMENTATIONS - TryCatch
     void Transpiler::visit(TryCatchStmt &node)
     {
@@ -4,18 +4,46 @@
 #include <string>
 #include <cstdlib>
 #include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <optional>
+#include <vector>
+#include <set>
+#include <cctype>
+#include <future>
+#include <atomic>
+#include <thread>
 #include <filesystem> // BUG #334 fix: for canonical path validation
 #include "Lexer.h"
 #include "Parser.h"
 #include "Transpiler.h"
 #include "StaticAnalyzer.h"
+#include "EffectAnalyzer.h"
+#include "BuildProfile.h"
+#include "PackageManager.h"
+#include "StdlibCache.h"
+#include "CodeStats.h"
 
 void printUsage(const char *programName)
 {
     std::cout << "Usage: " << programName << " <input.lpp> [-o <output>]\n";
+    std::cout << "       " << programName << " --unity [--units <n>] <a.lpp> <b.lpp> ... [-o <output>]\n";
     std::cout << "Options:\n";
     std::cout << "  -o <output>   Specify output executable name (default: a.out)\n";
     std::cout << "  -c            Generate C++ only (no compilation)\n";
+    std::cout << "  --effects     Print the inferred effects of every function and lambda\n";
+    std::cout << "  --profile <name>\n";
+    std::cout << "                Build profile: debug, release, release-native, size\n";
+    std::cout << "                (default: \"profile\" in package.lpp, else chosen by paradigm)\n";
+    std::cout << "  --pgo <stage> Profile-guided optimization: generate or use\n";
+    std::cout << "  --time-report Print time spent in each compiler phase\n";
+    std::cout << "  --emit-stats  Write lambdas, IIFEs, template hints and bytes of generated\n";
+    std::cout << "                C++ per function, construct and source line to <input>.stats.json\n";
+    std::cout << "  --no-pch      Parse lpp_stdlib.hpp in every compile instead of using\n";
+    std::cout << "                the cached precompiled copy\n";
+    std::cout << "  --unity       Merge all input modules into jumbo translation units\n";
+    std::cout << "  --units <n>   Number of jumbo units, compiled in parallel up to one per core\n";
+    std::cout << "                (default: 1)\n";
     std::cout << "  --help        Show this help message\n";
 }
 
@@ -44,52 +72,69 @@ void writeFile(const std::string &filename, const std::string &content)
     file << content;
 }
 
-int main(int argc, char *argv[])
+// Settings from the command line
+struct CompileOptions
 {
-    std::cout << "L++ Compiler v0.8.19\n\n";
-
-    if (argc < 2)
-    {
-        printUsage(argv[0]);
-        return 1;
-    }
-
-    std::string inputFile;
+    std::vector<std::string> inputFiles;
     std::string outputFile = "a.out";
     bool compileOnly = false;
+    bool dumpEffects = false;
+    bool timeReport = false;
+    bool emitStats = false;
+    bool unity = false;
+    bool precompiledStdlib = true;
+    size_t units = 1;
+    std::optional<lpp::BuildProfile> profile;
+    lpp::PgoMode pgo = lpp::PgoMode::NONE;
+};
+
+// Wall time per compiler phase for --time-report. Phases with the same
+// name (one per module in a unity build) are added up.
+struct PhaseTimer
+{
+    using Clock = std::chrono::steady_clock;
 
-    // Parse arguments
-    for (int i = 1; i < argc; i++)
-    {
-        std::string arg = argv[i];
+    bool enabled = false;
+    std::vector<std::pair<std::string, double>> phases;
+    Clock::time_point start = Clock::now();
 
-        if (arg == "--help")
-        {
-            printUsage(argv[0]);
-            return 0;
-        }
-        else if (arg == "-o" && i + 1 < argc)
-        {
-            outputFile = argv[++i];
-        }
-        else if (arg == "-c")
-        {
-            compileOnly = true;
-        }
-        else if (inputFile.empty())
+    void end(const std::string &name)
+    {
+        Clock::time_point now = Clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - start).count();
+        start = now;
+        for (auto &phase : phases)
         {
-            inputFile = arg;
+            if (phase.first == name)
+            {
+                phase.second += ms;
+                return;
+            }
         }
+        phases.emplace_back(name, ms);
     }
 
-    if (inputFile.empty())
+    void print(const std::string &profile) const
     {
-        std::cerr << "Error: No input file specified\n";
-        printUsage(argv[0]);
-        return 1;
+        if (!enabled)
+            return;
+        double total = 0;
+        std::cout << "\nTime report (profile: " << profile << ")\n";
+        for (const auto &phase : phases)
+        {
+            std::cout << "  " << std::left << std::setw(20) << phase.first << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(10) << phase.second << " ms\n";
+            total += phase.second;
+        }
+        std::cout << "  " << std::left << std::setw(20) << "total" << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(10) << total << " ms\n";
     }
+};
 
-    std::cout << "LPP Compiler v0.8.18\n";
+// Lex, parse, analyze and infer effects for one file. Diagnostics go to
+// stderr; returns nullptr if the file has parse or analysis errors.
+std::unique_ptr<lpp::Program> analyzeFile(const std::string &inputFile, bool dumpEffects, PhaseTimer &timer)
+{
     std::cout << "Compiling: " << inputFile << "\n";
 
     // Read source code
@@ -99,23 +144,26 @@ int main(int argc, char *argv[])
     std::cout << "Lexing...\n";
     lpp::Lexer lexer(source);
     std::vector<lpp::Token> tokens = lexer.tokenize();
+    timer.end("lex");
 
     // Parsing
     std::cout << "Parsing...\n";
     lpp::Parser parser(tokens, source); // Pass source code for better error messages
     std::unique_ptr<lpp::Program> ast = parser.parse();
+    timer.end("parse");
 
     // Check for parse errors
     if (parser.hasErrors())
     {
         std::cerr << "\nParsing failed with " << parser.getErrors().size() << " error(s).\n";
-        return 1;
+        return nullptr;
     }
 
     // Static analysis
     std::cout << "Running static analysis...\n";
     lpp::StaticAnalyzer analyzer;
     std::vector<lpp::AnalysisIssue> issues = analyzer.analyze(*ast);
+    timer.end("static analysis");
 
     // Report issues in standard compiler format
     int errorCount = 0;
@@ -181,6 +229,12 @@ int main(int argc, char *argv[])
         case lpp::IssueType::PARADIGM_GOLF_ENCOURAGED:
             std::cerr << "PARADIGM-GOLF";
             break;
+        case lpp::IssueType::ARENA_ESCAPE:
+            std::cerr << "ARENA-ESCAPE";
+            break;
+        case lpp::IssueType::DATA_RACE:
+            std::cerr << "DATA-RACE";
+            break;
         default:
             std::cerr << "UNKNOWN";
         }
@@ -207,7 +261,7 @@ int main(int argc, char *argv[])
     {
         std::cerr << "\nAnalysis failed with " << errorCount << " error(s) and "
                   << warningCount << " warning(s)\n";
-        return 1;
+        return nullptr;
     }
 
     if (warningCount > 0)
@@ -219,39 +273,448 @@ int main(int argc, char *argv[])
         std::cout << "✓ Analysis passed with no issues\n";
     }
 
+    // Effect inference: marks parallel map/filter/reduce and memoized functions
+    lpp::EffectAnalyzer effects;
+    effects.analyze(*ast);
+    timer.end("effect inference");
+    if (dumpEffects)
+    {
+        effects.dump(std::cout);
+    }
+
+    return ast;
+}
+
+// Build profile: --profile, then package.lpp next to the input, then the
+// default for the file's paradigm
+bool selectProfile(const CompileOptions &options, const std::string &inputFile, lpp::ParadigmMode paradigm,
+                   lpp::BuildProfile &profile)
+{
+    profile = lpp::BuildProfile::defaultFor(paradigm);
+    std::filesystem::path manifestPath = std::filesystem::path(inputFile).parent_path() / "package.lpp";
+    if (options.profile)
+    {
+        profile = *options.profile;
+    }
+    else if (std::filesystem::exists(manifestPath))
+    {
+        lpp::PackageManifest manifest = lpp::PackageManager::loadManifest(manifestPath.string());
+        if (!manifest.profile.empty())
+        {
+            std::optional<lpp::BuildProfile> named = lpp::BuildProfile::fromName(manifest.profile);
+            if (!named)
+            {
+                std::cerr << manifestPath.string() << ": error: Unknown build profile '" << manifest.profile
+                          << "'. Expected: debug, release, release-native, size\n";
+                return false;
+            }
+            profile = *named;
+        }
+    }
+    profile.pgo = options.pgo;
+    return true;
+}
+
+// BUG #334 fix: Validate paths before they reach the shell
+bool isValidPath(const std::string &path)
+{
+    return path.find("..") == std::string::npos &&
+           path.find(';') == std::string::npos &&
+           path.find('|') == std::string::npos &&
+           path.find('&') == std::string::npos &&
+           path.find('`') == std::string::npos &&
+           path.find('$') == std::string::npos &&
+           !path.empty();
+}
+
+// Quote a path for the shell command (Windows/Unix)
+std::string quotePath(const std::string &path)
+{
+#ifdef _WIN32
+    return "\"" + path + "\"";
+#else
+    return "'" + path + "'";
+#endif
+}
+
+// The generated code includes "../stdlib/lpp_stdlib.hpp" relative to itself
+std::string stdlibDirectory(const std::string &cppFile)
+{
+    return (std::filesystem::path(cppFile).parent_path() / ".." / "stdlib").string();
+}
+
+// ' -include <prelude>' for the cached precompiled stdlib (see
+// StdlibCache.h), or "" to compile against the headers directly. PGO builds
+// always use the headers: both stages must see the stdlib at the same path,
+// or the profile no longer matches the code.
+std::string stdlibPrelude(const CompileOptions &options, const std::string &cppFile,
+                          const lpp::BuildProfile &profile, PhaseTimer &timer)
+{
+    if (!options.precompiledStdlib || profile.pgo != lpp::PgoMode::NONE)
+    {
+        return "";
+    }
+    std::filesystem::path header = std::filesystem::path(stdlibDirectory(cppFile)) / "lpp_stdlib.hpp";
+    std::optional<std::string> prelude = lpp::StdlibCache::prepare(
+        header.string(), "-std=c++17 " + profile.compilerFlags(), lpp::Transpiler::preludeHeaders());
+    timer.end("stdlib prelude");
+    return prelude ? " -include " + quotePath(*prelude) : "";
+}
+
+// lppc --unity: each module is analyzed on its own, then all of them are
+// concatenated into a few jumbo translation units. The prelude and
+// lpp_stdlib.hpp are parsed once per unit instead of once per module, and
+// calls between modules of one unit can inline without LTO. Units are
+// compiled concurrently and then linked.
+int buildUnity(const CompileOptions &options, PhaseTimer &timer)
+{
+    std::vector<std::unique_ptr<lpp::Program>> modules;
+    bool failed = false;
+    for (const auto &inputFile : options.inputFiles)
+    {
+        modules.push_back(analyzeFile(inputFile, options.dumpEffects, timer));
+        failed = failed || !modules.back();
+    }
+    if (failed)
+    {
+        std::cerr << "\nUnity build failed: not all modules compiled\n";
+        return 1;
+    }
+
+    // Module tags: the file stem as an identifier, numbered when two modules
+    // in different directories share a stem
+    std::set<std::string> stems;
+    std::vector<std::string> tags;
+    std::set<std::string> usedTags;
+    for (size_t i = 0; i < options.inputFiles.size(); i++)
+    {
+        std::string stem = std::filesystem::path(options.inputFiles[i]).stem().string();
+        stems.insert(stem);
+        std::string tag = stem;
+        for (char &c : tag)
+        {
+            if (!std::isalnum(static_cast<unsigned char>(c)))
+                c = '_';
+        }
+        if (usedTags.count(tag))
+            tag += "_" + std::to_string(i);
+        usedTags.insert(tag);
+        tags.push_back(tag);
+    }
+
+    std::cout << "Transpiling " << modules.size() << " module(s) to C++...\n";
+    lpp::Transpiler transpiler;
+    transpiler.setUnityModules(stems);
+    lpp::CodeStats stats;
+    if (options.emitStats)
+        transpiler.setStats(&stats);
+    std::vector<std::string> bodies;
+    std::string declarations;
+    size_t totalSize = 0;
+    for (size_t i = 0; i < modules.size(); i++)
+    {
+        transpiler.setModuleTag(tags[i]);
+        declarations += transpiler.transpileDeclarations(*modules[i]);
+        stats.beginModule(options.inputFiles[i]);
+        bodies.push_back(transpiler.transpileModule(*modules[i]));
+        totalSize += bodies.back().size();
+    }
+
+    // Contiguous runs of modules of about equal generated size per unit
+    const size_t unitCount = std::max<size_t>(1, std::min(options.units, modules.size()));
+    std::vector<std::vector<size_t>> unitModules(unitCount);
+    size_t before = 0;
+    for (size_t i = 0; i < modules.size(); i++)
+    {
+        const size_t middle = before + bodies[i].size() / 2;
+        const size_t unit = std::min(unitCount - 1, totalSize ? middle * unitCount / totalSize : 0);
+        unitModules[unit].push_back(i);
+        before += bodies[i].size();
+    }
+    unitModules.erase(std::remove_if(unitModules.begin(), unitModules.end(),
+                                     [](const std::vector<size_t> &unit)
+                                     { return unit.empty(); }),
+                      unitModules.end());
+
+    // Units live next to the first input so the prelude's ../stdlib include resolves
+    const std::filesystem::path unitDir = std::filesystem::path(options.inputFiles.front()).parent_path();
+    const std::string unitStem = std::filesystem::path(options.outputFile).filename().string();
+    std::vector<std::string> unitFiles;
+    std::string allCode;
+    for (size_t u = 0; u < unitModules.size(); u++)
+    {
+        bool withPatterns = false;
+        for (size_t i : unitModules[u])
+            withPatterns = withPatterns || lpp::Transpiler::usesPatterns(*modules[i]);
+
+        std::string code = transpiler.transpilePrelude(withPatterns);
+        code += "// Functions of all modules in this build\n" + declarations + "\n";
+        for (size_t i : unitModules[u])
+            code += "// ===== module " + options.inputFiles[i] + " =====\n" + bodies[i] + "\n";
+
+        std::string unitFile = (unitDir / (unitStem + ".unity" + std::to_string(u) + ".cpp")).string();
+        writeFile(unitFile, code);
+        std::cout << "Generated: " << unitFile << " (" << unitModules[u].size() << " module(s))\n";
+        unitFiles.push_back(unitFile);
+        allCode += code;
+    }
+    if (options.emitStats)
+    {
+        const std::string statsFile = (unitDir / (unitStem + ".stats.json")).string();
+        writeFile(statsFile, stats.toJson());
+        std::cout << "Stats: " << statsFile << "\n";
+    }
+    timer.end("transpile");
+
+    std::string reportProfile = "-";
+    if (options.compileOnly)
+    {
+        std::cout << "Compilation skipped (-c flag)\n";
+        timer.print(reportProfile);
+        return 0;
+    }
+
+    // The module with main() decides the paradigm default
+    size_t mainModule = 0;
+    for (size_t i = 0; i < modules.size(); i++)
+    {
+        for (const auto &func : modules[i]->functions)
+        {
+            if (func->name == "main")
+                mainModule = i;
+        }
+    }
+    lpp::BuildProfile profile;
+    if (!selectProfile(options, options.inputFiles[mainModule], modules[mainModule]->paradigm, profile))
+    {
+        return 1;
+    }
+    reportProfile = profile.describe();
+
+    if (!isValidPath(options.outputFile) ||
+        !std::all_of(unitFiles.begin(), unitFiles.end(), isValidPath))
+    {
+        std::cerr << "Error: Invalid file path detected\n";
+        return 1;
+    }
+
+    // One unit compiles and links in one step; several compile to objects
+    // in parallel and link afterwards
+    const std::string flags = " -std=c++17 " + profile.compilerFlags();
+    const std::string prelude = stdlibPrelude(options, unitFiles.front(), profile, timer);
+    std::vector<std::string> compileCommands;
+    std::string linkCommand = "g++";
+    if (unitFiles.size() == 1)
+    {
+        linkCommand += " " + quotePath(unitFiles[0]) + " -o " + quotePath(options.outputFile) + flags + prelude;
+    }
+    else
+    {
+        for (const auto &unitFile : unitFiles)
+        {
+            const std::string objectFile = unitFile + ".o";
+            compileCommands.push_back("g++ -c " + quotePath(unitFile) + " -o " + quotePath(objectFile) + flags + prelude);
+            linkCommand += " " + quotePath(objectFile);
+        }
+        linkCommand += " -o " + quotePath(options.outputFile) + flags;
+    }
+
+    std::string allCommands = linkCommand;
+    for (const auto &command : compileCommands)
+        allCommands += "\n" + command;
+    std::string cacheKey = lpp::BuildCache::computeKey(allCode, allCommands, profile, stdlibDirectory(unitFiles.front()));
+    if (options.pgo == lpp::PgoMode::NONE && lpp::BuildCache::isUpToDate(options.outputFile, cacheKey))
+    {
+        timer.end("backend (cached)");
+        std::cout << "Up to date: " << options.outputFile << " [" << cacheKey << "]\n";
+        timer.print(reportProfile);
+        return 0;
+    }
+
+    std::cout << "Compiling " << unitFiles.size() << " unit(s) with g++ (profile: " << profile.name << ")...\n";
+    // At most one g++ per core: each runs through the whole prelude, so
+    // more units than cores only adds memory pressure
+    const size_t jobs = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), compileCommands.size());
+    std::atomic<size_t> nextCommand{0};
+    std::vector<std::future<bool>> compiles;
+    for (size_t job = 0; job < jobs; job++)
+    {
+        compiles.push_back(std::async(std::launch::async, [&compileCommands, &nextCommand]()
+                                      {
+            bool ok = true;
+            for (size_t i = nextCommand++; i < compileCommands.size(); i = nextCommand++)
+                ok = system(compileCommands[i].c_str()) == 0 && ok;
+            return ok; }));
+    }
+    bool compiled = true;
+    for (auto &compile : compiles)
+        compiled = compile.get() && compiled;
+    timer.end("backend compile");
+
+    if (!compiled || system(linkCommand.c_str()) != 0)
+    {
+        std::cerr << "Error: Compilation failed\n";
+        return 1;
+    }
+    timer.end(compileCommands.empty() ? "backend compile" : "backend link");
+
+    lpp::BuildCache::store(options.outputFile, cacheKey, profile);
+    std::cout << "Success! Executable: " << options.outputFile << "\n";
+    timer.print(reportProfile);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    std::cout << "L++ Compiler v0.8.19\n\n";
+
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    CompileOptions options;
+
+    // Parse arguments
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--help")
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if (arg == "-o" && i + 1 < argc)
+        {
+            options.outputFile = argv[++i];
+        }
+        else if (arg == "-c")
+        {
+            options.compileOnly = true;
+        }
+        else if (arg == "--effects")
+        {
+            options.dumpEffects = true;
+        }
+        else if (arg == "--profile" && i + 1 < argc)
+        {
+            options.profile = lpp::BuildProfile::fromName(argv[++i]);
+            if (!options.profile)
+            {
+                std::cerr << "Error: Unknown build profile '" << argv[i]
+                          << "'. Expected: debug, release, release-native, size\n";
+                return 1;
+            }
+        }
+        else if (arg == "--pgo" && i + 1 < argc)
+        {
+            std::string stage = argv[++i];
+            if (stage == "generate")
+                options.pgo = lpp::PgoMode::GENERATE;
+            else if (stage == "use")
+                options.pgo = lpp::PgoMode::USE;
+            else
+            {
+                std::cerr << "Error: Expected 'generate' or 'use' after --pgo\n";
+                return 1;
+            }
+        }
+        else if (arg == "--time-report")
+        {
+            options.timeReport = true;
+        }
+        else if (arg == "--emit-stats")
+        {
+            options.emitStats = true;
+        }
+        else if (arg == "--no-pch")
+        {
+            options.precompiledStdlib = false;
+        }
+        else if (arg == "--unity")
+        {
+            options.unity = true;
+        }
+        else if (arg == "--units" && i + 1 < argc)
+        {
+            std::string count = argv[++i];
+            if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos || std::stoul(count) == 0)
+            {
+                std::cerr << "Error: Expected a positive number after --units\n";
+                return 1;
+            }
+            options.units = std::stoul(count);
+        }
+        else if (options.inputFiles.empty() || options.unity)
+        {
+            options.inputFiles.push_back(arg);
+        }
+    }
+
+    if (options.inputFiles.empty())
+    {
+        std::cerr << "Error: No input file specified\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::cout << "LPP Compiler v0.8.18\n";
+    PhaseTimer timer;
+    timer.enabled = options.timeReport;
+
+    if (options.unity)
+    {
+        return buildUnity(options, timer);
+    }
+
+    const std::string &inputFile = options.inputFiles.front();
+    const std::string &outputFile = options.outputFile;
+    std::unique_ptr<lpp::Program> ast = analyzeFile(inputFile, options.dumpEffects, timer);
+    if (!ast)
+    {
+        return 1;
+    }
+
     // Transpilation
     std::cout << "Transpiling to C++...\n";
     lpp::Transpiler transpiler;
+    lpp::CodeStats stats;
+    if (options.emitStats)
+    {
+        transpiler.setStats(&stats);
+        stats.beginModule(inputFile);
+    }
     std::string cppCode = transpiler.transpile(*ast);
+    timer.end("transpile");
 
     // Write generated C++ code
     std::string cppFile = inputFile + ".cpp";
     writeFile(cppFile, cppCode);
     std::cout << "Generated: " << cppFile << "\n";
+    if (options.emitStats)
+    {
+        writeFile(inputFile + ".stats.json", stats.toJson());
+        std::cout << "Stats: " << inputFile << ".stats.json\n";
+    }
 
-    if (compileOnly)
+    std::string reportProfile = "-";
+    if (options.compileOnly)
     {
         std::cout << "Compilation skipped (-c flag)\n";
+        timer.print(reportProfile);
         return 0;
     }
 
-    // Compile with g++ (or clang++)
-    std::cout << "Compiling with g++...\n";
-
-    // BUG #334 fix: Validate paths with filesystem canonical
-    std::string sanitizedOutput = outputFile;
-
-    auto isValidPath = [](const std::string &path)
+    lpp::BuildProfile profile;
+    if (!selectProfile(options, inputFile, ast->paradigm, profile))
     {
-        return path.find("..") == std::string::npos &&
-               path.find(';') == std::string::npos &&
-               path.find('|') == std::string::npos &&
-               path.find('&') == std::string::npos &&
-               path.find('`') == std::string::npos &&
-               path.find('$') == std::string::npos &&
-               !path.empty();
-    };
+        return 1;
+    }
+    reportProfile = profile.describe();
 
+    // Compile with g++ (or clang++)
     if (!isValidPath(cppFile) || !isValidPath(outputFile))
     {
         std::cerr << "Error: Invalid file path detected\n";
@@ -275,16 +738,26 @@ int main(int argc, char *argv[])
     }
 
     // Build command with proper quoting for Windows/Unix
-#ifdef _WIN32
-    std::string command = "g++ \"" + cppFile + "\" -o \"" + outputFile + "\" -std=c++17";
-#else
-    std::string command = "g++ '" + cppFile + "' -o '" + outputFile + "' -std=c++17";
-#endif
+    std::string command = "g++ " + quotePath(cppFile) + " -o " + quotePath(outputFile) + " -std=c++17 " +
+                          profile.compilerFlags() + stdlibPrelude(options, cppFile, profile, timer);
+
+    // PGO builds depend on .gcda files the key cannot see, so never reuse them
+    std::string cacheKey = lpp::BuildCache::computeKey(cppCode, command, profile, stdlibDirectory(cppFile));
+    if (options.pgo == lpp::PgoMode::NONE && lpp::BuildCache::isUpToDate(outputFile, cacheKey))
+    {
+        timer.end("backend (cached)");
+        std::cout << "Up to date: " << outputFile << " [" << cacheKey << "]\n";
+        timer.print(reportProfile);
+        return 0;
+    }
 
+    std::cout << "Compiling with g++ (profile: " << profile.name << ")...\n";
     int result = system(command.c_str());
+    timer.end("backend");
 
     if (result == 0)
     {
+        lpp::BuildCache::store(outputFile, cacheKey, profile);
         std::cout << "Success! Executable: " << outputFile << "\n";
     }
     else
@@ -293,5 +766,6 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    timer.print(reportProfile);
     return 0;
 }
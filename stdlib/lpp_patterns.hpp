@@ -10,11 +10,2035 @@
 // Example: std::unique_ptr<ClassName> ClassName::instance = nullptr;
 //          std::mutex ClassName::mutex;
 
+#include <algorithm>
+#include <any>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
 namespace lpp
 {
     namespace patterns
     {
 
+        // ===== EVENT BUS =====
+        // Typed publish/subscribe behind the Observer pattern.
+        //   subscribe(fn) -> id / unsubscribe(id)   copy-on-write subscriber list
+        //   publish(e) / publishBatch(events)       synchronous delivery
+        //   startAsync() / post(e) / flush()        delivery on a worker thread
+        // Publishing takes no lock: it pins the current subscriber list with
+        // a reader count and walks it. Subscribing copies the list and swaps
+        // the pointer in; replaced lists are freed once no publisher is
+        // inside. A batch pins the list once and hands each subscriber every
+        // event in turn.
+        template <typename Event>
+        class EventBus
+        {
+        public:
+            using Handler = std::function<void(const Event &)>;
+            using SubscriptionId = uint64_t;
+
+            EventBus() : current(new SubscriberList()) {}
+            EventBus(const EventBus &) = delete;
+            EventBus &operator=(const EventBus &) = delete;
+
+            ~EventBus()
+            {
+                stopAsync();
+                delete current.load();
+                for (auto *list : retired)
+                    delete list;
+            }
+
+            // Handlers take the event, or nothing for plain notifications
+            template <typename F>
+            SubscriptionId subscribe(F handler)
+            {
+                if constexpr (std::is_invocable<F &, const Event &>::value)
+                    return add(Handler(std::move(handler)));
+                else
+                    return add(Handler([handler = std::move(handler)](const Event &) mutable
+                                       { handler(); }));
+            }
+
+            bool unsubscribe(SubscriptionId id)
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                const SubscriberList &list = *current.load();
+                auto found = std::find_if(list.begin(), list.end(), [id](const Subscriber &s)
+                                          { return s.id == id; });
+                if (found == list.end())
+                    return false;
+                auto *next = new SubscriberList();
+                next->reserve(list.size() - 1);
+                for (const auto &subscriber : list)
+                {
+                    if (subscriber.id != id)
+                        next->push_back(subscriber);
+                }
+                replace(next);
+                return true;
+            }
+
+            size_t subscriberCount() const
+            {
+                ReadGuard guard(*this);
+                return guard.list->size();
+            }
+
+            void publish(const Event &event) const
+            {
+                ReadGuard guard(*this);
+                for (const auto &subscriber : *guard.list)
+                    subscriber.handler(event);
+            }
+
+            template <typename It>
+            void publishBatch(It first, It last) const
+            {
+                ReadGuard guard(*this);
+                for (const auto &subscriber : *guard.list)
+                {
+                    for (It it = first; it != last; ++it)
+                        subscriber.handler(*it);
+                }
+            }
+
+            void publishBatch(const std::vector<Event> &events) const
+            {
+                publishBatch(events.begin(), events.end());
+            }
+
+            // Async delivery: post() appends to a pending buffer and the worker
+            // swaps the whole buffer out and publishes it as one batch. Start
+            // and stop from one thread; handlers must not call flush().
+            void startAsync()
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (asyncRunning || worker.joinable())
+                    return;
+                stopping = false;
+                asyncRunning = true;
+                worker = std::thread([this]
+                                     { deliverLoop(); });
+            }
+
+            // Queued when async delivery is running, published inline otherwise
+            void post(Event event)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(queueMutex);
+                    if (asyncRunning)
+                    {
+                        // The worker only sleeps on an empty buffer
+                        const bool wake = pending.empty();
+                        pending.push_back(std::move(event));
+                        posted++;
+                        lock.unlock();
+                        if (wake)
+                            queueReady.notify_one();
+                        return;
+                    }
+                }
+                publish(event);
+            }
+
+            // Blocks until every event posted before the call is delivered
+            void flush()
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                const uint64_t target = posted;
+                drained.wait(lock, [&]
+                             { return delivered >= target || !asyncRunning; });
+            }
+
+            // Delivers what is still queued, then joins the worker
+            void stopAsync()
+            {
+                std::thread finished;
+                {
+                    std::lock_guard<std::mutex> lock(queueMutex);
+                    if (!worker.joinable())
+                        return;
+                    stopping = true;
+                    finished = std::move(worker);
+                }
+                queueReady.notify_one();
+                finished.join();
+            }
+
+        private:
+            struct Subscriber
+            {
+                SubscriptionId id;
+                Handler handler;
+            };
+            using SubscriberList = std::vector<Subscriber>;
+
+            // Pins the current list for the lifetime of the guard
+            struct ReadGuard
+            {
+                const EventBus &bus;
+                const SubscriberList *list;
+
+                explicit ReadGuard(const EventBus &owner) : bus(owner)
+                {
+                    bus.readers.fetch_add(1);
+                    list = bus.current.load();
+                }
+                ~ReadGuard() { bus.readers.fetch_sub(1); }
+            };
+
+            SubscriptionId add(Handler handler)
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                auto *next = new SubscriberList(*current.load());
+                const SubscriptionId id = nextId++;
+                next->push_back({id, std::move(handler)});
+                replace(next);
+                return id;
+            }
+
+            // Caller holds writerMutex. A publisher that bumped readers before
+            // the exchange is counted here; one that bumps it after loads the
+            // new list, so retired lists are safe to free when readers is 0.
+            void replace(SubscriberList *next)
+            {
+                retired.push_back(current.exchange(next));
+                if (readers.load() == 0)
+                {
+                    for (auto *list : retired)
+                        delete list;
+                    retired.clear();
+                }
+            }
+
+            void deliverLoop()
+            {
+                std::vector<Event> batch;
+                std::unique_lock<std::mutex> lock(queueMutex);
+                for (;;)
+                {
+                    queueReady.wait(lock, [this]
+                                    { return !pending.empty() || stopping; });
+                    if (pending.empty())
+                    {
+                        asyncRunning = false;
+                        drained.notify_all();
+                        return;
+                    }
+                    // Swap buffers: producers refill the old batch's capacity
+                    batch.swap(pending);
+                    lock.unlock();
+                    publishBatch(batch.begin(), batch.end());
+                    const uint64_t count = batch.size();
+                    batch.clear();
+                    lock.lock();
+                    delivered += count;
+                    drained.notify_all();
+                }
+            }
+
+            alignas(64) std::atomic<const SubscriberList *> current;
+            mutable std::atomic<uint64_t> readers{0};
+
+            alignas(64) std::mutex writerMutex;
+            std::vector<const SubscriberList *> retired;
+            SubscriptionId nextId = 1;
+
+            std::mutex queueMutex;
+            std::condition_variable queueReady;
+            std::condition_variable drained;
+            std::vector<Event> pending;
+            uint64_t posted = 0;
+            uint64_t delivered = 0;
+            bool asyncRunning = false;
+            bool stopping = false;
+            std::thread worker;
+        };
+
+        // ===== SLAB POOL =====
+        // Object storage behind the ObjectPool pattern and pooled factories.
+        //   acquire(args...) -> PoolHandle<T>   construct T in a free slot
+        //   create(args...) / destroy(p)        the same without a handle
+        //   reserve(n), live(), capacity(), slabCount()
+        // Slots are cut from slabs that double in size (64 up to 4096 slots),
+        // so N objects cost a handful of mallocs instead of N. Released slots
+        // go on an intrusive free list and are reused before a new slab is
+        // cut. Slabs are only freed with the pool, which destroys the objects
+        // still live in them, so the pool must outlive its handles. Not
+        // thread-safe: keep one pool per thread or guard it.
+        template <typename T>
+        class PoolHandle
+        {
+        public:
+            PoolHandle() = default;
+            PoolHandle(T *object, void *pool, void (*recycle)(void *, void *))
+                : object(object), slot(object), pool(pool), recycle(recycle) {}
+            PoolHandle(const PoolHandle &) = delete;
+            PoolHandle &operator=(const PoolHandle &) = delete;
+
+            PoolHandle(PoolHandle &&other) noexcept { take(other); }
+
+            // A handle to a pooled Circle converts to a handle to Shape; the
+            // slot still goes back to the Circle pool
+            template <typename U, typename = std::enable_if_t<std::is_convertible<U *, T *>::value>>
+            PoolHandle(PoolHandle<U> &&other) noexcept
+                : object(other.object), slot(other.slot), pool(other.pool), recycle(other.recycle)
+            {
+                other.object = nullptr;
+                other.slot = nullptr;
+            }
+
+            PoolHandle &operator=(PoolHandle &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    reset();
+                    take(other);
+                }
+                return *this;
+            }
+
+            ~PoolHandle() { reset(); }
+
+            void reset()
+            {
+                if (object)
+                {
+                    object = nullptr;
+                    recycle(pool, slot);
+                    slot = nullptr;
+                }
+            }
+
+            T *get() const { return object; }
+            T &operator*() const { return *object; }
+            T *operator->() const { return object; }
+            explicit operator bool() const { return object != nullptr; }
+
+        private:
+            template <typename U>
+            friend class PoolHandle;
+
+            void take(PoolHandle &other)
+            {
+                object = other.object;
+                slot = other.slot;
+                pool = other.pool;
+                recycle = other.recycle;
+                other.object = nullptr;
+                other.slot = nullptr;
+            }
+
+            T *object = nullptr;
+            void *slot = nullptr; // the object as the pool's own type
+            void *pool = nullptr;
+            void (*recycle)(void *, void *) = nullptr;
+        };
+
+        template <typename T>
+        class SlabPool
+        {
+        public:
+            explicit SlabPool(size_t firstSlab = 64) : nextSlab(std::max<size_t>(firstSlab, 1)) {}
+            SlabPool(const SlabPool &) = delete;
+            SlabPool &operator=(const SlabPool &) = delete;
+
+            // Live slots are the ones not on the free list
+            ~SlabPool()
+            {
+                if constexpr (!std::is_trivially_destructible<T>::value)
+                {
+                    if (liveCount == 0)
+                        return;
+                    std::vector<const Slot *> freeSlots;
+                    freeSlots.reserve(slotCount - liveCount);
+                    for (const Slot *slot = freeList; slot; slot = slot->next)
+                        freeSlots.push_back(slot);
+                    std::sort(freeSlots.begin(), freeSlots.end(), std::less<const Slot *>());
+                    for (size_t s = 0; s < slabs.size(); s++)
+                    {
+                        for (size_t i = 0; i < slabSizes[s]; i++)
+                        {
+                            Slot *slot = &slabs[s][i];
+                            if (!std::binary_search(freeSlots.begin(), freeSlots.end(), slot, std::less<const Slot *>()))
+                                reinterpret_cast<T *>(slot->storage)->~T();
+                        }
+                    }
+                }
+            }
+
+            template <typename... Args>
+            T *create(Args &&...args)
+            {
+                if (!freeList)
+                    grow(nextSlab);
+                Slot *slot = freeList;
+                freeList = slot->next;
+                T *object;
+                try
+                {
+                    object = construct(slot->storage, std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    slot->next = freeList;
+                    freeList = slot;
+                    throw;
+                }
+                liveCount++;
+                return object;
+            }
+
+            void destroy(T *object)
+            {
+                if (!object)
+                    return;
+                object->~T();
+                Slot *slot = reinterpret_cast<Slot *>(object);
+                slot->next = freeList;
+                freeList = slot;
+                liveCount--;
+            }
+
+            template <typename... Args>
+            PoolHandle<T> acquire(Args &&...args)
+            {
+                return PoolHandle<T>(create(std::forward<Args>(args)...), this, &SlabPool::recycle);
+            }
+
+            void reserve(size_t count)
+            {
+                if (slotCount < count)
+                    grow(std::max(nextSlab, count - slotCount));
+            }
+
+            size_t live() const { return liveCount; }
+            size_t capacity() const { return slotCount; }
+            size_t slabCount() const { return slabs.size(); }
+
+        private:
+            union Slot
+            {
+                Slot *next;
+                alignas(T) unsigned char storage[sizeof(T)];
+            };
+
+            static constexpr size_t maxSlab = 4096;
+
+            template <typename... Args>
+            static T *construct(void *storage, Args &&...args)
+            {
+                // L++ classes without a constructor are aggregates
+                if constexpr (std::is_constructible<T, Args &&...>::value)
+                    return new (storage) T(std::forward<Args>(args)...);
+                else
+                    return new (storage) T{std::forward<Args>(args)...};
+            }
+
+            void grow(size_t count)
+            {
+                std::unique_ptr<Slot[]> slab(new Slot[count]);
+                for (size_t i = count; i-- > 0;)
+                {
+                    slab[i].next = freeList;
+                    freeList = &slab[i];
+                }
+                slabs.push_back(std::move(slab));
+                slabSizes.push_back(count);
+                slotCount += count;
+                nextSlab = std::min(maxSlab, nextSlab * 2);
+            }
+
+            static void recycle(void *pool, void *object)
+            {
+                static_cast<SlabPool *>(pool)->destroy(static_cast<T *>(object));
+            }
+
+            std::vector<std::unique_ptr<Slot[]>> slabs;
+            std::vector<size_t> slabSizes;
+            Slot *freeList = nullptr;
+            size_t nextSlab;
+            size_t slotCount = 0;
+            size_t liveCount = 0;
+        };
+
+        // ===== INTERN TABLE =====
+        // Hash-consing behind the Flyweight pattern: equal values intern to
+        // one shared instance.
+        //   intern(v) -> Interned<T>   the existing instance or a new one
+        //   find(v) / contains(v)      lookup without inserting
+        //   at(id), size()
+        // Instances live in a SlabPool, so they never move and handles stay
+        // valid for the table's lifetime. The index is a flat open-addressing
+        // table (linear probing, at most half full) of 64-bit entries: the
+        // high half keeps 32 bits of the hash, so most mismatches are
+        // rejected without touching the value, and the low half is id + 1
+        // (0 marks an empty entry). Handles compare by address.
+        template <typename T>
+        class Interned
+        {
+        public:
+            Interned() = default;
+            Interned(const T *instance, uint32_t index) : instance(instance), index(index) {}
+
+            const T &get() const { return *instance; }
+            const T &operator*() const { return *instance; }
+            const T *operator->() const { return instance; }
+            uint32_t id() const { return index; }
+            explicit operator bool() const { return instance != nullptr; }
+
+            bool operator==(const Interned &other) const { return instance == other.instance; }
+            bool operator!=(const Interned &other) const { return instance != other.instance; }
+            bool operator<(const Interned &other) const { return index < other.index; }
+
+        private:
+            const T *instance = nullptr;
+            uint32_t index = 0;
+        };
+
+        template <typename T, typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+        class InternTable
+        {
+        public:
+            explicit InternTable(size_t expected = 0)
+            {
+                size_t size = 16;
+                while (size < expected * 2)
+                    size *= 2;
+                entries.assign(size, 0);
+                mask = size - 1;
+                values.reserve(expected);
+            }
+
+            Interned<T> intern(const T &value) { return insert(value); }
+            Interned<T> intern(T &&value) { return insert(std::move(value)); }
+
+            // Empty handle when the value was never interned
+            Interned<T> find(const T &value) const
+            {
+                uint64_t entry = entries[probe(value, mix(hasher(value)))];
+                if (entry == 0)
+                    return Interned<T>();
+                uint32_t id = static_cast<uint32_t>(entry) - 1;
+                return Interned<T>(values[id], id);
+            }
+
+            bool contains(const T &value) const { return static_cast<bool>(find(value)); }
+
+            Interned<T> at(uint32_t id) const
+            {
+                if (id >= values.size())
+                    throw std::out_of_range("InternTable::at: no instance with id " + std::to_string(id));
+                return Interned<T>(values[id], id);
+            }
+
+            size_t size() const { return values.size(); }
+
+        private:
+            // MurmurHash3 finalizer: std::hash is the identity for integers
+            static uint64_t mix(uint64_t h)
+            {
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdULL;
+                h ^= h >> 33;
+                h *= 0xc4ceb9fe1a85ec53ULL;
+                h ^= h >> 33;
+                return h;
+            }
+
+            static uint64_t tagOf(uint64_t hash) { return hash & 0xffffffff00000000ULL; }
+
+            // Entry holding an equal value, or the empty entry ending the run
+            size_t probe(const T &value, uint64_t hash) const
+            {
+                for (size_t i = hash & mask;; i = (i + 1) & mask)
+                {
+                    uint64_t entry = entries[i];
+                    if (entry == 0)
+                        return i;
+                    if (tagOf(entry) == tagOf(hash) &&
+                        equal(*values[static_cast<uint32_t>(entry) - 1], value))
+                        return i;
+                }
+            }
+
+            template <typename V>
+            Interned<T> insert(V &&value)
+            {
+                uint64_t hash = mix(hasher(value));
+                size_t i = probe(value, hash);
+                if (entries[i] != 0)
+                {
+                    uint32_t id = static_cast<uint32_t>(entries[i]) - 1;
+                    return Interned<T>(values[id], id);
+                }
+                if (values.size() >= 0xffffffffULL)
+                    throw std::length_error("InternTable: more than 2^32 - 1 instances");
+                if ((values.size() + 1) * 2 > entries.size())
+                {
+                    rehash(entries.size() * 2);
+                    i = probe(value, hash);
+                }
+                uint32_t id = static_cast<uint32_t>(values.size());
+                values.push_back(storage.create(std::forward<V>(value)));
+                entries[i] = tagOf(hash) | (static_cast<uint64_t>(id) + 1);
+                return Interned<T>(values.back(), id);
+            }
+
+            void rehash(size_t size)
+            {
+                entries.assign(size, 0);
+                mask = size - 1;
+                for (uint32_t id = 0; id < values.size(); id++)
+                {
+                    uint64_t hash = mix(hasher(*values[id]));
+                    size_t i = hash & mask;
+                    while (entries[i] != 0)
+                        i = (i + 1) & mask;
+                    entries[i] = tagOf(hash) | (static_cast<uint64_t>(id) + 1);
+                }
+            }
+
+            SlabPool<T> storage;
+            std::vector<const T *> values; // by id
+            std::vector<uint64_t> entries;
+            size_t mask = 0;
+            Hash hasher;
+            Eq equal;
+        };
+
+        // ===== CREATIONAL PATTERNS =====
+        // Template implementations behind 'autopattern'. Each use lowers to
+        //   class Name : public lpp::patterns::Pattern<Name[, Arg]> {};
+        // so a translation unit carries one short class per use, and member
+        // bodies are only instantiated for the members a program calls.
+        // Derived is the generated class; fluent members return Derived &.
+
+        // Lazily created process-wide instance
+        template <typename Derived>
+        class Singleton
+        {
+        public:
+            static Derived *getInstance()
+            {
+                static Derived instance; // thread-safe initialisation (C++11)
+                return &instance;
+            }
+
+        protected:
+            Singleton() = default;
+            Singleton(const Singleton &) = delete;
+            Singleton &operator=(const Singleton &) = delete;
+        };
+
+        // Products built by named creators; autopattern Factory Name<Product>
+        // uses PooledFactory instead
+        template <typename Derived, typename Product = std::any>
+        class Factory
+        {
+        public:
+            using Creator = std::function<Product()>;
+
+            Derived &registerType(const std::string &type, Creator creator)
+            {
+                creators[type] = std::move(creator);
+                return static_cast<Derived &>(*this);
+            }
+
+            bool canCreate(const std::string &type) const { return creators.count(type) != 0; }
+
+            Product create(const std::string &type) const
+            {
+                auto it = creators.find(type);
+                if (it == creators.end())
+                    throw std::invalid_argument("Factory::create: unknown type '" + type + "'");
+                return it->second();
+            }
+
+        private:
+            std::unordered_map<std::string, Creator> creators;
+        };
+
+        // Products allocated from a SlabPool; create() forwards to the
+        // product's constructor
+        template <typename Derived, typename Product>
+        class PooledFactory
+        {
+        public:
+            template <typename... Args>
+            PoolHandle<Product> create(Args &&...args) { return products.acquire(std::forward<Args>(args)...); }
+            void reserve(size_t count) { products.reserve(count); }
+            size_t live() const { return products.live(); }
+
+        private:
+            SlabPool<Product> products;
+        };
+
+        // Families of creators for the same product kinds; use(family)
+        // selects the family create(kind) draws from
+        template <typename Derived, typename Product = std::any>
+        class AbstractFactory
+        {
+        public:
+            using Creator = std::function<Product()>;
+
+            Derived &registerProduct(const std::string &family, const std::string &kind, Creator creator)
+            {
+                families[family][kind] = std::move(creator);
+                if (current.empty())
+                    current = family;
+                return static_cast<Derived &>(*this);
+            }
+
+            Derived &use(const std::string &family)
+            {
+                if (!families.count(family))
+                    throw std::invalid_argument("AbstractFactory::use: unknown family '" + family + "'");
+                current = family;
+                return static_cast<Derived &>(*this);
+            }
+
+            const std::string &family() const { return current; }
+
+            Product create(const std::string &kind) const
+            {
+                auto family = families.find(current);
+                if (family != families.end())
+                {
+                    auto it = family->second.find(kind);
+                    if (it != family->second.end())
+                        return it->second();
+                }
+                throw std::invalid_argument("AbstractFactory::create: no '" + kind + "' in family '" + current + "'");
+            }
+
+        private:
+            std::unordered_map<std::string, std::unordered_map<std::string, Creator>> families;
+            std::string current;
+        };
+
+        // Assembles a product step by step; build() hands it over and
+        // starts a fresh one
+        template <typename Derived, typename Product = std::map<std::string, std::string>>
+        class Builder
+        {
+        public:
+            template <typename F>
+            Derived &step(F &&apply)
+            {
+                apply(product);
+                return static_cast<Derived &>(*this);
+            }
+
+            // For map-like products
+            template <typename K, typename V>
+            Derived &set(K &&key, V &&value)
+            {
+                product[std::forward<K>(key)] = std::forward<V>(value);
+                return static_cast<Derived &>(*this);
+            }
+
+            const Product &getResult() const { return product; }
+
+            Product build()
+            {
+                Product result = std::move(product);
+                product = Product();
+                return result;
+            }
+
+        private:
+            Product product{};
+        };
+
+        // Copies of the generated class through a named operation
+        template <typename Derived>
+        class Prototype
+        {
+        public:
+            Derived clone() const { return static_cast<const Derived &>(*this); }
+        };
+
+        // See SlabPool above
+        template <typename Derived, typename T>
+        class ObjectPool
+        {
+        public:
+            using Handle = PoolHandle<T>;
+
+            template <typename... Args>
+            Handle acquire(Args &&...args) { return objects.acquire(std::forward<Args>(args)...); }
+            void reserve(size_t count) { objects.reserve(count); }
+            size_t live() const { return objects.live(); }
+            size_t capacity() const { return objects.capacity(); }
+
+        private:
+            SlabPool<T> objects;
+        };
+
+        // ===== STRUCTURAL PATTERNS =====
+
+        // Presents the adaptee, typically a callable with another interface,
+        // through request()
+        template <typename Derived, typename Adaptee = std::function<void()>>
+        class Adapter
+        {
+        public:
+            Derived &adapt(Adaptee target)
+            {
+                adaptee = std::move(target);
+                return static_cast<Derived &>(*this);
+            }
+
+            Adaptee &getAdaptee() { return adaptee; }
+
+            template <typename... Args>
+            decltype(auto) request(Args &&...args) { return adaptee(std::forward<Args>(args)...); }
+
+        private:
+            Adaptee adaptee{};
+        };
+
+        // Abstraction with a swappable implementation behind operation()
+        template <typename Derived, typename Implementor = std::function<void()>>
+        class Bridge
+        {
+        public:
+            Derived &setImplementor(Implementor impl)
+            {
+                implementor = std::move(impl);
+                return static_cast<Derived &>(*this);
+            }
+
+            Implementor &getImplementor() { return implementor; }
+
+            template <typename... Args>
+            decltype(auto) operation(Args &&...args) { return implementor(std::forward<Args>(args)...); }
+
+        private:
+            Implementor implementor{};
+        };
+
+        // Tree of Derived nodes, each holding a value; a node owns its
+        // children and add() returns the new child. Copies are deep, since
+        // L++ lambdas take their parameters by value
+        template <typename Derived, typename T = std::string>
+        class Composite
+        {
+        public:
+            T value{};
+
+            Composite() = default;
+            Composite(Composite &&) = default;
+            Composite &operator=(Composite &&) = default;
+
+            Composite(const Composite &other) : value(other.value)
+            {
+                children.reserve(other.children.size());
+                for (const auto &node : other.children)
+                    children.push_back(std::make_unique<Derived>(*node));
+            }
+
+            Composite &operator=(const Composite &other)
+            {
+                if (this != &other)
+                {
+                    Composite copy(other);
+                    *this = std::move(copy);
+                }
+                return *this;
+            }
+
+            Derived &add(T childValue)
+            {
+                children.push_back(std::make_unique<Derived>());
+                children.back()->value = std::move(childValue);
+                return *children.back();
+            }
+
+            size_t childCount() const { return children.size(); }
+            Derived &child(size_t index) { return *children.at(index); }
+
+            // Pre-order over this node and its descendants
+            template <typename F>
+            void forEach(F &&visit)
+            {
+                visit(static_cast<Derived &>(*this));
+                for (auto &node : children)
+                    node->forEach(visit);
+            }
+
+            size_t size() const
+            {
+                size_t count = 1;
+                for (const auto &node : children)
+                    count += node->size();
+                return count;
+            }
+
+        private:
+            std::vector<std::unique_ptr<Derived>> children;
+        };
+
+        // Layers of T -> T behaviour applied in the order they were added
+        template <typename Derived, typename T = std::string>
+        class Decorator
+        {
+        public:
+            Derived &decorate(std::function<T(T)> layer)
+            {
+                layers.push_back(std::move(layer));
+                return static_cast<Derived &>(*this);
+            }
+
+            T operation(T input) const
+            {
+                for (const auto &layer : layers)
+                    input = layer(std::move(input));
+                return input;
+            }
+
+            size_t layerCount() const { return layers.size(); }
+
+        private:
+            std::vector<std::function<T(T)>> layers;
+        };
+
+        // One entry point over named subsystem steps
+        template <typename Derived>
+        class Facade
+        {
+        public:
+            Derived &addSubsystem(const std::string &name, std::function<void()> step)
+            {
+                subsystems.emplace_back(name, std::move(step));
+                return static_cast<Derived &>(*this);
+            }
+
+            // Every subsystem, in registration order
+            void operation()
+            {
+                for (auto &subsystem : subsystems)
+                    subsystem.second();
+            }
+
+            bool run(const std::string &name)
+            {
+                for (auto &subsystem : subsystems)
+                {
+                    if (subsystem.first == name)
+                    {
+                        subsystem.second();
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+        private:
+            std::vector<std::pair<std::string, std::function<void()>>> subsystems;
+        };
+
+        // See InternTable above
+        template <typename Derived, typename T = std::string>
+        class Flyweight
+        {
+        public:
+            using Handle = Interned<T>;
+
+            Handle intern(const T &state) { return flyweights.intern(state); }
+            Handle find(const T &state) const { return flyweights.find(state); }
+            bool contains(const T &state) const { return flyweights.contains(state); }
+            Handle get(uint32_t id) const { return flyweights.at(id); }
+            size_t size() const { return flyweights.size(); }
+
+        private:
+            InternTable<T> flyweights;
+        };
+
+        // Stands in for a subject that is loaded on the first request()
+        template <typename Derived, typename T = std::string>
+        class Proxy
+        {
+        public:
+            Derived &setLoader(std::function<T()> load)
+            {
+                loader = std::move(load);
+                subject.reset();
+                return static_cast<Derived &>(*this);
+            }
+
+            const T &request()
+            {
+                if (!subject)
+                {
+                    if (!loader)
+                        throw std::runtime_error("Proxy::request: no loader set");
+                    subject.emplace(loader());
+                }
+                return *subject;
+            }
+
+            bool isLoaded() const { return subject.has_value(); }
+            void invalidate() { subject.reset(); }
+
+        private:
+            std::function<T()> loader;
+            std::optional<T> subject;
+        };
+
+        // ===== BEHAVIORAL PATTERNS =====
+
+        // Handlers tried in order until one returns true
+        template <typename Derived, typename Request = std::string>
+        class ChainOfResponsibility
+        {
+        public:
+            Derived &addHandler(std::function<bool(const Request &)> handler)
+            {
+                handlers.push_back(std::move(handler));
+                return static_cast<Derived &>(*this);
+            }
+
+            bool handleRequest(const Request &request) const
+            {
+                for (const auto &handler : handlers)
+                {
+                    if (handler(request))
+                        return true;
+                }
+                return false;
+            }
+
+        private:
+            std::vector<std::function<bool(const Request &)>> handlers;
+        };
+
+        // Executed actions with undo/redo history
+        template <typename Derived>
+        class Command
+        {
+        public:
+            void execute(std::function<void()> action, std::function<void()> undoAction = nullptr)
+            {
+                action();
+                done.push_back({std::move(action), std::move(undoAction)});
+                undone.clear();
+            }
+
+            bool undo()
+            {
+                if (done.empty())
+                    return false;
+                Entry entry = std::move(done.back());
+                done.pop_back();
+                if (entry.undo)
+                    entry.undo();
+                undone.push_back(std::move(entry));
+                return true;
+            }
+
+            bool redo()
+            {
+                if (undone.empty())
+                    return false;
+                Entry entry = std::move(undone.back());
+                undone.pop_back();
+                entry.action();
+                done.push_back(std::move(entry));
+                return true;
+            }
+
+            bool canUndo() const { return !done.empty(); }
+            bool canRedo() const { return !undone.empty(); }
+
+        private:
+            struct Entry
+            {
+                std::function<void()> action;
+                std::function<void()> undo;
+            };
+            std::vector<Entry> done;
+            std::vector<Entry> undone;
+        };
+
+        // Cursor over an owned sequence; also usable in range-for
+        template <typename Derived, typename T = int>
+        class Iterator
+        {
+        public:
+            Derived &add(T item)
+            {
+                items.push_back(std::move(item));
+                return static_cast<Derived &>(*this);
+            }
+
+            bool hasNext() const { return current < items.size(); }
+
+            T &next()
+            {
+                if (current >= items.size())
+                    throw std::out_of_range("Iterator::next: past the end");
+                return items[current++];
+            }
+
+            void reset() { current = 0; }
+            size_t size() const { return items.size(); }
+            auto begin() { return items.begin(); }
+            auto end() { return items.end(); }
+
+        private:
+            std::vector<T> items;
+            size_t current = 0;
+        };
+
+        // Colleagues exchange messages through the mediator; notify() reaches
+        // every colleague but the sender
+        template <typename Derived, typename Message = std::string>
+        class Mediator
+        {
+        public:
+            using Handler = std::function<void(const std::string &sender, const Message &message)>;
+
+            Derived &join(const std::string &name, Handler handler)
+            {
+                colleagues.emplace_back(name, std::move(handler));
+                return static_cast<Derived &>(*this);
+            }
+
+            bool leave(const std::string &name)
+            {
+                auto it = std::find_if(colleagues.begin(), colleagues.end(),
+                                       [&](const auto &colleague)
+                                       { return colleague.first == name; });
+                if (it == colleagues.end())
+                    return false;
+                colleagues.erase(it);
+                return true;
+            }
+
+            void notify(const std::string &sender, const Message &message)
+            {
+                for (auto &colleague : colleagues)
+                {
+                    if (colleague.first != sender)
+                        colleague.second(sender, message);
+                }
+            }
+
+            size_t colleagueCount() const { return colleagues.size(); }
+
+        private:
+            std::vector<std::pair<std::string, Handler>> colleagues;
+        };
+
+        // Snapshots of state; restore() rolls back to the latest one
+        template <typename Derived, typename State = std::string>
+        class Memento
+        {
+        public:
+            State state{};
+
+            void setState(State next) { state = std::move(next); }
+            const State &getState() const { return state; }
+
+            void save() { snapshots.push_back(state); }
+
+            bool restore()
+            {
+                if (snapshots.empty())
+                    return false;
+                state = std::move(snapshots.back());
+                snapshots.pop_back();
+                return true;
+            }
+
+            size_t snapshotCount() const { return snapshots.size(); }
+
+        private:
+            std::vector<State> snapshots;
+        };
+
+        // See EventBus above
+        template <typename Derived, typename Event = std::string>
+        class Observer
+        {
+        public:
+            template <typename F>
+            uint64_t subscribe(F handler) { return eventBus.subscribe(std::move(handler)); }
+            bool unsubscribe(uint64_t id) { return eventBus.unsubscribe(id); }
+            void publish(const Event &event) { eventBus.publish(event); }
+            template <typename C>
+            void publishBatch(const C &events) { eventBus.publishBatch(std::begin(events), std::end(events)); }
+            void notify(const Event &event = Event()) { eventBus.publish(event); }
+            void post(Event event) { eventBus.post(std::move(event)); }
+            void startAsync() { eventBus.startAsync(); }
+            void flush() { eventBus.flush(); }
+            void stopAsync() { eventBus.stopAsync(); }
+            size_t subscriberCount() const { return eventBus.subscriberCount(); }
+
+        private:
+            EventBus<Event> eventBus;
+        };
+
+        // Finite state machine: transitions keyed by (state, event)
+        template <typename Derived, typename S = std::string>
+        class State
+        {
+        public:
+            Derived &addTransition(const S &from, const std::string &event, const S &to)
+            {
+                transitions[{from, event}] = to;
+                return static_cast<Derived &>(*this);
+            }
+
+            Derived &onEnter(std::function<void(const S &)> callback)
+            {
+                enter = std::move(callback);
+                return static_cast<Derived &>(*this);
+            }
+
+            // False when the current state has no transition for event
+            bool handle(const std::string &event)
+            {
+                auto it = transitions.find({current, event});
+                if (it == transitions.end())
+                    return false;
+                setState(it->second);
+                return true;
+            }
+
+            void setState(const S &state)
+            {
+                current = state;
+                if (enter)
+                    enter(current);
+            }
+
+            const S &getState() const { return current; }
+
+        private:
+            std::map<std::pair<S, std::string>, S> transitions;
+            std::function<void(const S &)> enter;
+            S current{};
+        };
+
+        // Interchangeable algorithm behind execute()
+        template <typename Derived, typename Algorithm = std::function<void()>>
+        class Strategy
+        {
+        public:
+            Derived &setStrategy(Algorithm algorithm)
+            {
+                strategy = std::move(algorithm);
+                return static_cast<Derived &>(*this);
+            }
+
+            template <typename... Args>
+            decltype(auto) execute(Args &&...args) { return strategy(std::forward<Args>(args)...); }
+
+        private:
+            Algorithm strategy{};
+        };
+
+        // templateMethod() runs the steps in a fixed order; classes that
+        // extend the generated one override them. The steps are virtual
+        // because those classes sit below Derived.
+        template <typename Derived>
+        class TemplateMethod
+        {
+        public:
+            virtual ~TemplateMethod() = default;
+
+            void templateMethod()
+            {
+                step1();
+                step2();
+            }
+
+            virtual void step1() {}
+            virtual void step2() {}
+        };
+
+        // Handlers registered per element type; visit() dispatches on the
+        // static type of its argument
+        template <typename Derived>
+        class Visitor
+        {
+        public:
+            template <typename Element, typename F>
+            Derived &on(F handler)
+            {
+                handlers[std::type_index(typeid(Element))] = [handler](const void *element) mutable
+                { handler(*static_cast<const Element *>(element)); };
+                return static_cast<Derived &>(*this);
+            }
+
+            // False when no handler is registered for Element
+            template <typename Element>
+            bool visit(const Element &element)
+            {
+                auto it = handlers.find(std::type_index(typeid(Element)));
+                if (it == handlers.end())
+                    return false;
+                it->second(&element);
+                return true;
+            }
+
+        private:
+            std::unordered_map<std::type_index, std::function<void(const void *)>> handlers;
+        };
+
+        // Evaluates postfix programs such as "a 2 * b +" over named
+        // variables; + - * / are predefined for arithmetic V
+        template <typename Derived, typename V = double>
+        class Interpreter
+        {
+        public:
+            Interpreter()
+            {
+                if constexpr (std::is_arithmetic<V>::value)
+                {
+                    operators["+"] = [](V a, V b)
+                    { return a + b; };
+                    operators["-"] = [](V a, V b)
+                    { return a - b; };
+                    operators["*"] = [](V a, V b)
+                    { return a * b; };
+                    operators["/"] = [](V a, V b)
+                    { return a / b; };
+                }
+            }
+
+            Derived &defineOperator(const std::string &symbol, std::function<V(V, V)> op)
+            {
+                operators[symbol] = std::move(op);
+                return static_cast<Derived &>(*this);
+            }
+
+            Derived &set(const std::string &name, V value)
+            {
+                context[name] = std::move(value);
+                return static_cast<Derived &>(*this);
+            }
+
+            V interpret(const std::string &program) const
+            {
+                std::vector<V> stack;
+                size_t pos = 0;
+                while (pos < program.size())
+                {
+                    size_t start = program.find_first_not_of(" \t\n", pos);
+                    if (start == std::string::npos)
+                        break;
+                    size_t end = program.find_first_of(" \t\n", start);
+                    std::string token = program.substr(start, end == std::string::npos ? std::string::npos : end - start);
+                    pos = end == std::string::npos ? program.size() : end;
+
+                    auto op = operators.find(token);
+                    if (op != operators.end())
+                    {
+                        if (stack.size() < 2)
+                            throw std::invalid_argument("Interpreter: '" + token + "' needs two operands");
+                        V rhs = std::move(stack.back());
+                        stack.pop_back();
+                        stack.back() = op->second(std::move(stack.back()), std::move(rhs));
+                    }
+                    else if (auto var = context.find(token); var != context.end())
+                        stack.push_back(var->second);
+                    else
+                        stack.push_back(literal(token));
+                }
+                if (stack.size() != 1)
+                    throw std::invalid_argument("Interpreter: program must leave exactly one value");
+                return stack.back();
+            }
+
+        private:
+            static V literal(const std::string &token)
+            {
+                if constexpr (std::is_arithmetic<V>::value)
+                {
+                    char *end = nullptr;
+                    double number = std::strtod(token.c_str(), &end);
+                    if (end != token.c_str() && *end == '\0')
+                        return static_cast<V>(number);
+                }
+                throw std::invalid_argument("Interpreter: unknown token '" + token + "'");
+            }
+
+            std::unordered_map<std::string, std::function<V(V, V)>> operators;
+            std::unordered_map<std::string, V> context;
+        };
+
+        // ===== FUNCTIONAL PATTERNS =====
+        // Value-level versions of the functional autopatterns. A template
+        // cannot rebind Derived to a new element type, so map-like members
+        // stay within T, and bind() takes a function returning the next
+        // Derived.
+
+        // Value in a context: pure() wraps, bind() sequences
+        template <typename Derived, typename T = int>
+        class Monad
+        {
+        public:
+            T value{};
+
+            static Derived pure(T x)
+            {
+                Derived result;
+                result.value = std::move(x);
+                return result;
+            }
+
+            template <typename F>
+            auto bind(F &&f) const { return f(value); }
+
+            template <typename F>
+            Derived map(F &&f) const { return pure(f(value)); }
+        };
+
+        template <typename Derived, typename T = int>
+        class Functor
+        {
+        public:
+            T value{};
+
+            template <typename F>
+            Derived map(F &&f) const
+            {
+                Derived result;
+                result.value = f(value);
+                return result;
+            }
+        };
+
+        // apply() takes an applicative holding a function; liftA2 combines
+        // two values with a binary function
+        template <typename Derived, typename T = int>
+        class Applicative
+        {
+        public:
+            T value{};
+
+            static Derived pure(T x)
+            {
+                Derived result;
+                result.value = std::move(x);
+                return result;
+            }
+
+            template <typename Fn>
+            Derived apply(const Fn &wrapped) const { return pure(wrapped.value(value)); }
+
+            template <typename F>
+            Derived liftA2(const Derived &other, F &&f) const { return pure(f(value, other.value)); }
+        };
+
+        // Associative combine with identity empty() (T{} for the default +)
+        template <typename Derived, typename T = int, typename Op = std::plus<T>>
+        class Monoid
+        {
+        public:
+            T value{};
+
+            static Derived empty() { return Derived(); }
+
+            Derived combine(const Derived &other) const
+            {
+                Derived result;
+                result.value = Op()(value, other.value);
+                return result;
+            }
+
+            static Derived concat(const std::vector<Derived> &parts)
+            {
+                Derived result = empty();
+                for (const auto &part : parts)
+                    result = result.combine(part);
+                return result;
+            }
+        };
+
+        template <typename Derived, typename T = int>
+        class Foldable
+        {
+        public:
+            Derived &add(T item)
+            {
+                items.push_back(std::move(item));
+                return static_cast<Derived &>(*this);
+            }
+
+            template <typename U, typename F>
+            U foldLeft(U init, F &&f) const
+            {
+                for (const auto &item : items)
+                    init = f(std::move(init), item);
+                return init;
+            }
+
+            template <typename U, typename F>
+            U foldRight(U init, F &&f) const
+            {
+                for (auto it = items.rbegin(); it != items.rend(); ++it)
+                    init = f(*it, std::move(init));
+                return init;
+            }
+
+            size_t size() const { return items.size(); }
+
+        protected:
+            std::vector<T> items;
+        };
+
+        // Traversal in the optional applicative: every element must map to
+        // a value or the whole result is empty
+        template <typename Derived, typename T = int>
+        class Traversable : public Foldable<Derived, T>
+        {
+        public:
+            template <typename F>
+            auto traverse(F &&f) const
+            {
+                using Result = typename std::decay_t<decltype(f(std::declval<const T &>()))>::value_type;
+                std::optional<std::vector<Result>> out(std::in_place);
+                out->reserve(this->items.size());
+                for (const auto &item : this->items)
+                {
+                    auto mapped = f(item);
+                    if (!mapped)
+                        return std::optional<std::vector<Result>>();
+                    out->push_back(std::move(*mapped));
+                }
+                return out;
+            }
+
+            // For T = optional<U>
+            auto sequence() const
+            {
+                return traverse([](const T &item)
+                                { return item; });
+            }
+        };
+
+        // Focus on a part T of a whole S through a getter and a setter
+        template <typename Derived, typename S, typename T>
+        class Lens
+        {
+        public:
+            Derived &focus(std::function<T(const S &)> get, std::function<S(S, T)> put)
+            {
+                getter = std::move(get);
+                setter = std::move(put);
+                return static_cast<Derived &>(*this);
+            }
+
+            T view(const S &whole) const { return getter(whole); }
+            S set(S whole, T part) const { return setter(std::move(whole), std::move(part)); }
+
+            template <typename F>
+            S over(S whole, F &&f) const
+            {
+                T part = getter(whole);
+                return setter(std::move(whole), f(std::move(part)));
+            }
+
+        private:
+            std::function<T(const S &)> getter;
+            std::function<S(S, T)> setter;
+        };
+
+        // Either a failure L or a result R
+        template <typename Derived, typename L = std::string, typename R = int>
+        class Either
+        {
+        public:
+            static Derived left(L l)
+            {
+                Derived result;
+                result.value.template emplace<0>(std::move(l));
+                return result;
+            }
+
+            static Derived right(R r)
+            {
+                Derived result;
+                result.value.template emplace<1>(std::move(r));
+                return result;
+            }
+
+            bool isLeft() const { return value.index() == 0; }
+            bool isRight() const { return value.index() == 1; }
+
+            template <typename OnLeft, typename OnRight>
+            auto fold(OnLeft &&onLeft, OnRight &&onRight) const
+            {
+                return isLeft() ? onLeft(std::get<0>(value)) : onRight(std::get<1>(value));
+            }
+
+            std::variant<L, R> value;
+        };
+
+        template <typename Derived, typename T = int>
+        class Maybe
+        {
+        public:
+            std::optional<T> value;
+
+            static Derived just(T x)
+            {
+                Derived result;
+                result.value = std::move(x);
+                return result;
+            }
+
+            static Derived nothing() { return Derived(); }
+
+            bool isJust() const { return value.has_value(); }
+            T getOrElse(T defaultValue) const { return value ? *value : std::move(defaultValue); }
+
+            template <typename F>
+            Derived map(F &&f) const { return value ? just(f(*value)) : nothing(); }
+
+            template <typename F>
+            Derived bind(F &&f) const { return value ? f(*value) : nothing(); }
+        };
+
+        // Computation threading a state S and producing A
+        template <typename Derived, typename S = int, typename A = int>
+        class StateMonad
+        {
+        public:
+            using Step = std::function<std::pair<A, S>(S)>;
+
+            static Derived of(Step step)
+            {
+                Derived result;
+                result.runState = std::move(step);
+                return result;
+            }
+
+            static Derived pure(A a)
+            {
+                return of([a](S s)
+                          { return std::make_pair(a, std::move(s)); });
+            }
+
+            // For A = S
+            static Derived get()
+            {
+                return of([](S s)
+                          { return std::make_pair(A(s), s); });
+            }
+
+            static Derived put(S next)
+            {
+                return of([next](S)
+                          { return std::make_pair(A(), next); });
+            }
+
+            template <typename F>
+            Derived bind(F f) const
+            {
+                Step first = runState;
+                return of([first, f](S s)
+                          {
+                    auto step = first(std::move(s));
+                    return f(std::move(step.first)).runState(std::move(step.second)); });
+            }
+
+            std::pair<A, S> run(S initial) const { return runState(std::move(initial)); }
+
+            Step runState = [](S s)
+            { return std::make_pair(A(), std::move(s)); };
+        };
+
+        // Computation reading a shared environment R
+        template <typename Derived, typename R = std::string, typename A = int>
+        class Reader
+        {
+        public:
+            using Step = std::function<A(const R &)>;
+
+            static Derived of(Step step)
+            {
+                Derived result;
+                result.runReader = std::move(step);
+                return result;
+            }
+
+            static Derived pure(A a)
+            {
+                return of([a](const R &)
+                          { return a; });
+            }
+
+            // For A = R
+            static Derived ask()
+            {
+                return of([](const R &env)
+                          { return A(env); });
+            }
+
+            Derived local(std::function<R(const R &)> f) const
+            {
+                Step inner = runReader;
+                return of([inner, f](const R &env)
+                          { return inner(f(env)); });
+            }
+
+            template <typename F>
+            Derived bind(F f) const
+            {
+                Step first = runReader;
+                return of([first, f](const R &env)
+                          { return f(first(env)).runReader(env); });
+            }
+
+            A run(const R &env) const { return runReader(env); }
+
+            Step runReader = [](const R &)
+            { return A(); };
+        };
+
+        // Value with an accumulated log W (appended with +=)
+        template <typename Derived, typename A = int, typename W = std::string>
+        class Writer
+        {
+        public:
+            A value{};
+            W log{};
+
+            Derived &tell(const W &entry)
+            {
+                log += entry;
+                return static_cast<Derived &>(*this);
+            }
+
+            std::pair<A, W> listen() const { return {value, log}; }
+
+            template <typename F>
+            Derived bind(F &&f) const
+            {
+                Derived next = f(value);
+                W combined = log;
+                combined += next.log;
+                next.log = std::move(combined);
+                return next;
+            }
+        };
+
+        // Deferred side effect, run by unsafePerformIO()
+        template <typename Derived, typename A = int>
+        class IO
+        {
+        public:
+            static Derived of(std::function<A()> effect)
+            {
+                Derived result;
+                result.action = std::move(effect);
+                return result;
+            }
+
+            static Derived pure(A a)
+            {
+                return of([a]
+                          { return a; });
+            }
+
+            template <typename F>
+            Derived bind(F f) const
+            {
+                std::function<A()> first = action;
+                return of([first, f]
+                          { return f(first()).unsafePerformIO(); });
+            }
+
+            A unsafePerformIO() const { return action(); }
+
+            std::function<A()> action = []
+            { return A(); };
+        };
+
+        // Program as data: instructions are recorded by impure() and given
+        // meaning later by an interpreter
+        template <typename Derived, typename Instruction = std::string>
+        class Free
+        {
+        public:
+            static Derived pure() { return Derived(); }
+
+            Derived &impure(Instruction instruction)
+            {
+                program.push_back(std::move(instruction));
+                return static_cast<Derived &>(*this);
+            }
+
+            template <typename F>
+            void interpret(F &&interpreter) const
+            {
+                for (const auto &instruction : program)
+                    interpreter(instruction);
+            }
+
+            template <typename U, typename F>
+            U foldMap(U init, F &&f) const
+            {
+                for (const auto &instruction : program)
+                    init = f(std::move(init), instruction);
+                return init;
+            }
+
+            size_t size() const { return program.size(); }
+
+        private:
+            std::vector<Instruction> program;
+        };
+
+        // Continuation-passing computation of A with final result R
+        template <typename Derived, typename A = int, typename R = int>
+        class Continuation
+        {
+        public:
+            using Cont = std::function<R(A)>;
+            using Step = std::function<R(Cont)>;
+
+            static Derived of(Step step)
+            {
+                Derived result;
+                result.runCont = std::move(step);
+                return result;
+            }
+
+            static Derived pure(A a)
+            {
+                return of([a](Cont k)
+                          { return k(a); });
+            }
+
+            template <typename F>
+            Derived bind(F f) const
+            {
+                Step first = runCont;
+                return of([first, f](Cont k)
+                          { return first([f, k](A a)
+                                         { return f(a).runCont(k); }); });
+            }
+
+            // f receives an escape function that jumps to the continuation
+            static Derived callCC(std::function<Derived(std::function<Derived(A)>)> f)
+            {
+                return of([f](Cont k)
+                          {
+                    std::function<Derived(A)> escape = [k](A a)
+                    { return of([k, a](Cont)
+                                { return k(a); }); };
+                    return f(escape).runCont(k); });
+            }
+
+            R run(Cont k) const { return runCont(std::move(k)); }
+
+            Step runCont = [](Cont k)
+            { return k(A()); };
+        };
+
+        // List zipper: a sequence with a focused position
+        template <typename Derived, typename T = int>
+        class Zipper
+        {
+        public:
+            Derived &add(T item)
+            {
+                items.push_back(std::move(item));
+                return static_cast<Derived &>(*this);
+            }
+
+            T &focus()
+            {
+                if (items.empty())
+                    throw std::out_of_range("Zipper::focus: empty zipper");
+                return items[position];
+            }
+
+            bool moveLeft()
+            {
+                if (position == 0)
+                    return false;
+                position--;
+                return true;
+            }
+
+            bool moveRight()
+            {
+                if (position + 1 >= items.size())
+                    return false;
+                position++;
+                return true;
+            }
+
+            template <typename F>
+            Derived &update(F &&f)
+            {
+                focus() = f(focus());
+                return static_cast<Derived &>(*this);
+            }
+
+            size_t index() const { return position; }
+            const std::vector<T> &toVector() const { return items; }
+
+        protected:
+            std::vector<T> items;
+            size_t position = 0;
+        };
+
+        // The zipper comonad: extend() evaluates f with every position in
+        // focus, e.g. for neighbourhood (stencil) computations
+        template <typename Derived, typename T = int>
+        class Comonad : public Zipper<Derived, T>
+        {
+        public:
+            const T &extract() const
+            {
+                if (this->items.empty())
+                    throw std::out_of_range("Comonad::extract: empty comonad");
+                return this->items[this->position];
+            }
+
+            template <typename F>
+            Derived extend(F &&f) const
+            {
+                Derived result;
+                result.items.reserve(this->items.size());
+                Derived cursor = static_cast<const Derived &>(*this);
+                for (size_t i = 0; i < this->items.size(); i++)
+                {
+                    cursor.position = i;
+                    result.items.push_back(f(static_cast<const Derived &>(cursor)));
+                }
+                result.position = this->position;
+                return result;
+            }
+
+            std::vector<Derived> duplicate() const
+            {
+                std::vector<Derived> views(this->items.size(), static_cast<const Derived &>(*this));
+                for (size_t i = 0; i < views.size(); i++)
+                    views[i].position = i;
+                return views;
+            }
+        };
+
+        // Church-encoded optional: fold() is the only eliminator
+        template <typename Derived, typename A = int>
+        class Church
+        {
+        public:
+            static Derived encode(A a)
+            {
+                Derived result;
+                result.payload = std::move(a);
+                return result;
+            }
+
+            static Derived empty() { return Derived(); }
+
+            template <typename OnValue, typename OnEmpty>
+            auto fold(OnValue &&onValue, OnEmpty &&onEmpty) const
+            {
+                return payload ? onValue(*payload) : onEmpty();
+            }
+
+        private:
+            std::optional<A> payload;
+        };
+
+        // perform() asks the innermost handler installed by handle()
+        template <typename Derived, typename Effect = std::string, typename A = int>
+        class AlgebraicEffect
+        {
+        public:
+            using Handler = std::function<A(const Effect &)>;
+
+            A perform(const Effect &effect) const
+            {
+                if (handlers.empty())
+                    throw std::runtime_error("AlgebraicEffect::perform: unhandled effect");
+                return handlers.back()(effect);
+            }
+
+            // Runs body with handler installed
+            template <typename F>
+            decltype(auto) handle(Handler handler, F &&body)
+            {
+                handlers.push_back(std::move(handler));
+                struct Pop
+                {
+                    std::vector<Handler> &stack;
+                    ~Pop() { stack.pop_back(); }
+                } pop{handlers};
+                return body();
+            }
+
+        private:
+            std::vector<Handler> handlers;
+        };
+
+        // Recursion schemes over sequences of T. ana unfolds a seed with a
+        // coalgebra returning optional<pair<T, Seed>>, cata folds from the
+        // right, hylo fuses the two without building the sequence.
+        template <typename Derived, typename T = int>
+        class Morphism
+        {
+        public:
+            template <typename Seed, typename Coalgebra>
+            static std::vector<T> ana(Seed seed, Coalgebra &&coalg)
+            {
+                std::vector<T> out;
+                while (auto step = coalg(seed))
+                {
+                    out.push_back(std::move(step->first));
+                    seed = std::move(step->second);
+                }
+                return out;
+            }
+
+            template <typename U, typename Algebra>
+            static U cata(const std::vector<T> &items, U init, Algebra &&alg)
+            {
+                for (auto it = items.rbegin(); it != items.rend(); ++it)
+                    init = alg(*it, std::move(init));
+                return init;
+            }
+
+            template <typename U, typename Seed, typename Coalgebra, typename Algebra>
+            static U hylo(Seed seed, Coalgebra &&coalg, U init, Algebra &&alg)
+            {
+                auto step = coalg(seed);
+                if (!step)
+                    return init;
+                return alg(step->first, hylo(std::move(step->second), coalg, std::move(init), alg));
+            }
+        };
+
 // ===== SINGLETON PATTERN =====
 // Usage: @pattern Singleton
 // Generates thread-safe singleton with lazy initialization
@@ -51,26 +2075,6 @@ public:                                                               \
         return nullptr;                                               \
     }
 
-// ===== OBSERVER PATTERN =====
-// Usage: @pattern Observer
-// Generates observer/subscriber mechanism
-#define LPP_PATTERN_OBSERVER(ClassName)            \
-private:                                           \
-    std::vector<std::function<void()>> observers;  \
-                                                   \
-public:                                            \
-    void subscribe(std::function<void()> callback) \
-    {                                              \
-        observers.push_back(callback);             \
-    }                                              \
-    void notify()                                  \
-    {                                              \
-        for (auto &observer : observers)           \
-        {                                          \
-            observer();                            \
-        }                                          \
-    }
-
 // ===== BUILDER PATTERN =====
 // Usage: @pattern Builder
 // Generates fluent builder interface
@@ -4,6 +4,8 @@
 #ifndef LPP_STDLIB_H
 #define LPP_STDLIB_H
 
+#include <string>
+#include <string_view>
 #include <map>
 #include <set>
 #include <unordered_map>
@@ -17,6 +19,51 @@
 #include <optional>
 #include <stdexcept>
 #include <cctype>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <limits>
+#include <type_traits>
+#include <functional>
+#include <future>
+#include <exception>
+#include <charconv>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <array>
+#include <tuple>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Attributes the transpiler puts on functions its effect analysis proved
+// free of side effects: LPP_CONST when the result depends only on scalar
+// arguments, LPP_PURE when the function may also read through its
+// arguments. The compiler may then merge, hoist or drop repeated calls.
+#if defined(__GNUC__)
+#define LPP_CONST __attribute__((const))
+#define LPP_PURE __attribute__((pure))
+#else
+#define LPP_CONST
+#define LPP_PURE
+#endif
 
 namespace lpp
 {
@@ -137,8 +184,8 @@ namespace lpp
             {
                 if (data.empty())
                     throw std::runtime_error("dequeue from empty queue");
-                // BUG #208 fix: Avoid const_cast by copying front, then move
-                T item = data.front();
+                // front() is a non-const reference, so move out before pop()
+                T item = std::move(data.front());
                 data.pop();
                 return item;
             }
@@ -298,583 +345,8730 @@ namespace lpp
             auto end() { return data.end(); }
         };
 
-        // ===== STRING UTILITIES =====
-
-        // Get length of string or vector
-        template <typename T>
-        int len(const std::vector<T> &vec)
+        // ===== PERSISTENT COLLECTIONS =====
+        // Immutable collections with structural sharing: an update returns a
+        // new collection in O(log32 n) and leaves the original valid, instead
+        // of copying every element. Functional-paradigm files lower array
+        // literals and Map/Set types to these.
+        //   PersistentVector<T>     bitmapped vector trie, 32-way, with a tail
+        //   PersistentMap<K, V>     hash array mapped trie (CHAMP layout)
+        //   PersistentSet<T>        the same trie without values
+        // transient() gives a builder for batch updates: it edits the nodes it
+        // has already copied in place, and persistent() seals it again.
+        namespace detail
         {
-            return vec.size();
-        }
+            constexpr unsigned TRIE_BITS = 5;
+            constexpr size_t TRIE_WIDTH = size_t(1) << TRIE_BITS;
+            constexpr size_t TRIE_MASK = TRIE_WIDTH - 1;
 
-        int len(const std::string &str)
-        {
-            return str.length();
-        }
+            // Owner tag for nodes a transient may edit in place. Tags are never
+            // reused, so a sealed transient's nodes are immutable from then on.
+            // 0 means no transient owns the node.
+            inline uint64_t nextEditToken()
+            {
+                static std::atomic<uint64_t> counter{0};
+                return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+            }
 
-        // Push element to vector
-        template <typename T>
-        void push(std::vector<T> &vec, const T &item)
-        {
-            vec.push_back(item);
-        }
+            inline unsigned popcount32(uint32_t bits)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned>(__builtin_popcount(bits));
+#else
+                unsigned count = 0;
+                for (; bits; bits &= bits - 1)
+                    count++;
+                return count;
+#endif
+            }
+        } // namespace detail
 
-        // BUG #233 fix: Move overload for push
         template <typename T>
-        void push(std::vector<T> &vec, T &&item)
+        class PersistentVector
         {
-            vec.push_back(std::move(item));
-        }
+        private:
+            // Internal nodes use children, leaves use values
+            struct Node
+            {
+                uint64_t edit = 0;
+                std::vector<std::shared_ptr<Node>> children;
+                std::vector<T> values;
+            };
+            using NodePtr = std::shared_ptr<Node>;
 
-        // Pop element from vector
-        template <typename T>
-        T pop(std::vector<T> &vec)
-        {
-            if (vec.empty())
-                throw std::runtime_error("pop from empty vector");
-            // BUG #209 fix: Use move semantics instead of copy
-            T item = std::move(vec.back());
-            vec.pop_back();
-            return item;
-        }
+            size_t count = 0;
+            unsigned shift = detail::TRIE_BITS;
+            NodePtr root;
+            NodePtr tail; // Last 1..32 elements, outside the trie
 
-        // Split string by delimiter
-        std::vector<std::string> split(const std::string &str, const std::string &delimiter)
-        {
-            // BUG #214 fix: Prevent infinite loop with empty delimiter
-            if (delimiter.empty())
-                throw std::invalid_argument("split delimiter cannot be empty");
+            static const NodePtr &emptyNode()
+            {
+                static const NodePtr node = std::make_shared<Node>();
+                return node;
+            }
 
-            std::vector<std::string> result;
-            size_t start = 0;
-            size_t end = str.find(delimiter);
+            static NodePtr editable(const NodePtr &node, uint64_t edit)
+            {
+                if (edit != 0 && node->edit == edit)
+                    return node;
+                auto copy = std::make_shared<Node>(*node);
+                copy->edit = edit;
+                return copy;
+            }
 
-            while (end != std::string::npos)
+            static NodePtr newNode(uint64_t edit)
             {
-                result.push_back(str.substr(start, end - start));
-                start = end + delimiter.length();
-                end = str.find(delimiter, start);
+                auto node = std::make_shared<Node>();
+                node->edit = edit;
+                return node;
             }
-            result.push_back(str.substr(start));
-            return result;
-        }
 
-        // Join vector of strings with delimiter
-        std::string join(const std::vector<std::string> &vec, const std::string &delimiter)
-        {
-            std::string result;
-            for (size_t i = 0; i < vec.size(); i++)
+            static NodePtr newPath(uint64_t edit, unsigned level, NodePtr node)
             {
-                result += vec[i];
-                // BUG #216 fix: Prevent underflow when vec.size() == 0
-                if (i + 1 < vec.size())
-                {
-                    result += delimiter;
-                }
+                if (level == 0)
+                    return node;
+                auto parent = newNode(edit);
+                parent->children.push_back(newPath(edit, level - detail::TRIE_BITS, std::move(node)));
+                return parent;
             }
-            return result;
-        }
 
-        // Slice vector
-        template <typename T>
-        std::vector<T> slice(const std::vector<T> &vec, int start, int end = -1)
-        {
-            if (end == -1)
-                end = vec.size();
-            if (start < 0)
-                start = vec.size() + start;
-            if (end < 0)
-                end = vec.size() + end;
+            size_t tailOffset() const
+            {
+                return count <= detail::TRIE_WIDTH ? 0 : ((count - 1) >> detail::TRIE_BITS) << detail::TRIE_BITS;
+            }
 
-            // BUG #212 & #217 fix: Clamp to valid range
-            if (start < 0)
-                start = 0;
-            if (end < 0)
-                end = 0;
-            if (start > (int)vec.size())
-                start = vec.size();
-            if (end > (int)vec.size())
-                end = vec.size();
-            if (end < start)
-                end = start;
+            const NodePtr &leafNode(size_t index) const
+            {
+                if (index >= tailOffset())
+                    return tail;
+                const NodePtr *node = &root;
+                for (unsigned level = shift; level > 0; level -= detail::TRIE_BITS)
+                    node = &(*node)->children[(index >> level) & detail::TRIE_MASK];
+                return *node;
+            }
 
-            std::vector<T> result;
-            for (int i = start; i < end; i++)
+            NodePtr pushTail(uint64_t edit, unsigned level, const NodePtr &parent, NodePtr leaf) const
             {
-                result.push_back(vec[i]);
+                NodePtr result = editable(parent, edit);
+                const size_t sub = ((count - 1) >> level) & detail::TRIE_MASK;
+                if (level == detail::TRIE_BITS)
+                    result->children.push_back(std::move(leaf));
+                else if (sub < result->children.size())
+                    result->children[sub] = pushTail(edit, level - detail::TRIE_BITS, result->children[sub], std::move(leaf));
+                else
+                    result->children.push_back(newPath(edit, level - detail::TRIE_BITS, std::move(leaf)));
+                return result;
             }
-            return result;
-        }
 
-        // Slice string
-        std::string slice(const std::string &str, int start, int end = -1)
-        {
-            if (end == -1)
-                end = str.length();
-            if (start < 0)
-                start = str.length() + start;
-            if (end < 0)
-                end = str.length() + end;
+            // Drops the rightmost leaf; nullptr when the subtree becomes empty
+            NodePtr popTail(uint64_t edit, unsigned level, const NodePtr &node) const
+            {
+                const size_t sub = ((count - 2) >> level) & detail::TRIE_MASK;
+                if (level > detail::TRIE_BITS)
+                {
+                    NodePtr child = popTail(edit, level - detail::TRIE_BITS, node->children[sub]);
+                    if (!child && sub == 0)
+                        return nullptr;
+                    NodePtr result = editable(node, edit);
+                    if (child)
+                        result->children[sub] = std::move(child);
+                    else
+                        result->children.pop_back();
+                    return result;
+                }
+                if (sub == 0)
+                    return nullptr;
+                NodePtr result = editable(node, edit);
+                result->children.pop_back();
+                return result;
+            }
 
-            // BUG #211 & #218 fix: Clamp to valid range and validate end >= start
-            if (start < 0)
-                start = 0;
-            if (end < 0)
-                end = 0;
-            if (start > (int)str.length())
-                start = str.length();
-            if (end > (int)str.length())
-                end = str.length();
-            if (end < start)
-                end = start;
+            static NodePtr assign(uint64_t edit, unsigned level, const NodePtr &node, size_t index, T value)
+            {
+                NodePtr result = editable(node, edit);
+                if (level == 0)
+                {
+                    result->values[index & detail::TRIE_MASK] = std::move(value);
+                }
+                else
+                {
+                    const size_t sub = (index >> level) & detail::TRIE_MASK;
+                    result->children[sub] = assign(edit, level - detail::TRIE_BITS, result->children[sub], index, std::move(value));
+                }
+                return result;
+            }
 
-            return str.substr(start, end - start);
-        }
+            void checkIndex(size_t index) const
+            {
+                if (index >= count)
+                {
+                    throw std::out_of_range("PersistentVector index " + std::to_string(index) + " out of range (size " +
+                                            std::to_string(count) + ")");
+                }
+            }
 
-        // Get character at index
-        char charAt(const std::string &str, int index)
-        {
-            if (index < 0 || index >= (int)str.length())
+            // Shared by the persistent operations (edit 0: copy every touched
+            // node) and by Transient (edit owns the nodes it copied)
+            void pushInPlace(T value, uint64_t edit)
             {
-                throw std::out_of_range("charAt index out of range");
+                if (!root)
+                    root = emptyNode();
+                if (!tail)
+                    tail = newNode(edit);
+                if (count - tailOffset() < detail::TRIE_WIDTH)
+                {
+                    tail = editable(tail, edit);
+                    tail->values.push_back(std::move(value));
+                    count++;
+                    return;
+                }
+                if ((count >> detail::TRIE_BITS) > (size_t(1) << shift))
+                {
+                    auto newRoot = newNode(edit);
+                    newRoot->children.push_back(root);
+                    newRoot->children.push_back(newPath(edit, shift, tail));
+                    root = std::move(newRoot);
+                    shift += detail::TRIE_BITS;
+                }
+                else
+                {
+                    root = pushTail(edit, shift, root, tail);
+                }
+                tail = newNode(edit);
+                tail->values.push_back(std::move(value));
+                count++;
             }
-            return str[index];
-        }
 
-        // Substring
-        std::string substring(const std::string &str, int start, int length)
-        {
-            // BUG #210 fix: Validate bounds before substr()
-            if (start < 0 || start > (int)str.length())
-                throw std::out_of_range("substring start out of range");
-            if (length < 0)
-                throw std::invalid_argument("substring length cannot be negative");
-            // Clamp length to available characters
-            int availableLength = str.length() - start;
-            if (length > availableLength)
-                length = availableLength;
-            return str.substr(start, length);
-        }
+            void setInPlace(size_t index, T value, uint64_t edit)
+            {
+                checkIndex(index);
+                if (index >= tailOffset())
+                {
+                    tail = editable(tail, edit);
+                    tail->values[index & detail::TRIE_MASK] = std::move(value);
+                }
+                else
+                {
+                    root = assign(edit, shift, root, index, std::move(value));
+                }
+            }
 
-        // To uppercase
-        std::string toUpper(const std::string &str)
-        {
-            std::string result = str;
-            std::transform(result.begin(), result.end(), result.begin(), ::toupper);
-            return result;
-        }
+            void popInPlace(uint64_t edit)
+            {
+                if (count == 0)
+                    throw std::runtime_error("popBack from empty PersistentVector");
+                if (count == 1)
+                {
+                    *this = PersistentVector();
+                    return;
+                }
+                if (count - tailOffset() > 1)
+                {
+                    tail = editable(tail, edit);
+                    tail->values.pop_back();
+                    count--;
+                    return;
+                }
+                NodePtr newTail = leafNode(count - 2);
+                NodePtr newRoot = popTail(edit, shift, root);
+                if (!newRoot)
+                    newRoot = emptyNode();
+                if (shift > detail::TRIE_BITS && newRoot->children.size() == 1)
+                {
+                    newRoot = newRoot->children[0];
+                    shift -= detail::TRIE_BITS;
+                }
+                root = std::move(newRoot);
+                tail = std::move(newTail);
+                count--;
+            }
 
-        // To lowercase
-        std::string toLower(const std::string &str)
-        {
-            std::string result = str;
-            std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-            return result;
-        }
+        public:
+            using value_type = T;
+            using size_type = size_t;
 
-        // Trim whitespace
-        std::string trim(const std::string &str)
-        {
-            size_t start = str.find_first_not_of(" \t\n\r");
-            if (start == std::string::npos)
-                return "";
-            size_t end = str.find_last_not_of(" \t\n\r");
-            return str.substr(start, end - start + 1);
-        }
+            class const_iterator
+            {
+            private:
+                const PersistentVector *vec = nullptr;
+                size_t index = 0;
+                const T *leaf = nullptr;
+                size_t leafBase = 0;
 
-        // String contains
-        bool contains(const std::string &str, const std::string &substr)
-        {
-            return str.find(substr) != std::string::npos;
-        }
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const T *;
+                using reference = const T &;
 
-        // String starts with
-        bool startsWith(const std::string &str, const std::string &prefix)
-        {
-            // BUG #213 fix: Check length before substr()
-            if (prefix.length() > str.length())
-                return false;
-            return str.substr(0, prefix.length()) == prefix;
-        }
+                const_iterator() = default;
+                const_iterator(const PersistentVector *owner, size_t position) : vec(owner), index(position)
+                {
+                    if (index < vec->count)
+                    {
+                        leaf = vec->leafNode(index)->values.data();
+                        leafBase = index & ~detail::TRIE_MASK;
+                    }
+                }
 
-        // String ends with
-        bool endsWith(const std::string &str, const std::string &suffix)
-        {
-            if (suffix.length() > str.length())
-                return false;
-            return str.substr(str.length() - suffix.length()) == suffix;
-        }
+                reference operator*() const { return leaf[index - leafBase]; }
+                pointer operator->() const { return leaf + (index - leafBase); }
 
-        // Replace all occurrences
-        std::string replace(const std::string &str, const std::string &from, const std::string &to)
-        {
-            // BUG #219 fix: Prevent infinite loop with empty 'from'
-            if (from.empty())
-                return str;
+                const_iterator &operator++()
+                {
+                    // Leaves are walked directly; the trie is only descended
+                    // once per 32 elements
+                    if (++index - leafBase == detail::TRIE_WIDTH && index < vec->count)
+                    {
+                        leaf = vec->leafNode(index)->values.data();
+                        leafBase = index;
+                    }
+                    return *this;
+                }
 
-            std::string result = str;
-            size_t pos = 0;
-            while ((pos = result.find(from, pos)) != std::string::npos)
-            {
-                result.replace(pos, from.length(), to);
-                pos += to.length();
-            }
-            return result;
-        }
+                const_iterator operator++(int)
+                {
+                    const_iterator previous = *this;
+                    ++*this;
+                    return previous;
+                }
 
-        // Repeat string n times
-        std::string repeat(const std::string &str, int count)
-        {
-            // BUG #215 fix: Validate count >= 0
-            if (count < 0)
-                throw std::invalid_argument("repeat count cannot be negative");
+                bool operator==(const const_iterator &other) const { return index == other.index; }
+                bool operator!=(const const_iterator &other) const { return index != other.index; }
+            };
+            using iterator = const_iterator;
 
-            std::string result;
-            for (int i = 0; i < count; i++)
+            // Batch builder; see the section comment
+            class Transient
             {
-                result += str;
-            }
-            return result;
-        }
+            private:
+                PersistentVector vec;
+                uint64_t edit;
 
-        // Reverse string
-        std::string reverse(const std::string &str)
-        {
-            return std::string(str.rbegin(), str.rend());
-        }
+                void checkOpen() const
+                {
+                    if (edit == 0)
+                        throw std::runtime_error("Transient used after persistent()");
+                }
 
-        // ===== MOLECULE / GRAPH =====
-        enum class BondType
+            public:
+                explicit Transient(PersistentVector source) : vec(std::move(source)), edit(detail::nextEditToken()) {}
+
+                Transient &pushBack(T value)
+                {
+                    checkOpen();
+                    vec.pushInPlace(std::move(value), edit);
+                    return *this;
+                }
+
+                template <typename Range>
+                Transient &append(const Range &items)
+                {
+                    for (const auto &item : items)
+                        pushBack(item);
+                    return *this;
+                }
+
+                Transient &set(size_t index, T value)
+                {
+                    checkOpen();
+                    vec.setInPlace(index, std::move(value), edit);
+                    return *this;
+                }
+
+                Transient &popBack()
+                {
+                    checkOpen();
+                    vec.popInPlace(edit);
+                    return *this;
+                }
+
+                size_t size() const { return vec.size(); }
+                const T &operator[](size_t index) const { return vec[index]; }
+
+                PersistentVector persistent()
+                {
+                    checkOpen();
+                    edit = 0;
+                    return std::move(vec);
+                }
+            };
+
+            PersistentVector() = default;
+
+            PersistentVector(std::initializer_list<T> items) : PersistentVector(items.begin(), items.end()) {}
+
+            template <typename Iter, typename = typename std::iterator_traits<Iter>::iterator_category>
+            PersistentVector(Iter first, Iter last)
+            {
+                const uint64_t edit = detail::nextEditToken();
+                for (; first != last; ++first)
+                    pushInPlace(*first, edit);
+            }
+
+            size_t size() const { return count; }
+            bool isEmpty() const { return count == 0; }
+
+            const T &operator[](size_t index) const
+            {
+                return leafNode(index)->values[index & detail::TRIE_MASK];
+            }
+
+            const T &at(size_t index) const
+            {
+                checkIndex(index);
+                return (*this)[index];
+            }
+
+            const T &get(size_t index) const { return at(index); }
+
+            const T &front() const { return at(0); }
+            const T &back() const
+            {
+                if (count == 0)
+                    throw std::out_of_range("back() on empty PersistentVector");
+                return tail->values.back();
+            }
+
+            // Updates return a new vector; *this is unchanged
+            PersistentVector set(size_t index, T value) const
+            {
+                PersistentVector result = *this;
+                result.setInPlace(index, std::move(value), 0);
+                return result;
+            }
+
+            PersistentVector pushBack(T value) const
+            {
+                PersistentVector result = *this;
+                result.pushInPlace(std::move(value), 0);
+                return result;
+            }
+
+            PersistentVector popBack() const
+            {
+                PersistentVector result = *this;
+                result.popInPlace(0);
+                return result;
+            }
+
+            Transient transient() const { return Transient(*this); }
+
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const { return const_iterator(this, count); }
+
+            std::vector<T> toVector() const { return std::vector<T>(begin(), end()); }
+
+            bool operator==(const PersistentVector &other) const
+            {
+                return count == other.count && std::equal(begin(), end(), other.begin());
+            }
+            bool operator!=(const PersistentVector &other) const { return !(*this == other); }
+        };
+
+        // [...xs, y] in functional files starts from this: O(1) for a
+        // persistent vector, one pass for anything else
+        template <typename T>
+        PersistentVector<T> toPersistentVector(const PersistentVector<T> &items)
+        {
+            return items;
+        }
+
+        template <typename C>
+        auto toPersistentVector(const C &items)
+        {
+            return PersistentVector<typename C::value_type>(std::begin(items), std::end(items));
+        }
+
+        namespace detail
+        {
+            // CHAMP node: entries whose hash slot ends here (dataMap) come
+            // before subtrees (nodeMap), both ordered by slot. Keys whose
+            // hashes agree in every bit share one collision node.
+            template <typename Entry>
+            struct HamtNode
+            {
+                uint64_t edit = 0;
+                uint32_t dataMap = 0;
+                uint32_t nodeMap = 0;
+                bool collision = false;
+                std::vector<Entry> entries;
+                std::vector<std::shared_ptr<HamtNode>> children;
+            };
+
+            template <typename K, typename Entry, typename Hash, typename KeyEqual, typename KeyOf>
+            class Hamt
+            {
+            public:
+                using Node = HamtNode<Entry>;
+                using NodePtr = std::shared_ptr<Node>;
+
+                static constexpr unsigned HASH_BITS = sizeof(size_t) * 8;
+
+                static size_t slot(size_t hash, unsigned shift) { return (hash >> shift) & TRIE_MASK; }
+                static uint32_t bitFor(size_t hash, unsigned shift) { return uint32_t(1) << slot(hash, shift); }
+                static size_t indexOf(uint32_t map, uint32_t bit) { return popcount32(map & (bit - 1)); }
+
+                static NodePtr editable(const NodePtr &node, uint64_t edit)
+                {
+                    if (edit != 0 && node->edit == edit)
+                        return node;
+                    auto copy = std::make_shared<Node>(*node);
+                    copy->edit = edit;
+                    return copy;
+                }
+
+                static const Entry *find(const Node *node, const K &key, size_t hash)
+                {
+                    KeyEqual equal;
+                    for (unsigned shift = 0;; shift += TRIE_BITS)
+                    {
+                        if (node->collision)
+                        {
+                            for (const Entry &entry : node->entries)
+                            {
+                                if (equal(KeyOf()(entry), key))
+                                    return &entry;
+                            }
+                            return nullptr;
+                        }
+                        const uint32_t bit = bitFor(hash, shift);
+                        if (node->dataMap & bit)
+                        {
+                            const Entry &entry = node->entries[indexOf(node->dataMap, bit)];
+                            return equal(KeyOf()(entry), key) ? &entry : nullptr;
+                        }
+                        if (!(node->nodeMap & bit))
+                            return nullptr;
+                        node = node->children[indexOf(node->nodeMap, bit)].get();
+                    }
+                }
+
+                static NodePtr merge(uint64_t edit, Entry a, size_t hashA, Entry b, size_t hashB, unsigned shift)
+                {
+                    auto node = std::make_shared<Node>();
+                    node->edit = edit;
+                    if (shift >= HASH_BITS)
+                    {
+                        node->collision = true;
+                        node->entries.push_back(std::move(a));
+                        node->entries.push_back(std::move(b));
+                        return node;
+                    }
+                    const size_t slotA = slot(hashA, shift);
+                    const size_t slotB = slot(hashB, shift);
+                    if (slotA == slotB)
+                    {
+                        node->nodeMap = uint32_t(1) << slotA;
+                        node->children.push_back(merge(edit, std::move(a), hashA, std::move(b), hashB, shift + TRIE_BITS));
+                    }
+                    else
+                    {
+                        node->dataMap = (uint32_t(1) << slotA) | (uint32_t(1) << slotB);
+                        if (slotA > slotB)
+                            std::swap(a, b);
+                        node->entries.push_back(std::move(a));
+                        node->entries.push_back(std::move(b));
+                    }
+                    return node;
+                }
+
+                // Insert or replace; 'added' is set when the key was new
+                static NodePtr insert(uint64_t edit, const NodePtr &node, Entry entry, size_t hash, unsigned shift, bool &added)
+                {
+                    KeyEqual equal;
+                    const K &key = KeyOf()(entry);
+                    if (node->collision)
+                    {
+                        NodePtr result = editable(node, edit);
+                        for (Entry &existing : result->entries)
+                        {
+                            if (equal(KeyOf()(existing), key))
+                            {
+                                existing = std::move(entry);
+                                return result;
+                            }
+                        }
+                        result->entries.push_back(std::move(entry));
+                        added = true;
+                        return result;
+                    }
+
+                    const uint32_t bit = bitFor(hash, shift);
+                    if (node->dataMap & bit)
+                    {
+                        const size_t index = indexOf(node->dataMap, bit);
+                        NodePtr result = editable(node, edit);
+                        if (equal(KeyOf()(result->entries[index]), key))
+                        {
+                            result->entries[index] = std::move(entry);
+                            return result;
+                        }
+                        // Two keys in one slot: push both one level down
+                        Entry existing = std::move(result->entries[index]);
+                        const size_t existingHash = Hash()(KeyOf()(existing));
+                        result->entries.erase(result->entries.begin() + static_cast<std::ptrdiff_t>(index));
+                        result->dataMap ^= bit;
+                        result->children.insert(result->children.begin() + static_cast<std::ptrdiff_t>(indexOf(result->nodeMap, bit)),
+                                                merge(edit, std::move(existing), existingHash, std::move(entry), hash, shift + TRIE_BITS));
+                        result->nodeMap |= bit;
+                        added = true;
+                        return result;
+                    }
+                    if (node->nodeMap & bit)
+                    {
+                        const size_t index = indexOf(node->nodeMap, bit);
+                        NodePtr child = insert(edit, node->children[index], std::move(entry), hash, shift + TRIE_BITS, added);
+                        if (child == node->children[index])
+                            return node; // Edited in place by the transient that owns both
+                        NodePtr result = editable(node, edit);
+                        result->children[index] = std::move(child);
+                        return result;
+                    }
+                    NodePtr result = editable(node, edit);
+                    result->entries.insert(result->entries.begin() + static_cast<std::ptrdiff_t>(indexOf(result->dataMap, bit)),
+                                           std::move(entry));
+                    result->dataMap |= bit;
+                    added = true;
+                    return result;
+                }
+
+                // Subtrees left with one entry are folded back into the parent,
+                // so equal maps have the same shape however they were built
+                static NodePtr erase(uint64_t edit, const NodePtr &node, const K &key, size_t hash, unsigned shift, bool &removed)
+                {
+                    KeyEqual equal;
+                    if (node->collision)
+                    {
+                        for (size_t i = 0; i < node->entries.size(); i++)
+                        {
+                            if (equal(KeyOf()(node->entries[i]), key))
+                            {
+                                NodePtr result = editable(node, edit);
+                                result->entries.erase(result->entries.begin() + static_cast<std::ptrdiff_t>(i));
+                                removed = true;
+                                return result;
+                            }
+                        }
+                        return node;
+                    }
+
+                    const uint32_t bit = bitFor(hash, shift);
+                    if (node->dataMap & bit)
+                    {
+                        const size_t index = indexOf(node->dataMap, bit);
+                        if (!equal(KeyOf()(node->entries[index]), key))
+                            return node;
+                        NodePtr result = editable(node, edit);
+                        result->entries.erase(result->entries.begin() + static_cast<std::ptrdiff_t>(index));
+                        result->dataMap ^= bit;
+                        removed = true;
+                        return result;
+                    }
+                    if (node->nodeMap & bit)
+                    {
+                        const size_t index = indexOf(node->nodeMap, bit);
+                        NodePtr child = erase(edit, node->children[index], key, hash, shift + TRIE_BITS, removed);
+                        if (!removed)
+                            return node;
+                        if (child->children.empty() && child->entries.size() == 1)
+                        {
+                            NodePtr result = editable(node, edit);
+                            result->children.erase(result->children.begin() + static_cast<std::ptrdiff_t>(index));
+                            result->nodeMap ^= bit;
+                            result->entries.insert(result->entries.begin() + static_cast<std::ptrdiff_t>(indexOf(result->dataMap, bit)),
+                                                   std::move(child->entries[0]));
+                            result->dataMap |= bit;
+                            return result;
+                        }
+                        if (child == node->children[index])
+                            return node;
+                        NodePtr result = editable(node, edit);
+                        result->children[index] = std::move(child);
+                        return result;
+                    }
+                    return node;
+                }
+
+                // Depth-first walk: a node's entries, then its subtrees
+                class Cursor
+                {
+                private:
+                    std::vector<std::pair<const Node *, size_t>> stack;
+
+                    void settle()
+                    {
+                        while (!stack.empty())
+                        {
+                            auto &[node, position] = stack.back();
+                            if (position < node->entries.size())
+                                return;
+                            const size_t child = position - node->entries.size();
+                            if (child < node->children.size())
+                            {
+                                position++;
+                                stack.emplace_back(node->children[child].get(), 0);
+                                continue;
+                            }
+                            stack.pop_back();
+                        }
+                    }
+
+                public:
+                    Cursor() = default;
+                    explicit Cursor(const Node *root)
+                    {
+                        if (root)
+                        {
+                            stack.emplace_back(root, 0);
+                            settle();
+                        }
+                    }
+
+                    const Entry &current() const { return stack.back().first->entries[stack.back().second]; }
+
+                    void advance()
+                    {
+                        stack.back().second++;
+                        settle();
+                    }
+
+                    bool operator==(const Cursor &other) const
+                    {
+                        if (stack.empty() || other.stack.empty())
+                            return stack.empty() == other.stack.empty();
+                        return stack.back() == other.stack.back();
+                    }
+                };
+            };
+
+            template <typename K, typename V>
+            struct MapEntryKey
+            {
+                const K &operator()(const std::pair<K, V> &entry) const { return entry.first; }
+            };
+
+            template <typename K>
+            struct SetEntryKey
+            {
+                const K &operator()(const K &entry) const { return entry; }
+            };
+        } // namespace detail
+
+        template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+        class PersistentMap
+        {
+        private:
+            using Entry = std::pair<K, V>;
+            using Trie = detail::Hamt<K, Entry, Hash, KeyEqual, detail::MapEntryKey<K, V>>;
+            using NodePtr = typename Trie::NodePtr;
+
+            NodePtr root;
+            size_t count = 0;
+
+            static const NodePtr &emptyNode()
+            {
+                static const NodePtr node = std::make_shared<typename Trie::Node>();
+                return node;
+            }
+
+            void setInPlace(const K &key, V value, uint64_t edit)
+            {
+                bool added = false;
+                root = Trie::insert(edit, root ? root : emptyNode(), Entry(key, std::move(value)), Hash()(key), 0, added);
+                count += added ? 1 : 0;
+            }
+
+            void removeInPlace(const K &key, uint64_t edit)
+            {
+                if (!root)
+                    return;
+                bool removed = false;
+                root = Trie::erase(edit, root, key, Hash()(key), 0, removed);
+                count -= removed ? 1 : 0;
+            }
+
+        public:
+            using key_type = K;
+            using mapped_type = V;
+            using value_type = Entry;
+
+            class const_iterator
+            {
+            private:
+                typename Trie::Cursor cursor;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Entry;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const Entry *;
+                using reference = const Entry &;
+
+                const_iterator() = default;
+                explicit const_iterator(typename Trie::Cursor start) : cursor(std::move(start)) {}
+
+                reference operator*() const { return cursor.current(); }
+                pointer operator->() const { return &cursor.current(); }
+                const_iterator &operator++()
+                {
+                    cursor.advance();
+                    return *this;
+                }
+                bool operator==(const const_iterator &other) const { return cursor == other.cursor; }
+                bool operator!=(const const_iterator &other) const { return !(cursor == other.cursor); }
+            };
+            using iterator = const_iterator;
+
+            class Transient
+            {
+            private:
+                PersistentMap map;
+                uint64_t edit;
+
+                void checkOpen() const
+                {
+                    if (edit == 0)
+                        throw std::runtime_error("Transient used after persistent()");
+                }
+
+            public:
+                explicit Transient(PersistentMap source) : map(std::move(source)), edit(detail::nextEditToken()) {}
+
+                Transient &set(const K &key, V value)
+                {
+                    checkOpen();
+                    map.setInPlace(key, std::move(value), edit);
+                    return *this;
+                }
+
+                Transient &remove(const K &key)
+                {
+                    checkOpen();
+                    map.removeInPlace(key, edit);
+                    return *this;
+                }
+
+                bool has(const K &key) const { return map.has(key); }
+                const V &get(const K &key) const { return map.get(key); }
+                size_t size() const { return map.size(); }
+
+                PersistentMap persistent()
+                {
+                    checkOpen();
+                    edit = 0;
+                    return std::move(map);
+                }
+            };
+
+            PersistentMap() = default;
+
+            PersistentMap(std::initializer_list<Entry> entries)
+            {
+                const uint64_t edit = detail::nextEditToken();
+                for (const Entry &entry : entries)
+                    setInPlace(entry.first, entry.second, edit);
+            }
+
+            size_t size() const { return count; }
+            bool isEmpty() const { return count == 0; }
+
+            // nullptr when absent
+            const V *find(const K &key) const
+            {
+                if (!root)
+                    return nullptr;
+                const Entry *entry = Trie::find(root.get(), key, Hash()(key));
+                return entry ? &entry->second : nullptr;
+            }
+
+            bool has(const K &key) const { return find(key) != nullptr; }
+
+            const V &get(const K &key) const
+            {
+                const V *value = find(key);
+                if (!value)
+                    throw std::out_of_range("PersistentMap key not found");
+                return *value;
+            }
+
+            V getOrDefault(const K &key, const V &defaultValue) const
+            {
+                const V *value = find(key);
+                return value ? *value : defaultValue;
+            }
+
+            // Updates return a new map; *this is unchanged
+            PersistentMap set(const K &key, V value) const
+            {
+                PersistentMap result = *this;
+                result.setInPlace(key, std::move(value), 0);
+                return result;
+            }
+
+            PersistentMap remove(const K &key) const
+            {
+                PersistentMap result = *this;
+                result.removeInPlace(key, 0);
+                return result;
+            }
+
+            Transient transient() const { return Transient(*this); }
+
+            const_iterator begin() const { return const_iterator(typename Trie::Cursor(root.get())); }
+            const_iterator end() const { return const_iterator(); }
+        };
+
+        template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+        class PersistentSet
+        {
+        private:
+            using Trie = detail::Hamt<T, T, Hash, KeyEqual, detail::SetEntryKey<T>>;
+            using NodePtr = typename Trie::NodePtr;
+
+            NodePtr root;
+            size_t count = 0;
+
+            static const NodePtr &emptyNode()
+            {
+                static const NodePtr node = std::make_shared<typename Trie::Node>();
+                return node;
+            }
+
+            void addInPlace(const T &item, uint64_t edit)
+            {
+                bool added = false;
+                root = Trie::insert(edit, root ? root : emptyNode(), item, Hash()(item), 0, added);
+                count += added ? 1 : 0;
+            }
+
+            void removeInPlace(const T &item, uint64_t edit)
+            {
+                if (!root)
+                    return;
+                bool removed = false;
+                root = Trie::erase(edit, root, item, Hash()(item), 0, removed);
+                count -= removed ? 1 : 0;
+            }
+
+        public:
+            using value_type = T;
+
+            class const_iterator
+            {
+            private:
+                typename Trie::Cursor cursor;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const T *;
+                using reference = const T &;
+
+                const_iterator() = default;
+                explicit const_iterator(typename Trie::Cursor start) : cursor(std::move(start)) {}
+
+                reference operator*() const { return cursor.current(); }
+                pointer operator->() const { return &cursor.current(); }
+                const_iterator &operator++()
+                {
+                    cursor.advance();
+                    return *this;
+                }
+                bool operator==(const const_iterator &other) const { return cursor == other.cursor; }
+                bool operator!=(const const_iterator &other) const { return !(cursor == other.cursor); }
+            };
+            using iterator = const_iterator;
+
+            class Transient
+            {
+            private:
+                PersistentSet set;
+                uint64_t edit;
+
+                void checkOpen() const
+                {
+                    if (edit == 0)
+                        throw std::runtime_error("Transient used after persistent()");
+                }
+
+            public:
+                explicit Transient(PersistentSet source) : set(std::move(source)), edit(detail::nextEditToken()) {}
+
+                Transient &add(const T &item)
+                {
+                    checkOpen();
+                    set.addInPlace(item, edit);
+                    return *this;
+                }
+
+                Transient &remove(const T &item)
+                {
+                    checkOpen();
+                    set.removeInPlace(item, edit);
+                    return *this;
+                }
+
+                bool has(const T &item) const { return set.has(item); }
+                size_t size() const { return set.size(); }
+
+                PersistentSet persistent()
+                {
+                    checkOpen();
+                    edit = 0;
+                    return std::move(set);
+                }
+            };
+
+            PersistentSet() = default;
+
+            PersistentSet(std::initializer_list<T> items)
+            {
+                const uint64_t edit = detail::nextEditToken();
+                for (const T &item : items)
+                    addInPlace(item, edit);
+            }
+
+            size_t size() const { return count; }
+            bool isEmpty() const { return count == 0; }
+
+            bool has(const T &item) const { return root && Trie::find(root.get(), item, Hash()(item)) != nullptr; }
+
+            // Updates return a new set; *this is unchanged
+            PersistentSet add(const T &item) const
+            {
+                PersistentSet result = *this;
+                result.addInPlace(item, 0);
+                return result;
+            }
+
+            PersistentSet remove(const T &item) const
+            {
+                PersistentSet result = *this;
+                result.removeInPlace(item, 0);
+                return result;
+            }
+
+            Transient transient() const { return Transient(*this); }
+
+            const_iterator begin() const { return const_iterator(typename Trie::Cursor(root.get())); }
+            const_iterator end() const { return const_iterator(); }
+        };
+
+        namespace detail
+        {
+            template <typename C, typename = void>
+            struct IsPersistent : std::false_type
+            {
+            };
+            template <typename C>
+            struct IsPersistent<C, std::void_t<decltype(std::declval<const C &>().transient())>> : std::true_type
+            {
+            };
+
+            // Adds one element of a persistent collection to a transient of
+            // the same type: pushBack for vectors, add for sets, set for maps
+            template <typename B, typename T, typename = void>
+            struct HasPushBack : std::false_type
+            {
+            };
+            template <typename B, typename T>
+            struct HasPushBack<B, T, std::void_t<decltype(std::declval<B &>().pushBack(std::declval<const T &>()))>> : std::true_type
+            {
+            };
+            template <typename B, typename T, typename = void>
+            struct HasAdd : std::false_type
+            {
+            };
+            template <typename B, typename T>
+            struct HasAdd<B, T, std::void_t<decltype(std::declval<B &>().add(std::declval<const T &>()))>> : std::true_type
+            {
+            };
+
+            template <typename B, typename T>
+            void transientInsert(B &builder, const T &item)
+            {
+                if constexpr (HasPushBack<B, T>::value)
+                    builder.pushBack(item);
+                else if constexpr (HasAdd<B, T>::value)
+                    builder.add(item);
+                else
+                    builder.set(item.first, item.second);
+            }
+        } // namespace detail
+
+        // ===== ARENA =====
+        // Region allocator behind `arena { ... }` blocks and functions marked
+        // `#pragma allocator arena`. Allocation bumps a pointer through an
+        // inline buffer, then through geometrically growing heap chunks;
+        // deallocate is a no-op and the whole region is freed in one shot
+        // when the Arena goes out of scope. Collections created inside the
+        // block are std::pmr containers bound to resource().
+        class Arena
+        {
+        public:
+            static constexpr size_t INLINE_BYTES = 4096;
+
+            Arena() : region(inlineBuffer, sizeof(inlineBuffer), std::pmr::new_delete_resource()) {}
+            Arena(const Arena &) = delete;
+            Arena &operator=(const Arena &) = delete;
+
+            std::pmr::memory_resource *resource() { return &region; }
+
+        private:
+            alignas(std::max_align_t) unsigned char inlineBuffer[INLINE_BYTES];
+            std::pmr::monotonic_buffer_resource region;
+        };
+
+        // Copy any iterable into a vector allocated from resource
+        template <typename T, typename C>
+        std::pmr::vector<T> toArenaVector(const C &items, std::pmr::memory_resource *resource)
+        {
+            return std::pmr::vector<T>(std::begin(items), std::end(items), resource);
+        }
+
+        // A temporary already living in the same arena is moved, not copied
+        template <typename T>
+        std::pmr::vector<T> toArenaVector(std::pmr::vector<T> &&items, std::pmr::memory_resource *resource)
+        {
+            if (items.get_allocator().resource() == resource)
+                return std::move(items);
+            return std::pmr::vector<T>(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()), resource);
+        }
+
+        // ===== CONCURRENT QUEUES =====
+        // Bounded lock-free ring buffers for producer/consumer pipelines.
+        // Capacity is rounded up to a power of two so index wrap is a mask.
+
+#ifndef LPP_CACHE_LINE
+#define LPP_CACHE_LINE 64
+#endif
+
+        namespace detail
+        {
+            inline size_t ringCapacity(size_t requested)
+            {
+                if (requested < 2)
+                    requested = 2;
+                size_t cap = 1;
+                while (cap < requested)
+                    cap <<= 1;
+                return cap;
+            }
+
+            // Uninitialized slot storage so T does not need a default constructor
+            template <typename T>
+            struct RingSlot
+            {
+                alignas(T) unsigned char storage[sizeof(T)];
+
+                T *ptr() { return std::launder(reinterpret_cast<T *>(storage)); }
+            };
+        } // namespace detail
+
+        // Single-producer / single-consumer queue.
+        // Each side keeps a cached copy of the other side's index, so the shared
+        // cache line is only touched when the cached view says full/empty.
+        template <typename T>
+        class SpscQueue
+        {
+        private:
+            const size_t mask;
+            std::unique_ptr<detail::RingSlot<T>[]> slots;
+
+            alignas(LPP_CACHE_LINE) std::atomic<size_t> head{0}; // next slot to read
+            size_t cachedTail = 0;                               // consumer's view of tail
+
+            alignas(LPP_CACHE_LINE) std::atomic<size_t> tail{0}; // next slot to write
+            size_t cachedHead = 0;                               // producer's view of head
+
+            template <typename U>
+            bool pushImpl(U &&item)
+            {
+                const size_t t = tail.load(std::memory_order_relaxed);
+                if (t - cachedHead > mask)
+                {
+                    cachedHead = head.load(std::memory_order_acquire);
+                    if (t - cachedHead > mask)
+                        return false; // full
+                }
+                new (slots[t & mask].storage) T(std::forward<U>(item));
+                tail.store(t + 1, std::memory_order_release);
+                return true;
+            }
+
+            // Hands the front element to 'sink' as an rvalue, then frees the slot
+            template <typename F>
+            bool popImpl(F &&sink)
+            {
+                const size_t h = head.load(std::memory_order_relaxed);
+                if (h == cachedTail)
+                {
+                    cachedTail = tail.load(std::memory_order_acquire);
+                    if (h == cachedTail)
+                        return false; // empty
+                }
+                T *slot = slots[h & mask].ptr();
+                sink(std::move(*slot));
+                slot->~T();
+                head.store(h + 1, std::memory_order_release);
+                return true;
+            }
+
+        public:
+            explicit SpscQueue(size_t capacity = 1024)
+                : mask(detail::ringCapacity(capacity) - 1),
+                  slots(new detail::RingSlot<T>[mask + 1]) {}
+
+            SpscQueue(const SpscQueue &) = delete;
+            SpscQueue &operator=(const SpscQueue &) = delete;
+
+            ~SpscQueue()
+            {
+                const size_t t = tail.load(std::memory_order_relaxed);
+                for (size_t h = head.load(std::memory_order_relaxed); h != t; h++)
+                    slots[h & mask].ptr()->~T();
+            }
+
+            // Producer side
+            bool tryEnqueue(const T &item) { return pushImpl(item); }
+            bool tryEnqueue(T &&item) { return pushImpl(std::move(item)); }
+
+            // Consumer side
+            bool tryDequeue(T &out)
+            {
+                return popImpl([&](T &&item)
+                               { out = std::move(item); });
+            }
+            std::optional<T> tryDequeue()
+            {
+                std::optional<T> result;
+                popImpl([&](T &&item)
+                        { result.emplace(std::move(item)); });
+                return result;
+            }
+
+            // Approximate when called concurrently
+            size_t size() const
+            {
+                return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+            }
+            bool isEmpty() const { return size() == 0; }
+            size_t capacity() const { return mask + 1; }
+        };
+
+        // Multi-producer / multi-consumer queue (Vyukov bounded MPMC).
+        // Every cell carries a sequence number; both sides claim a position with
+        // one CAS and publish through the cell sequence, so there is no lock.
+        template <typename T>
+        class MpmcQueue
+        {
+        private:
+            struct Cell
+            {
+                std::atomic<size_t> sequence;
+                detail::RingSlot<T> slot;
+            };
+
+            const size_t mask;
+            std::unique_ptr<Cell[]> cells;
+
+            alignas(LPP_CACHE_LINE) std::atomic<size_t> enqueuePos{0};
+            alignas(LPP_CACHE_LINE) std::atomic<size_t> dequeuePos{0};
+
+            template <typename U>
+            bool pushImpl(U &&item)
+            {
+                size_t pos = enqueuePos.load(std::memory_order_relaxed);
+                Cell *cell;
+                for (;;)
+                {
+                    cell = &cells[pos & mask];
+                    const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                    const std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+                    if (diff == 0)
+                    {
+                        if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (diff < 0)
+                    {
+                        return false; // full
+                    }
+                    else
+                    {
+                        pos = enqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+                new (cell->slot.storage) T(std::forward<U>(item));
+                cell->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            template <typename F>
+            bool popImpl(F &&sink)
+            {
+                size_t pos = dequeuePos.load(std::memory_order_relaxed);
+                Cell *cell;
+                for (;;)
+                {
+                    cell = &cells[pos & mask];
+                    const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                    const std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+                    if (diff == 0)
+                    {
+                        if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (diff < 0)
+                    {
+                        return false; // empty
+                    }
+                    else
+                    {
+                        pos = dequeuePos.load(std::memory_order_relaxed);
+                    }
+                }
+                T *slot = cell->slot.ptr();
+                sink(std::move(*slot));
+                slot->~T();
+                cell->sequence.store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+
+        public:
+            explicit MpmcQueue(size_t capacity = 1024)
+                : mask(detail::ringCapacity(capacity) - 1),
+                  cells(new Cell[mask + 1])
+            {
+                for (size_t i = 0; i <= mask; i++)
+                    cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            MpmcQueue(const MpmcQueue &) = delete;
+            MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+            ~MpmcQueue()
+            {
+                const size_t e = enqueuePos.load(std::memory_order_relaxed);
+                for (size_t pos = dequeuePos.load(std::memory_order_relaxed); pos != e; pos++)
+                    cells[pos & mask].slot.ptr()->~T();
+            }
+
+            bool tryEnqueue(const T &item) { return pushImpl(item); }
+            bool tryEnqueue(T &&item) { return pushImpl(std::move(item)); }
+
+            bool tryDequeue(T &out)
+            {
+                return popImpl([&](T &&item)
+                               { out = std::move(item); });
+            }
+            std::optional<T> tryDequeue()
+            {
+                std::optional<T> result;
+                popImpl([&](T &&item)
+                        { result.emplace(std::move(item)); });
+                return result;
+            }
+
+            // Approximate when called concurrently
+            size_t size() const
+            {
+                const size_t e = enqueuePos.load(std::memory_order_acquire);
+                const size_t d = dequeuePos.load(std::memory_order_acquire);
+                return e > d ? e - d : 0;
+            }
+            bool isEmpty() const { return size() == 0; }
+            size_t capacity() const { return mask + 1; }
+        };
+
+        // ===== CHANNEL =====
+        // Blocking bounded channel over MpmcQueue. The fast path is lock-free;
+        // the mutex is only taken to park a thread when the queue is full/empty,
+        // so uncontended send/receive never lock.
+        // Usage from L++:  let jobs: Channel<int>;  jobs.send(42);  jobs.receive();
+        template <typename T>
+        class Channel
+        {
+        private:
+            MpmcQueue<T> queue;
+            std::atomic<bool> closed{false};
+            std::atomic<int> waitingSenders{0};
+            std::atomic<int> waitingReceivers{0};
+            std::mutex waitMutex;
+            std::condition_variable notEmpty;
+            std::condition_variable notFull;
+
+            static constexpr int SPIN_LIMIT = 64;
+
+            void wake(std::atomic<int> &waiters, std::condition_variable &cv)
+            {
+                if (waiters.load(std::memory_order_seq_cst) > 0)
+                {
+                    // Taking the lock orders this notify after the waiter's predicate check
+                    {
+                        std::lock_guard<std::mutex> lock(waitMutex);
+                    }
+                    cv.notify_one();
+                }
+            }
+
+        public:
+            explicit Channel(size_t capacity = 1024) : queue(capacity) {}
+
+            Channel(const Channel &) = delete;
+            Channel &operator=(const Channel &) = delete;
+
+            // Blocks while the channel is full. Throws if the channel is closed.
+            template <typename U>
+            void send(U &&item)
+            {
+                T value(std::forward<U>(item));
+                for (int spin = 0;; spin++)
+                {
+                    if (closed.load(std::memory_order_acquire))
+                        throw std::runtime_error("send on closed channel");
+                    if (queue.tryEnqueue(std::move(value))) // only moves on success
+                        break;
+                    if (spin < SPIN_LIMIT)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> lock(waitMutex);
+                    waitingSenders.fetch_add(1, std::memory_order_seq_cst);
+                    notFull.wait(lock, [&]
+                                 { return queue.size() < queue.capacity() || closed.load(); });
+                    waitingSenders.fetch_sub(1, std::memory_order_relaxed);
+                }
+                wake(waitingReceivers, notEmpty);
+            }
+
+            // Non-blocking send; false if full or closed
+            template <typename U>
+            bool trySend(U &&item)
+            {
+                if (closed.load(std::memory_order_acquire) || !queue.tryEnqueue(std::forward<U>(item)))
+                    return false;
+                wake(waitingReceivers, notEmpty);
+                return true;
+            }
+
+            // Blocks until an item is available. Returns nullopt once the
+            // channel is closed and drained.
+            std::optional<T> receive()
+            {
+                std::optional<T> item;
+                for (int spin = 0;; spin++)
+                {
+                    if ((item = queue.tryDequeue()))
+                        break;
+                    if (closed.load(std::memory_order_acquire))
+                    {
+                        // Items sent before close() are still delivered
+                        if ((item = queue.tryDequeue()))
+                            break;
+                        return std::nullopt;
+                    }
+                    if (spin < SPIN_LIMIT)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> lock(waitMutex);
+                    waitingReceivers.fetch_add(1, std::memory_order_seq_cst);
+                    notEmpty.wait(lock, [&]
+                                  { return !queue.isEmpty() || closed.load(); });
+                    waitingReceivers.fetch_sub(1, std::memory_order_relaxed);
+                }
+                wake(waitingSenders, notFull);
+                return item;
+            }
+
+            std::optional<T> tryReceive()
+            {
+                std::optional<T> item = queue.tryDequeue();
+                if (item)
+                    wake(waitingSenders, notFull);
+                return item;
+            }
+
+            // Wakes every blocked sender/receiver; pending items stay receivable
+            void close()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(waitMutex);
+                    closed.store(true, std::memory_order_release);
+                }
+                notEmpty.notify_all();
+                notFull.notify_all();
+            }
+
+            bool isClosed() const { return closed.load(std::memory_order_acquire); }
+            size_t size() const { return queue.size(); }
+            bool isEmpty() const { return queue.isEmpty(); }
+            size_t capacity() const { return queue.capacity(); }
+        };
+
+        // ===== OUTPUT =====
+        // print() appends to a per-thread buffer that is written out when full,
+        // on flush(), and when the thread exits (for the main thread: at exit).
+        // An uncaught exception or std::terminate() flushes the terminating
+        // thread's buffer before the previous terminate handler runs, so the
+        // lines printed before a crash are not lost.
+        // A buffer only ever holds whole lines, so concurrent threads never
+        // split each other's lines. When stdout is a terminal every line is
+        // written immediately. Output from different threads is ordered only
+        // by flush(); mix with std::cout only after calling flush().
+        namespace detail
+        {
+            inline bool installOutputTerminateHandler();
+
+            class OutputBuffer
+            {
+            public:
+                static constexpr size_t CAPACITY = 1 << 16;
+
+            private:
+                std::unique_ptr<char[]> data;
+                size_t used = 0;
+                bool lineBuffered;
+
+                static void writeOut(const char *bytes, size_t count)
+                {
+#ifndef _WIN32
+                    while (count > 0)
+                    {
+                        ssize_t written = ::write(STDOUT_FILENO, bytes, count);
+                        if (written < 0)
+                        {
+                            if (errno == EINTR)
+                                continue;
+                            return; // Closed pipe etc.: drop output like std::cout would
+                        }
+                        bytes += written;
+                        count -= static_cast<size_t>(written);
+                    }
+#else
+                    std::fwrite(bytes, 1, count, stdout);
+                    std::fflush(stdout);
+#endif
+                }
+
+            public:
+                OutputBuffer() : data(new char[CAPACITY])
+                {
+                    static const bool terminateHandlerInstalled = installOutputTerminateHandler();
+                    (void)terminateHandlerInstalled;
+#ifndef _WIN32
+                    lineBuffered = ::isatty(STDOUT_FILENO) != 0;
+#else
+                    lineBuffered = true;
+#endif
+                }
+
+                OutputBuffer(const OutputBuffer &) = delete;
+                OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+                ~OutputBuffer() { flush(); }
+
+                bool empty() const { return used == 0; }
+
+                // Room for a line of 'count' bytes; lines longer than the
+                // buffer bypass it (returns nullptr after flushing)
+                char *reserve(size_t count)
+                {
+                    if (count > CAPACITY - used)
+                    {
+                        flush();
+                        if (count > CAPACITY)
+                            return nullptr;
+                    }
+                    return data.get() + used;
+                }
+
+                void commit(size_t count)
+                {
+                    used += count;
+                    if (lineBuffered)
+                        flush();
+                }
+
+                void writeLine(const char *text, size_t count)
+                {
+                    char *dest = reserve(count + 1);
+                    if (!dest)
+                    {
+                        writeOut(text, count);
+                        writeOut("\n", 1);
+                        return;
+                    }
+                    std::memcpy(dest, text, count);
+                    dest[count] = '\n';
+                    commit(count + 1);
+                }
+
+                void flush()
+                {
+                    if (used == 0)
+                        return;
+                    // Keep anything already queued in stdio in front of us
+                    std::fflush(stdout);
+                    writeOut(data.get(), used);
+                    used = 0;
+                }
+            };
+
+            inline OutputBuffer &threadOutput()
+            {
+                thread_local OutputBuffer out;
+                return out;
+            }
+
+            inline std::terminate_handler &previousTerminateHandler()
+            {
+                static std::terminate_handler handler = nullptr;
+                return handler;
+            }
+
+            [[noreturn]] inline void flushOutputOnTerminate()
+            {
+                threadOutput().flush();
+                if (std::terminate_handler previous = previousTerminateHandler())
+                    previous();
+                std::abort();
+            }
+
+            // Installed once, by the first buffer created in the program
+            inline bool installOutputTerminateHandler()
+            {
+                previousTerminateHandler() = std::set_terminate(flushOutputOnTerminate);
+                return true;
+            }
+
+            // Longest to_chars result for T plus the newline
+            template <typename T>
+            constexpr size_t formattedWidth()
+            {
+                return std::is_floating_point_v<T> ? 32 : std::numeric_limits<T>::digits10 + 4;
+            }
+        }
+
+        inline void print(std::string_view text)
+        {
+            detail::threadOutput().writeLine(text.data(), text.size());
+        }
+
+        inline void print(const std::string &text) { print(std::string_view(text)); }
+
+        inline void print(const char *text) { print(std::string_view(text)); }
+
+        // Integers (bool and char print as numbers) and floating point with
+        // the same %g / 6-digit formatting std::cout uses by default
+        template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+        void print(T value)
+        {
+            auto &out = detail::threadOutput();
+            char *dest = out.reserve(detail::formattedWidth<T>());
+            char *end = nullptr;
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                end = std::to_chars(dest, dest + detail::formattedWidth<T>() - 1, value,
+                                    std::chars_format::general, 6)
+                          .ptr;
+            }
+            else if constexpr (std::is_same_v<T, bool> || sizeof(T) < sizeof(int))
+            {
+                end = std::to_chars(dest, dest + detail::formattedWidth<T>() - 1, static_cast<int>(value)).ptr;
+            }
+            else
+            {
+                end = std::to_chars(dest, dest + detail::formattedWidth<T>() - 1, value).ptr;
+            }
+            *end++ = '\n';
+            out.commit(static_cast<size_t>(end - dest));
+        }
+
+        // Write this thread's pending output now
+        inline void flush() { detail::threadOutput().flush(); }
+
+        // ===== TASK SCHEDULER =====
+        // Work-stealing scheduler behind spawn, scope { }, parallel for and
+        // the data-parallel kernels (@, ?, \, parallelSort, graph algorithms),
+        // so a program has one set of worker threads however it mixes them.
+        // Each worker owns a deque: it pushes and pops its own tasks at the
+        // back (newest first, while their data is still in cache) and, once
+        // it runs dry, steals from the front of another worker's deque (the
+        // oldest task, usually the largest piece of work left). Threads
+        // outside the scheduler submit through a shared injection queue.
+        // A thread waiting for tasks (Task::get, TaskScope::join,
+        // parallelForEach, parallelForRange) runs queued tasks meanwhile
+        // instead of blocking, so nested parallelism cannot deadlock, even
+        // with one worker. With nothing left to run it sleeps until a task
+        // finishes or new work is queued.
+        class TaskScheduler
+        {
+        public:
+            using Job = std::function<void()>; // must not throw
+
+        private:
+            struct WorkQueue
+            {
+                std::mutex m;
+                std::deque<Job> jobs;
+            };
+            const size_t workerCount;
+            std::vector<std::unique_ptr<WorkQueue>> queues; // per worker, then injection
+            std::vector<std::thread> workers;
+            std::atomic<size_t> queued{0};
+            std::atomic<int> sleepers{0}; // idle workers, woken by push
+            std::atomic<int> waiters{0};  // threads in helpUntil, woken by push and finished tasks
+            std::mutex sleepMutex;
+            std::condition_variable wakeUp;
+            std::condition_variable taskDone;
+            bool stopping = false; // guarded by sleepMutex
+
+            struct Identity
+            {
+                const TaskScheduler *scheduler = nullptr;
+                size_t index = 0;
+                size_t victim = 0; // rotates so thieves don't all hit one deque
+            };
+            static Identity &identity()
+            {
+                static thread_local Identity self;
+                return self;
+            }
+
+            // This worker's deque, or the injection queue for other threads
+            size_t homeQueue() const
+            {
+                const Identity &self = identity();
+                return self.scheduler == this ? self.index : workerCount;
+            }
+
+            bool take(size_t queue, bool newest, Job &job)
+            {
+                WorkQueue &q = *queues[queue];
+                std::lock_guard<std::mutex> lock(q.m);
+                if (q.jobs.empty())
+                    return false;
+                if (newest)
+                {
+                    job = std::move(q.jobs.back());
+                    q.jobs.pop_back();
+                }
+                else
+                {
+                    job = std::move(q.jobs.front());
+                    q.jobs.pop_front();
+                }
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            // Own deque newest first, then the injection queue, then the
+            // oldest task of another worker
+            bool tryTake(Job &job)
+            {
+                if (queued.load(std::memory_order_acquire) == 0)
+                    return false;
+                const size_t home = homeQueue();
+                if (home < workerCount && take(home, true, job))
+                    return true;
+                if (take(workerCount, false, job))
+                    return true;
+                const size_t start = identity().victim++;
+                for (size_t k = 0; k < workerCount; k++)
+                {
+                    const size_t victim = (start + k) % workerCount;
+                    if (victim != home && take(victim, false, job))
+                        return true;
+                }
+                return false;
+            }
+
+            void workerLoop(size_t index)
+            {
+                identity() = Identity{this, index, index + 1};
+                for (;;)
+                {
+                    if (runOne())
+                    {
+                        // Workers live until exit; don't hold task output until then
+                        auto &out = detail::threadOutput();
+                        if (!out.empty())
+                        {
+                            out.flush();
+                        }
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> lock(sleepMutex);
+                    sleepers.fetch_add(1, std::memory_order_seq_cst);
+                    wakeUp.wait(lock, [this]
+                                { return stopping || queued.load(std::memory_order_seq_cst) > 0; });
+                    sleepers.fetch_sub(1, std::memory_order_seq_cst);
+                    if (stopping && queued.load() == 0)
+                    {
+                        return; // Stopping and drained
+                    }
+                }
+            }
+
+        public:
+            explicit TaskScheduler(size_t threads = std::thread::hardware_concurrency())
+                : workerCount(threads == 0 ? 1 : threads)
+            {
+                for (size_t i = 0; i <= workerCount; i++)
+                {
+                    queues.push_back(std::make_unique<WorkQueue>());
+                }
+                workers.reserve(workerCount);
+                for (size_t i = 0; i < workerCount; i++)
+                {
+                    workers.emplace_back([this, i]
+                                         { workerLoop(i); });
+                }
+            }
+
+            TaskScheduler(const TaskScheduler &) = delete;
+            TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+            // Runs every task still queued, then stops the workers
+            ~TaskScheduler()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(sleepMutex);
+                    stopping = true;
+                }
+                wakeUp.notify_all();
+                for (auto &worker : workers)
+                {
+                    worker.join();
+                }
+            }
+
+            // Process-wide scheduler sized to the hardware
+            static TaskScheduler &global()
+            {
+                static TaskScheduler scheduler;
+                return scheduler;
+            }
+
+            size_t size() const { return workerCount; }
+
+            void push(Job job)
+            {
+                {
+                    WorkQueue &q = *queues[homeQueue()];
+                    std::lock_guard<std::mutex> lock(q.m);
+                    q.jobs.push_back(std::move(job));
+                    queued.fetch_add(1, std::memory_order_seq_cst);
+                }
+                const bool sleeping = sleepers.load(std::memory_order_seq_cst) > 0;
+                const bool waiting = waiters.load(std::memory_order_seq_cst) > 0;
+                if (sleeping || waiting)
+                {
+                    // Taking the lock orders this notify after the sleeper's predicate check
+                    {
+                        std::lock_guard<std::mutex> lock(sleepMutex);
+                    }
+                    if (sleeping)
+                        wakeUp.notify_one();
+                    if (waiting)
+                        taskDone.notify_one();
+                }
+            }
+
+            // Runs one queued task on the calling thread; false if none was found
+            bool runOne()
+            {
+                Job job;
+                if (!tryTake(job))
+                    return false;
+                job();
+                // The task may have completed what a waiting thread needs. The
+                // fence pairs with the one in helpUntil: the job's release
+                // store of its result cannot be reordered after this load, so
+                // either the waiter sees the result or we see the waiter.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (waiters.load(std::memory_order_seq_cst) > 0)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(sleepMutex);
+                    }
+                    taskDone.notify_all();
+                }
+                return true;
+            }
+
+            // Runs queued tasks until done() holds, sleeping while there is
+            // nothing to run. done() must become true only through tasks of
+            // this scheduler (their completion is what wakes the caller).
+            template <typename Done>
+            void helpUntil(Done done)
+            {
+                while (!done())
+                {
+                    if (runOne())
+                        continue;
+                    std::unique_lock<std::mutex> lock(sleepMutex);
+                    waiters.fetch_add(1, std::memory_order_seq_cst);
+                    std::atomic_thread_fence(std::memory_order_seq_cst); // see runOne
+                    taskDone.wait(lock, [this, &done]
+                                  { return done() || queued.load(std::memory_order_seq_cst) > 0; });
+                    waiters.fetch_sub(1, std::memory_order_seq_cst);
+                }
+            }
+
+            // Run body(lo, hi) over [begin, end) split into chunks of 'grain'
+            // indices (chunk starts are begin + k * grain). At most size() threads
+            // take part, the caller included. Rethrows the first exception.
+            template <typename F>
+            void parallelForRange(size_t begin, size_t end, size_t grain, F &&body)
+            {
+                if (end <= begin)
+                {
+                    return;
+                }
+                if (grain == 0)
+                {
+                    grain = 1;
+                }
+                const size_t chunks = (end - begin + grain - 1) / grain;
+                if (chunks == 1 || workerCount <= 1)
+                {
+                    body(begin, end);
+                    return;
+                }
+
+                struct State
+                {
+                    std::atomic<size_t> next{0};
+                    std::atomic<size_t> done{0};
+                    std::mutex errorMutex;
+                    std::exception_ptr error;
+                };
+                auto state = std::make_shared<State>();
+
+                // Helpers that start after the last chunk was claimed touch only
+                // 'state', so they may outlive this call safely
+                auto runChunks = [state, begin, end, grain, chunks, &body]
+                {
+                    for (;;)
+                    {
+                        size_t chunk = state->next.fetch_add(1, std::memory_order_relaxed);
+                        if (chunk >= chunks)
+                        {
+                            return;
+                        }
+                        size_t lo = begin + chunk * grain;
+                        size_t hi = std::min(end, lo + grain);
+                        try
+                        {
+                            body(lo, hi);
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock(state->errorMutex);
+                            if (!state->error)
+                            {
+                                state->error = std::current_exception();
+                            }
+                        }
+                        state->done.fetch_add(1, std::memory_order_release);
+                    }
+                };
+
+                const size_t helpers = std::min(workerCount - 1, chunks - 1);
+                for (size_t i = 0; i < helpers; i++)
+                {
+                    push(runChunks);
+                }
+                runChunks();
+
+                helpUntil([&state, chunks]
+                          { return state->done.load(std::memory_order_acquire) == chunks; });
+                if (state->error)
+                {
+                    std::rethrow_exception(state->error);
+                }
+            }
+
+            // Per-index convenience form of parallelForRange
+            template <typename F>
+            void parallelFor(size_t begin, size_t end, F &&body, size_t grain = 1024)
+            {
+                parallelForRange(begin, end, grain, [&body](size_t lo, size_t hi)
+                                 {
+                    for (size_t i = lo; i < hi; i++)
+                        body(i); });
+            }
+        };
+
+        // The data-parallel kernels were written against a separate thread
+        // pool; they take the scheduler under that name
+        using ThreadPool = TaskScheduler;
+
+        namespace detail
+        {
+            template <typename R>
+            struct TaskState
+            {
+                std::atomic<bool> done{false};
+                std::optional<std::conditional_t<std::is_void<R>::value, char, R>> value;
+                std::exception_ptr error;
+            };
+        } // namespace detail
+
+        // Handle to a spawned task. get() waits for the result (running other
+        // tasks meanwhile) and rethrows what the task threw; 'await task' in
+        // L++ lowers to it.
+        template <typename R>
+        class Task
+        {
+        private:
+            std::shared_ptr<detail::TaskState<R>> state;
+            TaskScheduler *scheduler = nullptr;
+
+        public:
+            Task() = default;
+            Task(std::shared_ptr<detail::TaskState<R>> state, TaskScheduler &scheduler)
+                : state(std::move(state)), scheduler(&scheduler) {}
+
+            bool valid() const { return state != nullptr; }
+            bool ready() const { return state && state->done.load(std::memory_order_acquire); }
+
+            R get() const
+            {
+                if (!state)
+                    throw std::runtime_error("get() on an empty task");
+                scheduler->helpUntil([this]
+                                     { return ready(); });
+                if (state->error)
+                    std::rethrow_exception(state->error);
+                if constexpr (!std::is_void<R>::value)
+                    return *state->value;
+            }
+        };
+
+        namespace detail
+        {
+            // Queues fn; finish(error) runs last, once the result is published
+            template <typename F, typename Finish>
+            auto startTask(TaskScheduler &scheduler, F fn, Finish finish)
+            {
+                using R = std::invoke_result_t<F &>;
+                auto state = std::make_shared<TaskState<R>>();
+                scheduler.push([state, fn = std::move(fn), finish]() mutable
+                               {
+                    try
+                    {
+                        if constexpr (std::is_void<R>::value)
+                            fn();
+                        else
+                            state->value.emplace(fn());
+                    }
+                    catch (...)
+                    {
+                        state->error = std::current_exception();
+                    }
+                    state->done.store(true, std::memory_order_release);
+                    finish(state->error); });
+                return Task<R>(std::move(state), scheduler);
+            }
+        } // namespace detail
+
+        // Unscoped spawn: the task runs on its own and is awaited through the
+        // returned handle; the scheduler runs it before the program exits
+        template <typename F>
+        auto spawn(F fn, TaskScheduler &scheduler = TaskScheduler::global())
+        {
+            return detail::startTask(scheduler, std::move(fn), [](const std::exception_ptr &) {});
+        }
+
+        // Structured concurrency for 'scope { }': every task spawned through
+        // the scope has finished when the block is left. join() at the end of
+        // the block rethrows the first exception a task threw; when the block
+        // is left early (return, or an exception of its own) the destructor
+        // still waits for the tasks but reports nothing.
+        class TaskScope
+        {
+        private:
+            TaskScheduler &scheduler;
+            std::atomic<size_t> running{0};
+            std::mutex errorMutex;
+            std::exception_ptr error;
+
+        public:
+            explicit TaskScope(TaskScheduler &scheduler = TaskScheduler::global()) : scheduler(scheduler) {}
+
+            TaskScope(const TaskScope &) = delete;
+            TaskScope &operator=(const TaskScope &) = delete;
+
+            ~TaskScope()
+            {
+                scheduler.helpUntil([this]
+                                    { return running.load(std::memory_order_acquire) == 0; });
+            }
+
+            // Safe to call from tasks of the same scope
+            template <typename F>
+            auto spawn(F fn)
+            {
+                running.fetch_add(1, std::memory_order_relaxed);
+                try
+                {
+                    return detail::startTask(scheduler, std::move(fn), [this](const std::exception_ptr &failure)
+                                             {
+                        if (failure)
+                        {
+                            std::lock_guard<std::mutex> lock(errorMutex);
+                            if (!error)
+                                error = failure;
+                        }
+                        // Last touch of the scope: join() may return right after
+                        running.fetch_sub(1, std::memory_order_release); });
+                }
+                catch (...)
+                {
+                    running.fetch_sub(1, std::memory_order_release);
+                    throw;
+                }
+            }
+
+            void join()
+            {
+                scheduler.helpUntil([this]
+                                    { return running.load(std::memory_order_acquire) == 0; });
+                std::exception_ptr failure;
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    std::swap(failure, error);
+                }
+                if (failure)
+                    std::rethrow_exception(failure);
+            }
+        };
+
+        // ===== RANDOM =====
+        // xoshiro256** generator: 32 bytes of state, satisfies
+        // UniformRandomBitGenerator so it also drives the <random> distributions.
+        class Xoshiro256
+        {
+        private:
+            uint64_t s[4];
+
+            static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        public:
+            using result_type = uint64_t;
+
+            explicit Xoshiro256(uint64_t value = 0) { seed(value); }
+
+            // Expand one 64-bit seed with splitmix64 (never yields the all-zero state)
+            void seed(uint64_t value)
+            {
+                for (uint64_t &word : s)
+                {
+                    value += 0x9E3779B97F4A7C15ull;
+                    uint64_t z = value;
+                    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                    word = z ^ (z >> 31);
+                }
+            }
+
+            static constexpr result_type min() { return 0; }
+            static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+            result_type operator()()
+            {
+                const uint64_t result = rotl(s[1] * 5, 7) * 9;
+                const uint64_t t = s[1] << 17;
+                s[2] ^= s[0];
+                s[3] ^= s[1];
+                s[1] ^= s[2];
+                s[0] ^= s[3];
+                s[2] ^= t;
+                s[3] = rotl(s[3], 45);
+                return result;
+            }
+
+            // Uniform in [0, 1) with 53 random bits
+            double nextDouble() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+
+            // Uniform in [0, bound); bound must be non-zero
+            uint64_t nextBelow(uint64_t bound)
+            {
+                // Rejection keeps the result unbiased; at most one retry on average
+                const uint64_t limit = max() - max() % bound;
+                uint64_t x;
+                do
+                {
+                    x = (*this)();
+                } while (x >= limit);
+                return x % bound;
+            }
+        };
+
+        namespace detail
+        {
+            struct RandomSeedState
+            {
+                std::atomic<uint64_t> base;
+                std::atomic<uint64_t> generation{0};
+                std::atomic<uint64_t> streams{1}; // stream 0 is the thread that called seedRandom
+
+                RandomSeedState() : base(std::random_device{}() ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())) {}
+            };
+
+            inline RandomSeedState &randomSeedState()
+            {
+                static RandomSeedState state;
+                return state;
+            }
+
+            struct ThreadRandom
+            {
+                Xoshiro256 rng;
+                uint64_t generation = std::numeric_limits<uint64_t>::max();
+                uint64_t stream = std::numeric_limits<uint64_t>::max();
+            };
+
+            inline ThreadRandom &threadRandom()
+            {
+                thread_local ThreadRandom local;
+                return local;
+            }
+        } // namespace detail
+
+        // Per-thread generator. Each thread gets its own stream derived from the
+        // global seed, so no locking is needed. Streams are numbered in the
+        // order threads first draw, and tasks move between workers, so draws
+        // made on other threads differ from run to run even with a fixed seed;
+        // only the seeding thread's sequence is reproducible.
+        inline Xoshiro256 &threadRng()
+        {
+            detail::ThreadRandom &local = detail::threadRandom();
+            detail::RandomSeedState &state = detail::randomSeedState();
+            const uint64_t generation = state.generation.load(std::memory_order_acquire);
+            if (local.generation != generation)
+            {
+                if (local.stream == std::numeric_limits<uint64_t>::max())
+                    local.stream = state.streams.fetch_add(1, std::memory_order_relaxed);
+                local.rng.seed(state.base.load(std::memory_order_relaxed) ^ (local.stream * 0xD1B54A32D192ED03ull));
+                local.generation = generation;
+            }
+            return local.rng;
+        }
+
+        // Reseed every thread's generator (emitted for '#pragma seed N'). The
+        // calling thread takes stream 0, so a single-threaded program draws the
+        // same sequence on every run; a program that draws inside spawn,
+        // parallel for or parallel kernels does not.
+        inline void seedRandom(uint64_t seed)
+        {
+            detail::RandomSeedState &state = detail::randomSeedState();
+            state.base.store(seed, std::memory_order_relaxed);
+            state.generation.fetch_add(1, std::memory_order_release);
+            detail::threadRandom().stream = 0;
+        }
+
+        // Walker/Vose alias table: O(n) to build, O(1) per draw with one random
+        // number. Weights need not be normalized.
+        class AliasTable
+        {
+        private:
+            std::vector<double> threshold; // chance of keeping column i
+            std::vector<uint32_t> alias;   // otherwise take alias[i]
+
+        public:
+            AliasTable() = default;
+
+            explicit AliasTable(const std::vector<double> &weights)
+            {
+                const size_t n = weights.size();
+                if (n == 0 || n > std::numeric_limits<uint32_t>::max())
+                {
+                    throw std::invalid_argument("AliasTable: need between 1 and 2^32-1 weights");
+                }
+                double sum = 0.0;
+                for (double w : weights)
+                {
+                    if (!(w >= 0.0))
+                    {
+                        throw std::invalid_argument("AliasTable: weights must be non-negative");
+                    }
+                    sum += w;
+                }
+                if (!(sum > 0.0) || sum == std::numeric_limits<double>::infinity())
+                {
+                    throw std::invalid_argument("AliasTable: weights must have a positive finite sum");
+                }
+
+                threshold.resize(n);
+                alias.resize(n);
+                std::vector<uint32_t> small, large;
+                small.reserve(n);
+                large.reserve(n);
+                for (size_t i = 0; i < n; i++)
+                {
+                    threshold[i] = weights[i] * static_cast<double>(n) / sum;
+                    alias[i] = static_cast<uint32_t>(i);
+                    (threshold[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+                }
+                while (!small.empty() && !large.empty())
+                {
+                    uint32_t less = small.back();
+                    small.pop_back();
+                    uint32_t more = large.back();
+                    alias[less] = more;
+                    threshold[more] -= 1.0 - threshold[less];
+                    if (threshold[more] < 1.0)
+                    {
+                        large.pop_back();
+                        small.push_back(more);
+                    }
+                }
+                // Leftovers are 1.0 up to rounding
+                for (uint32_t i : large)
+                    threshold[i] = 1.0;
+                for (uint32_t i : small)
+                    threshold[i] = 1.0;
+            }
+
+            size_t size() const { return threshold.size(); }
+            bool empty() const { return threshold.empty(); }
+
+            size_t sample(Xoshiro256 &rng) const
+            {
+                // One draw picks the column (integer part) and the coin (fraction)
+                const double u = rng.nextDouble() * static_cast<double>(threshold.size());
+                size_t column = static_cast<size_t>(u);
+                if (column >= threshold.size())
+                    column = threshold.size() - 1;
+                return u - static_cast<double>(column) < threshold[column] ? column : alias[column];
+            }
+        };
+
+        // ===== QUANTUM VARIABLES =====
+        // Runtime for 'quantum let' declarations: a discrete distribution over
+        // states that collapses to one of them on the first observe().
+        //
+        // Variables derived with map()/entangle() share the probability table and
+        // read their states through the source (no copies): a derived variable
+        // costs O(1) memory however large the state space. The collapse is stored
+        // as an index, so T needs no operator==. Every variable owns a collapse
+        // cell from the start, so a variable combined with itself pairs state i
+        // with state i. A copy gets its own cell (starting in the original's
+        // state) and collapses independently; only entangle() shares one.
+        //
+        // Operators and map2() on two variables build the exact joint
+        // distribution (independent variables) or combine state by state
+        // (entangled ones).
+        enum class QuantumJoinMode
+        {
+            EXACT,       // full product; throws std::length_error above maxStates
+            MONTE_CARLO, // always approximate from 'samples' joint draws
+            AUTO         // exact up to maxStates, Monte-Carlo beyond
+        };
+
+        struct QuantumJoinOptions
+        {
+            QuantumJoinMode mode = QuantumJoinMode::AUTO;
+            size_t maxStates = size_t(1) << 22; // cap on the product of the state counts
+            size_t samples = size_t(1) << 16;   // joint draws in Monte-Carlo mode
+        };
+
+        // Options used by the operators; set them before starting threads
+        inline QuantumJoinOptions &quantumJoinDefaults()
+        {
+            static QuantumJoinOptions options;
+            return options;
+        }
+
+        namespace detail
+        {
+            constexpr size_t QUANTUM_NONE = std::numeric_limits<size_t>::max();
+
+            // Built once per declared variable and shared by everything derived
+            // from it, so the alias table is built eagerly
+            struct QuantumDistribution
+            {
+                std::vector<double> probabilities; // normalized
+                bool uniform;
+                AliasTable table; // empty when uniform
+
+                QuantumDistribution(std::vector<double> probs, bool isUniform)
+                    : probabilities(std::move(probs)), uniform(isUniform)
+                {
+                    if (!uniform)
+                        table = AliasTable(probabilities);
+                }
+
+                size_t draw(Xoshiro256 &rng) const
+                {
+                    if (uniform)
+                        return static_cast<size_t>(rng.nextBelow(probabilities.size()));
+                    return table.sample(rng);
+                }
+            };
+
+            template <typename T>
+            struct QuantumStates
+            {
+                virtual ~QuantumStates() = default;
+                virtual size_t size() const = 0;
+                virtual T at(size_t index) const = 0;
+                virtual const std::vector<T> *stored() const { return nullptr; }
+            };
+
+            template <typename T>
+            struct StoredQuantumStates : QuantumStates<T>
+            {
+                std::vector<T> values;
+
+                explicit StoredQuantumStates(std::vector<T> v) : values(std::move(v)) {}
+                size_t size() const override { return values.size(); }
+                T at(size_t index) const override { return values[index]; }
+                const std::vector<T> *stored() const override { return &values; }
+            };
+
+            // States of a map()/entangle() result, computed from the source on demand
+            template <typename T, typename S, typename F>
+            struct MappedQuantumStates : QuantumStates<T>
+            {
+                std::shared_ptr<const QuantumStates<S>> source;
+                mutable F func;
+
+                MappedQuantumStates(std::shared_ptr<const QuantumStates<S>> src, F f)
+                    : source(std::move(src)), func(std::move(f)) {}
+                size_t size() const override { return source->size(); }
+                T at(size_t index) const override { return func(source->at(index)); }
+            };
+
+            // Shared by entangled variables: observing one collapses all of them.
+            // Atomic so entangled variables can be observed from different
+            // tasks; the first observe() decides the state.
+            struct QuantumCollapse
+            {
+                std::atomic<size_t> index{QUANTUM_NONE};
+            };
+
+            // States, distribution and collapse of a declared variable in one
+            // allocation
+            template <typename T>
+            struct QuantumRoot
+            {
+                StoredQuantumStates<T> states;
+                QuantumDistribution distribution;
+                QuantumCollapse collapse;
+
+                QuantumRoot(std::vector<T> values, std::vector<double> probs, bool uniform)
+                    : states(std::move(values)), distribution(std::move(probs), uniform) {}
+            };
+
+            // States of an operation on two entangled variables: index i pairs
+            // the i-th states of both sources
+            template <typename R, typename A, typename B, typename F>
+            struct ZippedQuantumStates : QuantumStates<R>
+            {
+                std::shared_ptr<const QuantumStates<A>> left;
+                std::shared_ptr<const QuantumStates<B>> right;
+                mutable F func;
+
+                ZippedQuantumStates(std::shared_ptr<const QuantumStates<A>> l, std::shared_ptr<const QuantumStates<B>> r, F f)
+                    : left(std::move(l)), right(std::move(r)), func(std::move(f)) {}
+                size_t size() const override { return left->size(); }
+                R at(size_t index) const override { return func(left->at(index), right->at(index)); }
+            };
+
+            // Outcomes a variable can still produce, as parallel arrays (a
+            // collapsed variable is a point mass). Not copyable: values may
+            // point at owned.
+            template <typename T>
+            struct QuantumSupport
+            {
+                std::vector<T> owned; // used when the states are a lazy view
+                const std::vector<T> *values = nullptr;
+                const double *probs = nullptr;
+                size_t size = 0;
+
+                QuantumSupport() = default;
+                QuantumSupport(const QuantumSupport &) = delete;
+                QuantumSupport &operator=(const QuantumSupport &) = delete;
+            };
+
+            template <typename T, typename = void>
+            struct IsLessComparable : std::false_type
+            {
+            };
+            template <typename T>
+            struct IsLessComparable<T, std::void_t<decltype(std::declval<const T &>() < std::declval<const T &>())>> : std::true_type
+            {
+            };
+
+            template <typename T, typename = void>
+            struct IsHashable : std::false_type
+            {
+            };
+            template <typename T>
+            struct IsHashable<T, std::void_t<decltype(std::hash<T>{}(std::declval<const T &>()))>> : std::true_type
+            {
+            };
+
+            // operator< for outcomes, with NaNs after every number and equal to
+            // each other so sorting stays a strict weak ordering
+            template <typename T>
+            bool quantumLess(const T &a, const T &b)
+            {
+                if constexpr (std::is_floating_point<T>::value)
+                {
+                    if (std::isnan(a))
+                        return false;
+                    if (std::isnan(b))
+                        return true;
+                }
+                return a < b;
+            }
+
+            // Merge equal outcomes, summing their probabilities. Numbers (and other
+            // ordered types) are sorted, hashable types keep first-appearance
+            // order, anything else is left as is.
+            template <typename T>
+            void mergeOutcomes(std::vector<T> &values, std::vector<double> &probs)
+            {
+                if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value)
+                {
+                    // Compact integer range (sums of dice, counts): dense table, O(n)
+                    auto bounds = std::minmax_element(values.begin(), values.end());
+                    const double span = static_cast<double>(*bounds.second) - static_cast<double>(*bounds.first);
+                    if (span < 4.0 * static_cast<double>(values.size()) + 1024.0)
+                    {
+                        const T low = *bounds.first;
+                        std::vector<double> mass(static_cast<size_t>(span) + 1, 0.0);
+                        std::vector<bool> seen(mass.size(), false);
+                        for (size_t i = 0; i < values.size(); i++)
+                        {
+                            const size_t slot = static_cast<size_t>(values[i] - low);
+                            mass[slot] += probs[i];
+                            seen[slot] = true;
+                        }
+                        values.clear();
+                        probs.clear();
+                        for (size_t slot = 0; slot < mass.size(); slot++)
+                        {
+                            if (seen[slot])
+                            {
+                                values.push_back(static_cast<T>(low + static_cast<T>(slot)));
+                                probs.push_back(mass[slot]);
+                            }
+                        }
+                        return;
+                    }
+                }
+                if constexpr (std::is_arithmetic<T>::value || (IsLessComparable<T>::value && !IsHashable<T>::value))
+                {
+                    std::vector<size_t> order(values.size());
+                    for (size_t i = 0; i < order.size(); i++)
+                        order[i] = i;
+                    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                              { return quantumLess(values[a], values[b]); });
+                    std::vector<T> mergedValues;
+                    std::vector<double> mergedProbs;
+                    for (size_t i : order)
+                    {
+                        if (!mergedValues.empty() && !quantumLess(mergedValues.back(), values[i]))
+                        {
+                            mergedProbs.back() += probs[i];
+                            continue;
+                        }
+                        mergedValues.push_back(std::move(values[i]));
+                        mergedProbs.push_back(probs[i]);
+                    }
+                    values = std::move(mergedValues);
+                    probs = std::move(mergedProbs);
+                }
+                else if constexpr (IsHashable<T>::value)
+                {
+                    std::unordered_map<T, size_t> slots;
+                    slots.reserve(values.size());
+                    size_t kept = 0;
+                    for (size_t i = 0; i < values.size(); i++)
+                    {
+                        auto inserted = slots.emplace(values[i], kept);
+                        if (!inserted.second)
+                        {
+                            probs[inserted.first->second] += probs[i];
+                            continue;
+                        }
+                        if (kept != i)
+                        {
+                            values[kept] = std::move(values[i]);
+                            probs[kept] = probs[i];
+                        }
+                        kept++;
+                    }
+                    values.erase(values.begin() + static_cast<std::ptrdiff_t>(kept), values.end());
+                    probs.resize(kept);
+                }
+            }
+
+            // sum(probs[i] * values[i]) with four independent accumulators so the
+            // adds pipeline (and vectorize under -O3)
+            template <typename X, typename Project>
+            double quantumWeightedSum(const std::vector<X> &values, const double *probs, size_t n, Project project)
+            {
+                double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                {
+                    acc0 += probs[i] * project(values[i]);
+                    acc1 += probs[i + 1] * project(values[i + 1]);
+                    acc2 += probs[i + 2] * project(values[i + 2]);
+                    acc3 += probs[i + 3] * project(values[i + 3]);
+                }
+                for (; i < n; i++)
+                    acc0 += probs[i] * project(values[i]);
+                return (acc0 + acc1) + (acc2 + acc3);
+            }
+        } // namespace detail
+
+        template <typename T>
+        class QuantumVar
+        {
+        private:
+            template <typename>
+            friend class QuantumVar;
+
+            std::shared_ptr<const detail::QuantumStates<T>> states;
+            std::shared_ptr<const detail::QuantumDistribution> distribution;
+            // Shared with entangled variables; identifies the operands combine()
+            // must pair state by state
+            std::shared_ptr<detail::QuantumCollapse> collapse;
+            size_t cachedIndex = detail::QUANTUM_NONE; // index cachedValue was computed for
+            std::optional<T> cachedValue;
+
+            QuantumVar(std::shared_ptr<const detail::QuantumStates<T>> s,
+                       std::shared_ptr<const detail::QuantumDistribution> dist,
+                       std::shared_ptr<detail::QuantumCollapse> cell)
+                : states(std::move(s)), distribution(std::move(dist)), collapse(std::move(cell)) {}
+
+            void init(std::vector<T> values, std::vector<double> probs, bool uniform)
+            {
+                if (values.empty())
+                {
+                    throw std::runtime_error("QuantumVar: cannot create with empty states");
+                }
+                auto root = std::make_shared<detail::QuantumRoot<T>>(std::move(values), std::move(probs), uniform);
+                states = std::shared_ptr<const detail::QuantumStates<T>>(root, &root->states);
+                distribution = std::shared_ptr<const detail::QuantumDistribution>(root, &root->distribution);
+                collapse = std::shared_ptr<detail::QuantumCollapse>(root, &root->collapse);
+            }
+
+            size_t index() const { return collapse->index.load(std::memory_order_acquire); }
+
+            // Replace a lazy state view by its values (this variable only)
+            const std::vector<T> &materialize()
+            {
+                if (!states->stored())
+                {
+                    std::vector<T> values;
+                    values.reserve(states->size());
+                    for (size_t i = 0; i < states->size(); i++)
+                        values.push_back(states->at(i));
+                    states = std::make_shared<detail::StoredQuantumStates<T>>(std::move(values));
+                }
+                return *states->stored();
+            }
+
+            void support(detail::QuantumSupport<T> &result) const
+            {
+                static const double certain = 1.0;
+                const size_t current = index();
+                if (current != detail::QUANTUM_NONE)
+                {
+                    result.owned.push_back(states->at(current));
+                    result.probs = &certain;
+                    result.size = 1;
+                }
+                else
+                {
+                    if (!states->stored())
+                    {
+                        result.owned.reserve(states->size());
+                        for (size_t i = 0; i < states->size(); i++)
+                            result.owned.push_back(states->at(i));
+                    }
+                    result.probs = distribution->probabilities.data();
+                    result.size = states->size();
+                }
+                result.values = states->stored() && current == detail::QUANTUM_NONE ? states->stored() : &result.owned;
+            }
+
+            // One joint draw's state index; a collapsed variable always gives its own
+            size_t drawIndex(Xoshiro256 &rng) const
+            {
+                const size_t current = index();
+                return current != detail::QUANTUM_NONE ? current : distribution->draw(rng);
+            }
+
+            template <typename F, bool Shared>
+            auto derive(F func) const -> QuantumVar<std::decay_t<decltype(func(std::declval<T>()))>>
+            {
+                using U = std::decay_t<decltype(func(std::declval<T>()))>;
+                auto view = std::make_shared<detail::MappedQuantumStates<U, T, F>>(states, std::move(func));
+                return QuantumVar<U>(std::move(view), distribution,
+                                     Shared ? collapse : std::make_shared<detail::QuantumCollapse>());
+            }
+
+        public:
+            // A copy has its own collapse, starting in the original's state
+            QuantumVar(const QuantumVar &other)
+                : states(other.states), distribution(other.distribution),
+                  collapse(std::make_shared<detail::QuantumCollapse>()),
+                  cachedIndex(other.cachedIndex), cachedValue(other.cachedValue)
+            {
+                collapse->index.store(other.index(), std::memory_order_relaxed);
+            }
+
+            QuantumVar &operator=(const QuantumVar &other)
+            {
+                if (this != &other)
+                    *this = QuantumVar(other);
+                return *this;
+            }
+
+            QuantumVar(QuantumVar &&) = default;
+            QuantumVar &operator=(QuantumVar &&) = default;
+
+            // Uniform distribution
+            QuantumVar(std::vector<T> s)
+            {
+                const size_t n = s.size();
+                init(std::move(s), std::vector<double>(n, n == 0 ? 0.0 : 1.0 / n), true);
+            }
+
+            // Weighted distribution, normalized to sum to 1.0
+            QuantumVar(std::vector<T> s, const std::vector<double> &probs)
+            {
+                if (probs.size() != s.size())
+                {
+                    throw std::invalid_argument("QuantumVar: states and probabilities differ in length");
+                }
+                double sum = 0.0;
+                for (double p : probs)
+                {
+                    if (p < 0.0)
+                        throw std::invalid_argument("QuantumVar: probabilities must be non-negative");
+                    sum += p;
+                }
+                if (sum > 0.0)
+                {
+                    std::vector<double> normalized;
+                    normalized.reserve(probs.size());
+                    for (double p : probs)
+                        normalized.push_back(p / sum);
+                    init(std::move(s), std::move(normalized), false);
+                }
+                else
+                {
+                    // All zero: fall back to uniform
+                    const size_t n = s.size();
+                    init(std::move(s), std::vector<double>(n, n == 0 ? 0.0 : 1.0 / n), true);
+                }
+            }
+
+            // Collapse to a single state. Repeated calls return the same value
+            // until reset() (BUG #132: measurement is idempotent by design).
+            T observe()
+            {
+                size_t current = index();
+                if (current == detail::QUANTUM_NONE)
+                {
+                    // Another task observing an entangled variable may win;
+                    // then current holds its state
+                    const size_t drawn = distribution->draw(threadRng());
+                    if (collapse->index.compare_exchange_strong(current, drawn, std::memory_order_acq_rel))
+                        current = drawn;
+                }
+                if (cachedIndex != current)
+                {
+                    cachedValue = states->at(current);
+                    cachedIndex = current;
+                }
+                return *cachedValue;
+            }
+
+            // n independent draws from the distribution; does not collapse
+            std::vector<T> sample(size_t n)
+            {
+                // A lazy view would re-run the map chain per draw
+                if (n > states->size())
+                    materialize();
+                Xoshiro256 &rng = threadRng();
+                std::vector<T> result;
+                result.reserve(n);
+                for (size_t i = 0; i < n; i++)
+                    result.push_back(states->at(distribution->draw(rng)));
+                return result;
+            }
+
+            // Return to superposition (together with everything entangled with it)
+            void reset() { collapse->index.store(detail::QUANTUM_NONE, std::memory_order_release); }
+
+            bool isCollapsed() const { return index() != detail::QUANTUM_NONE; }
+            std::optional<size_t> collapsedIndex() const
+            {
+                if (index() == detail::QUANTUM_NONE)
+                    return std::nullopt;
+                return index();
+            }
+
+            size_t stateCount() const { return states->size(); }
+            T stateAt(size_t index) const
+            {
+                if (index >= states->size())
+                {
+                    throw std::out_of_range("QuantumVar::stateAt: index out of range");
+                }
+                return states->at(index);
+            }
+            const std::vector<T> &getStates() { return materialize(); }
+            const std::vector<double> &getProbabilities() const { return distribution->probabilities; }
+
+            // Independent variable over the transformed states (same probabilities)
+            template <typename F>
+            auto map(F func) const
+            {
+                return derive<F, false>(std::move(func));
+            }
+
+            // Correlated variable: shares this variable's collapse, so both always
+            // observe the same state index
+            template <typename F>
+            auto entangle(F transform) const
+            {
+                return derive<F, true>(std::move(transform));
+            }
+
+            // Distribution of func(x, y) for x from this variable and y from
+            // other. The same variable (q - q) and entangled operands pair state
+            // i with state i and the result stays entangled with them; otherwise
+            // the operands are independent and equal outcomes are merged.
+            template <typename U, typename F>
+            auto combine(const QuantumVar<U> &other, F func,
+                         const QuantumJoinOptions &options = quantumJoinDefaults()) const
+                -> QuantumVar<std::decay_t<decltype(func(std::declval<T>(), std::declval<U>()))>>
+            {
+                using R = std::decay_t<decltype(func(std::declval<T>(), std::declval<U>()))>;
+                if (collapse == other.collapse)
+                {
+                    auto view = std::make_shared<detail::ZippedQuantumStates<R, T, U, F>>(states, other.states, std::move(func));
+                    return QuantumVar<R>(std::move(view), distribution, collapse);
+                }
+
+                detail::QuantumSupport<T> left;
+                detail::QuantumSupport<U> right;
+                support(left);
+                other.support(right);
+                const bool overCap = left.size > options.maxStates / right.size;
+                if (overCap && options.mode == QuantumJoinMode::EXACT)
+                {
+                    throw std::length_error("QuantumVar::combine: joint distribution exceeds maxStates");
+                }
+
+                std::vector<R> values;
+                std::vector<double> probs;
+                if (options.mode == QuantumJoinMode::MONTE_CARLO || overCap)
+                {
+                    if (options.samples == 0)
+                    {
+                        throw std::invalid_argument("QuantumVar::combine: Monte-Carlo mode needs samples > 0");
+                    }
+                    Xoshiro256 &rng = threadRng();
+                    values.reserve(options.samples);
+                    for (size_t k = 0; k < options.samples; k++)
+                        values.push_back(func(states->at(drawIndex(rng)), other.states->at(other.drawIndex(rng))));
+                    probs.assign(options.samples, 1.0 / static_cast<double>(options.samples));
+                }
+                else
+                {
+                    // Pairs that cannot occur are skipped, so func never sees
+                    // them (a zero divisor with probability 0, for example)
+                    const size_t n = left.size, m = right.size;
+                    values.reserve(n * m);
+                    probs.reserve(n * m);
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        const double p = left.probs[i];
+                        if (p == 0.0)
+                            continue;
+                        for (size_t j = 0; j < m; j++)
+                        {
+                            if (right.probs[j] == 0.0)
+                                continue;
+                            values.push_back(func((*left.values)[i], (*right.values)[j]));
+                            probs.push_back(p * right.probs[j]);
+                        }
+                    }
+                }
+                detail::mergeOutcomes(values, probs);
+                QuantumVar<R> result(std::move(values), probs);
+                return result;
+            }
+
+            // Mean over the states observe() can still produce (numeric T)
+            double expectation() const
+            {
+                static_assert(std::is_convertible<T, double>::value, "QuantumVar::expectation: states must be numeric");
+                detail::QuantumSupport<T> s;
+                support(s);
+                return detail::quantumWeightedSum(*s.values, s.probs, s.size, [](const T &x)
+                                                  { return static_cast<double>(x); });
+            }
+
+            double variance() const
+            {
+                static_assert(std::is_convertible<T, double>::value, "QuantumVar::variance: states must be numeric");
+                detail::QuantumSupport<T> s;
+                support(s);
+                const double mean = detail::quantumWeightedSum(*s.values, s.probs, s.size, [](const T &x)
+                                                               { return static_cast<double>(x); });
+                return detail::quantumWeightedSum(*s.values, s.probs, s.size, [mean](const T &x)
+                                                  {
+                    const double d = static_cast<double>(x) - mean;
+                    return d * d; });
+            }
+
+            // Probability that observe() returns a state satisfying pred
+            template <typename Pred>
+            double probability(Pred pred) const
+            {
+                detail::QuantumSupport<T> s;
+                support(s);
+                return detail::quantumWeightedSum(*s.values, s.probs, s.size, [&](const T &x)
+                                                  { return pred(x) ? 1.0 : 0.0; });
+            }
+        };
+
+        template <typename A, typename B, typename F>
+        auto map2(const QuantumVar<A> &a, const QuantumVar<B> &b, F func,
+                  const QuantumJoinOptions &options = quantumJoinDefaults())
+        {
+            return a.combine(b, std::move(func), options);
+        }
+
+        // q1 op q2 combines distributions; q op scalar and scalar op q stay
+        // entangled with q
+#define LPP_QUANTUM_OPERATOR(op)                                                                    \
+    template <typename A, typename B>                                                               \
+    auto operator op(const QuantumVar<A> &a, const QuantumVar<B> &b)                                \
+    {                                                                                               \
+        return a.combine(b, [](const A &x, const B &y) { return x op y; });                         \
+    }                                                                                               \
+    template <typename A, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>    \
+    auto operator op(const QuantumVar<A> &a, S s)                                                   \
+    {                                                                                               \
+        return a.entangle([s](const A &x) { return x op s; });                                      \
+    }                                                                                               \
+    template <typename S, typename B, typename = std::enable_if_t<std::is_arithmetic<S>::value>>    \
+    auto operator op(S s, const QuantumVar<B> &b)                                                   \
+    {                                                                                               \
+        return b.entangle([s](const B &y) { return s op y; });                                      \
+    }
+
+        LPP_QUANTUM_OPERATOR(+)
+        LPP_QUANTUM_OPERATOR(-)
+        LPP_QUANTUM_OPERATOR(*)
+        LPP_QUANTUM_OPERATOR(<)
+        LPP_QUANTUM_OPERATOR(>)
+        LPP_QUANTUM_OPERATOR(<=)
+        LPP_QUANTUM_OPERATOR(>=)
+        LPP_QUANTUM_OPERATOR(==)
+        LPP_QUANTUM_OPERATOR(!=)
+#undef LPP_QUANTUM_OPERATOR
+
+        namespace detail
+        {
+            template <typename X, typename Y>
+            auto quantumDivide(const X &x, const Y &y)
+            {
+                if (y == Y(0))
+                {
+                    throw std::domain_error("QuantumVar: division by a zero outcome");
+                }
+                return x / y;
+            }
+        } // namespace detail
+
+        // Division reports a zero divisor that can occur instead of dividing
+        // by it (SIGFPE for integers)
+        template <typename A, typename B>
+        auto operator/(const QuantumVar<A> &a, const QuantumVar<B> &b)
+        {
+            return a.combine(b, [](const A &x, const B &y) { return detail::quantumDivide(x, y); });
+        }
+        template <typename A, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+        auto operator/(const QuantumVar<A> &a, S s)
+        {
+            if (s == S(0))
+            {
+                throw std::domain_error("QuantumVar: division by zero");
+            }
+            return a.entangle([s](const A &x) { return x / s; });
+        }
+        template <typename S, typename B, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+        auto operator/(S s, const QuantumVar<B> &b)
+        {
+            return b.entangle([s](const B &y) { return detail::quantumDivide(s, y); });
+        }
+
+        template <typename T, typename F>
+        auto entangle(const QuantumVar<T> &qvar, F transform)
+        {
+            return qvar.entangle(transform);
+        }
+
+        // ===== STRING UTILITIES =====
+
+        // Get length of string or vector
+        template <typename T, typename A>
+        int len(const std::vector<T, A> &vec)
+        {
+            return vec.size();
+        }
+
+        inline int len(const std::string &str)
+        {
+            return str.length();
+        }
+
+        template <typename T>
+        int len(const PersistentVector<T> &vec)
+        {
+            return static_cast<int>(vec.size());
+        }
+
+        template <typename K, typename V, typename H, typename E>
+        int len(const PersistentMap<K, V, H, E> &map)
+        {
+            return static_cast<int>(map.size());
+        }
+
+        template <typename T, typename H, typename E>
+        int len(const PersistentSet<T, H, E> &set)
+        {
+            return static_cast<int>(set.size());
+        }
+
+        // Push element to vector
+        template <typename T, typename A>
+        void push(std::vector<T, A> &vec, const T &item)
+        {
+            vec.push_back(item);
+        }
+
+        // BUG #233 fix: Move overload for push
+        template <typename T, typename A>
+        void push(std::vector<T, A> &vec, T &&item)
+        {
+            vec.push_back(std::move(item));
+        }
+
+        // Pop element from vector
+        template <typename T, typename A>
+        T pop(std::vector<T, A> &vec)
+        {
+            if (vec.empty())
+                throw std::runtime_error("pop from empty vector");
+            // BUG #209 fix: Use move semantics instead of copy
+            T item = std::move(vec.back());
+            vec.pop_back();
+            return item;
+        }
+
+        // Split string by delimiter
+        inline std::vector<std::string> split(const std::string &str, const std::string &delimiter)
+        {
+            // BUG #214 fix: Prevent infinite loop with empty delimiter
+            if (delimiter.empty())
+                throw std::invalid_argument("split delimiter cannot be empty");
+
+            std::vector<std::string> result;
+            size_t start = 0;
+            size_t end = str.find(delimiter);
+
+            while (end != std::string::npos)
+            {
+                result.push_back(str.substr(start, end - start));
+                start = end + delimiter.length();
+                end = str.find(delimiter, start);
+            }
+            result.push_back(str.substr(start));
+            return result;
+        }
+
+        // Join vector of strings with delimiter
+        inline std::string join(const std::vector<std::string> &vec, const std::string &delimiter)
+        {
+            std::string result;
+            for (size_t i = 0; i < vec.size(); i++)
+            {
+                result += vec[i];
+                // BUG #216 fix: Prevent underflow when vec.size() == 0
+                if (i + 1 < vec.size())
+                {
+                    result += delimiter;
+                }
+            }
+            return result;
+        }
+
+        // Slice vector
+        template <typename T>
+        std::vector<T> slice(const std::vector<T> &vec, int start, int end = -1)
+        {
+            if (end == -1)
+                end = vec.size();
+            if (start < 0)
+                start = vec.size() + start;
+            if (end < 0)
+                end = vec.size() + end;
+
+            // BUG #212 & #217 fix: Clamp to valid range
+            if (start < 0)
+                start = 0;
+            if (end < 0)
+                end = 0;
+            if (start > (int)vec.size())
+                start = vec.size();
+            if (end > (int)vec.size())
+                end = vec.size();
+            if (end < start)
+                end = start;
+
+            std::vector<T> result;
+            for (int i = start; i < end; i++)
+            {
+                result.push_back(vec[i]);
+            }
+            return result;
+        }
+
+        // Slice string
+        inline std::string slice(const std::string &str, int start, int end = -1)
+        {
+            if (end == -1)
+                end = str.length();
+            if (start < 0)
+                start = str.length() + start;
+            if (end < 0)
+                end = str.length() + end;
+
+            // BUG #211 & #218 fix: Clamp to valid range and validate end >= start
+            if (start < 0)
+                start = 0;
+            if (end < 0)
+                end = 0;
+            if (start > (int)str.length())
+                start = str.length();
+            if (end > (int)str.length())
+                end = str.length();
+            if (end < start)
+                end = start;
+
+            return str.substr(start, end - start);
+        }
+
+        // Get character at index
+        inline char charAt(const std::string &str, int index)
+        {
+            if (index < 0 || index >= (int)str.length())
+            {
+                throw std::out_of_range("charAt index out of range");
+            }
+            return str[index];
+        }
+
+        // Substring
+        inline std::string substring(const std::string &str, int start, int length)
+        {
+            // BUG #210 fix: Validate bounds before substr()
+            if (start < 0 || start > (int)str.length())
+                throw std::out_of_range("substring start out of range");
+            if (length < 0)
+                throw std::invalid_argument("substring length cannot be negative");
+            // Clamp length to available characters
+            int availableLength = str.length() - start;
+            if (length > availableLength)
+                length = availableLength;
+            return str.substr(start, length);
+        }
+
+        // To uppercase
+        inline std::string toUpper(const std::string &str)
+        {
+            std::string result = str;
+            std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+            return result;
+        }
+
+        // To lowercase
+        inline std::string toLower(const std::string &str)
+        {
+            std::string result = str;
+            std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+            return result;
+        }
+
+        // Trim whitespace
+        inline std::string trim(const std::string &str)
+        {
+            size_t start = str.find_first_not_of(" \t\n\r");
+            if (start == std::string::npos)
+                return "";
+            size_t end = str.find_last_not_of(" \t\n\r");
+            return str.substr(start, end - start + 1);
+        }
+
+        // String contains
+        inline bool contains(const std::string &str, const std::string &substr)
+        {
+            return str.find(substr) != std::string::npos;
+        }
+
+        // String starts with
+        inline bool startsWith(const std::string &str, const std::string &prefix)
+        {
+            // BUG #213 fix: Check length before substr()
+            if (prefix.length() > str.length())
+                return false;
+            return str.substr(0, prefix.length()) == prefix;
+        }
+
+        // String ends with
+        inline bool endsWith(const std::string &str, const std::string &suffix)
+        {
+            if (suffix.length() > str.length())
+                return false;
+            return str.substr(str.length() - suffix.length()) == suffix;
+        }
+
+        // Replace all occurrences
+        inline std::string replace(const std::string &str, const std::string &from, const std::string &to)
+        {
+            // BUG #219 fix: Prevent infinite loop with empty 'from'
+            if (from.empty())
+                return str;
+
+            std::string result = str;
+            size_t pos = 0;
+            while ((pos = result.find(from, pos)) != std::string::npos)
+            {
+                result.replace(pos, from.length(), to);
+                pos += to.length();
+            }
+            return result;
+        }
+
+        // Repeat string n times
+        inline std::string repeat(const std::string &str, int count)
+        {
+            // BUG #215 fix: Validate count >= 0
+            if (count < 0)
+                throw std::invalid_argument("repeat count cannot be negative");
+
+            std::string result;
+            for (int i = 0; i < count; i++)
+            {
+                result += str;
+            }
+            return result;
+        }
+
+        // Reverse string
+        inline std::string reverse(const std::string &str)
+        {
+            return std::string(str.rbegin(), str.rend());
+        }
+
+        // ===== LAZY RANGES =====
+        // Ranges that produce elements on demand (lines(path), and filter/map
+        // over them) declare 'using is_lazy_range = void'. The filter (?) and
+        // map (@) operators keep such ranges lazy instead of collecting into a
+        // vector, so a chain over a large file runs in constant memory.
+        // Views own their source range and function by value.
+        namespace detail
+        {
+            template <typename R, typename = void>
+            struct IsLazyRange : std::false_type
+            {
+            };
+            template <typename R>
+            struct IsLazyRange<R, std::void_t<typename R::is_lazy_range>> : std::true_type
+            {
+            };
+        }
+
+        template <typename Range, typename Pred>
+        class FilterView
+        {
+        private:
+            Range source;
+            Pred pred;
+
+        public:
+            using is_lazy_range = void;
+            using value_type = typename Range::value_type;
+
+            class iterator
+            {
+            private:
+                using Inner = decltype(std::declval<const Range &>().begin());
+                Inner it;
+                Inner last;
+                const Pred *pred;
+
+                void skip()
+                {
+                    while (it != last && !(*pred)(*it))
+                        ++it;
+                }
+
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = typename Range::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = decltype(*std::declval<Inner &>());
+
+                iterator(Inner first, Inner end, const Pred *p) : it(first), last(end), pred(p) { skip(); }
+
+                reference operator*() const { return *it; }
+                iterator &operator++()
+                {
+                    ++it;
+                    skip();
+                    return *this;
+                }
+                bool operator==(const iterator &other) const { return it == other.it; }
+                bool operator!=(const iterator &other) const { return it != other.it; }
+            };
+
+            FilterView(Range range, Pred predicate) : source(std::move(range)), pred(std::move(predicate)) {}
+
+            iterator begin() const { return iterator(source.begin(), source.end(), &pred); }
+            iterator end() const { return iterator(source.end(), source.end(), &pred); }
+        };
+
+        template <typename Range, typename Fn>
+        class MapView
+        {
+        private:
+            Range source;
+            Fn fn;
+
+        public:
+            using is_lazy_range = void;
+            using value_type = std::decay_t<decltype(std::declval<const Fn &>()(*std::declval<const Range &>().begin()))>;
+
+            class iterator
+            {
+            private:
+                using Inner = decltype(std::declval<const Range &>().begin());
+                Inner it;
+                const Fn *fn;
+
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = MapView::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = value_type;
+
+                iterator(Inner inner, const Fn *f) : it(inner), fn(f) {}
+
+                value_type operator*() const { return (*fn)(*it); }
+                iterator &operator++()
+                {
+                    ++it;
+                    return *this;
+                }
+                bool operator==(const iterator &other) const { return it == other.it; }
+                bool operator!=(const iterator &other) const { return it != other.it; }
+            };
+
+            MapView(Range range, Fn function) : source(std::move(range)), fn(std::move(function)) {}
+
+            iterator begin() const { return iterator(source.begin(), &fn); }
+            iterator end() const { return iterator(source.end(), &fn); }
+        };
+
+        // items ? pred: a FilterView for lazy ranges, otherwise a container of
+        // the same type holding the matching elements. Persistent collections
+        // are built through a transient (they have no push_back).
+        template <typename C, typename P>
+        auto filterEach(const C &items, P pred)
+        {
+            if constexpr (detail::IsLazyRange<C>::value)
+            {
+                return FilterView<C, P>(items, std::move(pred));
+            }
+            else if constexpr (detail::IsPersistent<C>::value)
+            {
+                auto builder = C().transient();
+                for (const auto &item : items)
+                {
+                    if (pred(item))
+                        detail::transientInsert(builder, item);
+                }
+                return builder.persistent();
+            }
+            else
+            {
+                C result;
+                for (const auto &item : items)
+                {
+                    if (pred(item))
+                        result.push_back(item);
+                }
+                return result;
+            }
+        }
+
+        // items @ fn: a MapView for lazy ranges, otherwise a vector of results
+        template <typename C, typename F>
+        auto mapEach(const C &items, F fn)
+        {
+            if constexpr (detail::IsLazyRange<C>::value)
+            {
+                return MapView<C, F>(items, std::move(fn));
+            }
+            else
+            {
+                std::vector<std::decay_t<decltype(fn(*std::begin(items)))>> result;
+                for (const auto &item : items)
+                    result.push_back(fn(item));
+                return result;
+            }
+        }
+
+        // Materialize any range into a vector
+        template <typename C>
+        auto collect(const C &items)
+        {
+            std::vector<typename C::value_type> result;
+            for (const auto &item : items)
+                result.push_back(item);
+            return result;
+        }
+
+        // ===== VECTOR KERNELS =====
+        // Targets for reduce (arr \ fn) and map (arr @ fn) expressions whose
+        // lambda the transpiler recognizes as +, *, min, max, && or || (reduce)
+        // or plain arithmetic on the element (map).
+        //
+        // Reduce kernels take the original lambda and fall back to the same
+        // left-to-right loop the generic lowering emits. The fast path splits
+        // contiguous arithmetic input across independent lanes (which the
+        // compiler turns into SIMD) and combines them at the end. That changes
+        // the order of operations, so:
+        //   - integers always take the fast path (the result is identical)
+        //   - floating point takes it only with FloatOrder::RELAXED
+        //     ('#pragma fp relaxed'); sums and products may then differ in the
+        //     last bits, and min/max may pick a different NaN or signed zero
+        enum class FloatOrder
+        {
+            STRICT,
+            RELAXED
+        };
+
+        namespace detail
+        {
+            template <typename C, typename = void>
+            struct IsContiguous : std::false_type
+            {
+            };
+            template <typename C>
+            struct IsContiguous<C, std::void_t<decltype(std::declval<const C &>().data()),
+                                               decltype(std::declval<const C &>().size())>> : std::true_type
+            {
+            };
+
+            constexpr size_t KERNEL_LANES = 8;
+
+            // Fast path applies when accumulator and elements are the same
+            // non-bool arithmetic type stored contiguously
+            template <FloatOrder Order, typename Acc, typename C>
+            constexpr bool useLanes()
+            {
+                using T = typename C::value_type;
+                return IsContiguous<C>::value && std::is_same<Acc, T>::value && std::is_arithmetic<T>::value &&
+                       !std::is_same<T, bool>::value && (std::is_integral<T>::value || Order == FloatOrder::RELAXED);
+            }
+
+            // init op data[0] op ... op data[n-1], evaluated as KERNEL_LANES
+            // interleaved partial results
+            template <typename T, typename Op>
+            T laneReduce(const T *data, size_t n, T init, Op op)
+            {
+                if (n < 2 * KERNEL_LANES)
+                {
+                    for (size_t i = 0; i < n; i++)
+                        init = op(init, data[i]);
+                    return init;
+                }
+                T lanes[KERNEL_LANES];
+                for (size_t l = 0; l < KERNEL_LANES; l++)
+                    lanes[l] = data[l];
+                size_t i = KERNEL_LANES;
+                for (; i + KERNEL_LANES <= n; i += KERNEL_LANES)
+                {
+                    for (size_t l = 0; l < KERNEL_LANES; l++)
+                        lanes[l] = op(lanes[l], data[i + l]);
+                }
+                for (size_t width = KERNEL_LANES / 2; width > 0; width /= 2)
+                {
+                    for (size_t l = 0; l < width; l++)
+                        lanes[l] = op(lanes[l], lanes[l + width]);
+                }
+                T acc = op(init, lanes[0]);
+                for (; i < n; i++)
+                    acc = op(acc, data[i]);
+                return acc;
+            }
+
+            // The operations the reduce kernels recognize
+            struct AddOp
+            {
+                template <typename T>
+                T operator()(T a, T b) const { return static_cast<T>(a + b); }
+            };
+            struct MulOp
+            {
+                template <typename T>
+                T operator()(T a, T b) const { return static_cast<T>(a * b); }
+            };
+            struct MinOp
+            {
+                template <typename T>
+                T operator()(T a, T b) const { return b < a ? b : a; }
+            };
+            struct MaxOp
+            {
+                template <typename T>
+                T operator()(T a, T b) const { return a < b ? b : a; }
+            };
+
+            template <FloatOrder Order, typename C, typename Acc, typename F, typename Op>
+            Acc reduceWith(const C &items, Acc init, F &fn, Op op)
+            {
+                if constexpr (useLanes<Order, Acc, C>())
+                {
+                    return laneReduce(items.data(), items.size(), init, op);
+                }
+                else
+                {
+                    for (const auto &item : items)
+                        init = fn(init, item);
+                    return init;
+                }
+            }
+        } // namespace detail
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename Acc, typename F>
+        Acc reduceSum(const C &items, Acc init, F fn)
+        {
+            return detail::reduceWith<Order>(items, init, fn, detail::AddOp());
+        }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename Acc, typename F>
+        Acc reduceProduct(const C &items, Acc init, F fn)
+        {
+            return detail::reduceWith<Order>(items, init, fn, detail::MulOp());
+        }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename Acc, typename F>
+        Acc reduceMin(const C &items, Acc init, F fn)
+        {
+            return detail::reduceWith<Order>(items, init, fn, detail::MinOp());
+        }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename Acc, typename F>
+        Acc reduceMax(const C &items, Acc init, F fn)
+        {
+            return detail::reduceWith<Order>(items, init, fn, detail::MaxOp());
+        }
+
+        // && and || stop at the first element that decides the result; the
+        // elements are plain values, so skipping the rest changes nothing
+        template <typename C, typename Acc, typename F>
+        Acc reduceAll(const C &items, Acc init, F fn)
+        {
+            for (const auto &item : items)
+            {
+                if (!init)
+                    break;
+                init = fn(init, item);
+            }
+            return init;
+        }
+
+        template <typename C, typename Acc, typename F>
+        Acc reduceAny(const C &items, Acc init, F fn)
+        {
+            for (const auto &item : items)
+            {
+                if (init)
+                    break;
+                init = fn(init, item);
+            }
+            return init;
+        }
+
+        // Without an initial value (plain 'arr \ fn') every reducer starts
+        // from a value-initialized element, like the generic lowering
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename F>
+        auto reduceSum(const C &items, F fn) { return reduceSum<Order>(items, typename C::value_type{}, std::move(fn)); }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename F>
+        auto reduceProduct(const C &items, F fn) { return reduceProduct<Order>(items, typename C::value_type{}, std::move(fn)); }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename F>
+        auto reduceMin(const C &items, F fn) { return reduceMin<Order>(items, typename C::value_type{}, std::move(fn)); }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename F>
+        auto reduceMax(const C &items, F fn) { return reduceMax<Order>(items, typename C::value_type{}, std::move(fn)); }
+
+        template <typename C, typename F>
+        auto reduceAll(const C &items, F fn) { return reduceAll(items, typename C::value_type{}, std::move(fn)); }
+
+        template <typename C, typename F>
+        auto reduceAny(const C &items, F fn) { return reduceAny(items, typename C::value_type{}, std::move(fn)); }
+
+        // Any other reducer: left-to-right fold
+        template <typename C, typename Acc, typename F>
+        Acc reduceEach(const C &items, Acc init, F fn)
+        {
+            for (const auto &item : items)
+                init = fn(init, item);
+            return init;
+        }
+
+        template <typename C, typename F>
+        auto reduceEach(const C &items, F fn) { return reduceEach(items, typename C::value_type{}, std::move(fn)); }
+
+        // Element-wise transform into a new vector. Arithmetic results are
+        // written by index into a presized buffer so the loop vectorizes.
+        // Lazy ranges stay lazy (see mapEach).
+        template <typename C, typename F>
+        auto mapVector(const C &items, F func)
+        {
+            if constexpr (detail::IsLazyRange<C>::value)
+            {
+                return MapView<C, F>(items, std::move(func));
+            }
+            else
+            {
+                using R = std::decay_t<decltype(func(*std::begin(items)))>;
+                std::vector<R> result;
+                if constexpr (detail::IsContiguous<C>::value && std::is_arithmetic<R>::value && !std::is_same<R, bool>::value)
+                {
+                    const size_t n = items.size();
+                    result.resize(n);
+                    const auto *in = items.data();
+                    R *out = result.data();
+                    for (size_t i = 0; i < n; i++)
+                        out[i] = func(in[i]);
+                }
+                else
+                {
+                    for (const auto &item : items)
+                        result.push_back(func(item));
+                }
+                return result;
+            }
+        }
+
+        // ===== PARALLEL KERNELS =====
+        // Targets for map (@), filter (?) and reduce (\) whose function the
+        // compiler's effect analysis found read-only: it writes no outer state,
+        // does no I/O and draws no random numbers, so calls may run in any
+        // order and at the same time. Contiguous inputs of PARALLEL_MIN_ITEMS
+        // elements or more are split across the thread pool; smaller inputs,
+        // lazy ranges and single-core machines use the sequential kernels.
+        // Results keep element order. If several elements throw, which
+        // exception propagates is unspecified.
+        //
+        // Reduce runs in parallel only for the associative kernels (sum,
+        // product, min, max) and only where their lane fast path applies.
+        namespace detail
+        {
+            constexpr size_t PARALLEL_MIN_ITEMS = 1 << 14;
+
+            template <typename C>
+            bool runParallel(const C &items, const ThreadPool &pool)
+            {
+                if constexpr (IsContiguous<C>::value && !IsLazyRange<C>::value)
+                    return pool.size() > 1 && items.size() >= PARALLEL_MIN_ITEMS;
+                else
+                    return false;
+            }
+
+            // About four chunks per worker so uneven elements still balance
+            inline size_t parallelGrain(size_t n, const ThreadPool &pool)
+            {
+                return std::max<size_t>(1024, n / (4 * pool.size()));
+            }
+
+            // Lane reduction per chunk, partial results combined in order
+            template <FloatOrder Order, typename C, typename Acc, typename F, typename Op>
+            Acc parallelReduceWith(const C &items, Acc init, F &fn, Op op, ThreadPool &pool)
+            {
+                if constexpr (useLanes<Order, Acc, C>())
+                {
+                    if (runParallel(items, pool))
+                    {
+                        const size_t n = items.size();
+                        const size_t grain = parallelGrain(n, pool);
+                        std::vector<Acc> partials((n + grain - 1) / grain);
+                        const Acc *data = items.data();
+                        pool.parallelForRange(0, n, grain, [&](size_t lo, size_t hi)
+                                              { partials[lo / grain] = laneReduce(data + lo + 1, hi - lo - 1, data[lo], op); });
+                        for (const Acc &partial : partials)
+                            init = op(init, partial);
+                        return init;
+                    }
+                }
+                return reduceWith<Order>(items, init, fn, op);
+            }
+        } // namespace detail
+
+        template <typename C, typename F>
+        auto parallelMap(const C &items, F func, ThreadPool &pool = ThreadPool::global())
+        {
+            if constexpr (detail::IsContiguous<C>::value && !detail::IsLazyRange<C>::value)
+            {
+                // vector<bool> packs bits, so neighbouring writes would race
+                using R = std::decay_t<decltype(func(*std::begin(items)))>;
+                if constexpr (std::is_default_constructible<R>::value && !std::is_same<R, bool>::value)
+                {
+                    if (detail::runParallel(items, pool))
+                    {
+                        const size_t n = items.size();
+                        std::vector<R> result(n);
+                        const auto *in = items.data();
+                        pool.parallelForRange(0, n, detail::parallelGrain(n, pool), [&](size_t lo, size_t hi)
+                                              {
+                            for (size_t i = lo; i < hi; i++)
+                                result[i] = func(in[i]); });
+                        return result;
+                    }
+                }
+            }
+            return mapVector(items, std::move(func));
+        }
+
+        template <typename C, typename P>
+        auto parallelFilter(const C &items, P pred, ThreadPool &pool = ThreadPool::global())
+        {
+            if constexpr (detail::IsContiguous<C>::value && !detail::IsLazyRange<C>::value)
+            {
+                if (detail::runParallel(items, pool))
+                {
+                    // Each chunk collects its own matches; chunks are joined in order
+                    const size_t n = items.size();
+                    const size_t grain = detail::parallelGrain(n, pool);
+                    std::vector<std::vector<typename C::value_type>> parts((n + grain - 1) / grain);
+                    const auto *in = items.data();
+                    pool.parallelForRange(0, n, grain, [&](size_t lo, size_t hi)
+                                          {
+                        auto &part = parts[lo / grain];
+                        for (size_t i = lo; i < hi; i++)
+                        {
+                            if (pred(in[i]))
+                                part.push_back(in[i]);
+                        } });
+                    size_t total = 0;
+                    for (const auto &part : parts)
+                        total += part.size();
+                    C result;
+                    result.reserve(total);
+                    for (auto &part : parts)
+                        result.insert(result.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+                    return result;
+                }
+            }
+            return filterEach(items, std::move(pred));
+        }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename Acc, typename F>
+        Acc parallelReduceSum(const C &items, Acc init, F fn)
+        {
+            return detail::parallelReduceWith<Order>(items, init, fn, detail::AddOp(), ThreadPool::global());
+        }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename Acc, typename F>
+        Acc parallelReduceProduct(const C &items, Acc init, F fn)
+        {
+            return detail::parallelReduceWith<Order>(items, init, fn, detail::MulOp(), ThreadPool::global());
+        }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename Acc, typename F>
+        Acc parallelReduceMin(const C &items, Acc init, F fn)
+        {
+            return detail::parallelReduceWith<Order>(items, init, fn, detail::MinOp(), ThreadPool::global());
+        }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename Acc, typename F>
+        Acc parallelReduceMax(const C &items, Acc init, F fn)
+        {
+            return detail::parallelReduceWith<Order>(items, init, fn, detail::MaxOp(), ThreadPool::global());
+        }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename F>
+        auto parallelReduceSum(const C &items, F fn) { return parallelReduceSum<Order>(items, typename C::value_type{}, std::move(fn)); }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename F>
+        auto parallelReduceProduct(const C &items, F fn) { return parallelReduceProduct<Order>(items, typename C::value_type{}, std::move(fn)); }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename F>
+        auto parallelReduceMin(const C &items, F fn) { return parallelReduceMin<Order>(items, typename C::value_type{}, std::move(fn)); }
+
+        template <FloatOrder Order = FloatOrder::STRICT, typename C, typename F>
+        auto parallelReduceMax(const C &items, F fn) { return parallelReduceMax<Order>(items, typename C::value_type{}, std::move(fn)); }
+
+        // parallel for (x in items) { ... }: runs body(x) for every element on
+        // the task scheduler and returns when all calls have finished,
+        // rethrowing the first exception one threw. The index range is split
+        // in halves on demand: each split queues its upper half, which an idle
+        // worker may steal and split again, so uneven iterations still
+        // balance. Non-contiguous inputs (lists, maps, lazy ranges) are
+        // indexed through a vector of iterators.
+        namespace detail
+        {
+            struct ForkJoin
+            {
+                std::atomic<size_t> pending{0};
+                std::mutex errorMutex;
+                std::exception_ptr error;
+            };
+
+            template <typename F>
+            void splitRange(TaskScheduler &scheduler, ForkJoin &join, size_t lo, size_t hi, size_t grain, F &body)
+            {
+                while (hi - lo > grain)
+                {
+                    const size_t mid = lo + (hi - lo) / 2;
+                    join.pending.fetch_add(1, std::memory_order_relaxed);
+                    scheduler.push([&scheduler, &join, mid, hi, grain, &body]
+                                   {
+                        splitRange(scheduler, join, mid, hi, grain, body);
+                        join.pending.fetch_sub(1, std::memory_order_release); });
+                    hi = mid;
+                }
+                try
+                {
+                    for (size_t i = lo; i < hi; i++)
+                        body(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(join.errorMutex);
+                    if (!join.error)
+                        join.error = std::current_exception();
+                }
+            }
+
+            template <typename F>
+            void forkJoin(size_t n, F &body, TaskScheduler &scheduler)
+            {
+                if (n == 0)
+                    return;
+                ForkJoin join;
+                // About eight pieces per worker; one element per piece for short loops
+                const size_t grain = std::max<size_t>(1, n / (8 * scheduler.size()));
+                splitRange(scheduler, join, 0, n, grain, body);
+                scheduler.helpUntil([&join]
+                                    { return join.pending.load(std::memory_order_acquire) == 0; });
+                if (join.error)
+                    std::rethrow_exception(join.error);
+            }
+        } // namespace detail
+
+        template <typename C, typename F>
+        void parallelForEach(const C &items, F body, TaskScheduler &scheduler = TaskScheduler::global())
+        {
+            if constexpr (detail::IsContiguous<C>::value && !detail::IsLazyRange<C>::value)
+            {
+                const auto *data = items.data();
+                auto run = [&](size_t i)
+                { body(data[i]); };
+                detail::forkJoin(items.size(), run, scheduler);
+            }
+            else
+            {
+                std::vector<decltype(std::begin(items))> positions;
+                for (auto it = std::begin(items); it != std::end(items); ++it)
+                    positions.push_back(it);
+                auto run = [&](size_t i)
+                { body(*positions[i]); };
+                detail::forkJoin(positions.size(), run, scheduler);
+            }
+        }
+
+        // ===== MEMOIZATION =====
+        // Result cache for functions the compiler found pure and
+        // tree-recursive (fib-style). Direct-mapped: each argument tuple
+        // hashes to one slot and a newer result evicts the older one, so memory
+        // stays at 'capacity' entries however many distinct arguments appear.
+        // Generated code keeps one static thread_local cache per function.
+        template <typename R, typename... Args>
+        class MemoCache
+        {
+        private:
+            struct Entry
+            {
+                std::tuple<Args...> key;
+                R value;
+                bool used = false;
+            };
+            std::vector<Entry> slots;
+
+            static size_t hashKey(const std::tuple<Args...> &key)
+            {
+                uint64_t h = 0;
+                std::apply([&h](const Args &...args)
+                           { ((h = (h ^ std::hash<Args>()(args)) * 0x9E3779B97F4A7C15ull), ...); },
+                           key);
+                return static_cast<size_t>(h ^ (h >> 29));
+            }
+
+        public:
+            explicit MemoCache(size_t capacity = 1 << 14) : slots(detail::ringCapacity(capacity)) {}
+
+            // Arguments are taken by value before compute() runs, since the
+            // body may reassign its parameters
+            template <typename F>
+            R getOrCompute(F &&compute, Args... args)
+            {
+                std::tuple<Args...> key(std::move(args)...);
+                const size_t index = hashKey(key) & (slots.size() - 1);
+                if (slots[index].used && slots[index].key == key)
+                    return slots[index].value;
+                R value = compute();
+                // compute() may have recursed into this cache; the slot is
+                // looked up again by index, never held across the call
+                Entry &slot = slots[index];
+                slot.key = std::move(key);
+                slot.value = value;
+                slot.used = true;
+                return value;
+            }
+
+            size_t capacity() const { return slots.size(); }
+        };
+
+        // ===== SORTING AND SEARCH =====
+        // In-place:  pdqsort(first, last[, comp]), sortInPlace, radixSort,
+        //            radixSortBy, parallelSort, nthElement
+        // Copies:    sorted, sortBy, topK, topKBy
+        // Search:    lowerBound, upperBound, binarySearch (branchless)
+        //
+        // sortBy(key), topK(k) and topKBy(k, key) called without the items
+        // return a function, so they slot into pipelines:
+        //   people |> sortBy(p => p.age)
+        //   scores |> topK(10)
+        namespace detail
+        {
+            // Pattern-defeating quicksort (Orson Peters): introsort whose
+            // partitions detect sorted runs, break up adversarial patterns and
+            // handle many equal keys in linear time. With a plain < or > on
+            // arithmetic values the partition is branchless (BlockQuicksort).
+            namespace pdq
+            {
+                constexpr std::ptrdiff_t INSERTION_SORT_THRESHOLD = 24;
+                constexpr std::ptrdiff_t NINTHER_THRESHOLD = 128;
+                constexpr size_t PARTIAL_INSERTION_SORT_LIMIT = 8;
+                constexpr size_t BLOCK_SIZE = 64;
+                constexpr size_t CACHELINE_SIZE = 64;
+
+                template <typename Iter, typename Compare>
+                void insertionSort(Iter begin, Iter end, Compare &comp)
+                {
+                    using T = typename std::iterator_traits<Iter>::value_type;
+                    if (begin == end)
+                        return;
+                    for (Iter cur = begin + 1; cur != end; ++cur)
+                    {
+                        Iter sift = cur;
+                        Iter siftPrev = cur - 1;
+                        if (comp(*sift, *siftPrev))
+                        {
+                            T tmp = std::move(*sift);
+                            do
+                            {
+                                *sift-- = std::move(*siftPrev);
+                            } while (sift != begin && comp(tmp, *--siftPrev));
+                            *sift = std::move(tmp);
+                        }
+                    }
+                }
+
+                // Same, but *(begin - 1) is known to be <= every element, so
+                // the inner loop needs no bounds check
+                template <typename Iter, typename Compare>
+                void unguardedInsertionSort(Iter begin, Iter end, Compare &comp)
+                {
+                    using T = typename std::iterator_traits<Iter>::value_type;
+                    if (begin == end)
+                        return;
+                    for (Iter cur = begin + 1; cur != end; ++cur)
+                    {
+                        Iter sift = cur;
+                        Iter siftPrev = cur - 1;
+                        if (comp(*sift, *siftPrev))
+                        {
+                            T tmp = std::move(*sift);
+                            do
+                            {
+                                *sift-- = std::move(*siftPrev);
+                            } while (comp(tmp, *--siftPrev));
+                            *sift = std::move(tmp);
+                        }
+                    }
+                }
+
+                // Insertion sort that gives up (returning false) once it has
+                // moved more than PARTIAL_INSERTION_SORT_LIMIT elements
+                template <typename Iter, typename Compare>
+                bool partialInsertionSort(Iter begin, Iter end, Compare &comp)
+                {
+                    using T = typename std::iterator_traits<Iter>::value_type;
+                    if (begin == end)
+                        return true;
+                    size_t moved = 0;
+                    for (Iter cur = begin + 1; cur != end; ++cur)
+                    {
+                        Iter sift = cur;
+                        Iter siftPrev = cur - 1;
+                        if (comp(*sift, *siftPrev))
+                        {
+                            T tmp = std::move(*sift);
+                            do
+                            {
+                                *sift-- = std::move(*siftPrev);
+                            } while (sift != begin && comp(tmp, *--siftPrev));
+                            *sift = std::move(tmp);
+                            moved += static_cast<size_t>(cur - sift);
+                        }
+                        if (moved > PARTIAL_INSERTION_SORT_LIMIT)
+                            return false;
+                    }
+                    return true;
+                }
+
+                template <typename Iter, typename Compare>
+                void sort2(Iter a, Iter b, Compare &comp)
+                {
+                    if (comp(*b, *a))
+                        std::iter_swap(a, b);
+                }
+
+                template <typename Iter, typename Compare>
+                void sort3(Iter a, Iter b, Iter c, Compare &comp)
+                {
+                    sort2(a, b, comp);
+                    sort2(b, c, comp);
+                    sort2(a, b, comp);
+                }
+
+                inline unsigned char *alignCacheline(unsigned char *p)
+                {
+                    const auto address = reinterpret_cast<std::uintptr_t>(p);
+                    return p + ((CACHELINE_SIZE - address % CACHELINE_SIZE) % CACHELINE_SIZE);
+                }
+
+                template <typename Iter>
+                void swapOffsets(Iter first, Iter last, const unsigned char *offsetsL, const unsigned char *offsetsR,
+                                 size_t count, bool useSwaps)
+                {
+                    using T = typename std::iterator_traits<Iter>::value_type;
+                    if (useSwaps)
+                    {
+                        // Needed for descending input to stay O(n)
+                        for (size_t i = 0; i < count; ++i)
+                            std::iter_swap(first + offsetsL[i], last - offsetsR[i]);
+                    }
+                    else if (count > 0)
+                    {
+                        // Cyclic permutation: one temporary instead of a swap each
+                        Iter l = first + offsetsL[0];
+                        Iter r = last - offsetsR[0];
+                        T tmp(std::move(*l));
+                        *l = std::move(*r);
+                        for (size_t i = 1; i < count; ++i)
+                        {
+                            l = first + offsetsL[i];
+                            *r = std::move(*l);
+                            r = last - offsetsR[i];
+                            *l = std::move(*r);
+                        }
+                        *r = std::move(tmp);
+                    }
+                }
+
+                // Partition around the pivot *begin; elements equal to it go
+                // right. Returns the pivot's final position and whether the
+                // range was already partitioned. Needs a median-of-3 pivot and
+                // at least INSERTION_SORT_THRESHOLD elements. Wrong-side
+                // elements are found a block at a time into offset buffers
+                // without branching on the comparison, then swapped in bulk.
+                template <typename Iter, typename Compare>
+                std::pair<Iter, bool> partitionRightBranchless(Iter begin, Iter end, Compare &comp)
+                {
+                    using T = typename std::iterator_traits<Iter>::value_type;
+                    T pivot(std::move(*begin));
+                    Iter first = begin;
+                    Iter last = end;
+
+                    // The median of 3 guarantees both searches stop in range
+                    while (comp(*++first, pivot))
+                    {
+                    }
+                    if (first - 1 == begin)
+                    {
+                        while (first < last && !comp(*--last, pivot))
+                        {
+                        }
+                    }
+                    else
+                    {
+                        while (!comp(*--last, pivot))
+                        {
+                        }
+                    }
+
+                    const bool alreadyPartitioned = first >= last;
+                    if (!alreadyPartitioned)
+                    {
+                        std::iter_swap(first, last);
+                        ++first;
+
+                        unsigned char storageL[BLOCK_SIZE + CACHELINE_SIZE];
+                        unsigned char storageR[BLOCK_SIZE + CACHELINE_SIZE];
+                        unsigned char *offsetsL = alignCacheline(storageL);
+                        unsigned char *offsetsR = alignCacheline(storageR);
+                        Iter baseL = first;
+                        Iter baseR = last;
+                        size_t countL = 0, countR = 0, startL = 0, startR = 0;
+
+                        while (first < last)
+                        {
+                            const auto unknown = static_cast<size_t>(last - first);
+                            const size_t splitL = countL == 0 ? (countR == 0 ? unknown / 2 : unknown) : 0;
+                            const size_t splitR = countR == 0 ? unknown - splitL : 0;
+
+                            if (splitL >= BLOCK_SIZE)
+                            {
+                                for (size_t i = 0; i < BLOCK_SIZE;)
+                                {
+                                    for (int unroll = 0; unroll < 8; unroll++)
+                                    {
+                                        offsetsL[countL] = static_cast<unsigned char>(i++);
+                                        countL += !comp(*first, pivot);
+                                        ++first;
+                                    }
+                                }
+                            }
+                            else
+                            {
+                                for (size_t i = 0; i < splitL;)
+                                {
+                                    offsetsL[countL] = static_cast<unsigned char>(i++);
+                                    countL += !comp(*first, pivot);
+                                    ++first;
+                                }
+                            }
+
+                            if (splitR >= BLOCK_SIZE)
+                            {
+                                for (size_t i = 0; i < BLOCK_SIZE;)
+                                {
+                                    for (int unroll = 0; unroll < 8; unroll++)
+                                    {
+                                        offsetsR[countR] = static_cast<unsigned char>(++i);
+                                        countR += comp(*--last, pivot);
+                                    }
+                                }
+                            }
+                            else
+                            {
+                                for (size_t i = 0; i < splitR;)
+                                {
+                                    offsetsR[countR] = static_cast<unsigned char>(++i);
+                                    countR += comp(*--last, pivot);
+                                }
+                            }
+
+                            const size_t count = std::min(countL, countR);
+                            swapOffsets(baseL, baseR, offsetsL + startL, offsetsR + startR, count, countL == countR);
+                            countL -= count;
+                            countR -= count;
+                            startL += count;
+                            startR += count;
+                            if (countL == 0)
+                            {
+                                startL = 0;
+                                baseL = first;
+                            }
+                            if (countR == 0)
+                            {
+                                startR = 0;
+                                baseR = last;
+                            }
+                        }
+
+                        // Leftovers of the last block: move them next to the split
+                        if (countL)
+                        {
+                            offsetsL += startL;
+                            while (countL--)
+                                std::iter_swap(baseL + offsetsL[countL], --last);
+                            first = last;
+                        }
+                        if (countR)
+                        {
+                            offsetsR += startR;
+                            while (countR--)
+                            {
+                                std::iter_swap(baseR - offsetsR[countR], first);
+                                ++first;
+                            }
+                            last = first;
+                        }
+                    }
+
+                    Iter pivotPos = first - 1;
+                    *begin = std::move(*pivotPos);
+                    *pivotPos = std::move(pivot);
+                    return std::make_pair(pivotPos, alreadyPartitioned);
+                }
+
+                // Branching version of the above for general comparators
+                template <typename Iter, typename Compare>
+                std::pair<Iter, bool> partitionRight(Iter begin, Iter end, Compare &comp)
+                {
+                    using T = typename std::iterator_traits<Iter>::value_type;
+                    T pivot(std::move(*begin));
+                    Iter first = begin;
+                    Iter last = end;
+
+                    while (comp(*++first, pivot))
+                    {
+                    }
+                    if (first - 1 == begin)
+                    {
+                        while (first < last && !comp(*--last, pivot))
+                        {
+                        }
+                    }
+                    else
+                    {
+                        while (!comp(*--last, pivot))
+                        {
+                        }
+                    }
+
+                    const bool alreadyPartitioned = first >= last;
+                    // Previously swapped pairs guard the searches from here on
+                    while (first < last)
+                    {
+                        std::iter_swap(first, last);
+                        while (comp(*++first, pivot))
+                        {
+                        }
+                        while (!comp(*--last, pivot))
+                        {
+                        }
+                    }
+
+                    Iter pivotPos = first - 1;
+                    *begin = std::move(*pivotPos);
+                    *pivotPos = std::move(pivot);
+                    return std::make_pair(pivotPos, alreadyPartitioned);
+                }
+
+                // Elements equal to the pivot go left. Used when the pivot equals
+                // the element before the range, so that whole left part is equal
+                // and done: many duplicates cost O(n).
+                template <typename Iter, typename Compare>
+                Iter partitionLeft(Iter begin, Iter end, Compare &comp)
+                {
+                    using T = typename std::iterator_traits<Iter>::value_type;
+                    T pivot(std::move(*begin));
+                    Iter first = begin;
+                    Iter last = end;
+
+                    while (comp(pivot, *--last))
+                    {
+                    }
+                    if (last + 1 == end)
+                    {
+                        while (first < last && !comp(pivot, *++first))
+                        {
+                        }
+                    }
+                    else
+                    {
+                        while (!comp(pivot, *++first))
+                        {
+                        }
+                    }
+
+                    while (first < last)
+                    {
+                        std::iter_swap(first, last);
+                        while (comp(pivot, *--last))
+                        {
+                        }
+                        while (!comp(pivot, *++first))
+                        {
+                        }
+                    }
+
+                    Iter pivotPos = last;
+                    *begin = std::move(*pivotPos);
+                    *pivotPos = std::move(pivot);
+                    return pivotPos;
+                }
+
+                template <bool Branchless, typename Iter, typename Compare>
+                void sortLoop(Iter begin, Iter end, Compare &comp, int badAllowed, bool leftmost)
+                {
+                    using Diff = typename std::iterator_traits<Iter>::difference_type;
+                    // Recurse on the left part, loop on the right
+                    for (;;)
+                    {
+                        const Diff size = end - begin;
+                        if (size < INSERTION_SORT_THRESHOLD)
+                        {
+                            if (leftmost)
+                                insertionSort(begin, end, comp);
+                            else
+                                unguardedInsertionSort(begin, end, comp);
+                            return;
+                        }
+
+                        // Median of 3, or pseudomedian of 9 on large ranges
+                        const Diff half = size / 2;
+                        if (size > NINTHER_THRESHOLD)
+                        {
+                            sort3(begin, begin + half, end - 1, comp);
+                            sort3(begin + 1, begin + (half - 1), end - 2, comp);
+                            sort3(begin + 2, begin + (half + 1), end - 3, comp);
+                            sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+                            std::iter_swap(begin, begin + half);
+                        }
+                        else
+                        {
+                            sort3(begin + half, begin, end - 1, comp);
+                        }
+
+                        // *(begin - 1) bounds this range from below; a pivot equal
+                        // to it means a run of equal keys
+                        if (!leftmost && !comp(*(begin - 1), *begin))
+                        {
+                            begin = partitionLeft(begin, end, comp) + 1;
+                            continue;
+                        }
+
+                        auto [pivotPos, alreadyPartitioned] = Branchless ? partitionRightBranchless(begin, end, comp)
+                                                                         : partitionRight(begin, end, comp);
+
+                        const Diff sizeL = pivotPos - begin;
+                        const Diff sizeR = end - (pivotPos + 1);
+                        if (sizeL < size / 8 || sizeR < size / 8)
+                        {
+                            // Too many bad splits: heapsort keeps O(n log n)
+                            if (--badAllowed == 0)
+                            {
+                                std::make_heap(begin, end, comp);
+                                std::sort_heap(begin, end, comp);
+                                return;
+                            }
+                            // Shuffle a few elements to break the pattern
+                            if (sizeL >= INSERTION_SORT_THRESHOLD)
+                            {
+                                std::iter_swap(begin, begin + sizeL / 4);
+                                std::iter_swap(pivotPos - 1, pivotPos - sizeL / 4);
+                                if (sizeL > NINTHER_THRESHOLD)
+                                {
+                                    std::iter_swap(begin + 1, begin + (sizeL / 4 + 1));
+                                    std::iter_swap(begin + 2, begin + (sizeL / 4 + 2));
+                                    std::iter_swap(pivotPos - 2, pivotPos - (sizeL / 4 + 1));
+                                    std::iter_swap(pivotPos - 3, pivotPos - (sizeL / 4 + 2));
+                                }
+                            }
+                            if (sizeR >= INSERTION_SORT_THRESHOLD)
+                            {
+                                std::iter_swap(pivotPos + 1, pivotPos + (1 + sizeR / 4));
+                                std::iter_swap(end - 1, end - sizeR / 4);
+                                if (sizeR > NINTHER_THRESHOLD)
+                                {
+                                    std::iter_swap(pivotPos + 2, pivotPos + (2 + sizeR / 4));
+                                    std::iter_swap(pivotPos + 3, pivotPos + (3 + sizeR / 4));
+                                    std::iter_swap(end - 2, end - (1 + sizeR / 4));
+                                    std::iter_swap(end - 3, end - (2 + sizeR / 4));
+                                }
+                            }
+                        }
+                        else if (alreadyPartitioned && partialInsertionSort(begin, pivotPos, comp) &&
+                                 partialInsertionSort(pivotPos + 1, end, comp))
+                        {
+                            // Balanced split of a range that was already in order
+                            return;
+                        }
+
+                        sortLoop<Branchless>(begin, pivotPos, comp, badAllowed, leftmost);
+                        begin = pivotPos + 1;
+                        leftmost = false;
+                    }
+                }
+
+                template <typename T, typename Compare>
+                constexpr bool isBranchless()
+                {
+                    return std::is_arithmetic<T>::value &&
+                           (std::is_same<Compare, std::less<>>::value || std::is_same<Compare, std::less<T>>::value ||
+                            std::is_same<Compare, std::greater<>>::value || std::is_same<Compare, std::greater<T>>::value);
+                }
+            } // namespace pdq
+
+            // Order-preserving map of an arithmetic value to an unsigned key
+            // of the same width: flip the sign bit of integers, and for floats
+            // flip all bits of negatives and the sign bit of the rest
+            template <size_t Size>
+            struct RadixUnsigned;
+            template <>
+            struct RadixUnsigned<1>
+            {
+                using type = uint8_t;
+            };
+            template <>
+            struct RadixUnsigned<2>
+            {
+                using type = uint16_t;
+            };
+            template <>
+            struct RadixUnsigned<4>
+            {
+                using type = uint32_t;
+            };
+            template <>
+            struct RadixUnsigned<8>
+            {
+                using type = uint64_t;
+            };
+
+            template <typename T>
+            using RadixKey = typename RadixUnsigned<sizeof(T)>::type;
+
+            template <typename T>
+            constexpr bool isRadixSortable()
+            {
+                return std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8 &&
+                       (std::is_integral<T>::value || std::numeric_limits<T>::is_iec559);
+            }
+
+            template <typename T>
+            RadixKey<T> toRadixKey(T value)
+            {
+                using K = RadixKey<T>;
+                constexpr K sign = K(1) << (sizeof(K) * 8 - 1);
+                K bits;
+                std::memcpy(&bits, &value, sizeof(T));
+                if constexpr (std::is_floating_point<T>::value)
+                    return (bits & sign) ? static_cast<K>(~bits) : static_cast<K>(bits | sign);
+                else if constexpr (std::is_signed<T>::value)
+                    return static_cast<K>(bits ^ sign);
+                else
+                    return bits;
+            }
+
+            template <typename T>
+            T fromRadixKey(RadixKey<T> key)
+            {
+                using K = RadixKey<T>;
+                constexpr K sign = K(1) << (sizeof(K) * 8 - 1);
+                K bits;
+                if constexpr (std::is_floating_point<T>::value)
+                    bits = (key & sign) ? static_cast<K>(key ^ sign) : static_cast<K>(~key);
+                else if constexpr (std::is_signed<T>::value)
+                    bits = static_cast<K>(key ^ sign);
+                else
+                    bits = key;
+                T value;
+                std::memcpy(&value, &bits, sizeof(T));
+                return value;
+            }
+
+            // Stable LSD radix sort on 8-bit digits. All digit histograms come
+            // from one pass; digits where every key agrees are skipped.
+            // 'payload', if given, is permuted along with the keys.
+            template <typename K, typename V>
+            void radixSortKeys(std::vector<K> &keys, std::vector<V> *payload)
+            {
+                constexpr size_t DIGITS = sizeof(K);
+                const size_t n = keys.size();
+                if (n < 2)
+                    return;
+
+                std::vector<std::array<size_t, 256>> counts(DIGITS);
+                for (auto &histogram : counts)
+                    histogram.fill(0);
+                for (K key : keys)
+                {
+                    for (size_t d = 0; d < DIGITS; d++)
+                        counts[d][(key >> (d * 8)) & 0xFF]++;
+                }
+
+                std::vector<K> keyBuffer(n);
+                std::vector<V> payloadBuffer(payload ? n : 0);
+                for (size_t d = 0; d < DIGITS; d++)
+                {
+                    auto &histogram = counts[d];
+                    if (histogram[(keys[0] >> (d * 8)) & 0xFF] == n)
+                        continue;
+                    size_t offset = 0;
+                    for (auto &count : histogram)
+                    {
+                        const size_t c = count;
+                        count = offset;
+                        offset += c;
+                    }
+                    if (payload)
+                    {
+                        for (size_t i = 0; i < n; i++)
+                        {
+                            const size_t slot = histogram[(keys[i] >> (d * 8)) & 0xFF]++;
+                            keyBuffer[slot] = keys[i];
+                            payloadBuffer[slot] = std::move((*payload)[i]);
+                        }
+                    }
+                    else
+                    {
+                        // Stage each bucket's keys in a cache line and write
+                        // whole lines: 256 scattered streams otherwise thrash
+                        // the TLB and write-allocate on every store
+                        constexpr size_t LINE = 64 / sizeof(K);
+                        alignas(64) K staged[256][LINE];
+                        uint8_t filled[256] = {};
+                        for (size_t i = 0; i < n; i++)
+                        {
+                            const K key = keys[i];
+                            const size_t digit = (key >> (d * 8)) & 0xFF;
+                            staged[digit][filled[digit]++] = key;
+                            if (filled[digit] == LINE)
+                            {
+                                std::memcpy(&keyBuffer[histogram[digit]], staged[digit], sizeof(staged[digit]));
+                                histogram[digit] += LINE;
+                                filled[digit] = 0;
+                            }
+                        }
+                        for (size_t digit = 0; digit < 256; digit++)
+                        {
+                            if (filled[digit])
+                                std::memcpy(&keyBuffer[histogram[digit]], staged[digit], filled[digit] * sizeof(K));
+                        }
+                    }
+                    keys.swap(keyBuffer);
+                    if (payload)
+                        payload->swap(payloadBuffer);
+                }
+            }
+
+            // Below this radix sort's passes cost more than comparisons
+            constexpr size_t RADIX_SORT_THRESHOLD = 256;
+
+            // Each radix pass is a full scatter, and radix sort cannot exploit
+            // presorted runs the way pdqsort does, so it is only picked
+            // automatically for keys of at most this many bytes (2 passes
+            // alone, 4 when an index travels with the key)
+            constexpr size_t RADIX_MAX_KEY_BYTES = 2;
+            constexpr size_t RADIX_MAX_KEY_BYTES_BY = 4;
+
+            // Index i such that the first 'diagonal' outputs of a stable merge
+            // of a and b are a[0, i) and b[0, diagonal - i)
+            template <typename T, typename Compare>
+            size_t mergePath(const T *a, size_t sizeA, const T *b, size_t sizeB, size_t diagonal, Compare &comp)
+            {
+                size_t lo = diagonal > sizeB ? diagonal - sizeB : 0;
+                size_t hi = std::min(diagonal, sizeA);
+                while (lo < hi)
+                {
+                    const size_t mid = lo + (hi - lo) / 2;
+                    if (comp(b[diagonal - mid - 1], a[mid]))
+                        hi = mid;
+                    else
+                        lo = mid + 1;
+                }
+                return lo;
+            }
+
+            template <typename C, typename = void>
+            struct IsSortableContainer : std::false_type
+            {
+            };
+            template <typename C>
+            struct IsSortableContainer<C, std::void_t<typename C::value_type, decltype(std::declval<const C &>().begin())>>
+                : std::true_type
+            {
+            };
+        } // namespace detail
+
+        template <typename Iter, typename Compare>
+        void pdqsort(Iter begin, Iter end, Compare comp)
+        {
+            if (end - begin < 2)
+                return;
+            using T = typename std::iterator_traits<Iter>::value_type;
+            int badAllowed = 0;
+            for (auto n = end - begin; n > 1; n >>= 1)
+                badAllowed++;
+            detail::pdq::sortLoop<detail::pdq::isBranchless<T, Compare>()>(begin, end, comp, badAllowed, true);
+        }
+
+        template <typename Iter>
+        void pdqsort(Iter begin, Iter end)
+        {
+            pdqsort(begin, end, std::less<>());
+        }
+
+        // Sort arithmetic values with LSD radix sort. Total order: -NaN first,
+        // NaN last, -0.0 before 0.0.
+        template <typename T>
+        void radixSort(std::vector<T> &items)
+        {
+            static_assert(detail::isRadixSortable<T>(), "radixSort requires integer or IEEE float elements");
+            std::vector<detail::RadixKey<T>> keys(items.size());
+            for (size_t i = 0; i < items.size(); i++)
+                keys[i] = detail::toRadixKey(items[i]);
+            detail::radixSortKeys<detail::RadixKey<T>, char>(keys, nullptr);
+            for (size_t i = 0; i < items.size(); i++)
+                items[i] = detail::fromRadixKey<T>(keys[i]);
+        }
+
+        // Stable sort by an arithmetic key; key(item) is called once per item
+        template <typename T, typename KeyFn>
+        void radixSortBy(std::vector<T> &items, KeyFn key)
+        {
+            using Key = std::decay_t<decltype(key(items[0]))>;
+            static_assert(detail::isRadixSortable<Key>(), "radixSortBy requires an integer or IEEE float key");
+            std::vector<detail::RadixKey<Key>> keys(items.size());
+            std::vector<size_t> order(items.size());
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                keys[i] = detail::toRadixKey(key(items[i]));
+                order[i] = i;
+            }
+            detail::radixSortKeys(keys, &order);
+            std::vector<T> result;
+            result.reserve(items.size());
+            for (size_t index : order)
+                result.push_back(std::move(items[index]));
+            items = std::move(result);
+        }
+
+        // pdqsort, or radix sort for large vectors of narrow integers in
+        // default order
+        template <typename T, typename Compare = std::less<>>
+        void sortInPlace(std::vector<T> &items, Compare comp = Compare())
+        {
+            if constexpr (detail::isRadixSortable<T>() && sizeof(T) <= detail::RADIX_MAX_KEY_BYTES &&
+                          std::is_same<Compare, std::less<>>::value)
+            {
+                if (items.size() >= detail::RADIX_SORT_THRESHOLD)
+                {
+                    radixSort(items);
+                    return;
+                }
+            }
+            pdqsort(items.begin(), items.end(), comp);
+        }
+
+        // Merge sort over a thread pool: one pdqsort'ed run per thread, then
+        // rounds of pairwise merges, each merge split at merge-path points so
+        // every round keeps all threads busy (the last round included).
+        // Stable with respect to the runs' order; T must be default
+        // constructible.
+        template <typename T, typename Compare = std::less<>>
+        void parallelSort(std::vector<T> &items, Compare comp = Compare(), ThreadPool &pool = ThreadPool::global())
+        {
+            constexpr size_t PARALLEL_SORT_CUTOFF = size_t(1) << 15;
+            const size_t n = items.size();
+            const size_t threads = pool.size();
+            if (threads <= 1 || n < PARALLEL_SORT_CUTOFF)
+            {
+                pdqsort(items.begin(), items.end(), comp);
+                return;
+            }
+
+            size_t runs = 1;
+            while (runs < threads)
+                runs *= 2;
+            std::vector<size_t> bounds(runs + 1);
+            for (size_t r = 0; r <= runs; r++)
+                bounds[r] = n * r / runs;
+
+            pool.parallelForRange(0, runs, 1, [&](size_t lo, size_t hi)
+                                  {
+                for (size_t r = lo; r < hi; r++)
+                    pdqsort(items.begin() + bounds[r], items.begin() + bounds[r + 1], comp); });
+
+            std::vector<T> buffer(n);
+            T *src = items.data();
+            T *dst = buffer.data();
+            for (size_t width = 1; width < runs; width *= 2)
+            {
+                const size_t pairs = runs / (2 * width);
+                const size_t pieces = std::max<size_t>(1, threads / pairs);
+                pool.parallelForRange(0, pairs * pieces, 1, [&](size_t lo, size_t hi)
+                                      {
+                    for (size_t task = lo; task < hi; task++)
+                    {
+                        const size_t pair = task / pieces;
+                        const size_t piece = task % pieces;
+                        const size_t begin = bounds[pair * 2 * width];
+                        const size_t mid = bounds[pair * 2 * width + width];
+                        const size_t end = bounds[(pair + 1) * 2 * width];
+                        const size_t total = end - begin;
+                        const size_t from = total * piece / pieces;
+                        const size_t to = total * (piece + 1) / pieces;
+                        const size_t a0 = detail::mergePath(src + begin, mid - begin, src + mid, end - mid, from, comp);
+                        const size_t a1 = detail::mergePath(src + begin, mid - begin, src + mid, end - mid, to, comp);
+                        std::merge(std::make_move_iterator(src + begin + a0), std::make_move_iterator(src + begin + a1),
+                                   std::make_move_iterator(src + mid + (from - a0)),
+                                   std::make_move_iterator(src + mid + (to - a1)), dst + begin + from, comp);
+                    } });
+                std::swap(src, dst);
+            }
+            if (src != items.data())
+                std::move(buffer.begin(), buffer.end(), items.begin());
+        }
+
+        // Puts the element that belongs at index n there, smaller ones before
+        // and larger ones after (introselect); returns it
+        template <typename T, typename Compare = std::less<>>
+        const T &nthElement(std::vector<T> &items, size_t n, Compare comp = Compare())
+        {
+            if (n >= items.size())
+            {
+                throw std::out_of_range("nthElement: index " + std::to_string(n) + " out of range");
+            }
+            std::nth_element(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(n), items.end(), comp);
+            return items[n];
+        }
+
+        template <typename C, typename Compare = std::less<>>
+        auto sorted(const C &items, Compare comp = Compare())
+        {
+            std::vector<typename C::value_type> result(std::begin(items), std::end(items));
+            sortInPlace(result, comp);
+            return result;
+        }
+
+        // Copy sorted by key(item), stable; keys are computed once. Narrow
+        // arithmetic keys use radix sort, others pdqsort on (key, position).
+        template <typename C, typename KeyFn, std::enable_if_t<detail::IsSortableContainer<C>::value, int> = 0>
+        auto sortBy(const C &items, KeyFn key)
+        {
+            using T = typename C::value_type;
+            std::vector<T> values(std::begin(items), std::end(items));
+            if (values.size() < 2)
+                return values;
+            using Key = std::decay_t<decltype(key(values[0]))>;
+            if constexpr (detail::isRadixSortable<Key>() && sizeof(Key) <= detail::RADIX_MAX_KEY_BYTES_BY)
+            {
+                if (values.size() >= detail::RADIX_SORT_THRESHOLD)
+                {
+                    radixSortBy(values, key);
+                    return values;
+                }
+            }
+            std::vector<std::pair<Key, size_t>> keyed;
+            keyed.reserve(values.size());
+            for (size_t i = 0; i < values.size(); i++)
+                keyed.emplace_back(key(values[i]), i);
+            pdqsort(keyed.begin(), keyed.end(), [](const std::pair<Key, size_t> &a, const std::pair<Key, size_t> &b)
+                    { return a.first < b.first || (!(b.first < a.first) && a.second < b.second); });
+            std::vector<T> result;
+            result.reserve(values.size());
+            for (const auto &entry : keyed)
+                result.push_back(std::move(values[entry.second]));
+            return result;
+        }
+
+        // The k smallest elements in ascending order (k largest with
+        // std::greater<>()). Small k keeps a heap of k; otherwise select and
+        // sort the prefix.
+        template <typename C, typename Compare = std::less<>, std::enable_if_t<detail::IsSortableContainer<C>::value, int> = 0>
+        auto topK(const C &items, size_t k, Compare comp = Compare())
+        {
+            using T = typename C::value_type;
+            std::vector<T> result;
+            const auto n = static_cast<size_t>(std::distance(std::begin(items), std::end(items)));
+            k = std::min(k, n);
+            if (k == 0)
+                return result;
+            if (k * 8 < n)
+            {
+                // Max-heap (under comp) of the best k so far
+                result.reserve(k);
+                for (const auto &item : items)
+                {
+                    if (result.size() < k)
+                    {
+                        result.push_back(item);
+                        std::push_heap(result.begin(), result.end(), comp);
+                    }
+                    else if (comp(item, result.front()))
+                    {
+                        std::pop_heap(result.begin(), result.end(), comp);
+                        result.back() = item;
+                        std::push_heap(result.begin(), result.end(), comp);
+                    }
+                }
+            }
+            else
+            {
+                result.assign(std::begin(items), std::end(items));
+                std::nth_element(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(k - 1), result.end(), comp);
+                result.resize(k);
+            }
+            pdqsort(result.begin(), result.end(), comp);
+            return result;
+        }
+
+        // The k elements with the smallest key(item), ascending by key
+        template <typename C, typename KeyFn, std::enable_if_t<detail::IsSortableContainer<C>::value, int> = 0>
+        auto topKBy(const C &items, size_t k, KeyFn key)
+        {
+            using T = typename C::value_type;
+            using Key = std::decay_t<decltype(key(*std::begin(items)))>;
+            std::vector<std::pair<Key, size_t>> keyed;
+            size_t index = 0;
+            for (const auto &item : items)
+                keyed.emplace_back(key(item), index++);
+            auto best = topK(keyed, k, [](const std::pair<Key, size_t> &a, const std::pair<Key, size_t> &b)
+                             { return a.first < b.first || (!(b.first < a.first) && a.second < b.second); });
+            std::vector<T> result;
+            result.reserve(best.size());
+            for (const auto &entry : best)
+                result.push_back(*std::next(std::begin(items), static_cast<std::ptrdiff_t>(entry.second)));
+            return result;
+        }
+
+        // Pipeline forms: items |> sortBy(key), items |> topK(k), items |> topKBy(k, key)
+        template <typename KeyFn, std::enable_if_t<!detail::IsSortableContainer<KeyFn>::value, int> = 0>
+        auto sortBy(KeyFn key)
+        {
+            return [key](const auto &items)
+            { return sortBy(items, key); };
+        }
+
+        inline auto topK(size_t k)
+        {
+            return [k](const auto &items)
+            { return topK(items, k); };
+        }
+
+        template <typename KeyFn>
+        auto topKBy(size_t k, KeyFn key)
+        {
+            return [k, key](const auto &items)
+            { return topKBy(items, k, key); };
+        }
+
+        // Branchless binary search over a sorted contiguous container: the
+        // loop has a fixed trip count (log2 n) and the step compiles to a
+        // conditional move, so there is nothing to mispredict. Returns an index.
+        template <typename C, typename T, typename Compare = std::less<>>
+        size_t lowerBound(const C &items, const T &value, Compare comp = Compare())
+        {
+            if constexpr (detail::IsContiguous<C>::value)
+            {
+                const auto *data = items.data();
+                const auto *base = data;
+                size_t n = items.size();
+                if (n == 0)
+                    return 0;
+                while (n > 1)
+                {
+                    const size_t half = n / 2;
+#if defined(__GNUC__) || defined(__clang__)
+                    // Both possible next probes, so the miss overlaps this one
+                    __builtin_prefetch(base + half / 2);
+                    __builtin_prefetch(base + half + half / 2);
+#endif
+                    base = comp(base[half], value) ? base + half : base;
+                    n -= half;
+                }
+                return static_cast<size_t>(base - data) + (comp(*base, value) ? 1 : 0);
+            }
+            else
+            {
+                return static_cast<size_t>(std::distance(std::begin(items), std::lower_bound(std::begin(items), std::end(items), value, comp)));
+            }
+        }
+
+        template <typename C, typename T, typename Compare = std::less<>>
+        size_t upperBound(const C &items, const T &value, Compare comp = Compare())
+        {
+            if constexpr (detail::IsContiguous<C>::value)
+            {
+                const auto *data = items.data();
+                const auto *base = data;
+                size_t n = items.size();
+                if (n == 0)
+                    return 0;
+                while (n > 1)
+                {
+                    const size_t half = n / 2;
+                    base = comp(value, base[half]) ? base : base + half;
+                    n -= half;
+                }
+                return static_cast<size_t>(base - data) + (comp(value, *base) ? 0 : 1);
+            }
+            else
+            {
+                return static_cast<size_t>(std::distance(std::begin(items), std::upper_bound(std::begin(items), std::end(items), value, comp)));
+            }
+        }
+
+        template <typename C, typename T, typename Compare = std::less<>>
+        bool binarySearch(const C &items, const T &value, Compare comp = Compare())
+        {
+            const size_t index = lowerBound(items, value, comp);
+            return index < items.size() && !comp(value, *std::next(std::begin(items), static_cast<std::ptrdiff_t>(index)));
+        }
+
+        // ===== MOLECULE / GRAPH =====
+        enum class BondType
+        {
+            SINGLE,       // - undirected edge
+            DOUBLE,       // = strong connection
+            ARROW,        // -> directed edge
+            BIDIRECTIONAL // <-> bidirectional edge
+        };
+
+        template <typename T>
+        struct MoleculeBond
+        {
+            T from;
+            T to;
+            BondType type;
+            double weight;
+
+            MoleculeBond(const T &f, const T &t, BondType bt, double w = 1.0)
+                : from(f), to(t), type(bt), weight(w) {}
+
+            // Copy constructor
+            MoleculeBond(const MoleculeBond &) = default;
+            // Move constructor
+            MoleculeBond(MoleculeBond &&) noexcept = default;
+            // Copy assignment
+            MoleculeBond &operator=(const MoleculeBond &) = default;
+            // Move assignment
+            MoleculeBond &operator=(MoleculeBond &&) noexcept = default;
+        };
+
+        // Non-owning view over contiguous elements (std::span is C++20; generated code is C++17)
+        template <typename T>
+        class Span
+        {
+        private:
+            T *first = nullptr;
+            size_t count = 0;
+
+        public:
+            constexpr Span() = default;
+            constexpr Span(T *data, size_t size) : first(data), count(size) {}
+
+            template <typename Container, typename = decltype(std::declval<Container &>().data())>
+            constexpr Span(Container &c) : first(c.data()), count(c.size()) {}
+
+            constexpr T *data() const { return first; }
+            constexpr size_t size() const { return count; }
+            constexpr bool empty() const { return count == 0; }
+            constexpr T *begin() const { return first; }
+            constexpr T *end() const { return first + count; }
+            constexpr T &operator[](size_t i) const { return first[i]; }
+
+            // Copy out when the caller needs to own the elements
+            std::vector<std::remove_const_t<T>> toVector() const
+            {
+                return std::vector<std::remove_const_t<T>>(first, first + count);
+            }
+        };
+
+        namespace detail
+        {
+            inline unsigned countTrailingZeros(uint64_t x)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+                unsigned n = 0;
+                while (!(x & 1))
+                {
+                    x >>= 1;
+                    n++;
+                }
+                return n;
+#endif
+            }
+
+            // One bit per dense atom ID (replaces per-call unordered_set visited-sets)
+            class VisitedBits
+            {
+            private:
+                std::vector<uint64_t> words;
+
+            public:
+                explicit VisitedBits(size_t n) : words((n + 63) / 64, 0) {}
+
+                bool test(size_t i) const
+                {
+                    return (words[i >> 6] >> (i & 63)) & 1u;
+                }
+
+                // Returns true if the bit was not set before
+                bool testAndSet(size_t i)
+                {
+                    const uint64_t bit = uint64_t(1) << (i & 63);
+                    uint64_t &word = words[i >> 6];
+                    if (word & bit)
+                        return false;
+                    word |= bit;
+                    return true;
+                }
+            };
+        } // namespace detail
+
+        // Compressed-sparse-row adjacency over dense atom IDs [0, atomCount).
+        // Neighbors of atom i are targets[offsets[i] .. offsets[i + 1]).
+        struct MoleculeCsr
+        {
+            using AtomId = uint32_t;
+            static constexpr AtomId NO_ATOM = std::numeric_limits<AtomId>::max();
+
+            std::vector<size_t> offsets; // atomCount + 1 entries
+            std::vector<AtomId> targets; // neighbor IDs grouped by source atom
+            std::vector<double> weights; // parallel to targets; empty means every weight is 1
+
+            size_t atomCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+            size_t edgeCount() const { return targets.size(); }
+            double weight(size_t edge) const { return weights.empty() ? 1.0 : weights[edge]; }
+
+            Span<const AtomId> neighbors(AtomId id) const
+            {
+                return Span<const AtomId>(targets.data() + offsets[id], offsets[id + 1] - offsets[id]);
+            }
+
+            // Reverse every edge (in-neighbors become neighbors)
+            MoleculeCsr transpose() const
+            {
+                const size_t n = atomCount();
+                MoleculeCsr t;
+                t.offsets.assign(n + 1, 0);
+                for (AtomId v : targets)
+                    t.offsets[v + 1]++;
+                for (size_t i = 0; i < n; i++)
+                    t.offsets[i + 1] += t.offsets[i];
+
+                t.targets.resize(targets.size());
+                t.weights.resize(weights.size());
+                std::vector<size_t> cursor(t.offsets.begin(), t.offsets.end() - 1);
+                for (size_t u = 0; u < n; u++)
+                {
+                    for (size_t e = offsets[u]; e < offsets[u + 1]; e++)
+                    {
+                        size_t slot = cursor[targets[e]]++;
+                        t.targets[slot] = static_cast<AtomId>(u);
+                        if (!weights.empty())
+                            t.weights[slot] = weights[e];
+                    }
+                }
+                return t;
+            }
+
+            // BFS order from start; the result vector doubles as the queue
+            std::vector<AtomId> bfs(AtomId start) const
+            {
+                std::vector<AtomId> order;
+                detail::VisitedBits seen(atomCount());
+                order.push_back(start);
+                seen.testAndSet(start);
+
+                for (size_t head = 0; head < order.size(); head++)
+                {
+                    for (AtomId next : neighbors(order[head]))
+                    {
+                        if (seen.testAndSet(next))
+                            order.push_back(next);
+                    }
+                }
+                return order;
+            }
+
+            // Preorder DFS with an explicit stack of (atom, next edge) frames
+            std::vector<AtomId> dfs(AtomId start) const
+            {
+                std::vector<AtomId> order;
+                std::vector<std::pair<AtomId, size_t>> stack;
+                detail::VisitedBits seen(atomCount());
+
+                seen.testAndSet(start);
+                order.push_back(start);
+                stack.emplace_back(start, offsets[start]);
+
+                while (!stack.empty())
+                {
+                    auto &frame = stack.back();
+                    if (frame.second == offsets[frame.first + 1])
+                    {
+                        stack.pop_back();
+                        continue;
+                    }
+                    AtomId next = targets[frame.second++];
+                    if (seen.testAndSet(next))
+                    {
+                        order.push_back(next);
+                        stack.emplace_back(next, offsets[next]);
+                    }
+                }
+                return order;
+            }
+
+            bool hasPath(AtomId from, AtomId to) const
+            {
+                if (from == to)
+                    return true;
+
+                std::vector<AtomId> queue{from};
+                detail::VisitedBits seen(atomCount());
+                seen.testAndSet(from);
+
+                for (size_t head = 0; head < queue.size(); head++)
+                {
+                    for (AtomId next : neighbors(queue[head]))
+                    {
+                        if (next == to)
+                            return true;
+                        if (seen.testAndSet(next))
+                            queue.push_back(next);
+                    }
+                }
+                return false;
+            }
+
+            // A visited neighbor other than the DFS parent closes a cycle
+            bool hasCycle() const
+            {
+                const size_t n = atomCount();
+                detail::VisitedBits seen(n);
+                std::vector<std::pair<AtomId, size_t>> stack;
+
+                for (AtomId root = 0; root < n; root++)
+                {
+                    if (!seen.testAndSet(root))
+                        continue;
+                    stack.emplace_back(root, offsets[root]);
+
+                    while (!stack.empty())
+                    {
+                        auto &frame = stack.back();
+                        if (frame.second == offsets[frame.first + 1])
+                        {
+                            stack.pop_back();
+                            continue;
+                        }
+                        AtomId next = targets[frame.second++];
+                        AtomId parent = stack.size() > 1 ? stack[stack.size() - 2].first : NO_ATOM;
+                        if (seen.testAndSet(next))
+                        {
+                            stack.emplace_back(next, offsets[next]);
+                        }
+                        else if (next != parent)
+                        {
+                            return true; // Back edge detected
+                        }
+                    }
+                }
+                return false;
+            }
+        };
+
+        // ===== PARALLEL GRAPH ALGORITHMS =====
+        struct ParallelBfsResult
+        {
+            std::vector<MoleculeCsr::AtomId> parent; // parent[source] == source, NO_ATOM if unreached
+            std::vector<uint32_t> depth;             // valid where parent != NO_ATOM
+            size_t reached = 0;
+
+            // Reached atoms ordered by depth, then ID (counting sort)
+            std::vector<MoleculeCsr::AtomId> levelOrder() const
+            {
+                std::vector<size_t> levelStart;
+                for (size_t id = 0; id < parent.size(); id++)
+                {
+                    if (parent[id] == MoleculeCsr::NO_ATOM)
+                        continue;
+                    if (levelStart.size() < depth[id] + 2)
+                        levelStart.resize(depth[id] + 2, 0);
+                    levelStart[depth[id] + 1]++;
+                }
+                for (size_t d = 1; d < levelStart.size(); d++)
+                    levelStart[d] += levelStart[d - 1];
+
+                std::vector<MoleculeCsr::AtomId> order(reached);
+                for (size_t id = 0; id < parent.size(); id++)
+                {
+                    if (parent[id] != MoleculeCsr::NO_ATOM)
+                        order[levelStart[depth[id]]++] = static_cast<MoleculeCsr::AtomId>(id);
+                }
+                return order;
+            }
+
+            // Source-to-target atom IDs along BFS parents (empty if unreached)
+            std::vector<MoleculeCsr::AtomId> pathTo(MoleculeCsr::AtomId target) const
+            {
+                std::vector<MoleculeCsr::AtomId> path;
+                if (parent[target] == MoleculeCsr::NO_ATOM)
+                    return path;
+                for (MoleculeCsr::AtomId id = target;; id = parent[id])
+                {
+                    path.push_back(id);
+                    if (parent[id] == id)
+                        break;
+                }
+                std::reverse(path.begin(), path.end());
+                return path;
+            }
+        };
+
+        // Direction-optimizing BFS (Beamer et al.). Top-down steps expand the
+        // frontier queue over out-edges and claim atoms with a CAS on parent[];
+        // once the frontier's edges outnumber the unexplored ones / ALPHA, bottom-up
+        // steps let each unvisited atom scan its in-edges for a frontier member.
+        // 'in' is the transpose of 'out' (the same CSR when all bonds are undirected).
+        inline ParallelBfsResult csrParallelBfs(const MoleculeCsr &out, const MoleculeCsr &in,
+                                                MoleculeCsr::AtomId source,
+                                                ThreadPool &pool = ThreadPool::global())
+        {
+            using AtomId = MoleculeCsr::AtomId;
+            constexpr AtomId NO_ATOM = MoleculeCsr::NO_ATOM;
+            constexpr size_t ALPHA = 14;              // top-down -> bottom-up
+            constexpr size_t BETA = 24;               // bottom-up -> top-down
+            constexpr size_t FRONTIER_GRAIN = 256;    // frontier atoms per top-down chunk
+            constexpr size_t ATOM_GRAIN = 64 * 64;    // whole bitmap words per bottom-up chunk
+
+            const size_t n = out.atomCount();
+            if (source >= n)
+            {
+                throw std::out_of_range("csrParallelBfs: source atom out of range");
+            }
+
+            ParallelBfsResult result;
+            std::unique_ptr<std::atomic<AtomId>[]> parent(new std::atomic<AtomId>[n]);
+            result.depth.assign(n, 0);
+            pool.parallelForRange(0, n, ATOM_GRAIN, [&](size_t lo, size_t hi)
+                                  {
+                for (size_t i = lo; i < hi; i++)
+                    parent[i].store(NO_ATOM, std::memory_order_relaxed); });
+            parent[source].store(source, std::memory_order_relaxed);
+
+            const size_t words = (n + 63) / 64;
+            std::vector<AtomId> frontier{source};
+            std::vector<uint64_t> frontierBits, nextBits;
+            bool bottomUp = false;
+
+            size_t frontierSize = 1;
+            size_t frontierEdges = out.neighbors(source).size();
+            size_t unexploredEdges = out.edgeCount() - frontierEdges;
+            std::mutex mergeMutex;
+            uint32_t level = 0;
+            result.reached = 1;
+
+            while (frontierSize > 0)
+            {
+                if (!bottomUp && frontierEdges > unexploredEdges / ALPHA)
+                {
+                    frontierBits.assign(words, 0);
+                    for (AtomId u : frontier)
+                        frontierBits[u >> 6] |= uint64_t(1) << (u & 63);
+                    bottomUp = true;
+                }
+                else if (bottomUp && frontierSize < n / BETA)
+                {
+                    frontier.clear();
+                    pool.parallelForRange(0, words, ATOM_GRAIN / 64, [&](size_t lo, size_t hi)
+                                          {
+                        std::vector<AtomId> local;
+                        for (size_t w = lo; w < hi; w++)
+                            for (uint64_t bits = frontierBits[w]; bits; bits &= bits - 1)
+                                local.push_back(static_cast<AtomId>(w * 64 + detail::countTrailingZeros(bits)));
+                        std::lock_guard<std::mutex> lock(mergeMutex);
+                        frontier.insert(frontier.end(), local.begin(), local.end()); });
+                    bottomUp = false;
+                }
+
+                std::atomic<size_t> nextSize{0}, nextEdges{0};
+                if (!bottomUp)
+                {
+                    std::vector<AtomId> next;
+                    pool.parallelForRange(0, frontier.size(), FRONTIER_GRAIN, [&](size_t lo, size_t hi)
+                                          {
+                        std::vector<AtomId> local;
+                        size_t localEdges = 0;
+                        for (size_t i = lo; i < hi; i++)
+                        {
+                            AtomId u = frontier[i];
+                            for (AtomId v : out.neighbors(u))
+                            {
+                                AtomId expected = NO_ATOM;
+                                if (parent[v].load(std::memory_order_relaxed) == NO_ATOM &&
+                                    parent[v].compare_exchange_strong(expected, u, std::memory_order_relaxed))
+                                {
+                                    result.depth[v] = level + 1;
+                                    local.push_back(v);
+                                    localEdges += out.neighbors(v).size();
+                                }
+                            }
+                        }
+                        nextEdges.fetch_add(localEdges, std::memory_order_relaxed);
+                        std::lock_guard<std::mutex> lock(mergeMutex);
+                        next.insert(next.end(), local.begin(), local.end()); });
+                    frontier.swap(next);
+                    nextSize = frontier.size();
+                }
+                else
+                {
+                    // Chunks cover whole words, so each nextBits word has one writer
+                    nextBits.assign(words, 0);
+                    pool.parallelForRange(0, n, ATOM_GRAIN, [&](size_t lo, size_t hi)
+                                          {
+                        size_t localSize = 0, localEdges = 0;
+                        for (size_t v = lo; v < hi; v++)
+                        {
+                            if (parent[v].load(std::memory_order_relaxed) != NO_ATOM)
+                                continue;
+                            for (AtomId u : in.neighbors(static_cast<AtomId>(v)))
+                            {
+                                if ((frontierBits[u >> 6] >> (u & 63)) & 1u)
+                                {
+                                    parent[v].store(u, std::memory_order_relaxed);
+                                    result.depth[v] = level + 1;
+                                    nextBits[v >> 6] |= uint64_t(1) << (v & 63);
+                                    localSize++;
+                                    localEdges += out.neighbors(static_cast<AtomId>(v)).size();
+                                    break;
+                                }
+                            }
+                        }
+                        nextSize.fetch_add(localSize, std::memory_order_relaxed);
+                        nextEdges.fetch_add(localEdges, std::memory_order_relaxed); });
+                    frontierBits.swap(nextBits);
+                }
+
+                frontierSize = nextSize.load();
+                frontierEdges = nextEdges.load();
+                unexploredEdges -= std::min(unexploredEdges, frontierEdges);
+                result.reached += frontierSize;
+                level++;
+            }
+
+            result.parent.resize(n);
+            pool.parallelForRange(0, n, ATOM_GRAIN, [&](size_t lo, size_t hi)
+                                  {
+                for (size_t i = lo; i < hi; i++)
+                    result.parent[i] = parent[i].load(std::memory_order_relaxed); });
+            return result;
+        }
+
+        // Weakly connected components by lock-free union-find. Each edge links the
+        // larger of its two roots under the smaller one with a CAS, so parent IDs
+        // only decrease and every label ends up as the smallest atom ID in its
+        // component (deterministic regardless of thread count).
+        inline std::vector<MoleculeCsr::AtomId> csrConnectedComponents(const MoleculeCsr &g,
+                                                                       ThreadPool &pool = ThreadPool::global())
+        {
+            using AtomId = MoleculeCsr::AtomId;
+            constexpr size_t GRAIN = 4096;
+
+            const size_t n = g.atomCount();
+            std::unique_ptr<std::atomic<AtomId>[]> parent(new std::atomic<AtomId>[n]);
+            pool.parallelForRange(0, n, GRAIN, [&](size_t lo, size_t hi)
+                                  {
+                for (size_t i = lo; i < hi; i++)
+                    parent[i].store(static_cast<AtomId>(i), std::memory_order_relaxed); });
+
+            // Root lookup with path halving
+            auto find = [&](AtomId x)
+            {
+                for (;;)
+                {
+                    AtomId p = parent[x].load(std::memory_order_acquire);
+                    if (p == x)
+                        return x;
+                    AtomId gp = parent[p].load(std::memory_order_acquire);
+                    if (gp != p)
+                        parent[x].compare_exchange_weak(p, gp, std::memory_order_acq_rel);
+                    x = gp;
+                }
+            };
+
+            pool.parallelForRange(0, n, GRAIN, [&](size_t lo, size_t hi)
+                                  {
+                for (size_t u = lo; u < hi; u++)
+                {
+                    for (AtomId v : g.neighbors(static_cast<AtomId>(u)))
+                    {
+                        AtomId a = static_cast<AtomId>(u), b = v;
+                        for (;;)
+                        {
+                            a = find(a);
+                            b = find(b);
+                            if (a == b)
+                                break;
+                            if (a < b)
+                                std::swap(a, b);
+                            AtomId expected = a;
+                            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel))
+                                break;
+                        }
+                    }
+                } });
+
+            std::vector<AtomId> labels(n);
+            pool.parallelForRange(0, n, GRAIN, [&](size_t lo, size_t hi)
+                                  {
+                for (size_t i = lo; i < hi; i++)
+                    labels[i] = find(static_cast<AtomId>(i)); });
+            return labels;
+        }
+
+        // ===== WEIGHTED GRAPH ALGORITHMS =====
+        namespace detail
+        {
+            // 4-ary min-heap over atom IDs with a position index, so a key can be
+            // lowered in place instead of pushing duplicate entries
+            class IndexedMinHeap
+            {
+            private:
+                static constexpr uint32_t NOT_IN_HEAP = std::numeric_limits<uint32_t>::max();
+                std::vector<MoleculeCsr::AtomId> heap;
+                std::vector<uint32_t> position;
+                std::vector<double> keys;
+
+                void place(size_t slot, MoleculeCsr::AtomId id)
+                {
+                    heap[slot] = id;
+                    position[id] = static_cast<uint32_t>(slot);
+                }
+
+                void siftUp(size_t slot)
+                {
+                    MoleculeCsr::AtomId id = heap[slot];
+                    while (slot > 0)
+                    {
+                        size_t parentSlot = (slot - 1) / 4;
+                        if (keys[heap[parentSlot]] <= keys[id])
+                            break;
+                        place(slot, heap[parentSlot]);
+                        slot = parentSlot;
+                    }
+                    place(slot, id);
+                }
+
+                void siftDown(size_t slot)
+                {
+                    MoleculeCsr::AtomId id = heap[slot];
+                    for (;;)
+                    {
+                        size_t first = slot * 4 + 1;
+                        if (first >= heap.size())
+                            break;
+                        size_t best = first;
+                        size_t last = std::min(first + 4, heap.size());
+                        for (size_t c = first + 1; c < last; c++)
+                        {
+                            if (keys[heap[c]] < keys[heap[best]])
+                                best = c;
+                        }
+                        if (keys[heap[best]] >= keys[id])
+                            break;
+                        place(slot, heap[best]);
+                        slot = best;
+                    }
+                    place(slot, id);
+                }
+
+            public:
+                explicit IndexedMinHeap(size_t atoms) : position(atoms, NOT_IN_HEAP), keys(atoms, 0.0) {}
+
+                bool empty() const { return heap.empty(); }
+                bool contains(MoleculeCsr::AtomId id) const { return position[id] != NOT_IN_HEAP; }
+
+                // Insert, or lower the key of an entry already in the heap
+                void pushOrDecrease(MoleculeCsr::AtomId id, double key)
+                {
+                    if (position[id] == NOT_IN_HEAP)
+                    {
+                        keys[id] = key;
+                        heap.push_back(id);
+                        siftUp(heap.size() - 1);
+                    }
+                    else if (key < keys[id])
+                    {
+                        keys[id] = key;
+                        siftUp(position[id]);
+                    }
+                }
+
+                MoleculeCsr::AtomId popMin()
+                {
+                    MoleculeCsr::AtomId top = heap.front();
+                    position[top] = NOT_IN_HEAP;
+                    MoleculeCsr::AtomId last = heap.back();
+                    heap.pop_back();
+                    if (!heap.empty())
+                    {
+                        heap[0] = last;
+                        siftDown(0);
+                    }
+                    return top;
+                }
+            };
+
+            // Sequential union-find (union by size, path halving) for Kruskal
+            class DisjointSets
+            {
+            private:
+                std::vector<MoleculeCsr::AtomId> parent;
+                std::vector<uint32_t> setSize;
+
+            public:
+                explicit DisjointSets(size_t n) : parent(n), setSize(n, 1)
+                {
+                    for (size_t i = 0; i < n; i++)
+                        parent[i] = static_cast<MoleculeCsr::AtomId>(i);
+                }
+
+                MoleculeCsr::AtomId find(MoleculeCsr::AtomId x)
+                {
+                    while (parent[x] != x)
+                    {
+                        parent[x] = parent[parent[x]];
+                        x = parent[x];
+                    }
+                    return x;
+                }
+
+                // Returns false if a and b were already in the same set
+                bool unite(MoleculeCsr::AtomId a, MoleculeCsr::AtomId b)
+                {
+                    a = find(a);
+                    b = find(b);
+                    if (a == b)
+                        return false;
+                    if (setSize[a] < setSize[b])
+                        std::swap(a, b);
+                    parent[b] = a;
+                    setSize[a] += setSize[b];
+                    return true;
+                }
+            };
+        } // namespace detail
+
+        struct ShortestPaths
+        {
+            std::vector<double> distance;            // infinity where unreached
+            std::vector<MoleculeCsr::AtomId> parent; // NO_ATOM where unreached; parent[source] == source
+
+            bool reached(MoleculeCsr::AtomId id) const { return parent[id] != MoleculeCsr::NO_ATOM; }
+
+            // Source-to-target atom IDs (empty if unreached)
+            std::vector<MoleculeCsr::AtomId> pathTo(MoleculeCsr::AtomId target) const
+            {
+                std::vector<MoleculeCsr::AtomId> path;
+                if (!reached(target))
+                    return path;
+                for (MoleculeCsr::AtomId id = target;; id = parent[id])
+                {
+                    path.push_back(id);
+                    if (parent[id] == id)
+                        break;
+                }
+                std::reverse(path.begin(), path.end());
+                return path;
+            }
+        };
+
+        struct WeightedEdge
+        {
+            MoleculeCsr::AtomId from;
+            MoleculeCsr::AtomId to;
+            double weight;
+        };
+
+        namespace detail
+        {
+            // Shared Dijkstra/A* loop; estimate(id) == 0 gives plain Dijkstra.
+            // Stops once 'target' is settled (NO_ATOM: settle everything).
+            template <typename Heuristic>
+            ShortestPaths bestFirstSearch(const MoleculeCsr &g, MoleculeCsr::AtomId source,
+                                          MoleculeCsr::AtomId target, Heuristic &&estimate)
+            {
+                const size_t n = g.atomCount();
+                if (source >= n || (target != MoleculeCsr::NO_ATOM && target >= n))
+                {
+                    throw std::out_of_range("shortest path: atom ID out of range");
+                }
+
+                ShortestPaths result;
+                result.distance.assign(n, std::numeric_limits<double>::infinity());
+                result.parent.assign(n, MoleculeCsr::NO_ATOM);
+                result.distance[source] = 0.0;
+                result.parent[source] = source;
+
+                IndexedMinHeap open(n);
+                open.pushOrDecrease(source, estimate(source));
+
+                while (!open.empty())
+                {
+                    MoleculeCsr::AtomId u = open.popMin();
+                    if (u == target)
+                        break;
+
+                    for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; e++)
+                    {
+                        double w = g.weight(e);
+                        if (w < 0.0)
+                        {
+                            throw std::invalid_argument("shortest path: negative bond weight");
+                        }
+                        MoleculeCsr::AtomId v = g.targets[e];
+                        double candidate = result.distance[u] + w;
+                        if (candidate < result.distance[v])
+                        {
+                            result.distance[v] = candidate;
+                            result.parent[v] = u;
+                            open.pushOrDecrease(v, candidate + estimate(v));
+                        }
+                    }
+                }
+                return result;
+            }
+        } // namespace detail
+
+        // Dijkstra over non-negative weights. With a target, stops once it is settled.
+        inline ShortestPaths csrDijkstra(const MoleculeCsr &g, MoleculeCsr::AtomId source,
+                                         MoleculeCsr::AtomId target = MoleculeCsr::NO_ATOM)
+        {
+            return detail::bestFirstSearch(g, source, target, [](MoleculeCsr::AtomId)
+                                           { return 0.0; });
+        }
+
+        // A*: heuristic(id) must not overestimate the remaining cost to target.
+        // An inconsistent heuristic is still exact (atoms may be re-opened).
+        template <typename Heuristic>
+        ShortestPaths csrAStar(const MoleculeCsr &g, MoleculeCsr::AtomId source,
+                               MoleculeCsr::AtomId target, Heuristic &&heuristic)
+        {
+            return detail::bestFirstSearch(g, source, target, std::forward<Heuristic>(heuristic));
+        }
+
+        // Minimum spanning forest, bond direction ignored. Each stored edge is a
+        // candidate, so symmetric CSRs simply offer every bond twice.
+        inline std::vector<WeightedEdge> csrKruskal(const MoleculeCsr &g)
+        {
+            std::vector<WeightedEdge> edges;
+            edges.reserve(g.edgeCount());
+            for (MoleculeCsr::AtomId u = 0; u < g.atomCount(); u++)
+            {
+                for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; e++)
+                {
+                    if (u != g.targets[e])
+                        edges.push_back({u, g.targets[e], g.weight(e)});
+                }
+            }
+            std::sort(edges.begin(), edges.end(), [](const WeightedEdge &a, const WeightedEdge &b)
+                      { return a.weight < b.weight; });
+
+            std::vector<WeightedEdge> forest;
+            detail::DisjointSets sets(g.atomCount());
+            for (const auto &edge : edges)
+            {
+                if (sets.unite(edge.from, edge.to))
+                {
+                    forest.push_back(edge);
+                    if (forest.size() + 1 == g.atomCount())
+                        break;
+                }
+            }
+            return forest;
+        }
+
+        // Prim's algorithm with the indexed heap. Expects a symmetric CSR
+        // (every bond stored both ways), e.g. a molecule without '->' bonds.
+        inline std::vector<WeightedEdge> csrPrim(const MoleculeCsr &g)
+        {
+            const size_t n = g.atomCount();
+            std::vector<WeightedEdge> forest;
+            std::vector<double> best(n, std::numeric_limits<double>::infinity());
+            std::vector<MoleculeCsr::AtomId> via(n, MoleculeCsr::NO_ATOM);
+            detail::VisitedBits inTree(n);
+            detail::IndexedMinHeap frontier(n);
+
+            for (MoleculeCsr::AtomId root = 0; root < n; root++)
+            {
+                if (inTree.test(root))
+                    continue;
+                best[root] = 0.0;
+                frontier.pushOrDecrease(root, 0.0);
+
+                while (!frontier.empty())
+                {
+                    MoleculeCsr::AtomId u = frontier.popMin();
+                    inTree.testAndSet(u);
+                    if (via[u] != MoleculeCsr::NO_ATOM)
+                        forest.push_back({via[u], u, best[u]});
+
+                    for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; e++)
+                    {
+                        MoleculeCsr::AtomId v = g.targets[e];
+                        if (!inTree.test(v) && g.weight(e) < best[v])
+                        {
+                            best[v] = g.weight(e);
+                            via[v] = u;
+                            frontier.pushOrDecrease(v, best[v]);
+                        }
+                    }
+                }
+            }
+            return forest;
+        }
+
+        struct SccResult
+        {
+            std::vector<uint32_t> component; // component index per atom
+            size_t count = 0;                // components are numbered in reverse topological order
+        };
+
+        // Tarjan's strongly connected components with an explicit call stack
+        inline SccResult csrStronglyConnected(const MoleculeCsr &g)
+        {
+            constexpr uint32_t UNVISITED = std::numeric_limits<uint32_t>::max();
+            const size_t n = g.atomCount();
+
+            SccResult result;
+            result.component.assign(n, UNVISITED);
+            std::vector<uint32_t> index(n, UNVISITED), low(n, 0);
+            std::vector<MoleculeCsr::AtomId> sccStack;
+            std::vector<std::pair<MoleculeCsr::AtomId, size_t>> callStack;
+            uint32_t nextIndex = 0;
+
+            auto enter = [&](MoleculeCsr::AtomId v)
+            {
+                index[v] = low[v] = nextIndex++;
+                sccStack.push_back(v);
+                callStack.emplace_back(v, g.offsets[v]);
+            };
+
+            for (MoleculeCsr::AtomId root = 0; root < n; root++)
+            {
+                if (index[root] != UNVISITED)
+                    continue;
+                enter(root);
+
+                while (!callStack.empty())
+                {
+                    MoleculeCsr::AtomId v = callStack.back().first;
+                    size_t &edge = callStack.back().second;
+                    if (edge < g.offsets[v + 1])
+                    {
+                        MoleculeCsr::AtomId w = g.targets[edge++];
+                        if (index[w] == UNVISITED)
+                            enter(w);
+                        else if (result.component[w] == UNVISITED) // still on the SCC stack
+                            low[v] = std::min(low[v], index[w]);
+                        continue;
+                    }
+
+                    if (low[v] == index[v])
+                    {
+                        MoleculeCsr::AtomId w;
+                        do
+                        {
+                            w = sccStack.back();
+                            sccStack.pop_back();
+                            result.component[w] = static_cast<uint32_t>(result.count);
+                        } while (w != v);
+                        result.count++;
+                    }
+                    callStack.pop_back();
+                    if (!callStack.empty())
+                    {
+                        MoleculeCsr::AtomId caller = callStack.back().first;
+                        low[caller] = std::min(low[caller], low[v]);
+                    }
+                }
+            }
+            return result;
+        }
+
+        // Kahn's topological sort; nullopt if the graph has a cycle. Undirected
+        // bonds are stored both ways, so only '->' molecules can be acyclic.
+        inline std::optional<std::vector<MoleculeCsr::AtomId>> csrTopologicalSort(const MoleculeCsr &g)
+        {
+            const size_t n = g.atomCount();
+            std::vector<uint32_t> inDegree(n, 0);
+            for (MoleculeCsr::AtomId v : g.targets)
+                inDegree[v]++;
+
+            // The output vector doubles as the ready queue
+            std::vector<MoleculeCsr::AtomId> order;
+            order.reserve(n);
+            for (MoleculeCsr::AtomId v = 0; v < n; v++)
+            {
+                if (inDegree[v] == 0)
+                    order.push_back(v);
+            }
+            for (size_t head = 0; head < order.size(); head++)
+            {
+                for (MoleculeCsr::AtomId v : g.neighbors(order[head]))
+                {
+                    if (--inDegree[v] == 0)
+                        order.push_back(v);
+                }
+            }
+
+            if (order.size() != n)
+                return std::nullopt;
+            return order;
+        }
+
+        template <typename T>
+        struct WeightedPath
+        {
+            std::vector<T> atoms; // empty if unreachable
+            double weight;        // infinity if unreachable
+        };
+
+        template <typename T>
+        class Molecule
+        {
+        public:
+            using AtomId = MoleculeCsr::AtomId;
+
+        private:
+            std::unordered_map<T, std::vector<T>> adjacency;
+            std::vector<MoleculeBond<T>> bonds;
+            std::unordered_set<T> atoms;
+
+            // Dense IDs in insertion order: ids[atomOrder[i]] == i
+            std::vector<T> atomOrder;
+            std::unordered_map<T, AtomId> ids;
+
+            // Bond weights by atom ID, parallel to the adjacency lists. Left empty
+            // until the first bond with a weight other than 1.
+            std::vector<std::vector<double>> adjacencyWeights;
+
+            // Built by freeze(), dropped by any mutation. The reverse CSR (for
+            // bottom-up BFS) is only needed when some bond is directed.
+            MoleculeCsr frozenCsr;
+            MoleculeCsr frozenReverse;
+            bool frozen = false;
+            size_t arrowBonds = 0;
+
+            void thaw()
+            {
+                if (frozen)
+                {
+                    frozen = false;
+                    frozenCsr = MoleculeCsr();
+                    frozenReverse = MoleculeCsr();
+                }
+            }
+
+            void addNeighbor(const T &from, const T &to, double weight)
+            {
+                adjacency[from].push_back(to);
+                if (!adjacencyWeights.empty())
+                {
+                    adjacencyWeights[ids.find(from)->second].push_back(weight);
+                }
+            }
+
+            void enableWeights()
+            {
+                adjacencyWeights.resize(atomOrder.size());
+                for (size_t id = 0; id < atomOrder.size(); id++)
+                {
+                    adjacencyWeights[id].assign(adjacency.find(atomOrder[id])->second.size(), 1.0);
+                }
+            }
+
+            void buildCsr(MoleculeCsr &out) const
+            {
+                out.offsets.assign(1, 0);
+                out.offsets.reserve(atomOrder.size() + 1);
+                out.targets.clear();
+                out.weights.clear();
+
+                size_t edges = 0;
+                for (const auto &atom : atomOrder)
+                    edges += adjacency.find(atom)->second.size();
+                out.targets.reserve(edges);
+                if (!adjacencyWeights.empty())
+                    out.weights.reserve(edges);
+
+                for (size_t id = 0; id < atomOrder.size(); id++)
+                {
+                    for (const auto &neighbor : adjacency.find(atomOrder[id])->second)
+                        out.targets.push_back(ids.find(neighbor)->second);
+                    if (!adjacencyWeights.empty())
+                        out.weights.insert(out.weights.end(), adjacencyWeights[id].begin(), adjacencyWeights[id].end());
+                    out.offsets.push_back(out.targets.size());
+                }
+            }
+
+            // Frozen CSR, or a temporary one built into scratch
+            const MoleculeCsr &graph(MoleculeCsr &scratch) const
+            {
+                if (frozen)
+                    return frozenCsr;
+                buildCsr(scratch);
+                return scratch;
+            }
+
+            // Forward and reverse CSR (the same object when no bond is directed)
+            std::pair<const MoleculeCsr *, const MoleculeCsr *> graphs(MoleculeCsr &scratch, MoleculeCsr &reverseScratch) const
+            {
+                const MoleculeCsr &forward = graph(scratch);
+                if (arrowBonds == 0)
+                    return {&forward, &forward};
+                if (frozen)
+                    return {&forward, &frozenReverse};
+                reverseScratch = forward.transpose();
+                return {&forward, &reverseScratch};
+            }
+
+            template <typename Estimate>
+            WeightedPath<T> bestFirstPath(const T &from, const T &to, Estimate &&estimate) const
+            {
+                auto src = ids.find(from);
+                auto dst = ids.find(to);
+                if (src == ids.end() || dst == ids.end())
+                {
+                    return WeightedPath<T>{{}, std::numeric_limits<double>::infinity()};
+                }
+
+                MoleculeCsr scratch;
+                ShortestPaths paths = detail::bestFirstSearch(graph(scratch), src->second, dst->second, estimate);
+                return WeightedPath<T>{toAtoms(paths.pathTo(dst->second)), paths.distance[dst->second]};
+            }
+
+            std::vector<T> toAtoms(const std::vector<AtomId> &order) const
+            {
+                std::vector<T> result;
+                result.reserve(order.size());
+                for (AtomId id : order)
+                    result.push_back(atomOrder[id]);
+                return result;
+            }
+
+        public:
+            // Default constructor
+            Molecule() = default;
+
+            // Copy constructor
+            Molecule(const Molecule &) = default;
+
+            // Move constructor
+            Molecule(Molecule &&) noexcept = default;
+
+            // Copy assignment
+            Molecule &operator=(const Molecule &) = default;
+
+            // Move assignment
+            Molecule &operator=(Molecule &&) noexcept = default;
+
+            // Destructor
+            ~Molecule() = default;
+
+            // Add atom/node (with validation)
+            void addAtom(const T &atom)
+            {
+                if (atoms.find(atom) != atoms.end())
+                {
+                    return; // Already exists, silently ignore
+                }
+                if (atomOrder.size() >= MoleculeCsr::NO_ATOM)
+                {
+                    throw std::length_error("Molecule exceeds maximum atom count");
+                }
+
+                thaw();
+                atoms.insert(atom);
+                ids.emplace(atom, static_cast<AtomId>(atomOrder.size()));
+                atomOrder.push_back(atom);
+                adjacency.emplace(atom, std::vector<T>());
+                if (!adjacencyWeights.empty())
+                {
+                    adjacencyWeights.emplace_back();
+                }
+            }
+
+            // Add bond/edge (with validation); weight defaults to 1
+            void addBond(const T &from, const T &to, BondType type, double weight = 1.0)
+            {
+                // Ensure atoms exist
+                addAtom(from);
+                addAtom(to);
+
+                // Check for duplicate bond (same from, to, type)
+                if (hasBond(from, to, type))
+                {
+                    return; // Duplicate detected, ignore
+                }
+
+                thaw();
+                bonds.push_back(MoleculeBond<T>(from, to, type, weight));
+                if (type == BondType::ARROW)
+                {
+                    arrowBonds++;
+                }
+                if (weight != 1.0 && adjacencyWeights.empty())
+                {
+                    enableWeights();
+                }
+
+                // Add to adjacency list based on bond type
+                addNeighbor(from, to, weight);
+                if (type == BondType::SINGLE || type == BondType::BIDIRECTIONAL)
+                {
+                    // Undirected or bidirectional: add reverse edge
+                    addNeighbor(to, from, weight);
+                }
+                else if (type == BondType::DOUBLE)
+                {
+                    // Double bond treated as bidirectional
+                    addNeighbor(to, from, weight);
+                }
+            }
+
+            // Build the CSR layout used by traversals. Call once the molecule is
+            // fully built; any later addAtom/addBond/clear drops it again.
+            void freeze()
+            {
+                if (frozen)
+                    return;
+                buildCsr(frozenCsr);
+                if (arrowBonds > 0)
+                {
+                    frozenReverse = frozenCsr.transpose();
+                }
+                frozen = true;
+            }
+
+            bool isFrozen() const { return frozen; }
+
+            // CSR view for ID-based algorithms (requires freeze())
+            const MoleculeCsr &csr() const
+            {
+                if (!frozen)
+                {
+                    throw std::runtime_error("Molecule::csr() called before freeze()");
+                }
+                return frozenCsr;
+            }
+
+            // Dense ID of an atom (insertion order), if present
+            std::optional<AtomId> atomId(const T &atom) const
+            {
+                auto it = ids.find(atom);
+                if (it == ids.end())
+                    return std::nullopt;
+                return it->second;
+            }
+
+            // Atom for a dense ID
+            const T &atomAt(AtomId id) const
+            {
+                return atomOrder.at(id);
+            }
+
+            // Neighbor IDs straight from the CSR arrays (requires freeze())
+            Span<const AtomId> neighborIds(AtomId id) const
+            {
+                return csr().neighbors(id);
+            }
+
+            // Get neighbors of an atom (view into the adjacency list, no copy;
+            // invalidated by the next addBond)
+            Span<const T> neighbors(const T &atom) const
+            {
+                auto it = adjacency.find(atom);
+                if (it != adjacency.end())
+                {
+                    return Span<const T>(it->second);
+                }
+                return Span<const T>();
+            }
+
+            // Check if atom exists
+            bool hasAtom(const T &atom) const
+            {
+                return atoms.find(atom) != atoms.end();
+            }
+
+            // Check if bond exists
+            bool hasBond(const T &from, const T &to, BondType type) const
+            {
+                // Every bond from->to puts 'to' in from's adjacency list, so only
+                // scan the bond list when that O(degree) check hits
+                auto it = adjacency.find(from);
+                if (it == adjacency.end() ||
+                    std::find(it->second.begin(), it->second.end(), to) == it->second.end())
+                {
+                    return false;
+                }
+
+                for (const auto &bond : bonds)
+                {
+                    if (bond.from == from && bond.to == to && bond.type == type)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // Get all atoms (const reference)
+            const std::unordered_set<T> &getAtoms() const
+            {
+                return atoms;
+            }
+
+            // Get all bonds (const reference)
+            const std::vector<MoleculeBond<T>> &getBonds() const
+            {
+                return bonds;
+            }
+
+            // Atom count (size_t for consistency)
+            size_t atomCount() const { return atoms.size(); }
+
+            // Bond count (size_t for consistency)
+            size_t bondCount() const { return bonds.size(); }
+
+            // Clear all data
+            void clear()
+            {
+                thaw();
+                atoms.clear();
+                bonds.clear();
+                adjacency.clear();
+                atomOrder.clear();
+                ids.clear();
+                adjacencyWeights.clear();
+                arrowBonds = 0;
+            }
+
+            // Check if molecule is empty
+            bool empty() const
+            {
+                return atoms.empty() && bonds.empty();
+            }
+
+            // BFS traversal (returns nodes in BFS order)
+            std::vector<T> bfs(const T &start) const
+            {
+                auto it = ids.find(start);
+                if (it == ids.end())
+                {
+                    return std::vector<T>(); // Start atom doesn't exist
+                }
+
+                MoleculeCsr scratch;
+                return toAtoms(graph(scratch).bfs(it->second));
+            }
+
+            // DFS traversal (returns nodes in DFS order)
+            std::vector<T> dfs(const T &start) const
+            {
+                auto it = ids.find(start);
+                if (it == ids.end())
+                {
+                    return std::vector<T>();
+                }
+
+                MoleculeCsr scratch;
+                return toAtoms(graph(scratch).dfs(it->second));
+            }
+
+            // Check if there's a path from 'from' to 'to'
+            bool hasPath(const T &from, const T &to) const
+            {
+                auto src = ids.find(from);
+                auto dst = ids.find(to);
+                if (src == ids.end() || dst == ids.end())
+                {
+                    return false;
+                }
+
+                MoleculeCsr scratch;
+                return graph(scratch).hasPath(src->second, dst->second);
+            }
+
+            // Check if graph is connected
+            bool isConnected() const
+            {
+                if (atomOrder.empty())
+                {
+                    return true; // Empty graph is vacuously connected
+                }
+
+                // BFS from first atom
+                MoleculeCsr scratch;
+                return graph(scratch).bfs(0).size() == atomOrder.size();
+            }
+
+            // Detect if graph has cycles (undirected)
+            bool hasCycle() const
+            {
+                MoleculeCsr scratch;
+                return graph(scratch).hasCycle();
+            }
+
+            // Parallel BFS: same atoms as bfs(), ordered by depth, then atom ID
+            std::vector<T> parallelBfs(const T &start, ThreadPool &pool = ThreadPool::global()) const
+            {
+                auto it = ids.find(start);
+                if (it == ids.end())
+                {
+                    return std::vector<T>();
+                }
+
+                MoleculeCsr scratch, reverseScratch;
+                auto g = graphs(scratch, reverseScratch);
+                return toAtoms(csrParallelBfs(*g.first, *g.second, it->second, pool).levelOrder());
+            }
+
+            // Fewest-bonds path from 'from' to 'to' (empty if unreachable)
+            std::vector<T> shortestPath(const T &from, const T &to, ThreadPool &pool = ThreadPool::global()) const
+            {
+                auto src = ids.find(from);
+                auto dst = ids.find(to);
+                if (src == ids.end() || dst == ids.end())
+                {
+                    return std::vector<T>();
+                }
+
+                MoleculeCsr scratch, reverseScratch;
+                auto g = graphs(scratch, reverseScratch);
+                return toAtoms(csrParallelBfs(*g.first, *g.second, src->second, pool).pathTo(dst->second));
+            }
+
+            // Component label per dense atom ID (smallest ID in the component;
+            // directed bonds count as undirected)
+            std::vector<AtomId> componentLabels(ThreadPool &pool = ThreadPool::global()) const
+            {
+                MoleculeCsr scratch;
+                return csrConnectedComponents(graph(scratch), pool);
+            }
+
+            // Number of weakly connected components
+            size_t componentCount(ThreadPool &pool = ThreadPool::global()) const
+            {
+                std::vector<AtomId> labels = componentLabels(pool);
+                size_t count = 0;
+                for (size_t id = 0; id < labels.size(); id++)
+                {
+                    if (labels[id] == id)
+                        count++;
+                }
+                return count;
+            }
+
+            // Minimum-weight path (Dijkstra; weights must be non-negative)
+            WeightedPath<T> weightedPath(const T &from, const T &to) const
+            {
+                return bestFirstPath(from, to, [](AtomId)
+                                     { return 0.0; });
+            }
+
+            // A* path; heuristic(atom) estimates the remaining weight to 'to'
+            // and must not overestimate it
+            template <typename Heuristic>
+            WeightedPath<T> aStarPath(const T &from, const T &to, Heuristic &&heuristic) const
+            {
+                return bestFirstPath(from, to, [&](AtomId id)
+                                     { return static_cast<double>(heuristic(atomOrder[id])); });
+            }
+
+            // Minimum spanning forest (Kruskal), bond direction ignored.
+            // Returned bonds are SINGLE and carry their weight.
+            std::vector<MoleculeBond<T>> minimumSpanningForest() const
+            {
+                MoleculeCsr scratch;
+                std::vector<MoleculeBond<T>> forest;
+                for (const auto &edge : csrKruskal(graph(scratch)))
+                {
+                    forest.push_back(MoleculeBond<T>(atomOrder[edge.from], atomOrder[edge.to],
+                                                     BondType::SINGLE, edge.weight));
+                }
+                return forest;
+            }
+
+            // Strongly connected components (Tarjan), in reverse topological order
+            std::vector<std::vector<T>> stronglyConnectedComponents() const
+            {
+                MoleculeCsr scratch;
+                SccResult scc = csrStronglyConnected(graph(scratch));
+                std::vector<std::vector<T>> components(scc.count);
+                for (size_t id = 0; id < atomOrder.size(); id++)
+                {
+                    components[scc.component[id]].push_back(atomOrder[id]);
+                }
+                return components;
+            }
+
+            // Topological order (Kahn). Only molecules built from '->' bonds can
+            // be acyclic; throws if there is a cycle.
+            std::vector<T> topologicalSort() const
+            {
+                MoleculeCsr scratch;
+                auto order = csrTopologicalSort(graph(scratch));
+                if (!order)
+                {
+                    throw std::runtime_error("topologicalSort: molecule has a cycle");
+                }
+                return toAtoms(*order);
+            }
+        };
+
+        // ===== STATIC MOLECULE =====
+        // Read-only molecule backed by constexpr data that the transpiler emits for
+        // 'mol' declarations: a name table, CSR arrays, the bond list and a
+        // hash-and-displace perfect hash over atom names. Name lookups are constexpr
+        // and nothing runs at startup; algorithms copy the arrays into a
+        // MoleculeCsr on first use.
+        struct StaticBond
+        {
+            MoleculeCsr::AtomId from;
+            MoleculeCsr::AtomId to;
+            BondType type;
+            double weight;
+        };
+
+        namespace detail
+        {
+            // FNV-1a with a seed and a final mix. Transpiler::moleculeNameHash
+            // must produce the same values.
+            constexpr uint64_t moleculeNameHash(std::string_view name, uint64_t seed)
+            {
+                uint64_t h = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+                for (char c : name)
+                {
+                    h ^= static_cast<unsigned char>(c);
+                    h *= 1099511628211ull;
+                }
+                h ^= h >> 29;
+                h *= 0xBF58476D1CE4E5B9ull;
+                h ^= h >> 32;
+                return h;
+            }
+
+            // Name-level algorithm wrappers shared by the read-only molecules.
+            // Derived provides atomId(Key) -> optional<AtomId>, atomAt(AtomId)
+            // (convertible to Name), atomCount(), csr() and reverseCsr().
+            template <typename Derived, typename Key, typename Name>
+            class CsrQueries
+            {
+            private:
+                using AtomId = MoleculeCsr::AtomId;
+
+                const Derived &self() const { return static_cast<const Derived &>(*this); }
+
+                std::vector<Name> toNames(const std::vector<AtomId> &order) const
+                {
+                    std::vector<Name> result;
+                    result.reserve(order.size());
+                    for (AtomId id : order)
+                        result.push_back(Name(self().atomAt(id)));
+                    return result;
+                }
+
+                template <typename Estimate>
+                WeightedPath<Name> bestFirstPath(const Key &from, const Key &to, Estimate &&estimate) const
+                {
+                    auto src = self().atomId(from);
+                    auto dst = self().atomId(to);
+                    if (!src || !dst)
+                    {
+                        return WeightedPath<Name>{{}, std::numeric_limits<double>::infinity()};
+                    }
+                    ShortestPaths paths = bestFirstSearch(self().csr(), *src, *dst, estimate);
+                    return WeightedPath<Name>{toNames(paths.pathTo(*dst)), paths.distance[*dst]};
+                }
+
+            public:
+                std::vector<Name> bfs(const Key &start) const
+                {
+                    auto id = self().atomId(start);
+                    return id ? toNames(self().csr().bfs(*id)) : std::vector<Name>();
+                }
+
+                std::vector<Name> dfs(const Key &start) const
+                {
+                    auto id = self().atomId(start);
+                    return id ? toNames(self().csr().dfs(*id)) : std::vector<Name>();
+                }
+
+                bool hasPath(const Key &from, const Key &to) const
+                {
+                    auto src = self().atomId(from);
+                    auto dst = self().atomId(to);
+                    return src && dst && self().csr().hasPath(*src, *dst);
+                }
+
+                bool isConnected() const
+                {
+                    return self().atomCount() == 0 || self().csr().bfs(0).size() == self().atomCount();
+                }
+
+                bool hasCycle() const { return self().csr().hasCycle(); }
+
+                std::vector<Name> parallelBfs(const Key &start, ThreadPool &pool = ThreadPool::global()) const
+                {
+                    auto id = self().atomId(start);
+                    if (!id)
+                        return std::vector<Name>();
+                    return toNames(csrParallelBfs(self().csr(), self().reverseCsr(), *id, pool).levelOrder());
+                }
+
+                std::vector<Name> shortestPath(const Key &from, const Key &to, ThreadPool &pool = ThreadPool::global()) const
+                {
+                    auto src = self().atomId(from);
+                    auto dst = self().atomId(to);
+                    if (!src || !dst)
+                        return std::vector<Name>();
+                    return toNames(csrParallelBfs(self().csr(), self().reverseCsr(), *src, pool).pathTo(*dst));
+                }
+
+                size_t componentCount(ThreadPool &pool = ThreadPool::global()) const
+                {
+                    std::vector<AtomId> labels = csrConnectedComponents(self().csr(), pool);
+                    size_t count = 0;
+                    for (size_t id = 0; id < labels.size(); id++)
+                    {
+                        if (labels[id] == id)
+                            count++;
+                    }
+                    return count;
+                }
+
+                WeightedPath<Name> weightedPath(const Key &from, const Key &to) const
+                {
+                    return bestFirstPath(from, to, [](AtomId)
+                                         { return 0.0; });
+                }
+
+                template <typename Heuristic>
+                WeightedPath<Name> aStarPath(const Key &from, const Key &to, Heuristic &&heuristic) const
+                {
+                    return bestFirstPath(from, to, [&](AtomId id)
+                                         { return static_cast<double>(heuristic(self().atomAt(id))); });
+                }
+
+                std::vector<MoleculeBond<Name>> minimumSpanningForest() const
+                {
+                    std::vector<MoleculeBond<Name>> forest;
+                    for (const auto &edge : csrKruskal(self().csr()))
+                    {
+                        forest.push_back(MoleculeBond<Name>(Name(self().atomAt(edge.from)), Name(self().atomAt(edge.to)),
+                                                            BondType::SINGLE, edge.weight));
+                    }
+                    return forest;
+                }
+
+                std::vector<std::vector<Name>> stronglyConnectedComponents() const
+                {
+                    SccResult scc = csrStronglyConnected(self().csr());
+                    std::vector<std::vector<Name>> components(scc.count);
+                    for (size_t id = 0; id < self().atomCount(); id++)
+                        components[scc.component[id]].push_back(Name(self().atomAt(static_cast<AtomId>(id))));
+                    return components;
+                }
+
+                std::vector<Name> topologicalSort() const
+                {
+                    auto order = csrTopologicalSort(self().csr());
+                    if (!order)
+                    {
+                        throw std::runtime_error("topologicalSort: molecule has a cycle");
+                    }
+                    return toNames(*order);
+                }
+            };
+        } // namespace detail
+
+        // Data provides: atomCount, bondCount, directed, names[], offsets[],
+        // targets[], weights (array or nullptr), bonds[], bucketCount,
+        // displacements[], slotCount, slots[]
+        template <typename Data>
+        class StaticMolecule : public detail::CsrQueries<StaticMolecule<Data>, std::string_view, std::string>
+        {
+        public:
+            using AtomId = MoleculeCsr::AtomId;
+
+        private:
+            static MoleculeCsr buildCsr()
+            {
+                MoleculeCsr g;
+                const size_t edges = Data::offsets[Data::atomCount];
+                g.offsets.assign(Data::offsets, Data::offsets + Data::atomCount + 1);
+                g.targets.assign(Data::targets, Data::targets + edges);
+                const double *weights = Data::weights;
+                if (weights)
+                    g.weights.assign(weights, weights + edges);
+                return g;
+            }
+
+        public:
+            static constexpr size_t atomCount() { return Data::atomCount; }
+            static constexpr size_t bondCount() { return Data::bondCount; }
+            static constexpr bool empty() { return Data::atomCount == 0; }
+
+            // Perfect-hash lookup; unknown names are rejected by the name check
+            static constexpr std::optional<AtomId> atomId(std::string_view name)
+            {
+                const uint64_t bucket = detail::moleculeNameHash(name, 0) % Data::bucketCount;
+                const uint64_t slot = detail::moleculeNameHash(name, Data::displacements[bucket]) % Data::slotCount;
+                const AtomId id = Data::slots[slot];
+                if (id != MoleculeCsr::NO_ATOM && Data::names[id] == name)
+                    return id;
+                return std::nullopt;
+            }
+
+            static constexpr bool hasAtom(std::string_view name)
+            {
+                return atomId(name).has_value();
+            }
+
+            static constexpr std::string_view atomAt(AtomId id)
+            {
+                if (id >= Data::atomCount)
+                {
+                    throw std::out_of_range("StaticMolecule::atomAt: atom ID out of range");
+                }
+                return Data::names[id];
+            }
+
+            static constexpr Span<const AtomId> neighborIds(AtomId id)
+            {
+                return Span<const AtomId>(Data::targets + Data::offsets[id], Data::offsets[id + 1] - Data::offsets[id]);
+            }
+
+            static std::vector<std::string_view> neighbors(std::string_view atom)
+            {
+                std::vector<std::string_view> result;
+                if (auto id = atomId(atom))
+                {
+                    for (AtomId next : neighborIds(*id))
+                        result.push_back(Data::names[next]);
+                }
+                return result;
+            }
+
+            static constexpr bool hasBond(std::string_view from, std::string_view to, BondType type)
+            {
+                auto src = atomId(from);
+                auto dst = atomId(to);
+                if (!src || !dst)
+                    return false;
+                for (const StaticBond &bond : Data::bonds)
+                {
+                    if (bond.from == *src && bond.to == *dst && bond.type == type)
+                        return true;
+                }
+                return false;
+            }
+
+            static constexpr Span<const StaticBond> getBonds() { return Span<const StaticBond>(Data::bonds, Data::bondCount); }
+
+            // CSR built from the constexpr arrays on first use (thread-safe static)
+            static const MoleculeCsr &csr()
+            {
+                static const MoleculeCsr g = buildCsr();
+                return g;
+            }
+
+            static const MoleculeCsr &reverseCsr()
+            {
+                if (!Data::directed)
+                    return csr();
+                static const MoleculeCsr g = csr().transpose();
+                return g;
+            }
+
+            // Mutable copy for code that needs to add atoms or bonds
+            static Molecule<std::string> toMolecule()
+            {
+                Molecule<std::string> mol;
+                for (size_t id = 0; id < Data::atomCount; id++)
+                    mol.addAtom(std::string(Data::names[id]));
+                for (const StaticBond &bond : Data::bonds)
+                    mol.addBond(std::string(Data::names[bond.from]), std::string(Data::names[bond.to]), bond.type, bond.weight);
+                mol.freeze();
+                return mol;
+            }
+        };
+
+        // ===== FROZEN MOLECULE =====
+        // Read-only molecule owning its name table and CSR arrays; what the bulk
+        // loaders (loadEdgeList, loadSnapshot) return. Edges have no bond type:
+        // an undirected graph stores every edge in both directions.
+        template <typename T>
+        class FrozenMolecule : public detail::CsrQueries<FrozenMolecule<T>, T, T>
+        {
+        public:
+            using AtomId = MoleculeCsr::AtomId;
+
+        private:
+            std::vector<T> names;
+            std::unordered_map<T, AtomId> ids;
+            MoleculeCsr forward;
+            MoleculeCsr reverse;
+            bool directed = false;
+
+        public:
+            FrozenMolecule() = default;
+
+            FrozenMolecule(std::vector<T> atomNames, MoleculeCsr csr, bool isDirected)
+                : names(std::move(atomNames)), forward(std::move(csr)), directed(isDirected)
+            {
+                if (forward.atomCount() != names.size())
+                {
+                    throw std::invalid_argument("FrozenMolecule: name table and CSR disagree on atom count");
+                }
+                ids.reserve(names.size());
+                for (size_t id = 0; id < names.size(); id++)
+                {
+                    ids.emplace(names[id], static_cast<AtomId>(id));
+                }
+                if (directed)
+                {
+                    reverse = forward.transpose();
+                }
+            }
+
+            // Snapshot of a Molecule (frozen first if needed)
+            explicit FrozenMolecule(const Molecule<T> &mol)
+            {
+                if (!mol.isFrozen())
+                {
+                    Molecule<T> copy = mol;
+                    copy.freeze();
+                    *this = FrozenMolecule(copy);
+                    return;
+                }
+                std::vector<T> atomNames;
+                atomNames.reserve(mol.atomCount());
+                bool hasArrow = false;
+                for (size_t id = 0; id < mol.atomCount(); id++)
+                    atomNames.push_back(mol.atomAt(static_cast<AtomId>(id)));
+                for (const auto &bond : mol.getBonds())
+                    hasArrow = hasArrow || bond.type == BondType::ARROW;
+                *this = FrozenMolecule(std::move(atomNames), mol.csr(), hasArrow);
+            }
+
+            size_t atomCount() const { return names.size(); }
+            size_t edgeCount() const { return forward.edgeCount(); }
+            bool empty() const { return names.empty(); }
+            bool isDirected() const { return directed; }
+
+            std::optional<AtomId> atomId(const T &atom) const
+            {
+                auto it = ids.find(atom);
+                if (it == ids.end())
+                    return std::nullopt;
+                return it->second;
+            }
+
+            bool hasAtom(const T &atom) const { return ids.find(atom) != ids.end(); }
+            const T &atomAt(AtomId id) const { return names.at(id); }
+            const std::vector<T> &getAtoms() const { return names; }
+
+            Span<const AtomId> neighborIds(AtomId id) const { return forward.neighbors(id); }
+
+            std::vector<T> neighbors(const T &atom) const
+            {
+                std::vector<T> result;
+                if (auto id = atomId(atom))
+                {
+                    for (AtomId next : forward.neighbors(*id))
+                        result.push_back(names[next]);
+                }
+                return result;
+            }
+
+            const MoleculeCsr &csr() const { return forward; }
+            const MoleculeCsr &reverseCsr() const { return directed ? reverse : forward; }
+
+            // Mutable copy: ARROW bonds if directed, otherwise one SINGLE bond per
+            // stored edge pair
+            Molecule<T> toMolecule() const
+            {
+                Molecule<T> mol;
+                for (const auto &name : names)
+                    mol.addAtom(name);
+                for (AtomId u = 0; u < names.size(); u++)
+                {
+                    for (size_t e = forward.offsets[u]; e < forward.offsets[u + 1]; e++)
+                    {
+                        AtomId v = forward.targets[e];
+                        if (directed)
+                            mol.addBond(names[u], names[v], BondType::ARROW, forward.weight(e));
+                        else if (u <= v)
+                            mol.addBond(names[u], names[v], BondType::SINGLE, forward.weight(e));
+                    }
+                }
+                mol.freeze();
+                return mol;
+            }
+        };
+
+        // ===== FILE MAPPING =====
+        // Read-only view of a whole file: mmap on POSIX, a single bulk read
+        // elsewhere. The view stays valid for the lifetime of the object.
+        class MappedFile
+        {
+        private:
+            const char *ptr = nullptr;
+            size_t length = 0;
+#ifdef _WIN32
+            std::vector<char> buffer;
+#endif
+
+            void release()
+            {
+#ifndef _WIN32
+                if (ptr && length > 0)
+                    munmap(const_cast<char *>(ptr), length);
+#endif
+                ptr = nullptr;
+                length = 0;
+            }
+
+        public:
+            MappedFile() = default;
+
+            explicit MappedFile(const std::string &path)
+            {
+#ifdef _WIN32
+                std::ifstream file(path, std::ios::binary | std::ios::ate);
+                if (!file)
+                {
+                    throw std::runtime_error("MappedFile: cannot open " + path);
+                }
+                buffer.resize(static_cast<size_t>(file.tellg()));
+                file.seekg(0);
+                if (!buffer.empty() && !file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())))
+                {
+                    throw std::runtime_error("MappedFile: cannot read " + path);
+                }
+                ptr = buffer.data();
+                length = buffer.size();
+#else
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                {
+                    throw std::runtime_error("MappedFile: cannot open " + path);
+                }
+                struct stat info;
+                if (::fstat(fd, &info) != 0)
+                {
+                    ::close(fd);
+                    throw std::runtime_error("MappedFile: cannot stat " + path);
+                }
+                length = static_cast<size_t>(info.st_size);
+                if (length > 0)
+                {
+                    void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (mapped == MAP_FAILED)
+                    {
+                        ::close(fd);
+                        length = 0;
+                        throw std::runtime_error("MappedFile: cannot map " + path);
+                    }
+                    ::madvise(mapped, length, MADV_SEQUENTIAL);
+                    ptr = static_cast<const char *>(mapped);
+                }
+                ::close(fd); // the mapping keeps the file referenced
+#endif
+            }
+
+            ~MappedFile() { release(); }
+
+            MappedFile(const MappedFile &) = delete;
+            MappedFile &operator=(const MappedFile &) = delete;
+
+            MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+            MappedFile &operator=(MappedFile &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    release();
+#ifdef _WIN32
+                    buffer = std::move(other.buffer);
+#endif
+                    ptr = other.ptr;
+                    length = other.length;
+                    other.ptr = nullptr;
+                    other.length = 0;
+                }
+                return *this;
+            }
+
+            const char *data() const { return ptr; }
+            size_t size() const { return length; }
+            bool empty() const { return length == 0; }
+            std::string_view view() const { return std::string_view(ptr, length); }
+        };
+
+        // ===== FILE I/O =====
+        // readFile() maps a whole file and returns a view of it. lines() walks
+        // a mapping one line at a time without copying. Views handed out by
+        // either stay valid while any FileView or LineRange on the mapping
+        // (or a filter/map over one) is alive.
+        class FileView
+        {
+        private:
+            std::shared_ptr<const MappedFile> file;
+
+        public:
+            FileView() = default;
+
+            explicit FileView(std::shared_ptr<const MappedFile> mapped) : file(std::move(mapped)) {}
+
+            const char *data() const { return file ? file->data() : nullptr; }
+            size_t size() const { return file ? file->size() : 0; }
+            bool empty() const { return size() == 0; }
+            std::string_view view() const { return file ? file->view() : std::string_view(); }
+            operator std::string_view() const { return view(); }
+            std::string str() const { return std::string(view()); }
+
+            const std::shared_ptr<const MappedFile> &mapping() const { return file; }
+        };
+
+        inline FileView readFile(const std::string &path)
+        {
+            return FileView(std::make_shared<const MappedFile>(path));
+        }
+
+        // Lines split on '\n' with a trailing '\r' removed. A final newline
+        // does not produce an extra empty line (same as std::getline). The
+        // newline search is memchr, which the C library implements with SIMD.
+        // Iteration hands pages it has passed back to the kernel every
+        // RELEASE_STRIDE bytes, so resident memory stays flat on huge files;
+        // earlier views remain valid (the pages are read back on access).
+        class LineRange
+        {
+        private:
+            std::shared_ptr<const MappedFile> file;
+
+        public:
+            using is_lazy_range = void;
+            using value_type = std::string_view;
+
+            static constexpr size_t RELEASE_STRIDE = size_t(8) << 20;
+
+            class iterator
+            {
+            private:
+                const char *pos = nullptr;
+                const char *last = nullptr;
+                const char *lineEnd = nullptr;
+                const char *released = nullptr; // Page-aligned: starts at the mapping base
+
+                void scan()
+                {
+                    if (pos == last)
+                        return;
+                    const void *newline = std::memchr(pos, '\n', static_cast<size_t>(last - pos));
+                    lineEnd = newline ? static_cast<const char *>(newline) : last;
+                }
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = std::string_view;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = std::string_view;
+
+                iterator() = default;
+                iterator(const char *first, const char *end) : pos(first), last(end), released(first) { scan(); }
+
+                std::string_view operator*() const
+                {
+                    const char *stop = lineEnd;
+                    if (stop != pos && stop[-1] == '\r')
+                        --stop;
+                    return std::string_view(pos, static_cast<size_t>(stop - pos));
+                }
+
+                iterator &operator++()
+                {
+                    pos = lineEnd == last ? last : lineEnd + 1;
+#ifndef _WIN32
+                    if (static_cast<size_t>(pos - released) >= RELEASE_STRIDE)
+                    {
+                        ::madvise(const_cast<char *>(released), RELEASE_STRIDE, MADV_DONTNEED);
+                        released += RELEASE_STRIDE;
+                    }
+#endif
+                    scan();
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    iterator previous = *this;
+                    ++*this;
+                    return previous;
+                }
+
+                bool operator==(const iterator &other) const { return pos == other.pos; }
+                bool operator!=(const iterator &other) const { return pos != other.pos; }
+            };
+
+            explicit LineRange(std::shared_ptr<const MappedFile> mapped) : file(std::move(mapped)) {}
+
+            iterator begin() const { return iterator(file->data(), file->data() + file->size()); }
+            iterator end() const { return iterator(file->data() + file->size(), file->data() + file->size()); }
+        };
+
+        inline LineRange lines(const std::string &path)
+        {
+            return LineRange(std::make_shared<const MappedFile>(path));
+        }
+
+        inline LineRange lines(const FileView &file)
+        {
+            if (!file.mapping())
+            {
+                throw std::invalid_argument("lines: empty FileView");
+            }
+            return LineRange(file.mapping());
+        }
+
+        // Stream a file through fn(std::string_view) in pieces of at most
+        // chunkSize bytes using one reused buffer. Returns the bytes read.
+        template <typename F>
+        size_t readChunks(const std::string &path, size_t chunkSize, F fn)
+        {
+            if (chunkSize == 0)
+            {
+                throw std::invalid_argument("readChunks: chunk size must be positive");
+            }
+            std::ifstream in(path, std::ios::binary);
+            if (!in)
+            {
+                throw std::runtime_error("readChunks: cannot open " + path);
+            }
+            std::vector<char> buffer(chunkSize);
+            size_t total = 0;
+            while (in)
+            {
+                in.read(buffer.data(), static_cast<std::streamsize>(chunkSize));
+                const auto got = static_cast<size_t>(in.gcount());
+                if (got == 0)
+                    break;
+                fn(std::string_view(buffer.data(), got));
+                total += got;
+            }
+            if (in.bad())
+            {
+                throw std::runtime_error("readChunks: cannot read " + path);
+            }
+            return total;
+        }
+
+        // Binary output collected in a fixed buffer and written in large
+        // blocks. Flushed on close() and by the destructor (which swallows
+        // errors; call close() to see them).
+        class ChunkWriter
+        {
+        private:
+            std::ofstream out;
+            std::string path;
+            std::vector<char> buffer;
+            size_t used = 0;
+            size_t written = 0;
+
+        public:
+            explicit ChunkWriter(const std::string &filePath, size_t bufferSize = 1 << 20)
+                : out(filePath, std::ios::binary | std::ios::trunc), path(filePath), buffer(bufferSize > 0 ? bufferSize : 1)
+            {
+                if (!out)
+                {
+                    throw std::runtime_error("ChunkWriter: cannot open " + path);
+                }
+            }
+
+            ~ChunkWriter()
+            {
+                try
+                {
+                    close();
+                }
+                catch (...)
+                {
+                }
+            }
+
+            ChunkWriter(const ChunkWriter &) = delete;
+            ChunkWriter &operator=(const ChunkWriter &) = delete;
+
+            void write(const void *bytes, size_t count)
+            {
+                const char *src = static_cast<const char *>(bytes);
+                if (count > buffer.size() - used)
+                {
+                    flush();
+                    if (count >= buffer.size())
+                    {
+                        // Larger than the buffer: no point copying it first
+                        out.write(src, static_cast<std::streamsize>(count));
+                        written += count;
+                        return;
+                    }
+                }
+                std::memcpy(buffer.data() + used, src, count);
+                used += count;
+                written += count;
+            }
+
+            void write(std::string_view text) { write(text.data(), text.size()); }
+
+            template <typename T>
+            void writeValue(const T &value)
+            {
+                static_assert(std::is_trivially_copyable<T>::value, "writeValue requires a trivially copyable type");
+                write(&value, sizeof(T));
+            }
+
+            template <typename T>
+            void writeArray(const std::vector<T> &items)
+            {
+                static_assert(std::is_trivially_copyable<T>::value, "writeArray requires a trivially copyable type");
+                write(items.data(), items.size() * sizeof(T));
+            }
+
+            void flush()
+            {
+                if (used > 0)
+                {
+                    out.write(buffer.data(), static_cast<std::streamsize>(used));
+                    used = 0;
+                }
+                out.flush();
+                if (!out)
+                {
+                    throw std::runtime_error("ChunkWriter: cannot write " + path);
+                }
+            }
+
+            void close()
+            {
+                if (!out.is_open())
+                    return;
+                flush();
+                out.close();
+            }
+
+            size_t bytesWritten() const { return written; }
+        };
+
+        inline void writeFile(const std::string &path, std::string_view contents)
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out || !out.write(contents.data(), static_cast<std::streamsize>(contents.size())))
+            {
+                throw std::runtime_error("writeFile: cannot write " + path);
+            }
+        }
+
+        // ===== TEXT SCANNING =====
+        namespace detail
+        {
+            inline unsigned lowestSetBit(uint64_t bits)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+                unsigned index = 0;
+                while (!(bits & 1))
+                {
+                    bits >>= 1;
+                    index++;
+                }
+                return index;
+#endif
+            }
+
+            // First byte in [p, end) equal to any of 'set', or end. Compares 16
+            // bytes per step with SSE2; elsewhere 8 bytes per step inside a
+            // 64-bit word (exact for the lowest match, which is all we use).
+            template <size_t N>
+            const char *scanAny(const char *p, const char *end, const std::array<char, N> &set)
+            {
+#if defined(__SSE2__)
+                __m128i needles[N];
+                for (size_t k = 0; k < N; k++)
+                    needles[k] = _mm_set1_epi8(set[k]);
+                while (end - p >= 16)
+                {
+                    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                    __m128i hit = _mm_cmpeq_epi8(chunk, needles[0]);
+                    for (size_t k = 1; k < N; k++)
+                        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, needles[k]));
+                    const auto mask = static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(hit)));
+                    if (mask != 0)
+                        return p + lowestSetBit(mask);
+                    p += 16;
+                }
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                constexpr uint64_t ones = 0x0101010101010101ull;
+                constexpr uint64_t highs = 0x8080808080808080ull;
+                while (end - p >= 8)
+                {
+                    uint64_t word;
+                    std::memcpy(&word, p, 8);
+                    uint64_t hit = 0;
+                    for (size_t k = 0; k < N; k++)
+                    {
+                        const uint64_t x = word ^ (ones * static_cast<unsigned char>(set[k]));
+                        hit |= (x - ones) & ~x & highs;
+                    }
+                    if (hit != 0)
+                        return p + lowestSetBit(hit) / 8;
+                    p += 8;
+                }
+#endif
+                for (; p < end; p++)
+                {
+                    for (char c : set)
+                    {
+                        if (*p == c)
+                            return p;
+                    }
+                }
+                return end;
+            }
+
+            // masks[k] gets bit i set where p[i] == set[k], for the 64 bytes at p
+            template <size_t N>
+            void classify64(const char *p, const std::array<char, N> &set, uint64_t (&masks)[N])
+            {
+                for (size_t k = 0; k < N; k++)
+                    masks[k] = 0;
+#if defined(__SSE2__)
+                for (int part = 0; part < 4; part++)
+                {
+                    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + part * 16));
+                    for (size_t k = 0; k < N; k++)
+                    {
+                        const __m128i hit = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(set[k]));
+                        masks[k] |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(hit))) << (part * 16);
+                    }
+                }
+#else
+                for (int i = 0; i < 64; i++)
+                {
+                    for (size_t k = 0; k < N; k++)
+                    {
+                        if (p[i] == set[k])
+                            masks[k] |= uint64_t(1) << i;
+                    }
+                }
+#endif
+            }
+
+            // Bit i becomes the XOR of bits 0..i. Over a quote mask that marks
+            // each opening quote and the bytes up to its closing quote.
+            inline uint64_t prefixXor(uint64_t bits)
+            {
+                bits ^= bits << 1;
+                bits ^= bits << 2;
+                bits ^= bits << 4;
+                bits ^= bits << 8;
+                bits ^= bits << 16;
+                bits ^= bits << 32;
+                return bits;
+            }
+
+            // scanAny for a cursor that keeps moving forward through one buffer
+            // (many short hops, e.g. CSV fields): one 64-byte block is
+            // classified at a time and each next() call only reads the mask.
+            template <size_t N>
+            class BlockScanner
+            {
+            private:
+                const char *end;
+                std::array<char, N> set;
+                const char *blockStart = nullptr;
+                const char *blockEnd = nullptr;
+                uint64_t mask = 0;
+
+                void load(const char *p)
+                {
+                    blockStart = p;
+                    blockEnd = p + 64;
+                    mask = 0;
+#if defined(__SSE2__)
+                    __m128i needles[N];
+                    for (size_t k = 0; k < N; k++)
+                        needles[k] = _mm_set1_epi8(set[k]);
+                    for (int part = 0; part < 4; part++)
+                    {
+                        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + part * 16));
+                        __m128i hit = _mm_cmpeq_epi8(chunk, needles[0]);
+                        for (size_t k = 1; k < N; k++)
+                            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, needles[k]));
+                        mask |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(hit))) << (part * 16);
+                    }
+#else
+                    for (int i = 0; i < 64; i++)
+                    {
+                        for (char c : set)
+                        {
+                            if (p[i] == c)
+                                mask |= uint64_t(1) << i;
+                        }
+                    }
+#endif
+                }
+
+            public:
+                BlockScanner(const char *last, const std::array<char, N> &stops) : end(last), set(stops) {}
+
+                // First byte at or after p that is in the set, or end
+                const char *next(const char *p)
+                {
+                    for (;;)
+                    {
+                        if (p >= blockStart && p < blockEnd)
+                        {
+                            const uint64_t rest = mask >> (p - blockStart);
+                            if (rest != 0)
+                                return p + lowestSetBit(rest);
+                            p = blockEnd;
+                        }
+                        if (end - p < 64)
+                            return scanAny(p, end, set);
+                        load(p);
+                    }
+                }
+            };
+
+            inline std::string_view trimSpaces(std::string_view text)
+            {
+                while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+                    text.remove_prefix(1);
+                while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+                    text.remove_suffix(1);
+                return text;
+            }
+        } // namespace detail
+
+        // Whole-field number parse with std::from_chars (surrounding spaces and
+        // a leading '+' allowed). Throws std::invalid_argument otherwise.
+        template <typename T>
+        T parseNumber(std::string_view text)
+        {
+            static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                          "parseNumber requires a numeric type");
+            std::string_view digits = detail::trimSpaces(text);
+            if (!digits.empty() && digits.front() == '+')
+                digits.remove_prefix(1);
+            T value{};
+            const char *last = digits.data() + digits.size();
+            auto [ptr, ec] = std::from_chars(digits.data(), last, value);
+            if (digits.empty() || ec != std::errc() || ptr != last)
+            {
+                throw std::invalid_argument("parseNumber: not a number: '" + std::string(text) + "'");
+            }
+            return value;
+        }
+
+        // ===== CSV =====
+        // RFC 4180 records: fields separated by the delimiter, optionally
+        // quoted; inside quotes the delimiter and line breaks are literal and
+        // "" stands for one quote. Records end at \n or \r\n. A quote inside an
+        // unquoted field is kept as is.
+        //
+        // Field views point into the input, except quoted fields containing ""
+        // which are unescaped into the row's own buffer. Either way they are
+        // valid until the row is reused or the input goes away.
+        struct CsvOptions
+        {
+            char delimiter = ',';
+            char quote = '"';
+        };
+
+        class CsvRow
+        {
+        private:
+            std::vector<std::string_view> fields;
+            std::string unescaped;
+            size_t line = 0;
+
+            friend class CsvParser;
+
+            // Copied/moved fields that pointed into other.unescaped must point
+            // into ours instead
+            void rebase(const char *oldBase, size_t oldSize)
+            {
+                for (auto &field : fields)
+                {
+                    if (!field.empty() && field.data() >= oldBase && field.data() < oldBase + oldSize)
+                        field = std::string_view(unescaped.data() + (field.data() - oldBase), field.size());
+                }
+            }
+
+        public:
+            CsvRow() = default;
+
+            CsvRow(const CsvRow &other) : fields(other.fields), unescaped(other.unescaped), line(other.line)
+            {
+                rebase(other.unescaped.data(), other.unescaped.size());
+            }
+
+            CsvRow(CsvRow &&other) noexcept { *this = std::move(other); }
+
+            CsvRow &operator=(const CsvRow &other)
+            {
+                if (this != &other)
+                {
+                    fields = other.fields;
+                    unescaped = other.unescaped;
+                    line = other.line;
+                    rebase(other.unescaped.data(), other.unescaped.size());
+                }
+                return *this;
+            }
+
+            CsvRow &operator=(CsvRow &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    const char *oldBase = other.unescaped.data();
+                    const size_t oldSize = other.unescaped.size();
+                    fields = std::move(other.fields);
+                    unescaped = std::move(other.unescaped);
+                    line = other.line;
+                    rebase(oldBase, oldSize);
+                }
+                return *this;
+            }
+
+            size_t size() const { return fields.size(); }
+            bool empty() const { return fields.empty(); }
+
+            // 1-based line of the record's first character
+            size_t lineNumber() const { return line; }
+
+            std::string_view operator[](size_t index) const { return fields[index]; }
+
+            std::string_view at(size_t index) const
+            {
+                if (index >= fields.size())
+                {
+                    throw std::out_of_range("CsvRow: column " + std::to_string(index) + " out of range on line " +
+                                            std::to_string(line));
+                }
+                return fields[index];
+            }
+
+            template <typename T>
+            T as(size_t index) const
+            {
+                try
+                {
+                    return parseNumber<T>(at(index));
+                }
+                catch (const std::invalid_argument &)
+                {
+                    throw std::invalid_argument("CsvRow: column " + std::to_string(index) + " on line " +
+                                                std::to_string(line) + " is not a number: '" +
+                                                std::string(fields[index]) + "'");
+                }
+            }
+
+            int64_t asInt(size_t index) const { return as<int64_t>(index); }
+            double asDouble(size_t index) const { return as<double>(index); }
+            std::string asString(size_t index) const { return std::string(at(index)); }
+
+            auto begin() const { return fields.begin(); }
+            auto end() const { return fields.end(); }
+        };
+
+        // Pull parser over a complete CSV text (a readFile() view, a string...)
+        class CsvParser
         {
-            SINGLE,       // - undirected edge
-            DOUBLE,       // = strong connection
-            ARROW,        // -> directed edge
-            BIDIRECTIONAL // <-> bidirectional edge
+        private:
+            std::string_view text;
+            CsvOptions options;
+            size_t pos = 0;
+            size_t line = 1;
+            detail::BlockScanner<4> scanner;
+            std::vector<size_t> escapedFields; // Quoted fields containing ""
+
+            [[noreturn]] void fail(const std::string &message, size_t atLine) const
+            {
+                throw std::runtime_error("csv: " + message + " on line " + std::to_string(atLine));
+            }
+
+        public:
+            explicit CsvParser(std::string_view input, CsvOptions opts = {})
+                : text(input), options(opts),
+                  scanner(input.data() + input.size(), {opts.delimiter, opts.quote, '\n', '\r'}) {}
+
+            // Parse the next record into row (reusing its storage); false once
+            // the input is exhausted
+            bool next(CsvRow &row)
+            {
+                if (pos >= text.size())
+                    return false;
+
+                const char *base = text.data();
+                const char *p = base + pos;
+                const char *end = base + text.size();
+                const char delimiter = options.delimiter;
+                const char quote = options.quote;
+                const size_t recordLine = line;
+                size_t extraLines = 0;
+                size_t escapedBytes = 0;
+
+                row.line = recordLine;
+                row.fields.clear();
+                escapedFields.clear();
+                for (;;)
+                {
+                    if (p < end && *p == quote)
+                    {
+                        const char *start = ++p;
+                        bool escaped = false;
+                        for (;;)
+                        {
+                            const auto *close = static_cast<const char *>(std::memchr(p, quote, static_cast<size_t>(end - p)));
+                            if (!close)
+                                fail("unterminated quoted field", recordLine + extraLines);
+                            extraLines += static_cast<size_t>(std::count(p, close, '\n'));
+                            if (close + 1 < end && close[1] == quote)
+                            {
+                                escaped = true;
+                                p = close + 2;
+                                continue;
+                            }
+                            if (escaped)
+                            {
+                                escapedFields.push_back(row.fields.size());
+                                escapedBytes += static_cast<size_t>(close - start);
+                            }
+                            row.fields.push_back(std::string_view(start, static_cast<size_t>(close - start)));
+                            p = close + 1;
+                            break;
+                        }
+                        if (p < end && *p != delimiter && *p != '\n' && *p != '\r')
+                            fail("unexpected character after closing quote", recordLine + extraLines);
+                    }
+                    else
+                    {
+                        const char *stop = scanner.next(p);
+                        while (stop < end && *stop == quote)
+                            stop = scanner.next(stop + 1);
+                        row.fields.push_back(std::string_view(p, static_cast<size_t>(stop - p)));
+                        p = stop;
+                    }
+
+                    if (p < end && *p == delimiter)
+                    {
+                        ++p;
+                        continue;
+                    }
+                    if (p < end && *p == '\r')
+                        ++p;
+                    if (p < end && *p == '\n')
+                        ++p;
+                    break;
+                }
+                pos = static_cast<size_t>(p - base);
+                line = recordLine + extraLines + 1;
+
+                // Reserve first so views into 'unescaped' stay put while filling
+                row.unescaped.clear();
+                if (!escapedFields.empty())
+                {
+                    row.unescaped.reserve(escapedBytes);
+                    for (size_t index : escapedFields)
+                    {
+                        const std::string_view raw = row.fields[index];
+                        const size_t offset = row.unescaped.size();
+                        for (size_t i = 0; i < raw.size(); i++)
+                        {
+                            row.unescaped.push_back(raw[i]);
+                            if (raw[i] == quote)
+                                i++; // Second quote of ""
+                        }
+                        row.fields[index] = std::string_view(row.unescaped.data() + offset, row.unescaped.size() - offset);
+                    }
+                }
+                return true;
+            }
+
+            // Byte offset of the next record
+            size_t offset() const { return pos; }
+        };
+
+        // Parse one line (e.g. from lines()) as a record. Quoted fields cannot
+        // span lines here; use CsvParser or csvRows() on the whole text for that.
+        inline void parseCsvLine(std::string_view line, CsvRow &row, CsvOptions options = {})
+        {
+            CsvParser parser(line, options);
+            if (!parser.next(row))
+                row = CsvRow();
+        }
+
+        // Lazy range of records over a mapped file. Single pass: each
+        // iterator step reuses one CsvRow, so copy a row to keep it.
+        class CsvRange
+        {
+        private:
+            struct Cursor
+            {
+                CsvParser parser;
+                CsvRow row;
+
+                Cursor(std::string_view text, CsvOptions options) : parser(text, options) {}
+            };
+
+            FileView file;
+            CsvOptions options;
+
+        public:
+            using is_lazy_range = void;
+            using value_type = CsvRow;
+
+            class iterator
+            {
+            private:
+                std::shared_ptr<Cursor> cursor; // null at end
+
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = CsvRow;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const CsvRow *;
+                using reference = const CsvRow &;
+
+                iterator() = default;
+                explicit iterator(std::shared_ptr<Cursor> c) : cursor(std::move(c)) {}
+
+                const CsvRow &operator*() const { return cursor->row; }
+                const CsvRow *operator->() const { return &cursor->row; }
+
+                iterator &operator++()
+                {
+                    if (!cursor->parser.next(cursor->row))
+                        cursor.reset();
+                    return *this;
+                }
+
+                bool operator==(const iterator &other) const { return cursor == other.cursor; }
+                bool operator!=(const iterator &other) const { return cursor != other.cursor; }
+            };
+
+            CsvRange(FileView source, CsvOptions opts) : file(std::move(source)), options(opts) {}
+
+            iterator begin() const
+            {
+                auto cursor = std::make_shared<Cursor>(file.view(), options);
+                if (!cursor->parser.next(cursor->row))
+                    return iterator();
+                return iterator(std::move(cursor));
+            }
+
+            iterator end() const { return iterator(); }
+        };
+
+        inline CsvRange csvRows(const std::string &path, CsvOptions options = {})
+        {
+            return CsvRange(readFile(path), options);
+        }
+
+        inline CsvRange csvRows(const FileView &file, CsvOptions options = {})
+        {
+            return CsvRange(file, options);
+        }
+
+        // ===== JSON =====
+        // On-demand reader. A JsonValue is just a position in the text:
+        // nothing is decoded until a getter asks for it, and values on the way
+        // to the one requested are skipped with a SIMD scan for quotes and
+        // brackets. Skipped values are not validated, so malformed JSON is only
+        // reported when the bad part is actually read.
+        enum class JsonType
+        {
+            NULL_VALUE,
+            BOOLEAN,
+            NUMBER,
+            STRING,
+            ARRAY,
+            OBJECT
         };
 
-        template <typename T>
-        struct MoleculeBond
-        {
-            T from;
-            T to;
-            BondType type;
+        namespace detail
+        {
+            [[noreturn]] inline void jsonError(const std::string &message, size_t offset)
+            {
+                throw std::runtime_error("json: " + message + " at offset " + std::to_string(offset));
+            }
+
+            inline size_t jsonSkipSpace(std::string_view text, size_t pos)
+            {
+                while (pos < text.size() &&
+                       (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t'))
+                    pos++;
+                return pos;
+            }
+
+            // pos at the opening quote; returns the offset after the closing one
+            inline size_t jsonSkipString(std::string_view text, size_t pos)
+            {
+                static constexpr std::array<char, 2> stops{'"', '\\'};
+                const char *base = text.data();
+                const char *end = base + text.size();
+                const char *p = base + pos + 1;
+                for (;;)
+                {
+                    p = scanAny(p, end, stops);
+                    if (p == end)
+                        jsonError("unterminated string", pos);
+                    if (*p == '"')
+                        return static_cast<size_t>(p - base) + 1;
+                    p += 2; // Escape: skip the escaped character
+                    if (p > end)
+                        jsonError("unterminated string", pos);
+                }
+            }
+
+            inline size_t jsonSkipNumber(std::string_view text, size_t pos)
+            {
+                while (pos < text.size())
+                {
+                    const char c = text[pos];
+                    if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+                        pos++;
+                    else
+                        break;
+                }
+                return pos;
+            }
+
+            // pos at '{' or '['; returns the offset after the matching close.
+            // Works on 64-byte blocks: one compare per structural character
+            // gives bit masks, a prefix XOR over the quote mask marks string
+            // interiors, and only brackets outside strings are visited. Blocks
+            // containing a backslash (escapes) are walked byte by byte.
+            inline size_t jsonSkipContainer(std::string_view text, size_t pos)
+            {
+                static constexpr std::array<char, 6> stops{'"', '\\', '{', '[', '}', ']'};
+                const char *base = text.data();
+                const char *end = base + text.size();
+                size_t depth = 1;
+                bool inString = false;
+
+                // Returns true when the container closes at q
+                auto step = [&](const char *&q)
+                {
+                    const char c = *q;
+                    if (inString)
+                    {
+                        if (c == '\\')
+                        {
+                            if (end - q < 2)
+                                jsonError("unterminated string", static_cast<size_t>(q - base));
+                            q += 2;
+                            return false;
+                        }
+                        inString = c != '"';
+                    }
+                    else if (c == '"')
+                    {
+                        inString = true;
+                    }
+                    else if (c == '{' || c == '[')
+                    {
+                        depth++;
+                    }
+                    else if ((c == '}' || c == ']') && --depth == 0)
+                    {
+                        return true;
+                    }
+                    q++;
+                    return false;
+                };
+
+                const char *p = base + pos + 1;
+                while (end - p >= 64)
+                {
+                    uint64_t masks[6];
+                    classify64(p, stops, masks);
+                    if (masks[1] != 0)
+                    {
+                        const char *blockEnd = p + 64;
+                        while (p < blockEnd)
+                        {
+                            if (step(p))
+                                return static_cast<size_t>(p - base) + 1;
+                        }
+                        continue;
+                    }
+                    const uint64_t inside = prefixXor(masks[0]) ^ (inString ? ~uint64_t(0) : 0);
+                    inString = (inside >> 63) != 0;
+                    const uint64_t opens = (masks[2] | masks[3]) & ~inside;
+                    uint64_t brackets = opens | ((masks[4] | masks[5]) & ~inside);
+                    while (brackets != 0)
+                    {
+                        const unsigned bit = lowestSetBit(brackets);
+                        if ((opens >> bit) & 1)
+                            depth++;
+                        else if (--depth == 0)
+                            return static_cast<size_t>(p - base) + bit + 1;
+                        brackets &= brackets - 1;
+                    }
+                    p += 64;
+                }
+                while (p < end)
+                {
+                    if (step(p))
+                        return static_cast<size_t>(p - base) + 1;
+                }
+                jsonError("unterminated container", pos);
+            }
+
+            // pos at the first character of a value; returns the offset just
+            // past it
+            inline size_t jsonSkipValue(std::string_view text, size_t pos)
+            {
+                if (pos >= text.size())
+                    jsonError("expected a value", pos);
+                switch (text[pos])
+                {
+                case '"':
+                    return jsonSkipString(text, pos);
+                case '{':
+                case '[':
+                    return jsonSkipContainer(text, pos);
+                case 't':
+                    if (text.substr(pos, 4) != "true")
+                        jsonError("invalid literal", pos);
+                    return pos + 4;
+                case 'f':
+                    if (text.substr(pos, 5) != "false")
+                        jsonError("invalid literal", pos);
+                    return pos + 5;
+                case 'n':
+                    if (text.substr(pos, 4) != "null")
+                        jsonError("invalid literal", pos);
+                    return pos + 4;
+                default:
+                {
+                    const size_t end = jsonSkipNumber(text, pos);
+                    if (end == pos)
+                        jsonError(std::string("unexpected character '") + text[pos] + "'", pos);
+                    return end;
+                }
+                }
+            }
+
+            inline void appendUtf8(std::string &out, uint32_t code)
+            {
+                if (code < 0x80)
+                {
+                    out.push_back(static_cast<char>(code));
+                }
+                else if (code < 0x800)
+                {
+                    out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+                else if (code < 0x10000)
+                {
+                    out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                    out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+            }
+
+            // Decode the body of a string (between the quotes); 'offset' is
+            // only used in error messages
+            inline std::string jsonUnescape(std::string_view raw, size_t offset)
+            {
+                std::string out;
+                out.reserve(raw.size());
+                auto hex4 = [&](size_t at)
+                {
+                    uint32_t code = 0;
+                    if (at + 4 > raw.size() || std::from_chars(raw.data() + at, raw.data() + at + 4, code, 16).ptr != raw.data() + at + 4)
+                        jsonError("invalid \\u escape", offset + at);
+                    return code;
+                };
+                for (size_t i = 0; i < raw.size(); i++)
+                {
+                    if (raw[i] != '\\')
+                    {
+                        out.push_back(raw[i]);
+                        continue;
+                    }
+                    if (++i >= raw.size())
+                        jsonError("invalid escape", offset + i);
+                    switch (raw[i])
+                    {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        out.push_back(raw[i]);
+                        break;
+                    case 'b':
+                        out.push_back('\b');
+                        break;
+                    case 'f':
+                        out.push_back('\f');
+                        break;
+                    case 'n':
+                        out.push_back('\n');
+                        break;
+                    case 'r':
+                        out.push_back('\r');
+                        break;
+                    case 't':
+                        out.push_back('\t');
+                        break;
+                    case 'u':
+                    {
+                        uint32_t code = hex4(i + 1);
+                        i += 4;
+                        // Surrogate pair: \uD83D\uDE00 is one code point
+                        if (code >= 0xD800 && code < 0xDC00 && i + 6 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u')
+                        {
+                            const uint32_t low = hex4(i + 3);
+                            if (low >= 0xDC00 && low < 0xE000)
+                            {
+                                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                                i += 6;
+                            }
+                        }
+                        appendUtf8(out, code);
+                        break;
+                    }
+                    default:
+                        jsonError("invalid escape", offset + i);
+                    }
+                }
+                return out;
+            }
+        } // namespace detail
+
+        class JsonValue
+        {
+        private:
+            std::string_view text; // Whole document
+            size_t pos = 0;        // First character of this value
+
+            void expect(JsonType wanted, const char *what) const
+            {
+                if (type() != wanted)
+                    detail::jsonError(std::string("expected ") + what, pos);
+            }
+
+            // Calls fn(keyRaw, value) for each field until fn returns false
+            template <typename F>
+            void eachField(F fn) const
+            {
+                expect(JsonType::OBJECT, "an object");
+                size_t p = detail::jsonSkipSpace(text, pos + 1);
+                if (p < text.size() && text[p] == '}')
+                    return;
+                for (;;)
+                {
+                    if (p >= text.size() || text[p] != '"')
+                        detail::jsonError("expected a field name", p);
+                    const size_t keyEnd = detail::jsonSkipString(text, p);
+                    const std::string_view key = text.substr(p + 1, keyEnd - p - 2);
+                    p = detail::jsonSkipSpace(text, keyEnd);
+                    if (p >= text.size() || text[p] != ':')
+                        detail::jsonError("expected ':'", p);
+                    p = detail::jsonSkipSpace(text, p + 1);
+                    const JsonValue value(text, p);
+                    if (!fn(key, value))
+                        return;
+                    p = detail::jsonSkipSpace(text, detail::jsonSkipValue(text, p));
+                    if (p < text.size() && text[p] == ',')
+                    {
+                        p = detail::jsonSkipSpace(text, p + 1);
+                        continue;
+                    }
+                    if (p < text.size() && text[p] == '}')
+                        return;
+                    detail::jsonError("expected ',' or '}'", p);
+                }
+            }
+
+            // Offset of the first element or of the closing ']'
+            size_t firstElement() const
+            {
+                expect(JsonType::ARRAY, "an array");
+                const size_t p = detail::jsonSkipSpace(text, pos + 1);
+                if (p >= text.size())
+                    detail::jsonError("unterminated array", pos);
+                return p;
+            }
+
+            // From an element at p to the next element or the closing ']'
+            static size_t nextElement(std::string_view text, size_t p)
+            {
+                p = detail::jsonSkipSpace(text, detail::jsonSkipValue(text, p));
+                if (p < text.size() && text[p] == ',')
+                    return detail::jsonSkipSpace(text, p + 1);
+                if (p < text.size() && text[p] == ']')
+                    return p;
+                detail::jsonError("expected ',' or ']'", p);
+            }
+
+        public:
+            JsonValue() = default;
+            JsonValue(std::string_view document, size_t offset) : text(document), pos(offset) {}
+
+            JsonType type() const
+            {
+                if (pos >= text.size())
+                    detail::jsonError("expected a value", pos);
+                switch (text[pos])
+                {
+                case '{':
+                    return JsonType::OBJECT;
+                case '[':
+                    return JsonType::ARRAY;
+                case '"':
+                    return JsonType::STRING;
+                case 't':
+                case 'f':
+                    return JsonType::BOOLEAN;
+                case 'n':
+                    return JsonType::NULL_VALUE;
+                default:
+                    return JsonType::NUMBER;
+                }
+            }
+
+            bool isNull() const { return type() == JsonType::NULL_VALUE; }
+            bool isObject() const { return type() == JsonType::OBJECT; }
+            bool isArray() const { return type() == JsonType::ARRAY; }
+
+            // Source text of the value, e.g. to hand a sub-document elsewhere
+            std::string_view raw() const { return text.substr(pos, detail::jsonSkipValue(text, pos) - pos); }
+            size_t offset() const { return pos; }
+
+            bool getBool() const
+            {
+                expect(JsonType::BOOLEAN, "a boolean");
+                detail::jsonSkipValue(text, pos); // Validates the literal
+                return text[pos] == 't';
+            }
+
+            template <typename T>
+            T getNumber() const
+            {
+                expect(JsonType::NUMBER, "a number");
+                const size_t end = detail::jsonSkipNumber(text, pos);
+                T value{};
+                auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + end, value);
+                if (ec != std::errc() || ptr != text.data() + end)
+                    detail::jsonError(std::is_integral<T>::value ? "expected an integer" : "invalid number", pos);
+                return value;
+            }
+
+            int64_t getInt() const { return getNumber<int64_t>(); }
+            double getDouble() const { return getNumber<double>(); }
+
+            // String contents with escapes left as written (no allocation)
+            std::string_view getRawString() const
+            {
+                expect(JsonType::STRING, "a string");
+                const size_t end = detail::jsonSkipString(text, pos);
+                return text.substr(pos + 1, end - pos - 2);
+            }
+
+            std::string getString() const
+            {
+                const std::string_view rawText = getRawString();
+                if (rawText.find('\\') == std::string_view::npos)
+                    return std::string(rawText);
+                return detail::jsonUnescape(rawText, pos + 1);
+            }
+
+            std::optional<JsonValue> find(std::string_view key) const
+            {
+                std::optional<JsonValue> found;
+                eachField([&](std::string_view name, const JsonValue &value)
+                          {
+                    const bool match = name.find('\\') == std::string_view::npos
+                                           ? name == key
+                                           : detail::jsonUnescape(name, value.pos) == key;
+                    if (match)
+                        found = value;
+                    return !match; });
+                return found;
+            }
+
+            bool contains(std::string_view key) const { return find(key).has_value(); }
+
+            JsonValue operator[](std::string_view key) const
+            {
+                auto found = find(key);
+                if (!found)
+                {
+                    throw std::out_of_range("json: no field '" + std::string(key) + "' in object at offset " +
+                                            std::to_string(pos));
+                }
+                return *found;
+            }
+
+            JsonValue operator[](size_t index) const
+            {
+                size_t p = firstElement();
+                for (size_t i = 0; text[p] != ']'; i++)
+                {
+                    if (i == index)
+                        return JsonValue(text, p);
+                    p = nextElement(text, p);
+                }
+                throw std::out_of_range("json: index " + std::to_string(index) + " out of range in array at offset " +
+                                        std::to_string(pos));
+            }
+
+            // Elements of an array or fields of an object
+            size_t size() const
+            {
+                size_t count = 0;
+                if (type() == JsonType::OBJECT)
+                {
+                    eachField([&](std::string_view, const JsonValue &)
+                              { count++; return true; });
+                    return count;
+                }
+                for (size_t p = firstElement(); text[p] != ']'; p = nextElement(text, p))
+                    count++;
+                return count;
+            }
+
+            // Array elements, in order. end() is a sentinel that any iterator
+            // resting on the closing ']' compares equal to, so iterating never
+            // has to find the end of the array up front.
+            class iterator
+            {
+            private:
+                static constexpr size_t AT_END = std::numeric_limits<size_t>::max();
+
+                std::string_view text;
+                size_t p = AT_END;
+
+                bool atEnd() const { return p == AT_END || text[p] == ']'; }
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = JsonValue;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = JsonValue;
+
+                iterator() = default;
+                iterator(std::string_view document, size_t offset) : text(document), p(offset) {}
+
+                JsonValue operator*() const { return JsonValue(text, p); }
 
-            MoleculeBond(const T &f, const T &t, BondType bt)
-                : from(f), to(t), type(bt) {}
+                iterator &operator++()
+                {
+                    p = nextElement(text, p);
+                    return *this;
+                }
 
-            // Copy constructor
-            MoleculeBond(const MoleculeBond &) = default;
-            // Move constructor
-            MoleculeBond(MoleculeBond &&) noexcept = default;
-            // Copy assignment
-            MoleculeBond &operator=(const MoleculeBond &) = default;
-            // Move assignment
-            MoleculeBond &operator=(MoleculeBond &&) noexcept = default;
+                bool operator==(const iterator &other) const
+                {
+                    const bool done = atEnd();
+                    return done == other.atEnd() && (done || p == other.p);
+                }
+                bool operator!=(const iterator &other) const { return !(*this == other); }
+            };
+
+            iterator begin() const { return iterator(text, firstElement()); }
+            iterator end() const { return iterator(); }
+
+            // Object fields as (decoded name, value) pairs
+            std::vector<std::pair<std::string, JsonValue>> fields() const
+            {
+                std::vector<std::pair<std::string, JsonValue>> result;
+                eachField([&](std::string_view name, const JsonValue &value)
+                          {
+                    result.emplace_back(name.find('\\') == std::string_view::npos ? std::string(name)
+                                                                                  : detail::jsonUnescape(name, value.pos),
+                                        value);
+                    return true; });
+                return result;
+            }
         };
 
-        template <typename T>
-        class Molecule
+        // Owns (or maps) the text that its JsonValues point into
+        class JsonDocument
         {
         private:
-            std::unordered_map<T, std::vector<T>> adjacency;
-            std::vector<MoleculeBond<T>> bonds;
-            std::unordered_set<T> atoms;
+            std::shared_ptr<const std::string> owned;
+            FileView file;
+            std::string_view text;
 
         public:
-            // Default constructor
-            Molecule() = default;
+            explicit JsonDocument(std::string json)
+                : owned(std::make_shared<const std::string>(std::move(json))), text(*owned) {}
 
-            // Copy constructor
-            Molecule(const Molecule &) = default;
+            explicit JsonDocument(FileView mapped) : file(std::move(mapped)), text(file.view()) {}
 
-            // Move constructor
-            Molecule(Molecule &&) noexcept = default;
+            JsonValue root() const
+            {
+                const size_t start = detail::jsonSkipSpace(text, 0);
+                if (start >= text.size())
+                    detail::jsonError("empty document", start);
+                return JsonValue(text, start);
+            }
 
-            // Copy assignment
-            Molecule &operator=(const Molecule &) = default;
+            std::string_view view() const { return text; }
+        };
 
-            // Move assignment
-            Molecule &operator=(Molecule &&) noexcept = default;
+        inline JsonDocument parseJson(std::string json) { return JsonDocument(std::move(json)); }
 
-            // Destructor
-            ~Molecule() = default;
+        inline JsonDocument readJson(const std::string &path) { return JsonDocument(readFile(path)); }
 
-            // Add atom/node (with validation)
-            void addAtom(const T &atom)
+        // Root value of text owned by the caller, e.g. one line of NDJSON from
+        // lines(): lines("events.ndjson") @ (l => jsonView(l)["id"].getInt())
+        inline JsonValue jsonView(std::string_view text)
+        {
+            const size_t start = detail::jsonSkipSpace(text, 0);
+            if (start >= text.size())
+                detail::jsonError("empty document", start);
+            return JsonValue(text, start);
+        }
+
+        // ===== GRAPH LOADING =====
+        // Bulk construction of FrozenMolecule from edge-list files and binary
+        // snapshots, bypassing per-bond addBond calls.
+        //
+        // Edge list format: one edge per line, "from to [weight]", separated by
+        // any mix of spaces, tabs, commas or semicolons. Blank lines and lines
+        // starting with '#' or '%' are skipped. Duplicate lines give parallel
+        // edges. T is std::string (names are taken verbatim) or an integer type
+        // (names are parsed as decimal numbers).
+        struct EdgeListOptions
+        {
+            bool directed = false; // false: each line is stored in both directions
+            bool header = false;   // skip the first line
+        };
+
+        namespace detail
+        {
+            template <typename T>
+            using EdgeListKey = std::conditional_t<std::is_integral<T>::value, T, std::string_view>;
+
+            inline bool isEdgeListDelimiter(char c)
             {
-                if (atoms.find(atom) != atoms.end())
-                {
-                    return; // Already exists, silently ignore
-                }
+                return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+            }
 
-                atoms.insert(atom);
-                if (adjacency.find(atom) == adjacency.end())
-                {
-                    adjacency[atom] = std::vector<T>();
-                }
+            inline uint64_t edgeListHash(std::string_view key) { return moleculeNameHash(key, 0); }
+
+            template <typename Int, typename = std::enable_if_t<std::is_integral<Int>::value>>
+            uint64_t edgeListHash(Int key)
+            {
+                uint64_t h = static_cast<uint64_t>(key) + 0x9E3779B97F4A7C15ull;
+                h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+                h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+                return h ^ (h >> 31);
             }
 
-            // Add bond/edge (with validation)
-            void addBond(const T &from, const T &to, BondType type)
+            // Open-addressing name -> ID table for the loaders. Slots hold the ID
+            // and the upper hash bits, so most probes never touch the key array.
+            template <typename Key>
+            class EdgeListInterner
             {
-                // Ensure atoms exist
-                addAtom(from);
-                addAtom(to);
+            private:
+                using AtomId = MoleculeCsr::AtomId;
+                struct Slot
+                {
+                    AtomId id;
+                    uint32_t tag;
+                };
 
-                // Check for duplicate bond (same from, to, type)
-                for (const auto &bond : bonds)
+                std::vector<Slot> slots;
+                std::vector<Key> keys;
+                size_t mask = 0;
+
+                void grow()
                 {
-                    if (bond.from == from && bond.to == to && bond.type == type)
+                    std::vector<Slot> old = std::move(slots);
+                    slots.assign(old.size() * 2, Slot{MoleculeCsr::NO_ATOM, 0});
+                    mask = slots.size() - 1;
+                    for (const Slot &slot : old)
                     {
-                        return; // Duplicate detected, ignore
+                        if (slot.id == MoleculeCsr::NO_ATOM)
+                            continue;
+                        size_t i = edgeListHash(keys[slot.id]) & mask;
+                        while (slots[i].id != MoleculeCsr::NO_ATOM)
+                            i = (i + 1) & mask;
+                        slots[i] = slot;
                     }
                 }
 
-                bonds.push_back(MoleculeBond<T>(from, to, type));
-
-                // Add to adjacency list based on bond type
-                adjacency[from].push_back(to);
-                if (type == BondType::SINGLE || type == BondType::BIDIRECTIONAL)
+            public:
+                explicit EdgeListInterner(size_t expected = 16)
                 {
-                    // Undirected or bidirectional: add reverse edge
-                    adjacency[to].push_back(from);
+                    size_t capacity = 16;
+                    while (capacity < expected * 2)
+                        capacity *= 2;
+                    slots.assign(capacity, Slot{MoleculeCsr::NO_ATOM, 0});
+                    mask = capacity - 1;
                 }
-                else if (type == BondType::DOUBLE)
+
+                AtomId intern(const Key &key)
                 {
-                    // Double bond treated as bidirectional
-                    adjacency[to].push_back(from);
+                    const uint64_t h = edgeListHash(key);
+                    const uint32_t tag = static_cast<uint32_t>(h >> 32);
+                    for (size_t i = h & mask;; i = (i + 1) & mask)
+                    {
+                        Slot &slot = slots[i];
+                        if (slot.id == MoleculeCsr::NO_ATOM)
+                        {
+                            if (keys.size() == MoleculeCsr::NO_ATOM)
+                            {
+                                throw std::length_error("loadEdgeList: too many atoms");
+                            }
+                            slot = Slot{static_cast<AtomId>(keys.size()), tag};
+                            keys.push_back(key);
+                            if (keys.size() * 2 > slots.size())
+                                grow();
+                            return static_cast<AtomId>(keys.size() - 1);
+                        }
+                        if (slot.tag == tag && keys[slot.id] == key)
+                            return slot.id;
+                    }
                 }
-            }
 
-            // Get neighbors of an atom (const-correct)
-            std::vector<T> neighbors(const T &atom) const
+                const std::vector<Key> &names() const { return keys; }
+                std::vector<Key> takeNames() { return std::move(keys); }
+            };
+
+            // One newline-aligned slice of the input, parsed independently.
+            // Atom IDs are chunk-local until remapped.
+            template <typename Key>
+            struct EdgeListChunk
             {
-                auto it = adjacency.find(atom);
-                if (it != adjacency.end())
+                size_t begin = 0;
+                size_t end = 0;
+                std::vector<Key> names; // first-appearance order
+                std::vector<MoleculeCsr::AtomId> from;
+                std::vector<MoleculeCsr::AtomId> to;
+                std::vector<double> weights;
+                bool weighted = false;
+                size_t errorOffset = std::numeric_limits<size_t>::max();
+                std::string error;
+            };
+
+            template <typename Key>
+            bool parseEdgeListKey(std::string_view token, Key &key)
+            {
+                if constexpr (std::is_integral<Key>::value)
                 {
-                    return it->second;
+                    auto result = std::from_chars(token.data(), token.data() + token.size(), key);
+                    return result.ec == std::errc() && result.ptr == token.data() + token.size();
+                }
+                else
+                {
+                    key = token;
+                    return true;
                 }
-                return std::vector<T>();
             }
 
-            // Check if atom exists
-            bool hasAtom(const T &atom) const
+            inline bool parseEdgeListWeight(std::string_view token, double &weight)
             {
-                return atoms.find(atom) != atoms.end();
+                // strtod needs a terminated buffer; the mapping has none
+                char text[64];
+                if (token.size() >= sizeof(text))
+                    return false;
+                std::memcpy(text, token.data(), token.size());
+                text[token.size()] = '\0';
+                char *end = nullptr;
+                weight = std::strtod(text, &end);
+                return end == text + token.size();
             }
 
-            // Check if bond exists
-            bool hasBond(const T &from, const T &to, BondType type) const
+            template <typename Key>
+            void parseEdgeListChunk(const char *data, EdgeListChunk<Key> &chunk)
             {
-                for (const auto &bond : bonds)
+                EdgeListInterner<Key> local((chunk.end - chunk.begin) / 32);
+                auto intern = [&](const Key &key)
+                { return local.intern(key); };
+
+                size_t pos = chunk.begin;
+                while (pos < chunk.end)
                 {
-                    if (bond.from == from && bond.to == to && bond.type == type)
+                    const char *newline = static_cast<const char *>(std::memchr(data + pos, '\n', chunk.end - pos));
+                    const size_t lineEnd = newline ? static_cast<size_t>(newline - data) : chunk.end;
+                    const size_t lineStart = pos;
+                    pos = lineEnd + 1;
+
+                    std::string_view tokens[4];
+                    size_t count = 0;
+                    size_t i = lineStart;
+                    while (i < lineEnd && count < 4)
                     {
-                        return true;
+                        while (i < lineEnd && isEdgeListDelimiter(data[i]))
+                            i++;
+                        size_t start = i;
+                        while (i < lineEnd && !isEdgeListDelimiter(data[i]))
+                            i++;
+                        if (i > start)
+                            tokens[count++] = std::string_view(data + start, i - start);
+                    }
+                    if (count == 0 || tokens[0][0] == '#' || tokens[0][0] == '%')
+                        continue;
+
+                    Key from{}, to{};
+                    double weight = 1.0;
+                    if (count < 2 || count > 3)
+                        chunk.error = "expected 'from to [weight]'";
+                    else if (!parseEdgeListKey(tokens[0], from) || !parseEdgeListKey(tokens[1], to))
+                        chunk.error = "invalid atom name";
+                    else if (count == 3 && !parseEdgeListWeight(tokens[2], weight))
+                        chunk.error = "invalid weight '" + std::string(tokens[2]) + "'";
+                    if (!chunk.error.empty())
+                    {
+                        chunk.errorOffset = lineStart;
+                        break;
                     }
+
+                    chunk.from.push_back(intern(from));
+                    chunk.to.push_back(intern(to));
+                    chunk.weights.push_back(weight);
+                    chunk.weighted = chunk.weighted || count == 3;
                 }
-                return false;
+                chunk.names = local.takeNames();
             }
 
-            // Get all atoms (const reference)
-            const std::unordered_set<T> &getAtoms() const
+            // Split [begin, end) into about 'parts' slices that each end on a newline
+            inline std::vector<std::pair<size_t, size_t>> splitAtNewlines(const char *data, size_t begin, size_t end, size_t parts)
             {
-                return atoms;
+                std::vector<std::pair<size_t, size_t>> slices;
+                size_t start = begin;
+                for (size_t k = 1; k <= parts && start < end; k++)
+                {
+                    size_t stop = k == parts ? end : std::max(start, begin + (end - begin) * k / parts);
+                    if (stop < end)
+                    {
+                        const char *newline = static_cast<const char *>(std::memchr(data + stop, '\n', end - stop));
+                        stop = newline ? static_cast<size_t>(newline - data) + 1 : end;
+                    }
+                    slices.emplace_back(start, stop);
+                    start = stop;
+                }
+                return slices;
             }
 
-            // Get all bonds (const reference)
-            const std::vector<MoleculeBond<T>> &getBonds() const
+            template <typename T, typename Key>
+            T edgeListName(const Key &key)
             {
-                return bonds;
+                return T(key);
             }
+        } // namespace detail
 
-            // Atom count (size_t for consistency)
-            size_t atomCount() const { return atoms.size(); }
-
-            // Bond count (size_t for consistency)
-            size_t bondCount() const { return bonds.size(); }
+        // Parses the file in parallel newline-aligned chunks, interns names in
+        // order of first appearance (so atom IDs match an addBond loop over the
+        // same lines) and builds the CSR with a counting pass and one scatter.
+        template <typename T = std::string>
+        FrozenMolecule<T> loadEdgeList(const std::string &path, const EdgeListOptions &options = EdgeListOptions(),
+                                       ThreadPool &pool = ThreadPool::global())
+        {
+            static_assert(std::is_integral<T>::value || std::is_same<T, std::string>::value,
+                          "loadEdgeList: atom type must be std::string or an integer type");
+            using AtomId = MoleculeCsr::AtomId;
+            using Key = detail::EdgeListKey<T>;
 
-            // Clear all data
-            void clear()
+            MappedFile file(path);
+            const char *data = file.data();
+            size_t begin = 0;
+            if (options.header && !file.empty())
             {
-                atoms.clear();
-                bonds.clear();
-                adjacency.clear();
+                const char *newline = static_cast<const char *>(std::memchr(data, '\n', file.size()));
+                begin = newline ? static_cast<size_t>(newline - data) + 1 : file.size();
             }
 
-            // Check if molecule is empty
-            bool empty() const
+            // Phase 1: tokenize and intern chunk-locally, in parallel
+            const size_t minChunkBytes = size_t(1) << 20;
+            // A single worker parses one chunk: splitting would only repeat the interning
+            const size_t perWorker = pool.size() > 1 ? 4 : 1;
+            const size_t parts = std::max<size_t>(1, std::min(pool.size() * perWorker, (file.size() - begin) / minChunkBytes + 1));
+            std::vector<detail::EdgeListChunk<Key>> chunks;
+            for (const auto &slice : detail::splitAtNewlines(data, begin, file.size(), parts))
             {
-                return atoms.empty() && bonds.empty();
+                chunks.emplace_back();
+                chunks.back().begin = slice.first;
+                chunks.back().end = slice.second;
             }
+            pool.parallelFor(0, chunks.size(), [&](size_t c)
+                             { detail::parseEdgeListChunk(data, chunks[c]); }, 1);
 
-            // BFS traversal (returns nodes in BFS order)
-            std::vector<T> bfs(const T &start) const
+            for (const auto &chunk : chunks)
             {
-                if (!hasAtom(start))
+                if (!chunk.error.empty())
                 {
-                    return std::vector<T>(); // Start atom doesn't exist
+                    size_t line = 1 + static_cast<size_t>(std::count(data, data + chunk.errorOffset, '\n'));
+                    throw std::runtime_error("loadEdgeList: " + path + ":" + std::to_string(line) + ": " + chunk.error);
                 }
+            }
 
-                std::vector<T> result;
-                std::unordered_set<T> visited;
-                std::queue<T> queue;
+            // Phase 2: global intern in chunk order
+            detail::EdgeListInterner<Key> global(chunks.empty() ? 0 : chunks[0].names.size());
+            std::vector<std::vector<AtomId>> remap(chunks.size());
+            bool weighted = false;
+            for (size_t c = 0; c < chunks.size(); c++)
+            {
+                remap[c].reserve(chunks[c].names.size());
+                for (const Key &key : chunks[c].names)
+                    remap[c].push_back(global.intern(key));
+                weighted = weighted || chunks[c].weighted;
+            }
+            const std::vector<Key> &keys = global.names();
 
-                queue.push(start);
-                visited.insert(start);
+            // Phase 3: translate to global IDs in parallel, then count and scatter
+            pool.parallelFor(0, chunks.size(), [&](size_t c)
+                             {
+                for (AtomId &id : chunks[c].from)
+                    id = remap[c][id];
+                for (AtomId &id : chunks[c].to)
+                    id = remap[c][id]; }, 1);
 
-                while (!queue.empty())
+            const size_t atoms = keys.size();
+            MoleculeCsr g;
+            g.offsets.assign(atoms + 1, 0);
+            for (const auto &chunk : chunks)
+            {
+                for (size_t e = 0; e < chunk.from.size(); e++)
                 {
-                    T current = queue.front();
-                    queue.pop();
-                    result.push_back(current);
-
-                    auto neighs = neighbors(current);
-                    for (const auto &neighbor : neighs)
-                    {
-                        if (visited.find(neighbor) == visited.end())
-                        {
-                            visited.insert(neighbor);
-                            queue.push(neighbor);
-                        }
-                    }
+                    g.offsets[chunk.from[e] + 1]++;
+                    if (!options.directed)
+                        g.offsets[chunk.to[e] + 1]++;
                 }
-
-                return result;
             }
+            for (size_t id = 0; id < atoms; id++)
+                g.offsets[id + 1] += g.offsets[id];
 
-            // DFS traversal (returns nodes in DFS order)
-            std::vector<T> dfs(const T &start) const
+            g.targets.resize(g.offsets[atoms]);
+            if (weighted)
+                g.weights.resize(g.offsets[atoms]);
+            std::vector<size_t> cursor(g.offsets.begin(), g.offsets.end() - 1);
+            for (const auto &chunk : chunks)
             {
-                if (!hasAtom(start))
+                for (size_t e = 0; e < chunk.from.size(); e++)
                 {
-                    return std::vector<T>();
+                    size_t slot = cursor[chunk.from[e]]++;
+                    g.targets[slot] = chunk.to[e];
+                    if (weighted)
+                        g.weights[slot] = chunk.weights[e];
+                    if (!options.directed)
+                    {
+                        slot = cursor[chunk.to[e]]++;
+                        g.targets[slot] = chunk.from[e];
+                        if (weighted)
+                            g.weights[slot] = chunk.weights[e];
+                    }
                 }
-
-                std::vector<T> result;
-                std::unordered_set<T> visited;
-                dfsHelper(start, visited, result);
-                return result;
             }
 
-            // Check if there's a path from 'from' to 'to'
-            bool hasPath(const T &from, const T &to) const
+            std::vector<T> names;
+            names.reserve(atoms);
+            for (const Key &key : keys)
+                names.push_back(detail::edgeListName<T>(key));
+            return FrozenMolecule<T>(std::move(names), std::move(g), options.directed);
+        }
+
+        // Binary snapshot of a FrozenMolecule: a fixed header followed by the CSR
+        // arrays and the name table, all in native byte order. Loading maps the
+        // file and copies each array out in one pass, with no parsing or hashing
+        // beyond rebuilding the name index.
+        //
+        //   header | uint64 offsets[n+1] | uint32 targets[e] | pad to 8
+        //          | double weights[e] (if weighted)
+        //          | int64 names[n]                          (integer atoms)
+        //          | uint64 nameOffsets[n+1] | char bytes[]  (string atoms)
+        namespace detail
+        {
+            struct SnapshotHeader
             {
-                if (!hasAtom(from) || !hasAtom(to))
-                {
-                    return false;
-                }
+                char magic[8];
+                uint32_t version;
+                uint32_t byteOrder;
+                uint32_t flags;
+                uint32_t reserved;
+                uint64_t atomCount;
+                uint64_t edgeCount;
+                uint64_t namesBytes;
+            };
 
-                if (from == to)
-                {
-                    return true;
-                }
+            constexpr char SNAPSHOT_MAGIC[8] = {'L', 'P', 'P', 'M', 'O', 'L', '1', '\0'};
+            constexpr uint32_t SNAPSHOT_VERSION = 1;
+            constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+            constexpr uint32_t SNAPSHOT_DIRECTED = 1;
+            constexpr uint32_t SNAPSHOT_WEIGHTED = 2;
+            constexpr uint32_t SNAPSHOT_INTEGER_NAMES = 4;
 
-                std::unordered_set<T> visited;
-                std::queue<T> queue;
+            inline size_t snapshotPadding(size_t bytes) { return (8 - bytes % 8) % 8; }
 
-                queue.push(from);
-                visited.insert(from);
+            template <typename U>
+            void writeSnapshotArray(std::ofstream &out, const U *items, size_t count)
+            {
+                out.write(reinterpret_cast<const char *>(items), static_cast<std::streamsize>(count * sizeof(U)));
+            }
 
-                while (!queue.empty())
-                {
-                    T current = queue.front();
-                    queue.pop();
+            // Bounds-checked sequential reader over a mapped snapshot
+            class SnapshotReader
+            {
+            private:
+                const char *data;
+                size_t size;
+                size_t pos = 0;
+
+            public:
+                SnapshotReader(const char *bytes, size_t length) : data(bytes), size(length) {}
 
-                    if (current == to)
+                template <typename U>
+                void read(U *items, size_t count)
+                {
+                    if (count > (size - pos) / sizeof(U))
                     {
-                        return true;
+                        throw std::runtime_error("loadSnapshot: file is truncated");
                     }
+                    if (count > 0)
+                        std::memcpy(items, data + pos, count * sizeof(U));
+                    pos += count * sizeof(U);
+                }
 
-                    auto neighs = neighbors(current);
-                    for (const auto &neighbor : neighs)
+                const char *take(size_t bytes)
+                {
+                    if (bytes > size - pos)
                     {
-                        if (visited.find(neighbor) == visited.end())
-                        {
-                            visited.insert(neighbor);
-                            queue.push(neighbor);
-                        }
+                        throw std::runtime_error("loadSnapshot: file is truncated");
                     }
+                    const char *start = data + pos;
+                    pos += bytes;
+                    return start;
                 }
 
-                return false;
-            }
+                void skip(size_t bytes) { take(bytes); }
+                bool atEnd() const { return pos == size; }
+            };
+        } // namespace detail
 
-            // Check if graph is connected
-            bool isConnected() const
+        template <typename T>
+        void saveSnapshot(const FrozenMolecule<T> &mol, const std::string &path)
+        {
+            static_assert(std::is_integral<T>::value || std::is_same<T, std::string>::value,
+                          "saveSnapshot: atom type must be std::string or an integer type");
+            const MoleculeCsr &g = mol.csr();
+            const size_t atoms = mol.atomCount();
+            const size_t edges = g.edgeCount();
+            const bool weighted = !g.weights.empty();
+
+            detail::SnapshotHeader header{};
+            std::memcpy(header.magic, detail::SNAPSHOT_MAGIC, sizeof(header.magic));
+            header.version = detail::SNAPSHOT_VERSION;
+            header.byteOrder = detail::SNAPSHOT_BYTE_ORDER;
+            header.flags = (mol.isDirected() ? detail::SNAPSHOT_DIRECTED : 0) |
+                           (weighted ? detail::SNAPSHOT_WEIGHTED : 0) |
+                           (std::is_integral<T>::value ? detail::SNAPSHOT_INTEGER_NAMES : 0);
+            header.atomCount = atoms;
+            header.edgeCount = edges;
+
+            std::vector<uint64_t> nameOffsets;
+            if constexpr (!std::is_integral<T>::value)
             {
-                if (atoms.empty())
-                {
-                    return true; // Empty graph is vacuously connected
-                }
+                nameOffsets.reserve(atoms + 1);
+                nameOffsets.push_back(0);
+                for (const auto &name : mol.getAtoms())
+                    nameOffsets.push_back(nameOffsets.back() + name.size());
+                header.namesBytes = nameOffsets.back();
+            }
 
-                // BFS from first atom
-                T start = *atoms.begin();
-                auto reachable = bfs(start);
-                return reachable.size() == atoms.size();
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                throw std::runtime_error("saveSnapshot: cannot open " + path);
             }
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
 
-            // Detect if graph has cycles (undirected)
-            bool hasCycle() const
+            std::vector<uint64_t> offsets(g.offsets.begin(), g.offsets.end());
+            detail::writeSnapshotArray(out, offsets.data(), offsets.size());
+            detail::writeSnapshotArray(out, g.targets.data(), edges);
+            const char zeros[8] = {};
+            out.write(zeros, static_cast<std::streamsize>(detail::snapshotPadding(edges * sizeof(MoleculeCsr::AtomId))));
+            if (weighted)
+                detail::writeSnapshotArray(out, g.weights.data(), edges);
+
+            if constexpr (std::is_integral<T>::value)
             {
-                std::unordered_set<T> visited;
-                std::unordered_map<T, T> parent;
+                std::vector<int64_t> names(mol.getAtoms().begin(), mol.getAtoms().end());
+                detail::writeSnapshotArray(out, names.data(), atoms);
+            }
+            else
+            {
+                detail::writeSnapshotArray(out, nameOffsets.data(), nameOffsets.size());
+                for (const auto &name : mol.getAtoms())
+                    out.write(name.data(), static_cast<std::streamsize>(name.size()));
+            }
 
-                for (const auto &atom : atoms)
-                {
-                    if (visited.find(atom) == visited.end())
-                    {
-                        if (hasCycleHelper(atom, visited, parent, T()))
-                        {
-                            return true;
-                        }
-                    }
-                }
-                return false;
+            if (!out)
+            {
+                throw std::runtime_error("saveSnapshot: write failed for " + path);
             }
+        }
 
-        private:
-            // DFS helper
-            void dfsHelper(const T &node, std::unordered_set<T> &visited, std::vector<T> &result) const
+        template <typename T = std::string>
+        FrozenMolecule<T> loadSnapshot(const std::string &path)
+        {
+            static_assert(std::is_integral<T>::value || std::is_same<T, std::string>::value,
+                          "loadSnapshot: atom type must be std::string or an integer type");
+            using AtomId = MoleculeCsr::AtomId;
+
+            MappedFile file(path);
+            detail::SnapshotReader reader(file.data(), file.size());
+            detail::SnapshotHeader header;
+            reader.read(&header, 1);
+
+            if (std::memcmp(header.magic, detail::SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+            {
+                throw std::runtime_error("loadSnapshot: " + path + " is not a molecule snapshot");
+            }
+            if (header.version != detail::SNAPSHOT_VERSION || header.byteOrder != detail::SNAPSHOT_BYTE_ORDER)
+            {
+                throw std::runtime_error("loadSnapshot: " + path + " has an unsupported version or byte order");
+            }
+            if (((header.flags & detail::SNAPSHOT_INTEGER_NAMES) != 0) != std::is_integral<T>::value)
+            {
+                throw std::invalid_argument("loadSnapshot: atom type does not match the snapshot");
+            }
+            if (header.atomCount >= MoleculeCsr::NO_ATOM || header.atomCount > file.size() ||
+                header.edgeCount > file.size())
             {
-                visited.insert(node);
-                result.push_back(node);
+                throw std::runtime_error("loadSnapshot: " + path + " has a corrupt header");
+            }
 
-                auto neighs = neighbors(node);
-                for (const auto &neighbor : neighs)
-                {
-                    if (visited.find(neighbor) == visited.end())
-                    {
-                        dfsHelper(neighbor, visited, result);
-                    }
-                }
+            const size_t atoms = static_cast<size_t>(header.atomCount);
+            const size_t edges = static_cast<size_t>(header.edgeCount);
+            MoleculeCsr g;
+            std::vector<uint64_t> offsets(atoms + 1);
+            reader.read(offsets.data(), offsets.size());
+            g.offsets.assign(offsets.begin(), offsets.end());
+            g.targets.resize(edges);
+            reader.read(g.targets.data(), edges);
+            reader.skip(detail::snapshotPadding(edges * sizeof(AtomId)));
+            if (header.flags & detail::SNAPSHOT_WEIGHTED)
+            {
+                g.weights.resize(edges);
+                reader.read(g.weights.data(), edges);
             }
 
-            // Cycle detection helper
-            bool hasCycleHelper(const T &node, std::unordered_set<T> &visited,
-                                std::unordered_map<T, T> &parent, const T &par) const
+            // Reject anything the algorithms would index out of bounds with
+            if (g.offsets[0] != 0 || g.offsets[atoms] != edges)
+            {
+                throw std::runtime_error("loadSnapshot: " + path + " has inconsistent offsets");
+            }
+            for (size_t id = 0; id < atoms; id++)
+            {
+                if (g.offsets[id] > g.offsets[id + 1])
+                    throw std::runtime_error("loadSnapshot: " + path + " has inconsistent offsets");
+            }
+            for (AtomId target : g.targets)
             {
-                visited.insert(node);
-                parent[node] = par;
+                if (target >= atoms)
+                    throw std::runtime_error("loadSnapshot: " + path + " has an out-of-range edge");
+            }
 
-                auto neighs = neighbors(node);
-                for (const auto &neighbor : neighs)
+            std::vector<T> names;
+            names.reserve(atoms);
+            if constexpr (std::is_integral<T>::value)
+            {
+                std::vector<int64_t> stored(atoms);
+                reader.read(stored.data(), atoms);
+                names.assign(stored.begin(), stored.end());
+            }
+            else
+            {
+                std::vector<uint64_t> nameOffsets(atoms + 1);
+                reader.read(nameOffsets.data(), nameOffsets.size());
+                if (nameOffsets[0] != 0 || nameOffsets[atoms] != header.namesBytes)
                 {
-                    if (visited.find(neighbor) == visited.end())
-                    {
-                        if (hasCycleHelper(neighbor, visited, parent, node))
-                        {
-                            return true;
-                        }
-                    }
-                    else if (neighbor != parent[node])
-                    {
-                        return true; // Back edge detected
-                    }
+                    throw std::runtime_error("loadSnapshot: " + path + " has a corrupt name table");
+                }
+                const char *bytes = reader.take(static_cast<size_t>(header.namesBytes));
+                for (size_t id = 0; id < atoms; id++)
+                {
+                    if (nameOffsets[id] > nameOffsets[id + 1])
+                        throw std::runtime_error("loadSnapshot: " + path + " has a corrupt name table");
+                    names.emplace_back(bytes + nameOffsets[id], bytes + nameOffsets[id + 1]);
                 }
-                return false;
             }
-        };
+            if (!reader.atEnd())
+            {
+                throw std::runtime_error("loadSnapshot: " + path + " has trailing data");
+            }
+
+            return FrozenMolecule<T>(std::move(names), std::move(g), (header.flags & detail::SNAPSHOT_DIRECTED) != 0);
+        }
 
         // ===== GRAPH UTILITIES (NEW in v0.8.16) =====
         // Additional graph algorithms as standalone functions